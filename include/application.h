@@ -1,8 +1,27 @@
 #include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #include "maze.h"
 #include "mazeBuilder.h"
 #include "mazeSolver.h"
+#include "tripleBuffer.h"
+#include "profiler.h"
+#include "mazeLod.h"
+#include "mazeExporter.h"
+#include "mazeFile.h"
+#include "mazeRecorder.h"
+#include "mazeCheckpoint.h"
+#include "mazeGraph.h"
+#include "mazeWeights.h"
+#include "mazeMetrics.h"
+#include "mazeRace.h"
+#include "mazeArena.h"
+#include "mazeRegistry.h"
+#include "mazeSessions.h"
+#include "mazeCounters.h"
+#include "mazeMemory.h"
 
 class Application
 {
@@ -13,41 +32,164 @@ public:
     Application(uint16_t* width, uint16_t* height);
     ~Application();
 
+    // Called by the render thread once per frame, only creates/destroys the algorithms
     void GetButtonStates();
     uint32_t GetPathIfFound();
     bool IsButtonPressed(uint16_t buttonPressed) const;
     void DeleteMaze();
+    // Safe to call from the render thread while the simulation is running
+    void RecreateMaze(uint16_t cellWidth, uint16_t wallThickness);
+
+    // Latest state published by the simulation thread, call once per frame before drawing
+    const MazeSnapshot& ConsumeSnapshot();
+    bool IsBuilderCompleted() const;
+    bool IsSolverCompleted() const;
+    // Rebuilds the level of detail pyramid from the current snapshot, throttled for huge mazes
+    void UpdateLevelOfDetail();
+    // Rasterizes the current maze and solver path on the CPU, .png or .ppm
+    bool ExportImage(const std::string& filePath, uint16_t cellPixelSize);
+    bool SaveMaze(const std::string& filePath, bool withWeights);
+    // Replaces the current maze, it comes back completed so a solver can be started right away
+    bool LoadMaze(const std::string& filePath);
+    // Snapshot of the maze, builder and solver which is written on a background thread
+    void SaveCheckpoint();
+    // Continues the run stored in a checkpoint exactly where it stopped
+    bool LoadCheckpoint(const std::string& filePath);
+    // Adjacency of the completed maze for graph tools, the format comes from the extension: .csr, .edges or .gr (DIMACS)
+    bool ExportGraph(const std::string& filePath, bool withWeights);
+    // Fills the weights with the generator of m_WeightSettings, a running solver sees them from its next step
+    void ReassignWeights();
+    // Weight map of the current maze, see MazeWeights::Load for the formats
+    bool LoadWeights(const std::string& filePath);
+    bool SaveWeights(const std::string& filePath);
+    // Fills in m_Metrics from the completed maze and the solver path if there is one
+    void ComputeMetrics();
+    // Always computes the metrics again first
+    bool ExportMetrics(const std::string& filePath);
+    // Start and goal of the next solver, a running one heads for the new goal from its next step. Takes the simulation lock
+    void SetRoute(uint32_t start, uint32_t end);
+    // Runs every solver at once on the completed maze, each on its own thread and search overlay
+    void StartRace();
+    void StopRace();
+    // Solver of the race shown by ConsumeSnapshot, -1 shows the maze and its own solver
+    void SetRaceView(int racer);
+    int GetRaceView() const { return m_RaceView; }
+    // Refills m_MemoryReport and samples the resident size, a few times a second at most. Render thread, takes the
+    // simulation lock like GetButtonStates. Call it before the geometry of the maze is cleared for the next frame
+    void SampleMemory();
+    // Hardware counters of the builder and solver in the current snapshot
+    const MazeCounterSample& GetBuilderCounters() const { return m_CurrentSnapshot->builderCounters; }
+    const MazeCounterSample& GetSolverCounters() const { return m_CurrentSnapshot->solverCounters; }
+
+private:
+    void SimulationLoop();
+    // Advances the running builder or solver by up to maxSteps steps, returns how many it took, 0 when there was nothing to do
+    uint64_t StepSimulation(uint64_t maxSteps);
+    void PublishSnapshot();
+    // Opens the step log of a builder or solver which was just created
+    void StartRecording(MazeRecorder& recorder, const std::string& filePath, MazeLogKind kind, uint8_t algorithm);
+    // Needs the simulation lock, skipped while the previous checkpoint is still being written
+    void CaptureCheckpoint();
+    // Plugins keep state checkpoints do not know about. Needs the simulation lock
+    bool UsesPlugin() const;
+    // Needs the simulation lock
+    void GenerateWeights();
 
 public:
     uint16_t* m_Width, * m_Height = nullptr;
 
+    // Buffers of deleted mazes, builders and solvers for the next ones
+    MazeArena m_Arena;
     Maze* m_Maze = nullptr;
     MazeBuilder* m_MazeBuilder = nullptr;
     MazeSolver* m_MazeSolver = nullptr;
-    int m_Delay = 10;
+    // Built once the maze is completed and shared by the solvers
+    MazeGraph m_MazeGraph;
+    // Delay between two simulation steps, 0 runs the algorithms as fast as possible
+    std::atomic<int> m_Delay = 10;
+    std::atomic<bool> m_SimulationPaused = false;
 
     bool m_PathAnimation = true;
     float m_PathSpeed = 0.05;
     float m_ColorPath[4] = { 1.0f, 0.0f, 0.0f, 1.0f };
 
-    const enum
+    enum
     {
         PATH = 0x01,
         MAZE = 0x02,
-        BUILDER_RECURSIVE_BACKTRACK = 0x04,
-        BUILDER_KRUSKAL = 0x08,
-        BUILDER_PRIMS = 0x10,
-        BUILDER_WILSON = 0x20,
-        SOLVER_DFS = 0x40,
-        SOLVER_BFS = 0x80,
-        SOLVER_DIJKSTRA = 0x100,
-        SOLVER_ASTAR = 0x200
+        // One of the registered builders or solvers, which one is in m_BuilderRequested and m_SolverRequested
+        BUILDER = 0x04,
+        SOLVER = 0x08
     };
 
-    uint16_t m_ButtonStates = 0x00;
+    // Written by ImGui and read by both threads
+    std::atomic<uint16_t> m_ButtonStates = 0x00;
+    // Set before the BUILDER or SOLVER button state
+    std::atomic<uint8_t> m_BuilderRequested = MazeBuilder::Algorithms::NONE;
+    std::atomic<uint8_t> m_SolverRequested = MazeSolver::Algorithms::NONE;
     
     MazeBuilder::Algorithms m_BuilderSelected = MazeBuilder::Algorithms::NONE;
     MazeSolver::Algorithms m_SolverSelected = MazeSolver::Algorithms::NONE;
 
+    // Written on the render thread with the simulation lock held, see SetRoute
     std::pair<uint32_t, uint32_t> m_Route;
+
+    Profiler m_Profiler;
+    MazeLod m_MazeLod;
+    // Maze is this many times larger than the scene window, zooming in shows the cells
+    uint16_t m_MazeScale = 1;
+    // Size of a cell in exported images
+    uint16_t m_ExportCellPixels = 8;
+    bool m_SaveWeights = true;
+    // Generator used for every new maze and by Reassign Weights, a new seed is drawn each time unless fixed
+    MazeWeightSettings m_WeightSettings;
+    bool m_FixedWeightSeed = false;
+    // Builders and solvers started while this is set write a step log, see MazeLog
+    bool m_RecordSteps = false;
+    std::string m_CheckpointPath = "maze.ckpt";
+    // Seconds between automatic checkpoints of a running builder or solver, 0 turns them off
+    std::atomic<int> m_CheckpointInterval = 0;
+    // Shape of the current maze, only valid until the maze or its solution changes
+    MazeMetrics m_Metrics;
+    bool m_MetricsValid = false;
+    // Results stay after the race until the maze or its weights change
+    MazeRace m_Race;
+    // Independent mazes shown side by side in the Sessions window, stepped on a pool of their own with the same delay and pause
+    MazeSessions m_Sessions{ &m_Delay, &m_SimulationPaused };
+    // Hardware counters around every batch of builder and solver steps, see MazeCounters. They show up in the snapshots
+    std::atomic<bool> m_CountHardwareEvents = true;
+    // Structures of the maze, builder, solver and renderer by subsystem, refreshed by SampleMemory
+    MazeMemoryReport m_MemoryReport;
+    MazeMemoryHistory m_MemoryHistory;
+
+private:
+    // Held by the simulation thread while stepping and by the render thread while
+    // it creates or destroys the maze, builder or solver
+    std::mutex m_SimulationMutex;
+    std::thread m_SimulationThread;
+    std::atomic<bool> m_SimulationRunning = true;
+    // Forces a snapshot even when no step was taken e.g. after a reset
+    std::atomic<bool> m_SnapshotRequested = true;
+    uint64_t m_SnapshotSequence = 0;
+    // Steps taken between two looks at the clock when there is no delay, small enough that the publish interval holds
+    static constexpr uint64_t STEPS_PER_CLOCK_CHECK = 256;
+
+    MazeRecorder m_BuilderRecorder;
+    MazeRecorder m_SolverRecorder;
+
+    // Opened by the simulation thread for itself
+    MazeCounters m_Counters;
+    // Counted for the current builder and solver, reset with them under the simulation lock
+    MazeCounterSample m_BuilderCounters;
+    MazeCounterSample m_SolverCounters;
+
+    // Captured under the lock, written by m_CheckpointThread without it
+    std::vector<uint8_t> m_CheckpointData;
+    std::thread m_CheckpointThread;
+    std::atomic<bool> m_CheckpointWriting = false;
+
+    TripleBuffer<MazeSnapshot> m_Snapshots;
+    const MazeSnapshot* m_CurrentSnapshot = nullptr;
+    // Render thread only
+    int m_RaceView = -1;
 };
\ No newline at end of file
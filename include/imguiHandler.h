@@ -1,3 +1,8 @@
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
 #include <imgui.h>
 #include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_opengl3.h>
@@ -11,6 +16,19 @@ namespace ImGuiHandler
 {
     void ControlTab(bool& showDemoWindow, Application& application);
     void VisualizeTab(bool& showDemoWindow, Application& application);
+    void ProfilerTab(Application& application);
+    void HardwareCounters(Application& application);
+    void MemoryTab(Application& application);
+
+    // Texture main.cpp uploads the latest frame of a session to, with what the frame said about the session
+    struct SessionView
+    {
+        unsigned int texture = 0;
+        uint64_t sequence = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        MazeSessionStats stats;
+    };
 
     void Init(const char* glslVersion, GLFWwindow* window)
     {
@@ -84,18 +102,31 @@ namespace ImGuiHandler
                 VisualizeTab(showDemoWindow, application);
                 ImGui::EndTabItem();
             }
+
+            if (ImGui::BeginTabItem("Profiler"))
+            {
+                ProfilerTab(application);
+                ImGui::EndTabItem();
+            }
+
+            if (ImGui::BeginTabItem("Memory"))
+            {
+                MemoryTab(application);
+                ImGui::EndTabItem();
+            }
             ImGui::EndTabBar();
         }
         // FIXME: ImGui::End() called in main.cpp
     }
 
-    void EndFrame(ImGuiID dockSpaceID, unsigned int* texture, ImVec2& getRegion, bool& imguiWindowResized)
+    void EndFrame(ImGuiID dockSpaceID, unsigned int* texture, ImVec2& getRegion, bool& imguiWindowResized, Application& application)
     {
         ImGui::SetNextWindowDockID(dockSpaceID, ImGuiCond_FirstUseEver);
         ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.f, 0.f));
         ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(0.f, 0.f));
         ImGui::PushStyleVar(ImGuiStyleVar_WindowMinSize, ImVec2(0.f, 0.f));
-        ImGui::Begin("SceneWindow", false, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_HorizontalScrollbar);
+        ImGui::Begin("SceneWindow", false, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_HorizontalScrollbar
+            | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoScrollWithMouse);
         if (getRegion.x != ImGui::GetContentRegionAvail().x || getRegion.y != ImGui::GetContentRegionAvail().y)
             imguiWindowResized = true;
         getRegion = ImGui::GetContentRegionAvail();
@@ -103,6 +134,27 @@ namespace ImGuiHandler
         // To invert the image
         //ImGui::Image((void*)(unsigned int)(*texture), getRegion, ImVec2(0, 1), ImVec2(1, 0));
         ImGui::Image((void*)(unsigned int)(*texture), getRegion);
+
+        // Wheel zooms around the cursor, dragging pans and double click shows the whole maze again
+        // Shift + click is left for picking the start and end cells
+        if (ImGui::IsItemHovered() && getRegion.x > 0 && getRegion.y > 0)
+        {
+            ImGuiIO& io = ImGui::GetIO();
+            ImVec2 imageMin = ImGui::GetItemRectMin();
+
+            // Same -1 to 1 range as the maze vertices, the image is not inverted so -1 is the top
+            float screenX = 2.0f * (io.MousePos.x - imageMin.x) / getRegion.x - 1.0f;
+            float screenY = 2.0f * (io.MousePos.y - imageMin.y) / getRegion.y - 1.0f;
+
+            if (io.MouseWheel != 0.0f)
+                application.m_Maze->ZoomView(std::pow(1.2f, io.MouseWheel), screenX, screenY);
+
+            if (!io.KeyShift && (ImGui::IsMouseDragging(ImGuiMouseButton_Left) || ImGui::IsMouseDragging(ImGuiMouseButton_Middle)))
+                application.m_Maze->PanView(2.0f * io.MouseDelta.x / getRegion.x, 2.0f * io.MouseDelta.y / getRegion.y);
+
+            if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left))
+                application.m_Maze->SetView(1.0f, 0.0f, 0.0f);
+        }
         ImGui::PopStyleVar(3);
     }
 
@@ -120,29 +172,18 @@ namespace ImGuiHandler
         ImGui::SetNextItemOpen(true, ImGuiCond_Once);
         if (ImGui::TreeNode("Building Algorithms"))
         {
-            if ((!application.m_MazeBuilder || !application.m_MazeBuilder->m_Completed) &&
-                !application.IsButtonPressed(Application::BUILDER_RECURSIVE_BACKTRACK) &&
-                !application.IsButtonPressed(Application::BUILDER_KRUSKAL) &&
-                !application.IsButtonPressed(Application::BUILDER_PRIMS))
-            {
-                application.m_ButtonStates |= (ImGui::Button("Recursive Backtrack") ? Application::BUILDER_RECURSIVE_BACKTRACK : 0x00);
-                application.m_ButtonStates |= (ImGui::Button("Kruskal") ? Application::BUILDER_KRUSKAL : 0x00);
-                application.m_ButtonStates |= (ImGui::Button("Prims") ? Application::BUILDER_PRIMS : 0x00);
-                application.m_ButtonStates |= (ImGui::Button("Wilson") ? Application::BUILDER_WILSON : 0x00);
-            }
-            else if ((application.m_MazeBuilder && application.m_MazeBuilder->m_Completed) ||
-                application.IsButtonPressed(Application::BUILDER_RECURSIVE_BACKTRACK) ||
-                application.IsButtonPressed(Application::BUILDER_KRUSKAL) ||
-                application.IsButtonPressed(Application::BUILDER_PRIMS) ||
-                application.IsButtonPressed(Application::BUILDER_WILSON))
+            // Disabled once one was pressed, until Reset All
+            const bool available = (!application.m_MazeBuilder || !application.IsBuilderCompleted()) && !application.IsButtonPressed(Application::BUILDER);
+            ImGui::BeginDisabled(!available);
+            for (const MazeBuilderEntry& entry : MazeRegistry::GetBuilders())
             {
-                ImGui::BeginDisabled();
-                ImGui::Button("Recursive Backtrack");
-                ImGui::Button("Kruskal");
-                ImGui::Button("Prims");
-                ImGui::Button("Wilson");
-                ImGui::EndDisabled();
+                if (ImGui::Button(entry.label.c_str()) && available)
+                {
+                    application.m_BuilderRequested = entry.algorithm;
+                    application.m_ButtonStates |= Application::BUILDER;
+                }
             }
+            ImGui::EndDisabled();
             ImGui::TreePop();
         }
         ImGui::NewLine();
@@ -150,26 +191,87 @@ namespace ImGuiHandler
         ImGui::SetNextItemOpen(true, ImGuiCond_Once);
         if (ImGui::TreeNode("Solving Algorithms"))
         {
-            if (application.m_MazeBuilder && application.m_MazeBuilder->m_Completed
-                && !application.IsButtonPressed(Application::SOLVER_DFS) && !application.IsButtonPressed(Application::SOLVER_BFS)
-                && !application.IsButtonPressed(Application::SOLVER_DIJKSTRA) && !application.IsButtonPressed(Application::SOLVER_ASTAR))
+            // Disabled once one was pressed, until Reset Path
+            const bool available = application.m_MazeBuilder && application.IsBuilderCompleted() && !application.IsButtonPressed(Application::SOLVER);
+            ImGui::BeginDisabled(!available);
+            for (const MazeSolverEntry& entry : MazeRegistry::GetSolvers())
             {
-                application.m_ButtonStates |= (ImGui::Button("Depth First Search") ? Application::SOLVER_DFS : 0);
-                application.m_ButtonStates |= (ImGui::Button("Breadth First Search") ? Application::SOLVER_BFS : 0);
-                application.m_ButtonStates |= (ImGui::Button("Dijkstra") ? Application::SOLVER_DIJKSTRA : 0);
-                application.m_ButtonStates |= (ImGui::Button("A star") ? Application::SOLVER_ASTAR : 0);
+                if (ImGui::Button(entry.label.c_str()) && available)
+                {
+                    application.m_SolverRequested = entry.algorithm;
+                    application.m_ButtonStates |= Application::SOLVER;
+                }
             }
-            else if (!application.m_MazeBuilder || !application.m_MazeBuilder->m_Completed ||
-                application.IsButtonPressed(Application::BUILDER_RECURSIVE_BACKTRACK) || application.IsButtonPressed(Application::BUILDER_KRUSKAL) ||
-                application.IsButtonPressed(Application::SOLVER_DIJKSTRA) || application.IsButtonPressed(Application::SOLVER_ASTAR))
+            ImGui::EndDisabled();
+            ImGui::TreePop();
+        }
+        ImGui::NewLine();
+
+        // Every solver at once, each on a thread of its own. The maze view follows one of them at a time
+        if (ImGui::TreeNode("Solver Race"))
+        {
+            MazeRace& race = application.m_Race;
+            if (!application.m_MazeBuilder || !application.IsBuilderCompleted())
             {
                 ImGui::BeginDisabled();
-                ImGui::Button("Depth first search");
-                ImGui::Button("Breadth first search");
-                ImGui::Button("Dijkstra");
-                ImGui::Button("A star");
+                ImGui::Button("Start Race");
                 ImGui::EndDisabled();
             }
+            else if (ImGui::Button("Start Race"))
+            {
+                application.StartRace();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Stop Race"))
+                application.StopRace();
+
+            if (race.GetRacerCount() > 0)
+            {
+                int view = application.GetRaceView();
+                ImGui::RadioButton("Maze", &view, -1);
+                for (size_t i = 0; i < race.GetRacerCount(); i++)
+                {
+                    ImGui::SameLine();
+                    ImGui::RadioButton(MazeSolver::GetAlgorithmName(race.GetResult(i).algorithm), &view, static_cast<int>(i));
+                }
+                application.SetRaceView(view);
+
+                if (ImGui::BeginTable("##RaceTable", 6, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+                {
+                    ImGui::TableSetupColumn("Solver");
+                    ImGui::TableSetupColumn("Expansions");
+                    ImGui::TableSetupColumn("Peak Frontier");
+                    ImGui::TableSetupColumn("Time");
+                    ImGui::TableSetupColumn("Path Cells");
+                    ImGui::TableSetupColumn("Path Cost");
+                    ImGui::TableHeadersRow();
+
+                    for (size_t i = 0; i < race.GetRacerCount(); i++)
+                    {
+                        MazeRaceResult result = race.GetResult(i);
+                        ImGui::TableNextRow();
+                        ImGui::TableSetColumnIndex(0);
+                        ImGui::Text("%s", MazeSolver::GetAlgorithmName(result.algorithm));
+                        ImGui::TableSetColumnIndex(1);
+                        ImGui::Text("%llu", static_cast<unsigned long long>(result.expansions));
+                        ImGui::TableSetColumnIndex(2);
+                        ImGui::Text("%llu", static_cast<unsigned long long>(result.peakFrontier));
+                        ImGui::TableSetColumnIndex(3);
+                        ImGui::Text("%.3f ms", result.milliseconds);
+                        ImGui::TableSetColumnIndex(4);
+                        if (result.completed)
+                            ImGui::Text("%llu", static_cast<unsigned long long>(result.pathCells));
+                        else
+                            ImGui::Text("-");
+                        ImGui::TableSetColumnIndex(5);
+                        if (result.completed)
+                            ImGui::Text("%llu", static_cast<unsigned long long>(result.pathCost));
+                        else
+                            ImGui::Text("-");
+                    }
+                    ImGui::EndTable();
+                }
+            }
             ImGui::TreePop();
         }
         ImGui::NewLine();
@@ -183,19 +285,32 @@ namespace ImGuiHandler
             uint16_t cellWidth = application.m_Maze->m_HalfCellHeight;
             uint16_t wallWidth = application.m_Maze->m_WallThickness;
 
-            ImGui::SliderInt("Delay (ms)", &application.m_Delay, 0, 200);
+            int delay = application.m_Delay;
+            if (ImGui::SliderInt("Delay (ms)", &delay, 0, 200))
+                application.m_Delay = delay;
             ImGui::SliderScalar("Cell Width", ImGuiDataType_U16, &application.m_Maze->m_HalfCellHeight, &lower1, &higher1);
             ImGui::SliderScalar("Wall Width", ImGuiDataType_U16, &application.m_Maze->m_WallThickness, &lower1, &higher2);
             ImGui::SliderScalar("Path Width", ImGuiDataType_U16, &application.m_Maze->m_LineThickness, &lower1, &higher3);
-            ImGui::SliderScalar("Start Cell", ImGuiDataType_U32, &application.m_Route.first, &lower3, &higher4);
-            ImGui::SliderScalar("End Cell", ImGuiDataType_U32, &application.m_Route.second, &lower3, &higher4);
+            // The simulation thread reads the route, it is only written through SetRoute
+            std::pair<uint32_t, uint32_t> route = application.m_Route;
+            bool routeChanged = ImGui::SliderScalar("Start Cell", ImGuiDataType_U32, &route.first, &lower3, &higher4);
+            routeChanged |= ImGui::SliderScalar("End Cell", ImGuiDataType_U32, &route.second, &lower3, &higher4);
+            if (routeChanged)
+                application.SetRoute(route.first, route.second);
+
+            // Multiplies the size of the maze in pixels, zoom in to see the cells of large scales
+            uint16_t mazeScale = application.m_MazeScale, lowerScale = 1, higherScale = 64;
+            if (ImGui::SliderScalar("Maze Scale", ImGuiDataType_U16, &mazeScale, &lowerScale, &higherScale) && mazeScale != application.m_MazeScale)
+            {
+                application.m_MazeScale = mazeScale;
+                application.RecreateMaze(cellWidth, wallWidth);
+            }
 
             if (cellWidth != application.m_Maze->m_HalfCellHeight || wallWidth != application.m_Maze->m_WallThickness)
             {
                 cellWidth = application.m_Maze->m_HalfCellHeight;
                 wallWidth = application.m_Maze->m_WallThickness;
-                application.DeleteMaze();
-                application.m_Maze = new Maze(*application.m_Width, *application.m_Height, cellWidth, wallWidth);
+                application.RecreateMaze(cellWidth, wallWidth);
             }
 
             ImGui::TreePop();
@@ -204,7 +319,12 @@ namespace ImGuiHandler
         ImGui::SetNextItemOpen(true, ImGuiCond_Once);
         if (ImGui::TreeNode("Resetting"))
         {
-            if (!application.m_MazeSolver || !application.m_MazeSolver->m_Completed)
+            // Pausing only stops the simulation thread, rendering carries on
+            if (ImGui::Button(application.m_SimulationPaused ? "Resume" : "Pause"))
+                application.m_SimulationPaused = !application.m_SimulationPaused;
+
+            // Reset Path also stops a solver that is still running
+            if (!application.m_MazeSolver)
             {
                 ImGui::BeginDisabled();
                 ImGui::Button("Reset Path");
@@ -218,6 +338,56 @@ namespace ImGuiHandler
             ImGui::TreePop();
         }
 
+        //ImGui::SetNextItemOpen(true, ImGuiCond_Once);
+        if (ImGui::TreeNode("Files"))
+        {
+            // Binary maze file with the walls and optionally the weights, see mazeFile.h
+            ImGui::Checkbox("Save Weights", &application.m_SaveWeights);
+            if (ImGui::Button("Save Maze"))
+                application.SaveMaze("maze.maze", application.m_SaveWeights);
+            ImGui::SameLine();
+            if (ImGui::Button("Load Maze"))
+                application.LoadMaze("maze.maze");
+            ImGui::NewLine();
+
+            // Drawn on the CPU, the image does not depend on the window size or the view
+            uint16_t lowerPixels = 1, higherPixels = 64;
+            ImGui::SliderScalar("Pixels Per Cell", ImGuiDataType_U16, &application.m_ExportCellPixels, &lowerPixels, &higherPixels);
+
+            if (ImGui::Button("Export PNG"))
+                application.ExportImage("maze.png", application.m_ExportCellPixels);
+            ImGui::SameLine();
+            if (ImGui::Button("Export PPM"))
+                application.ExportImage("maze.ppm", application.m_ExportCellPixels);
+            ImGui::NewLine();
+
+            // Passages of the completed maze for external graph tools, weights follow Save Weights
+            if (ImGui::Button("Export CSR"))
+                application.ExportGraph("maze.csr", application.m_SaveWeights);
+            ImGui::SameLine();
+            if (ImGui::Button("Export Edge List"))
+                application.ExportGraph("maze.edges", application.m_SaveWeights);
+            ImGui::SameLine();
+            if (ImGui::Button("Export DIMACS"))
+                application.ExportGraph("maze.gr", application.m_SaveWeights);
+            ImGui::NewLine();
+
+            // Applies to builders and solvers started afterwards, compare runs with the MazeLog tool
+            ImGui::Checkbox("Record Steps (builder.mlog, solver.mlog)", &application.m_RecordSteps);
+            ImGui::NewLine();
+
+            // Builder and solver state as well as the maze, a restored run carries on exactly where it stopped
+            int checkpointInterval = application.m_CheckpointInterval;
+            if (ImGui::SliderInt("Checkpoint Every (s)", &checkpointInterval, 0, 600))
+                application.m_CheckpointInterval = checkpointInterval;
+            if (ImGui::Button("Save Checkpoint"))
+                application.SaveCheckpoint();
+            ImGui::SameLine();
+            if (ImGui::Button("Load Checkpoint"))
+                application.LoadCheckpoint(application.m_CheckpointPath);
+            ImGui::TreePop();
+        }
+
         //ImGui::SetNextItemOpen(true, ImGuiCond_Once);
         if (ImGui::TreeNode("Colors"))
         {
@@ -244,8 +414,7 @@ namespace ImGuiHandler
     {
 
         static int minDisplayValue = 0;
-        static int maxDisplayValue = application.m_Maze->m_RandUpperLimit;
-        static int previousValue = application.m_Maze->m_RandUpperLimit;
+        static int maxDisplayValue = application.m_WeightSettings.maxWeight;
 
         static bool displayValue = false;
         static char fmtData[4]{};
@@ -288,7 +457,11 @@ namespace ImGuiHandler
 
         if (ImPlot::BeginPlot("##Heatmap1", ImVec2(225, 225), ImPlotFlags_NoLegend | ImPlotFlags_NoMouseText))
         {
-            ImPlot::PlotHeatmap("heat", application.m_Maze->m_CellWeights.data(), application.m_Maze->m_CellsAcrossHeight, application.m_Maze->m_CellsAcrossWidth, minDisplayValue, maxDisplayValue, fmtData, ImPlotPoint(0, 0), ImPlotPoint(application.m_Maze->m_CellsAcrossWidth, application.m_Maze->m_CellsAcrossHeight), hm_flags);
+            // ImPlot has a heatmap for each of the weight widths
+            application.m_Maze->m_CellWeights.Visit([&](const auto& weights)
+                {
+                    ImPlot::PlotHeatmap("heat", weights.data(), application.m_Maze->m_CellsAcrossHeight, application.m_Maze->m_CellsAcrossWidth, minDisplayValue, maxDisplayValue, fmtData, ImPlotPoint(0, 0), ImPlotPoint(application.m_Maze->m_CellsAcrossWidth, application.m_Maze->m_CellsAcrossHeight), hm_flags);
+                });
             ImPlot::EndPlot();
         }
         ImGui::SameLine();
@@ -300,15 +473,479 @@ namespace ImGuiHandler
         ImGui::PushStyleColor(ImGuiCol_ButtonActive, (ImVec4)ImColor::HSV(0.0f / 7.0f, 0.8f, 0.8f));
         if (ImGui::Button("Reassign Weights"))
         {
-            application.m_Maze->SetCellWeights();
+            application.ReassignWeights();
         }
         ImGui::PopStyleColor(3);
+
+        // Every control below regenerates the weights, they take milliseconds even for huge mazes
+        MazeWeightSettings& settings = application.m_WeightSettings;
+        bool changed = false;
+
         ImGui::SetNextItemWidth(225);
-        ImGui::SliderInt("Max Weight Value", &application.m_Maze->m_RandUpperLimit, 1, 500);
-        if (previousValue != application.m_Maze->m_RandUpperLimit)
+        if (ImGui::BeginCombo("Generator", MazeWeights::GetGeneratorName(settings.generator)))
         {
-            previousValue = application.m_Maze->m_RandUpperLimit;
-            application.m_Maze->SetCellWeights();
+            for (uint8_t generator = MazeWeightSettings::UNIFORM; generator <= MazeWeightSettings::SWAMP; generator++)
+            {
+                if (ImGui::Selectable(MazeWeights::GetGeneratorName(generator), settings.generator == generator))
+                {
+                    settings.generator = generator;
+                    changed = true;
+                }
+            }
+            ImGui::EndCombo();
         }
+
+        int maxWeight = settings.maxWeight;
+        ImGui::SetNextItemWidth(225);
+        if (ImGui::SliderInt("Max Weight Value", &maxWeight, 1, 500))
+        {
+            settings.maxWeight = maxWeight;
+            changed = true;
+        }
+
+        switch (settings.generator)
+        {
+        case MazeWeightSettings::TERRAIN:
+        {
+            int octaves = settings.octaves;
+            ImGui::SetNextItemWidth(225);
+            changed |= ImGui::SliderFloat("Feature Size", &settings.featureSize, 2.0f, 1024.0f, "%.0f", ImGuiSliderFlags_Logarithmic);
+            ImGui::SetNextItemWidth(225);
+            if (ImGui::SliderInt("Octaves", &octaves, 1, 8))
+            {
+                settings.octaves = octaves;
+                changed = true;
+            }
+            break;
+        }
+        case MazeWeightSettings::RADIAL:
+            ImGui::SetNextItemWidth(225);
+            changed |= ImGui::SliderFloat("Center X", &settings.centerX, 0.0f, 1.0f);
+            ImGui::SetNextItemWidth(225);
+            changed |= ImGui::SliderFloat("Center Y", &settings.centerY, 0.0f, 1.0f);
+            break;
+        case MazeWeightSettings::LINEAR:
+            ImGui::SetNextItemWidth(225);
+            changed |= ImGui::SliderFloat("Angle", &settings.angle, 0.0f, 360.0f, "%.0f");
+            break;
+        case MazeWeightSettings::SWAMP:
+        {
+            int patchCount = settings.patchCount;
+            ImGui::SetNextItemWidth(225);
+            if (ImGui::SliderInt("Patches", &patchCount, 1, 1024))
+            {
+                settings.patchCount = patchCount;
+                changed = true;
+            }
+            ImGui::SetNextItemWidth(225);
+            changed |= ImGui::SliderFloat("Patch Radius", &settings.patchRadius, 1.0f, 512.0f, "%.0f", ImGuiSliderFlags_Logarithmic);
+            break;
+        }
+        }
+
+        if (settings.generator != MazeWeightSettings::UNIFORM)
+            changed |= ImGui::Checkbox("Invert", &settings.invert);
+        // A fixed seed keeps the field in place while its settings are tuned
+        ImGui::Checkbox("Fixed Seed", &application.m_FixedWeightSeed);
+
+        if (changed)
+        {
+            maxDisplayValue = settings.maxWeight;
+            application.ReassignWeights();
+        }
+
+        // A .pgm image can be painted in any editor, raw files are a uint32_t per cell
+        if (ImGui::Button("Export Weights"))
+            application.SaveWeights("weights.pgm");
+        ImGui::SameLine();
+        if (ImGui::Button("Import Weights"))
+            application.LoadWeights("weights.pgm");
+        ImGui::SameLine();
+        if (ImGui::Button("Import Raw Weights"))
+            application.LoadWeights("weights.raw");
+
+        ImGui::Separator();
+        // Shape of the finished maze, the solution is included once a solver has found it
+        if (ImGui::Button("Compute Metrics"))
+            application.ComputeMetrics();
+        ImGui::SameLine();
+        if (ImGui::Button("Export Metrics"))
+            application.ExportMetrics("metrics.json");
+
+        if (!application.m_MetricsValid)
+            return;
+
+        const MazeMetrics& metrics = application.m_Metrics;
+        if (ImGui::BeginTable("##MetricsTable", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+        {
+            auto row = [](const char* name, const char* format, auto value)
+                {
+                    ImGui::TableNextRow();
+                    ImGui::TableSetColumnIndex(0);
+                    ImGui::Text("%s", name);
+                    ImGui::TableSetColumnIndex(1);
+                    ImGui::Text(format, value);
+                };
+            row("Dead Ends", "%.2f %%", metrics.GetDeadEndRatio() * 100.0);
+            row("Junctions", "%llu", static_cast<unsigned long long>(metrics.junctions + metrics.crossroads));
+            row("Corridors", "%llu", static_cast<unsigned long long>(metrics.corridors));
+            row("Mean Corridor", "%.2f", metrics.GetMeanCorridor());
+            row("Longest Corridor", "%llu", static_cast<unsigned long long>(metrics.longestCorridor));
+            row("River", "%.2f", metrics.GetRiver());
+            if (metrics.solvedSamples)
+            {
+                row("Solution Steps", "%llu", static_cast<unsigned long long>(metrics.solutionSteps));
+                row("Solution Turns", "%llu", static_cast<unsigned long long>(metrics.solutionTurns));
+                row("Tortuosity", "%.3f", metrics.GetTortuosity());
+            }
+            ImGui::EndTable();
+        }
+    }
+
+    void ProfilerTab(Application& application)
+    {
+        Profiler& profiler = application.m_Profiler;
+
+        ImGui::Checkbox("Pause Capture", &profiler.m_Paused);
+        ImGui::SameLine();
+        if (ImGui::Button("Export CSV"))
+            profiler.ExportCSV("profile.csv");
+        ImGui::SameLine();
+        if (ImGui::Button("Export Trace"))
+            profiler.ExportChromeTrace("profile_trace.json");
+
+        MazeArena& arena = application.m_Arena;
+        ImGui::Text("Maze arena: %.1f of %.0f MB kept, %llu reused, %llu allocated", arena.GetKeptBytes() / (1024.0 * 1024.0),
+            arena.GetByteBudget() / (1024.0 * 1024.0), static_cast<unsigned long long>(arena.GetHits()), static_cast<unsigned long long>(arena.GetMisses()));
+        ImGui::SameLine();
+        if (ImGui::Button("Free Kept Memory"))
+            arena.Clear();
+
+        HardwareCounters(application);
+
+        uint32_t frameCount = profiler.GetFrameCount();
+        if (frameCount == 0)
+            return;
+
+        const Profiler::FrameRecord& lastFrame = profiler.GetFrame(frameCount - 1);
+
+        if (ImGui::BeginTable("##ProfilerTable", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+        {
+            ImGui::TableSetupColumn("Phase / Counter");
+            ImGui::TableSetupColumn("Last Frame");
+            ImGui::TableSetupColumn("Average");
+            ImGui::TableHeadersRow();
+
+            for (uint32_t i = 0; i < Profiler::PHASE_COUNT; i++)
+            {
+                double average = 0.0;
+                for (uint32_t j = 0; j < frameCount; j++)
+                    average += profiler.GetFrame(j).phaseMs[i];
+                average /= frameCount;
+
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%s", Profiler::GetPhaseName(static_cast<Profiler::Phase>(i)));
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%.3f ms", lastFrame.phaseMs[i]);
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.3f ms", average);
+            }
+
+            for (uint32_t i = 0; i < Profiler::COUNTER_COUNT; i++)
+            {
+                double average = 0.0;
+                for (uint32_t j = 0; j < frameCount; j++)
+                    average += static_cast<double>(profiler.GetFrame(j).counters[i]);
+                average /= frameCount;
+
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%s", Profiler::GetCounterName(static_cast<Profiler::Counter>(i)));
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%llu", static_cast<unsigned long long>(lastFrame.counters[i]));
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.1f", average);
+            }
+            ImGui::EndTable();
+        }
+
+        // History is a ring buffer, the offset makes ImPlot start at the oldest frame
+        int offset = static_cast<int>(profiler.GetHistoryOffset());
+
+        if (ImPlot::BeginPlot("Frame Phases", ImVec2(-1, 200)))
+        {
+            ImPlot::SetupAxes("Frame", "ms", ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit);
+            ImPlot::SetupAxisLimits(ImAxis_X1, 0, Profiler::HISTORY_SIZE, ImGuiCond_Always);
+            for (uint32_t i = 0; i < Profiler::PHASE_COUNT; i++)
+            {
+                Profiler::Phase phase = static_cast<Profiler::Phase>(i);
+                ImPlot::PlotLine(Profiler::GetPhaseName(phase), profiler.GetPhaseHistory(phase), frameCount, 1.0, 0.0, 0, offset);
+            }
+            ImPlot::EndPlot();
+        }
+
+        if (ImPlot::BeginPlot("Steps And Cells", ImVec2(-1, 200)))
+        {
+            ImPlot::SetupAxes("Frame", "count", ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit);
+            ImPlot::SetupAxisLimits(ImAxis_X1, 0, Profiler::HISTORY_SIZE, ImGuiCond_Always);
+            ImPlot::PlotLine("BuilderSteps", profiler.GetCounterHistory(Profiler::BUILDER_STEPS), frameCount, 1.0, 0.0, 0, offset);
+            ImPlot::PlotLine("SolverSteps", profiler.GetCounterHistory(Profiler::SOLVER_STEPS), frameCount, 1.0, 0.0, 0, offset);
+            ImPlot::PlotLine("CellsTouched", profiler.GetCounterHistory(Profiler::CELLS_TOUCHED), frameCount, 1.0, 0.0, 0, offset);
+            ImPlot::EndPlot();
+        }
+
+        if (ImPlot::BeginPlot("Uploads", ImVec2(-1, 200)))
+        {
+            ImPlot::SetupAxes("Frame", "bytes", ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit);
+            ImPlot::SetupAxisLimits(ImAxis_X1, 0, Profiler::HISTORY_SIZE, ImGuiCond_Always);
+            ImPlot::PlotShaded("BytesUploaded", profiler.GetCounterHistory(Profiler::BYTES_UPLOADED), frameCount, 0.0, 1.0, 0.0, 0, offset);
+            ImPlot::EndPlot();
+        }
+    }
+
+    // Cost per processed cell of the current builder and solver, measured around their batches of steps
+    void HardwareCounters(Application& application)
+    {
+        bool countHardwareEvents = application.m_CountHardwareEvents;
+        if (ImGui::Checkbox("Hardware Counters", &countHardwareEvents))
+            application.m_CountHardwareEvents = countHardwareEvents;
+        if (!countHardwareEvents)
+            return;
+
+        const MazeCounterSample* samples[] = { &application.GetBuilderCounters(), &application.GetSolverCounters() };
+        if (samples[0]->cells > 0 && samples[0]->available == 0)
+        {
+            ImGui::TextDisabled("Not available on this system, the reason is printed at startup");
+            return;
+        }
+
+        if (ImGui::BeginTable("##CountersTable", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+        {
+            ImGui::TableSetupColumn("Per Cell");
+            ImGui::TableSetupColumn("Builder");
+            ImGui::TableSetupColumn("Solver");
+            ImGui::TableHeadersRow();
+
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("Cells");
+            for (int i = 0; i < 2; i++)
+            {
+                ImGui::TableSetColumnIndex(i + 1);
+                ImGui::Text("%llu", static_cast<unsigned long long>(samples[i]->cells));
+            }
+
+            for (uint32_t event = 0; event < MazeCounterSample::EVENT_COUNT; event++)
+            {
+                const MazeCounterSample::Events counter = static_cast<MazeCounterSample::Events>(event);
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%s", MazeCounterSample::GetEventName(counter));
+                for (int i = 0; i < 2; i++)
+                {
+                    ImGui::TableSetColumnIndex(i + 1);
+                    if (samples[i]->cells > 0 && samples[i]->IsAvailable(counter))
+                        ImGui::Text("%.2f", samples[i]->GetPerCell(counter));
+                    else
+                        ImGui::TextDisabled("-");
+                }
+            }
+
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("IPC");
+            for (int i = 0; i < 2; i++)
+            {
+                ImGui::TableSetColumnIndex(i + 1);
+                ImGui::Text("%.2f", samples[i]->GetIpc());
+            }
+            ImGui::EndTable();
+        }
+    }
+
+    // Bytes held per subsystem, a subsystem opens up into its structures
+    void MemoryTab(Application& application)
+    {
+        const MazeMemoryReport& report = application.m_MemoryReport;
+        const MazeMemoryHistory& history = application.m_MemoryHistory;
+        const double megabyte = 1024.0 * 1024.0;
+
+        ImGui::Text("Resident %.1f MB, peak %.1f MB", history.GetLastBytes() / megabyte, MazeMemoryReport::GetPeakResidentBytes() / megabyte);
+        ImGui::Text("Structures %.1f MB used, %.1f MB reserved", report.GetUsedBytes() / megabyte, report.GetReservedBytes() / megabyte);
+        ImGui::SameLine();
+        if (ImGui::Button("Print Report"))
+            report.Print(std::cout);
+
+        if (ImGui::BeginTable("##MemoryTable", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+        {
+            ImGui::TableSetupColumn("Structure");
+            ImGui::TableSetupColumn("Used MB");
+            ImGui::TableSetupColumn("Reserved MB");
+            ImGui::TableHeadersRow();
+
+            for (const MazeMemoryEntry& subsystem : report.GetSubsystems())
+            {
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                const bool open = ImGui::TreeNodeEx(subsystem.subsystem, ImGuiTreeNodeFlags_SpanFullWidth);
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%.2f", subsystem.usedBytes / megabyte);
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.2f", subsystem.reservedBytes / megabyte);
+                if (!open)
+                    continue;
+
+                for (const MazeMemoryEntry& entry : report.GetEntries())
+                {
+                    if (std::strcmp(entry.subsystem, subsystem.subsystem) != 0)
+                        continue;
+                    ImGui::TableNextRow();
+                    ImGui::TableSetColumnIndex(0);
+                    ImGui::Indent();
+                    ImGui::Text("%s", entry.name);
+                    ImGui::Unindent();
+                    ImGui::TableSetColumnIndex(1);
+                    ImGui::Text("%.2f", entry.usedBytes / megabyte);
+                    ImGui::TableSetColumnIndex(2);
+                    ImGui::Text("%.2f", entry.reservedBytes / megabyte);
+                }
+                ImGui::TreePop();
+            }
+            ImGui::EndTable();
+        }
+
+        if (ImPlot::BeginPlot("Resident Memory", ImVec2(-1, 200)))
+        {
+            ImPlot::SetupAxes("Sample", "MB", ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit);
+            ImPlot::SetupAxisLimits(ImAxis_X1, 0, MazeMemoryHistory::HISTORY_SIZE, ImGuiCond_Always);
+            ImPlot::PlotShaded("Resident", history.GetHistory(), history.GetCount(), 0.0, 1.0, 0.0, 0, history.GetHistoryOffset());
+            ImPlot::EndPlot();
+        }
+    }
+
+    // Independent mazes stepped by the session workers, each one drawn from a thumbnail of its own
+    void SessionsWindow(Application& application, const std::unordered_map<uint32_t, SessionView>& views)
+    {
+        MazeSessions& sessions = application.m_Sessions;
+        const std::vector<MazeBuilderEntry>& builders = MazeRegistry::GetBuilders();
+        const std::vector<MazeSolverEntry>& solvers = MazeRegistry::GetSolvers();
+
+        static size_t builder = 0;
+        static size_t solver = 0;
+        static int cells[2] = { 64, 36 };
+        static int seed = 0;
+        static int columns = 3;
+
+        ImGui::Begin("Sessions");
+
+        if (ImGui::BeginCombo("Builder", builders[builder].label.c_str()))
+        {
+            for (size_t i = 0; i < builders.size(); i++)
+            {
+                if (ImGui::Selectable(builders[i].label.c_str(), i == builder))
+                    builder = i;
+            }
+            ImGui::EndCombo();
+        }
+        if (ImGui::BeginCombo("Solver", solvers[solver].label.c_str()))
+        {
+            for (size_t i = 0; i < solvers.size(); i++)
+            {
+                if (ImGui::Selectable(solvers[i].label.c_str(), i == solver))
+                    solver = i;
+            }
+            ImGui::EndCombo();
+        }
+        ImGui::SliderInt2("Cells", cells, 2, 1024);
+        ImGui::InputInt("Seed (0 is random)", &seed);
+
+        auto settingsFor = [&](uint8_t builderAlgorithm, uint8_t solverAlgorithm, uint32_t sessionSeed)
+            {
+                MazeSessionSettings settings;
+                settings.builder = builderAlgorithm;
+                settings.solver = solverAlgorithm;
+                settings.cellsAcrossWidth = static_cast<uint32_t>(cells[0]);
+                settings.cellsAcrossHeight = static_cast<uint32_t>(cells[1]);
+                settings.seed = sessionSeed;
+                return settings;
+            };
+
+        if (ImGui::Button("Add Session"))
+            sessions.Add(settingsFor(builders[builder].algorithm, solvers[solver].algorithm, seed != 0 ? seed : rand()));
+        ImGui::SameLine();
+        // One seed for all of them, so the solvers of a builder all run on the same maze
+        if (ImGui::Button("Add Every Combination"))
+        {
+            const uint32_t sharedSeed = seed != 0 ? seed : rand();
+            for (const MazeBuilderEntry& builderEntry : builders)
+            {
+                for (const MazeSolverEntry& solverEntry : solvers)
+                    sessions.Add(settingsFor(builderEntry.algorithm, solverEntry.algorithm, sharedSeed));
+            }
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Restart All"))
+        {
+            for (size_t i = 0; i < sessions.GetCount(); i++)
+                sessions.Restart(i);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Remove All"))
+            sessions.Clear();
+        ImGui::SliderInt("Columns", &columns, 1, 8);
+        ImGui::Separator();
+
+        // Thumbnails keep their aspect ratio and share the width of the window
+        const float spacing = ImGui::GetStyle().ItemSpacing.x;
+        const float thumbnailWidth = std::max((ImGui::GetContentRegionAvail().x - (columns - 1) * spacing) / columns, 1.0f);
+
+        size_t removed = sessions.GetCount();
+        for (size_t i = 0; i < sessions.GetCount(); i++)
+        {
+            auto view = views.find(sessions.GetId(i));
+            if (view == views.end())
+                continue;
+
+            const SessionView& sessionView = view->second;
+            const MazeSessionSettings& settings = sessions.GetSettings(i);
+            const MazeSessionStats& stats = sessionView.stats;
+            const MazeBuilderEntry* builderEntry = MazeRegistry::FindBuilder(settings.builder);
+
+            if (i % columns != 0)
+                ImGui::SameLine();
+            ImGui::PushID(static_cast<int>(sessions.GetId(i)));
+            ImGui::BeginGroup();
+
+            if (sessionView.width > 0)
+                ImGui::Image((void*)(intptr_t)sessionView.texture, ImVec2(thumbnailWidth, thumbnailWidth * sessionView.height / sessionView.width));
+            ImGui::Text("%s / %s", builderEntry ? builderEntry->label.c_str() : "None", MazeSolver::GetAlgorithmName(settings.solver));
+            ImGui::Text("%ux%u cells, seed %u", settings.cellsAcrossWidth, settings.cellsAcrossHeight, settings.seed);
+            ImGui::Text("Build: %llu steps, %.2f ms", static_cast<unsigned long long>(stats.builderSteps), stats.builderMilliseconds);
+            if (stats.state != MazeSessionStats::BUILDING)
+            {
+                ImGui::Text("Solve: %llu steps, %.2f ms, peak frontier %llu", static_cast<unsigned long long>(stats.solverSteps),
+                    stats.solverMilliseconds, static_cast<unsigned long long>(stats.peakFrontier));
+            }
+            if (stats.state == MazeSessionStats::FINISHED && stats.pathCells > 0)
+                ImGui::Text("Path: %llu cells", static_cast<unsigned long long>(stats.pathCells));
+            else if (stats.state == MazeSessionStats::FINISHED)
+                ImGui::Text("Path: none");
+
+            if (ImGui::Button("Restart"))
+                sessions.Restart(i);
+            ImGui::SameLine();
+            if (ImGui::Button("Remove"))
+                removed = i;
+
+            ImGui::EndGroup();
+            ImGui::PopID();
+        }
+
+        // Removing waits for the session to be handed back, which is never longer than a slice
+        if (removed < sessions.GetCount())
+            sessions.Remove(removed);
+
+        ImGui::End();
     }
 }
\ No newline at end of file
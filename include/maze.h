@@ -1,10 +1,35 @@
 #pragma once
 
 #include <vector>
-#include <map>
 #include <stack>
 #include <stdint.h>
 
+#include "mazeCounters.h"
+#include "narrowVector.h"
+#include "packedPath.h"
+
+struct MazeWeightSettings;
+class MazeArena;
+class MazeMemoryReport;
+
+// Everything the renderer needs from the simulation thread, published through a TripleBuffer
+struct MazeSnapshot
+{
+    std::vector<uint16_t> cellInfo;
+    std::vector<uint32_t> builderPath;
+    PackedPath solverPath;
+    uint32_t mazeArea = 0;
+    bool builderStarted = false;
+    bool builderCompleted = false;
+    bool solverStarted = false;
+    bool solverCompleted = false;
+    // Hardware counters of the current builder and solver, see MazeCounters
+    MazeCounterSample builderCounters;
+    MazeCounterSample solverCounters;
+    // Increases by one for every published snapshot
+    uint64_t sequence = 0;
+};
+
 class Maze
 {
 public:
@@ -13,23 +38,49 @@ public:
     Maze(Maze&) = delete;
     Maze(Maze&&) = delete;
 
-    Maze(uint16_t width, uint16_t height, uint16_t cellWidth = 10, uint16_t wallThickness = 2);
+    // width and height are in pixels, they can be larger than the window since the view can be zoomed
+    // randomWeights can be turned off when the weights are about to be overwritten anyway e.g. by a loaded file.
+    // With an arena the cell arrays of the maze and of its builders and solvers come from it and go back to it
+    Maze(uint32_t width, uint32_t height, uint16_t cellWidth = 10, uint16_t wallThickness = 2, bool randomWeights = true, MazeArena* arena = nullptr);
     ~Maze();
 
-    uint32_t DrawMaze(std::vector<uint32_t>* stack = nullptr, std::pair<uint32_t, uint32_t>* route = nullptr);
+    // cellInfo is a copy of m_VisitedCellInfo so that drawing never touches the state being simulated
+    uint32_t DrawMaze(const std::vector<uint16_t>& cellInfo, const std::vector<uint32_t>* path = nullptr, const std::pair<uint32_t, uint32_t>* route = nullptr);
     bool MazeCompleted() const;
+
+    // Center of the cell in grid coordinates, cell x,y spans x..x+1 and y..y+1 including its walls
+    std::pair<float, float> GetCellOrigin(uint32_t cell) const;
+    // Columns [xBegin, xEnd) and rows [yBegin, yEnd) of the cells inside the view
+    void GetVisibleCells(uint32_t& xBegin, uint32_t& xEnd, uint32_t& yBegin, uint32_t& yEnd) const;
+    // Scale xy and offset zw which take grid coordinates to the screen, the only thing that changes on pan, zoom and resize
+    void GetViewTransform(float transform[4]) const;
+    // Cell under a point of the maze from -1 to 1, m_MazeArea if there is none
+    uint32_t GetCellAt(float mazeX, float mazeY) const;
+    // Size of one cell on screen, below 1 pixel the maze is drawn from the level of detail pyramid
+    float GetCellPixelSize(uint32_t framebufferWidth) const;
+
+    // Screen coordinates go from -1 to 1 across the scene window
+    void SetView(float zoom, float centerX, float centerY);
+    void ZoomView(float factor, float screenX, float screenY);
+    void PanView(float screenDeltaX, float screenDeltaY);
+    std::pair<float, float> ScreenToMaze(float screenX, float screenY) const;
     // Each cell does std::abs(cellWeight+neighbourWeight) to get corresponding weight
+    // Uniform noise up to m_RandUpperLimit with a new seed
     void SetCellWeights();
+    // Any of the generators, m_RandUpperLimit follows the settings
+    void SetCellWeights(const MazeWeightSettings& settings);
+    // Cell arrays and the geometry of the last DrawMaze
+    void ReportMemory(MazeMemoryReport& report) const;
 
 public:
     // This is made public to let our algorithm access it
     // TDL: Do I really need getters/setters?
     
-    // 1st int is cell number,
-    // 2nd int represents the neighbours and if it has been visited or not
-    std::map<uint32_t, uint16_t> m_VisitedCellInfo;
+    // Indexed by cell number,
+    // value represents the neighbours and if it has been visited or not
+    std::vector<uint16_t> m_VisitedCellInfo;
 
-    const enum
+    enum
     {
         CELL_NORTH = 0x01,
         CELL_EAST = 0x02,
@@ -52,10 +103,15 @@ public:
     uint16_t m_TotalCellHeight = 0;
     uint16_t m_LineThickness = 8;
 
-	uint16_t m_MazeWidth = 0, m_MazeHeight = 0;
+    // Pixel size the maze was laid out for, only used to decide the number of cells
+	uint32_t m_MazeWidth = 0, m_MazeHeight = 0;
 	uint32_t m_MazeArea, m_CellsAcrossWidth = 0, m_CellsAcrossHeight = 0, m_VisitedCellCount = 0;
 
-    std::vector<std::pair<float, float>> m_CellOrigin;
+    // View transform, screen = (maze - center) * zoom where maze goes from -1 to 1 across the whole grid
+    // Zoom of 1 shows the whole maze
+    float m_ViewZoom = 1.0f;
+    float m_ViewCenterX = 0.0f, m_ViewCenterY = 0.0f;
+    float m_MaxViewZoom = 4096.0f;
 
     std::vector<std::pair<float, float>> m_Vertices;
     std::vector<uint32_t> m_Indices;
@@ -63,6 +119,16 @@ public:
     std::vector<std::pair<float, float>> m_LineVertices;
     std::vector<uint32_t> m_LineIndices;
 
-    std::vector<uint32_t> m_CellWeights;
+    // As narrow as the largest weight allows, solvers are instantiated for each width
+    NarrowVector m_CellWeights;
+    // Bumped whenever m_CellWeights is replaced, solvers keep their own copy of the weights
+    uint32_t m_WeightsVersion = 0;
     int m_RandUpperLimit = 30;
+
+    // Builder and seed that produced this maze, stored in saved files
+    uint8_t m_Builder = 0;
+    uint32_t m_Seed = 0;
+
+    // Has to outlive the maze, null allocates from the system as usual
+    MazeArena* m_Arena = nullptr;
 };
\ No newline at end of file
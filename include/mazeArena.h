@@ -0,0 +1,253 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+// Keeps the maze sized buffers of destroyed mazes, builders and solvers so the next ones of the same or a smaller
+// size take them over instead of going to the system allocator. Reused buffers are already paged in, so resetting
+// a huge maze does not fault in hundreds of megabytes again. What is kept stays below a byte budget, the oldest
+// buffers are given back first. Owned by the session, safe to use from any thread.
+class MazeArena
+{
+public:
+    MazeArena() = default;
+    MazeArena(MazeArena&) = delete;
+    MazeArena(MazeArena&&) = delete;
+
+    // vector gets size copies of value, in the smallest kept buffer that is large enough if there is one.
+    // Without an arena these are the plain std::vector calls
+    template<typename T>
+    static void Assign(MazeArena* arena, std::vector<T>& vector, size_t size, const T& value = T())
+    {
+        Reserve(arena, vector, size);
+        vector.assign(size, value);
+    }
+
+    // Only the capacity, for vectors which are filled later
+    template<typename T>
+    static void Reserve(MazeArena* arena, std::vector<T>& vector, size_t capacity)
+    {
+        if (arena)
+            arena->Take(vector, capacity);
+        else
+            vector.reserve(capacity);
+    }
+
+    // Keeps the buffer of vector, which is left empty
+    template<typename T>
+    static void Release(MazeArena* arena, std::vector<T>& vector)
+    {
+        if (arena)
+            arena->Keep(vector);
+    }
+
+    // Gives every kept buffer back to the system
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Pools.clear();
+        m_KeptBytes = 0;
+    }
+
+    // Called with the area of every new maze. Buffers of a maze more than four times larger would only be taken
+    // over at a fraction of their size, so they are given back once the area drops that far
+    void Fit(uint64_t mazeArea)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (mazeArea * SHRINK_FACTOR < m_MazeArea)
+        {
+            m_Pools.clear();
+            m_KeptBytes = 0;
+        }
+        m_MazeArea = mazeArea;
+    }
+
+    // Buffers which would take the kept bytes above it are given back, oldest first
+    void SetByteBudget(uint64_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_ByteBudget = bytes;
+        EvictOverBudget();
+    }
+
+    uint64_t GetByteBudget() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_ByteBudget;
+    }
+
+    uint64_t GetKeptBytes() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_KeptBytes;
+    }
+
+    // Requests served from a kept buffer and requests that had to allocate
+    uint64_t GetHits() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Hits;
+    }
+
+    uint64_t GetMisses() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Misses;
+    }
+
+private:
+    static constexpr size_t MAX_BUFFERS_PER_TYPE = 8;
+    // Enough for the buffers of a 4096 cells across maze, its builder and a solver
+    static constexpr uint64_t DEFAULT_BYTE_BUDGET = uint64_t(1) << 30;
+    static constexpr uint64_t SHRINK_FACTOR = 4;
+
+    template<typename T>
+    void Take(std::vector<T>& vector, size_t capacity)
+    {
+        if (vector.capacity() >= capacity)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        std::vector<KeptBuffer<T>>& buffers = GetBuffers<T>();
+        auto best = buffers.end();
+        for (auto kept = buffers.begin(); kept != buffers.end(); ++kept)
+        {
+            if (kept->buffer.capacity() >= capacity && (best == buffers.end() || kept->buffer.capacity() < best->buffer.capacity()))
+                best = kept;
+        }
+
+        if (best == buffers.end())
+        {
+            m_Misses++;
+            vector.reserve(capacity);
+            return;
+        }
+
+        m_Hits++;
+        m_KeptBytes -= best->buffer.capacity() * sizeof(T);
+        vector.swap(best->buffer);
+        vector.clear();
+        buffers.erase(best);
+    }
+
+    template<typename T>
+    void Keep(std::vector<T>& vector)
+    {
+        if (vector.capacity() == 0)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        // Would only push out everything else and still not fit
+        if (vector.capacity() * sizeof(T) > m_ByteBudget)
+        {
+            std::vector<T>().swap(vector);
+            return;
+        }
+
+        std::vector<KeptBuffer<T>>& buffers = GetBuffers<T>();
+        vector.clear();
+        m_KeptBytes += vector.capacity() * sizeof(T);
+        KeptBuffer<T>& kept = buffers.emplace_back();
+        kept.buffer.swap(vector);
+        kept.order = m_NextOrder++;
+
+        // A maze only needs a few buffers of a type at once, the smallest ones are the least useful
+        if (buffers.size() > MAX_BUFFERS_PER_TYPE)
+        {
+            auto smallest = std::min_element(buffers.begin(), buffers.end(),
+                [](const KeptBuffer<T>& a, const KeptBuffer<T>& b) { return a.buffer.capacity() < b.buffer.capacity(); });
+            m_KeptBytes -= smallest->buffer.capacity() * sizeof(T);
+            buffers.erase(smallest);
+        }
+        EvictOverBudget();
+    }
+
+    template<typename T>
+    struct KeptBuffer
+    {
+        std::vector<T> buffer;
+        // When it was kept, lower is older
+        uint64_t order = 0;
+    };
+
+    struct Pool
+    {
+        virtual ~Pool() = default;
+        // Order of the oldest buffer, the largest value when there is none
+        virtual uint64_t GetOldestOrder() const = 0;
+        // Gives the oldest buffer back and returns its bytes
+        virtual uint64_t EvictOldest() = 0;
+    };
+
+    template<typename T>
+    struct TypedPool : Pool
+    {
+        std::vector<KeptBuffer<T>> buffers;
+
+        uint64_t GetOldestOrder() const override
+        {
+            uint64_t oldest = std::numeric_limits<uint64_t>::max();
+            for (const KeptBuffer<T>& kept : buffers)
+                oldest = std::min(oldest, kept.order);
+            return oldest;
+        }
+
+        uint64_t EvictOldest() override
+        {
+            auto oldest = std::min_element(buffers.begin(), buffers.end(),
+                [](const KeptBuffer<T>& a, const KeptBuffer<T>& b) { return a.order < b.order; });
+            const uint64_t bytes = oldest->buffer.capacity() * sizeof(T);
+            buffers.erase(oldest);
+            return bytes;
+        }
+    };
+
+    // Needs m_Mutex
+    template<typename T>
+    std::vector<KeptBuffer<T>>& GetBuffers()
+    {
+        std::unique_ptr<Pool>& pool = m_Pools[std::type_index(typeid(T))];
+        if (!pool)
+            pool = std::make_unique<TypedPool<T>>();
+        return static_cast<TypedPool<T>&>(*pool).buffers;
+    }
+
+    // Needs m_Mutex. There are only a few pools with at most MAX_BUFFERS_PER_TYPE buffers, a scan is enough
+    void EvictOverBudget()
+    {
+        while (m_KeptBytes > m_ByteBudget)
+        {
+            Pool* oldest = nullptr;
+            uint64_t oldestOrder = std::numeric_limits<uint64_t>::max();
+            for (auto& [type, pool] : m_Pools)
+            {
+                const uint64_t order = pool->GetOldestOrder();
+                if (order < oldestOrder)
+                {
+                    oldest = pool.get();
+                    oldestOrder = order;
+                }
+            }
+            if (!oldest)
+                break;
+            m_KeptBytes -= oldest->EvictOldest();
+        }
+    }
+
+    mutable std::mutex m_Mutex;
+    std::unordered_map<std::type_index, std::unique_ptr<Pool>> m_Pools;
+    uint64_t m_KeptBytes = 0;
+    uint64_t m_ByteBudget = DEFAULT_BYTE_BUDGET;
+    uint64_t m_NextOrder = 0;
+    // Of the last maze passed to Fit
+    uint64_t m_MazeArea = 0;
+    uint64_t m_Hits = 0;
+    uint64_t m_Misses = 0;
+};
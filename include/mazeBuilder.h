@@ -1,7 +1,19 @@
+#pragma once
+
+#include <memory>
+#include <random>
 #include <stack>
+#include <vector>
+#include <stdint.h>
+
+#include "mazeStreamBuilder.h"
 
 class Maze;
 class DisjointSet;
+class MazeArena;
+class MazeMemoryReport;
+class MazeBuilderPlugin;
+class MazeCheckpoint;
 
 class MazeBuilder
 {
@@ -10,23 +22,45 @@ public:
 	MazeBuilder(MazeBuilder&) = delete;
 	MazeBuilder(MazeBuilder&&) = delete;
 
-	MazeBuilder(Maze* maze, uint8_t selectedAlgorithm);
-	//~MazeBuilder();
+	// The same seed always builds the same maze
+	MazeBuilder(Maze* maze, uint8_t selectedAlgorithm, uint32_t seed = std::random_device{}());
+	// Has to be deleted before the maze, its buffers go back to the maze arena
+	~MazeBuilder();
 	
 	void OnCompletion();
+	// One step of the selected algorithm
+	void Step();
+	// Step of a registered MazeBuilderPlugin
+	void StepPlugin();
 	void RecursiveBacktrack();
 	void RandomizedKruskal();
 	void RandomizedPrims();
 	void Wilson();
+	// One whole column per step
+	void Eller();
+	// Batch loops of the four above, see MazeCarver. Up to maxSteps steps which build the same maze as calling the
+	// step as often, returns the steps taken
+	uint64_t AdvanceRecursiveBacktrack(uint64_t maxSteps);
+	uint64_t AdvanceKruskal(uint64_t maxSteps);
+	uint64_t AdvancePrims(uint64_t maxSteps);
+	uint64_t AdvanceWilson(uint64_t maxSteps);
+
+	// Cell the last step worked on and the size of what is left to explore, for the step log
+	uint32_t GetCurrentCell() const;
+	uint32_t GetFrontierSize() const;
+	// State of every algorithm, the maze reports its own arrays. Plugins are not included
+	void ReportMemory(MazeMemoryReport& report) const;
 
 public:
-	const enum Algorithms
+	// Registered plugins get the ids after ELLER
+	enum Algorithms : uint8_t
 	{
 		NONE = 0,
 		RECURSIVE_BACKTRACK,
 		KRUSKAL,
 		PRIMS,
-		WILSON
+		WILSON,
+		ELLER
 	};
 
 	Maze* m_Maze = nullptr;
@@ -34,6 +68,9 @@ public:
 	Algorithms m_SelectedAlgorithm = Algorithms::NONE;
 	uint32_t m_StartCoordinate = 0;
 	std::vector<uint32_t> m_Path;
+	uint32_t m_Seed = 0;
+	// Every random choice of the builders comes from here
+	std::mt19937 m_Generator;
 
 	// For RECURSIVE_BACKTRACK
 	std::stack<uint32_t> m_Stack;
@@ -41,17 +78,38 @@ public:
 	// For KRUSKAL
 	// Cells indxed by the cell number
 	DisjointSet* m_Cells = nullptr;
-	// Index is wallNumber, pair are cells separated by that wall
-	// Each cell has 2 walls by default in N->S and W->E
-	std::vector<std::pair<int32_t, int32_t>> m_Walls;
-	// These represent the indexes
+	// For KRUSKAL and PRIMS
+	// Walls left, numbered cell * 4 + direction like MazeCarver does. Kruskal takes them from the back,
+	// Prims at random
 	std::vector<uint32_t> m_WallShuffler;
-	uint32_t m_LastCell = 0;
 
 	// For Wilson
+	// Unordered, cells leave by swapping with the last one
 	std::vector<uint32_t> m_ElementsLeft;
+	// Position of every cell in m_ElementsLeft and in the walk in m_Path. A walk position is only
+	// valid if m_Path has the cell there, so they are never cleared
+	std::vector<uint32_t> m_ElementIndex;
+	std::vector<uint32_t> m_WalkIndex;
 	uint32_t m_RandomWalkStart = 0;
 	uint32_t m_RandomWalkEnd = 0;
+
+	// For ELLER
+	// Seeded with m_Seed so it matches a maze streamed to a file with the same seed
+	MazeStreamBuilder m_Eller;
+
+	// For registered builders, see MazeRegistry
+	std::unique_ptr<MazeBuilderPlugin> m_Plugin;
+
+private:
+	friend class MazeCheckpoint;
+	// Step of the selected algorithm, looked up in MazeRegistry on the first step
+	void (MazeBuilder::*m_StepFunction)() = nullptr;
+	// Empty builder which MazeCheckpoint fills in
+	explicit MazeBuilder(Maze* maze);
+	// Puts the first cell into the maze so every walk has something to end on
+	void StartWilson();
+	// Builds m_ElementIndex and m_WalkIndex from m_ElementsLeft and m_Path, checkpoints do not store them
+	void IndexWilson();
 };
 
 class DisjointSet
@@ -61,11 +119,16 @@ public:
 	DisjointSet(DisjointSet&) = delete;
 	DisjointSet(DisjointSet&&) = delete;
 
-	DisjointSet(uint32_t n);
+	DisjointSet(uint32_t n, MazeArena* arena = nullptr);
+	~DisjointSet();
 
 	uint32_t Find(uint32_t x);
 	void UnionSets(uint32_t x, uint32_t y);
+	void ReportMemory(MazeMemoryReport& report, const char* subsystem) const;
 private:
+	friend class MazeCheckpoint;
+
 	std::vector<uint32_t> parent;
 	std::vector<uint32_t> rank;
+	MazeArena* m_Arena = nullptr;
 };
\ No newline at end of file
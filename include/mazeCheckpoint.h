@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+class Maze;
+class MazeBuilder;
+class MazeSolver;
+
+// Maze, builder and solver that carry on exactly where a checkpoint was taken
+struct MazeCheckpointState
+{
+    Maze* maze = nullptr;
+    // Either can be nullptr when it was not running
+    MazeBuilder* builder = nullptr;
+    MazeSolver* solver = nullptr;
+    // The solver points at this, move it along with the solver
+    std::pair<uint32_t, uint32_t> route;
+};
+
+// Binary snapshot of a run in progress, every value is little endian
+//   "MCKP", version, flags      MAZE_CHECKPOINT_* flags say which sections follow the maze
+//   Maze                        layout, cell info, weights
+//   Builder                     generator state and every container of the algorithm
+//   Solver                      generator state, route and every container of the algorithm
+// Generators are stored with their full state so a restored run is bit identical to one that never stopped.
+// Capture only copies into memory, which is the only part that has to pause the simulation,
+// writing to disk can then happen on any thread.
+class MazeCheckpoint
+{
+public:
+    MazeCheckpoint() = delete;
+
+    // 2 stores weights, distances and heuristic at their narrow width and parents as directions.
+    // 5 adds the compact solver node records after the full ones.
+    // 6 numbers the Kruskal and Prims walls like MazeCarver and drops the wall pairs
+    // 7 A* node records hold the cost without the heuristic
+    static constexpr uint16_t VERSION = 7;
+
+    static void Capture(std::vector<uint8_t>& data, const Maze& maze, const MazeBuilder* builder, const MazeSolver* solver, const std::pair<uint32_t, uint32_t>& route);
+    // Goes through a temporary file which is renamed at the end, so a crash never leaves half a checkpoint behind
+    static bool Write(const std::string& filePath, const std::vector<uint8_t>& data);
+    static bool Load(const std::string& filePath, MazeCheckpointState& state);
+    static bool Restore(const std::vector<uint8_t>& data, MazeCheckpointState& state);
+};
+
+enum MazeCheckpointFlags
+{
+    MAZE_CHECKPOINT_BUILDER = 0x01,
+    MAZE_CHECKPOINT_SOLVER = 0x02
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <stdint.h>
+
+// Hardware counter totals over some stretch of builder or solver work and the number of cells it processed
+struct MazeCounterSample
+{
+    enum Events : uint8_t
+    {
+        CYCLES = 0,
+        INSTRUCTIONS,
+        // Level 1 data cache read misses
+        L1D_MISSES,
+        // Last level cache misses, these are the ones which go to memory
+        LLC_MISSES,
+        BRANCH_MISSES,
+        EVENT_COUNT
+    };
+
+    uint64_t counts[EVENT_COUNT]{};
+    uint64_t cells = 0;
+    // Bit per event which could be counted, the counts of the others stay 0
+    uint8_t available = 0;
+
+    bool IsAvailable(Events event) const { return (available >> event) & 1; }
+    double GetPerCell(Events event) const { return cells ? static_cast<double>(counts[event]) / cells : 0.0; }
+    // Instructions per cycle, 0 when either is missing
+    double GetIpc() const;
+    void Add(const MazeCounterSample& other);
+
+    static const char* GetEventName(Events event);
+};
+
+// Linux perf_event_open counters of the thread which opened them, user space only so they also work with the
+// default perf_event_paranoid. Every event is opened on its own, whatever the CPU, kernel or VM does not offer is
+// left out and everywhere else Open fails and Read returns nothing, so callers never have to check twice
+class MazeCounters
+{
+public:
+    MazeCounters();
+    MazeCounters(MazeCounters&) = delete;
+    MazeCounters(MazeCounters&&) = delete;
+    ~MazeCounters();
+
+    // Has to be called on the thread to be measured. False when no event could be opened, GetError says why
+    bool Open();
+    void Close();
+    bool IsOpen() const { return m_Available != 0; }
+    const std::string& GetError() const { return m_Error; }
+
+    // Totals since Open, scaled up when the kernel had to share the hardware counters between events.
+    // cells is left at 0, the difference of two reads is the cost of the work in between
+    MazeCounterSample Read() const;
+    static MazeCounterSample Difference(const MazeCounterSample& start, const MazeCounterSample& end);
+
+private:
+    int m_Files[MazeCounterSample::EVENT_COUNT];
+    uint8_t m_Available = 0;
+    std::string m_Error;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+class Maze;
+class MazeSolver;
+
+// Rasterizes a maze on the CPU into an RGB8 image with the same colours as the renderer, no OpenGL needed.
+// Rows of cells are split in bands which are drawn on separate threads.
+class MazeExporter
+{
+public:
+    MazeExporter() = default;
+    MazeExporter(MazeExporter&) = delete;
+    MazeExporter(MazeExporter&&) = delete;
+
+    // cellPixelSize is the size of one cell including its wall, the solver path is only drawn once it is completed
+    void Render(const Maze& maze, uint16_t cellPixelSize, const MazeSolver* solver = nullptr, const std::pair<uint32_t, uint32_t>* route = nullptr);
+
+    bool WritePPM(const std::string& filePath) const;
+    // Stored deflate blocks, no compression but quick to write and readable by everything
+    bool WritePNG(const std::string& filePath) const;
+    // Picks the format from the extension, .ppm or .png
+    bool Write(const std::string& filePath) const;
+
+    uint32_t GetWidth() const;
+    uint32_t GetHeight() const;
+    // Rows from top to bottom, 3 bytes per pixel
+    const std::vector<uint8_t>& GetPixels() const;
+
+public:
+    // Path colour belongs to Application so it has to be passed along
+    float m_ColorPath[4] = { 1.0f, 0.0f, 0.0f, 1.0f };
+    // 0 uses every hardware thread
+    uint32_t m_ThreadCount = 0;
+
+private:
+    uint32_t m_Width = 0, m_Height = 0;
+    // Kept between renders so exporting many thumbnails does not allocate every time
+    std::vector<uint8_t> m_Pixels;
+};
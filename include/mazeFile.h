@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <stdint.h>
+
+class Maze;
+
+// Binary maze file, every value is little endian
+//   MazeFileHeader  32 bytes
+//   Wall plane      2 bits per cell in cell number order, bit 0 is an open north wall and bit 1 an open east wall,
+//                   4 cells per byte starting from the low bits, padded to a multiple of 8 bytes
+//   Weight plane    uint32_t per cell, only present when MAZE_FILE_WEIGHTS is set
+// South and west walls are the north and east walls of the neighbours so a perfect maze needs nothing else.
+struct MazeFileHeader
+{
+    char magic[4] = { 'M', 'A', 'Z', 'E' };
+    uint16_t version = 1;
+    uint16_t flags = 0;
+    uint32_t cellsAcrossWidth = 0;
+    uint32_t cellsAcrossHeight = 0;
+    uint64_t seed = 0;
+    // MazeBuilder::Algorithms
+    uint8_t builder = 0;
+    uint8_t reserved[7]{};
+};
+
+static_assert(sizeof(MazeFileHeader) == 32, "MazeFileHeader is written as is");
+
+enum MazeFileFlags
+{
+    MAZE_FILE_WEIGHTS = 0x01
+};
+
+class MazeFile
+{
+public:
+    MazeFile() = delete;
+
+    static constexpr uint16_t VERSION = 1;
+
+    static bool Save(const std::string& filePath, const Maze& maze, bool withWeights);
+    // Returns a new completed maze or nullptr if the file could not be read
+    static Maze* Load(const std::string& filePath, uint16_t cellWidth = 10, uint16_t wallThickness = 2);
+
+    static uint64_t GetWallPlaneSize(uint64_t mazeArea);
+};
+
+// Read-only memory mapping of a maze file, nothing is copied until a cell is asked for
+// so opening even a huge maze only costs the validation of its header.
+class MappedMazeFile
+{
+public:
+    MappedMazeFile() = default;
+    MappedMazeFile(MappedMazeFile&) = delete;
+    MappedMazeFile(MappedMazeFile&&) = delete;
+    ~MappedMazeFile();
+
+    bool Open(const std::string& filePath);
+    void Close();
+    bool IsOpen() const;
+
+    const MazeFileHeader& GetHeader() const;
+    // Streamed files can hold more cells than a Maze so this is 64 bit
+    uint64_t GetMazeArea() const;
+    // Open walls of a cell as Maze::CELL_* flags including CELL_VISITED, read straight from the mapping
+    uint16_t GetCellInfo(uint64_t cell) const;
+    // nullptr when the file has no weights
+    const uint32_t* GetWeights() const;
+
+    // Decodes the whole file into a new completed maze using every hardware thread,
+    // nullptr when it has more cells than a Maze can hold
+    Maze* CreateMaze(uint16_t cellWidth, uint16_t wallThickness) const;
+
+private:
+    uint8_t GetWallBits(uint64_t cell) const;
+
+    const uint8_t* m_Data = nullptr;
+    uint64_t m_Size = 0;
+    const MazeFileHeader* m_Header = nullptr;
+    const uint8_t* m_WallPlane = nullptr;
+    const uint32_t* m_Weights = nullptr;
+
+#ifdef _WIN32
+    void* m_File = nullptr;
+    void* m_Mapping = nullptr;
+#endif
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+class Maze;
+class MappedMazeFile;
+class NarrowVector;
+class MazeMemoryReport;
+
+// Read-only adjacency of a finished maze in compressed sparse row form.
+// Neighbours of cell c are m_Targets[m_Offsets[c]] up to m_Targets[m_Offsets[c + 1]], in N, E, S, W order,
+// so solvers walk a flat array instead of testing four walls and bounds per expansion.
+// Every passage is stored once in each direction.
+class MazeGraph
+{
+public:
+    MazeGraph() = default;
+    MazeGraph(MazeGraph&) = delete;
+    MazeGraph(MazeGraph&&) = delete;
+
+    // Only needs to be done once the maze is completed, walls never change after that
+    bool Build(const Maze& maze, bool withWeights = false);
+    // Same graph read straight from the wall plane of a mapped file, the maze never has to be decoded.
+    // Weights are the ones of the file
+    bool Build(const MappedMazeFile& file, bool withWeights = false);
+    void Clear();
+    bool IsBuilt() const;
+    // Weight of an edge is the weight of the cell it leads to, same as the solvers use
+    void SetWeights(const NarrowVector& cellWeights);
+    void ReportMemory(MazeMemoryReport& report) const;
+
+    uint32_t GetVertexCount() const;
+    // Directed edges, twice the number of passages
+    uint64_t GetEdgeCount() const;
+    const uint32_t* GetNeighboursBegin(uint32_t cell) const { return m_Targets.data() + m_Offsets[cell]; }
+    const uint32_t* GetNeighboursEnd(uint32_t cell) const { return m_Targets.data() + m_Offsets[cell + 1]; }
+
+    // Header "MCSR", version, flags, vertex count, edge count then offsets, targets and weights as uint32_t arrays
+    bool WriteBinary(const std::string& filePath) const;
+    // One "from to [weight]" line per passage
+    bool WriteEdgeList(const std::string& filePath) const;
+    // DIMACS shortest path format, 1 based arcs in both directions, weight 1 when there are no weights
+    bool WriteDimacs(const std::string& filePath) const;
+
+public:
+    std::vector<uint32_t> m_Offsets;
+    std::vector<uint32_t> m_Targets;
+    // Parallel to m_Targets, empty unless weights were asked for
+    std::vector<uint32_t> m_Weights;
+
+private:
+    // Counts and fills offsets and targets, cellInfo(cell) returns the Maze::CELL_* flags of a cell
+    template<typename CellInfo>
+    bool BuildAdjacency(uint32_t mazeArea, uint32_t cellsAcrossHeight, CellInfo cellInfo);
+};
+
+struct MazeGraphHeader
+{
+    char magic[4] = { 'M', 'C', 'S', 'R' };
+    uint16_t version = 1;
+    // MAZE_FILE_WEIGHTS when the weight array follows the targets
+    uint16_t flags = 0;
+    uint32_t vertexCount = 0;
+    uint32_t reserved = 0;
+    uint64_t edgeCount = 0;
+};
+
+static_assert(sizeof(MazeGraphHeader) == 24, "MazeGraphHeader is written as is");
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include <stdint.h>
+
+class PackedPath;
+class MazeMemoryReport;
+
+// Mip pyramid of aggregated cell states which is drawn instead of the cells once they get smaller than a pixel.
+// Level 0 aggregates 2x2 cells and every level after that halves the resolution again.
+// Texels are RGBA8 where R is the visited fraction, G the searched fraction and B the on path fraction.
+// Like the cells, texels are stored column by column so level data is a transposed texture.
+class MazeLod
+{
+public:
+    MazeLod() = default;
+    MazeLod(MazeLod&) = delete;
+    MazeLod(MazeLod&&) = delete;
+
+    void Build(const std::vector<uint16_t>& cellInfo, const PackedPath& path, uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight);
+    void Clear();
+    void ReportMemory(MazeMemoryReport& report) const;
+
+    // Coarsest level whose texels are not much bigger than a pixel
+    uint32_t SelectLevel(float cellPixelSize) const;
+
+    uint32_t GetLevelCount() const;
+    // Number of texel columns, same direction as the cell columns
+    uint32_t GetLevelWidth(uint32_t level) const;
+    // Number of texels in a column
+    uint32_t GetLevelHeight(uint32_t level) const;
+    uint32_t GetCellsPerTexel(uint32_t level) const;
+    const uint8_t* GetLevelData(uint32_t level) const;
+
+public:
+    // Sequence of the snapshot the pyramid was built from
+    uint64_t m_BuiltSequence = 0;
+    // Used to throttle rebuilds of huge mazes
+    std::chrono::steady_clock::time_point m_LastBuild;
+    double m_BuildSeconds = 0.0;
+
+private:
+    struct Level
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> texels;
+    };
+
+    std::vector<Level> m_Levels;
+};
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+#include <stdint.h>
+
+// One structure of a report. Used is what its elements take, reserved what it holds on to, e.g. vector capacity
+struct MazeMemoryEntry
+{
+    // String literals, reports are refilled a few times a second and should not allocate once warmed up
+    const char* subsystem = "";
+    const char* name = "";
+    uint64_t usedBytes = 0;
+    uint64_t reservedBytes = 0;
+};
+
+// Bytes held by the structures of the maze, its builder, solver and whatever else reports into it.
+// Components add themselves with a ReportMemory(MazeMemoryReport&) const function
+class MazeMemoryReport
+{
+public:
+    void Clear() { m_Entries.clear(); }
+    void Add(const char* subsystem, const char* name, uint64_t usedBytes, uint64_t reservedBytes);
+
+    template<typename T>
+    void AddVector(const char* subsystem, const char* name, const std::vector<T>& vector)
+    {
+        Add(subsystem, name, vector.size() * sizeof(T), vector.capacity() * sizeof(T));
+    }
+
+    // std::stack, std::queue and std::priority_queue do not tell their capacity, only what they hold is counted
+    template<typename Adapter>
+    void AddAdapter(const char* subsystem, const char* name, const Adapter& adapter)
+    {
+        const uint64_t bytes = adapter.size() * sizeof(typename Adapter::value_type);
+        Add(subsystem, name, bytes, bytes);
+    }
+
+    const std::vector<MazeMemoryEntry>& GetEntries() const { return m_Entries; }
+    uint64_t GetUsedBytes() const;
+    uint64_t GetReservedBytes() const;
+    // Subsystems in the order they were first added, with their totals as entries named ""
+    std::vector<MazeMemoryEntry> GetSubsystems() const;
+
+    // One line per entry largest first, followed by the totals per subsystem and the resident size of the process
+    void Print(std::ostream& stream) const;
+
+    // Resident size of the whole process, 0 where it can not be read
+    static uint64_t GetResidentBytes();
+    // Highest resident size so far, see MazeBench for resetting it between cases on Linux
+    static uint64_t GetPeakResidentBytes();
+
+private:
+    std::vector<MazeMemoryEntry> m_Entries;
+};
+
+// Resident size of the process sampled over time, a ring buffer laid out like the Profiler histories
+class MazeMemoryHistory
+{
+public:
+    MazeMemoryHistory();
+
+    // Takes a sample when the last one is at least intervalMs old, returns whether it did
+    bool Sample(uint32_t intervalMs = 250);
+
+    // Megabytes, usable directly with ImPlot::PlotLine and GetHistoryOffset
+    const float* GetHistory() const { return m_History.data(); }
+    uint32_t GetCount() const { return m_Count; }
+    uint32_t GetHistoryOffset() const { return (m_Head + HISTORY_SIZE - m_Count) % HISTORY_SIZE; }
+    uint64_t GetLastBytes() const { return m_LastBytes; }
+
+public:
+    // A minute at the default interval
+    static constexpr uint32_t HISTORY_SIZE = 240;
+
+private:
+    std::vector<float> m_History;
+    uint32_t m_Head = 0;
+    uint32_t m_Count = 0;
+    uint64_t m_LastBytes = 0;
+    // Milliseconds on the steady clock
+    int64_t m_LastSample = 0;
+};
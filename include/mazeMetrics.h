@@ -0,0 +1,63 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <stdint.h>
+
+class Maze;
+class PackedPath;
+
+// Shape statistics of a finished maze and optionally of its solution.
+// A corridor is a run of cells with exactly two open walls between two cells that are not, its length is the
+// number of steps from one end to the other. Loops made only of corridor cells are not counted.
+struct MazeMetrics
+{
+    static constexpr uint32_t HISTOGRAM_SIZE = 32;
+
+    // Number of mazes added together, every count below is a total over them
+    uint64_t samples = 0;
+    uint64_t cells = 0;
+    uint64_t passages = 0;
+    uint64_t horizontalPassages = 0;
+    uint64_t verticalPassages = 0;
+
+    // Cells by number of open walls
+    uint64_t deadEnds = 0;
+    uint64_t corridorCells = 0;
+    uint64_t junctions = 0;
+    uint64_t crossroads = 0;
+    // Corridor cells that go straight through
+    uint64_t straightCells = 0;
+
+    uint64_t corridors = 0;
+    uint64_t corridorSteps = 0;
+    uint64_t longestCorridor = 0;
+    // Bucket i counts corridors of 2^i to 2^(i + 1) - 1 steps
+    uint64_t corridorHistogram[HISTOGRAM_SIZE] = {};
+
+    // River, how far a dead end reaches back before it meets a junction. Mazes with a low river have many short
+    // dead ends, a high river means few long winding ones
+    uint64_t deadEndSteps = 0;
+
+    // Only filled in for samples with a solution
+    uint64_t solvedSamples = 0;
+    uint64_t solutionSteps = 0;
+    uint64_t solutionTurns = 0;
+    // Solution steps over the Manhattan distance between its ends, 1 is a straight line. Summed over the samples
+    double tortuositySum = 0.0;
+
+    double GetMeanCorridor() const { return corridors ? static_cast<double>(corridorSteps) / corridors : 0.0; }
+    double GetRiver() const { return deadEnds ? static_cast<double>(deadEndSteps) / deadEnds : 0.0; }
+    double GetDeadEndRatio() const { return cells ? static_cast<double>(deadEnds) / cells : 0.0; }
+    double GetTortuosity() const { return solvedSamples ? tortuositySum / solvedSamples : 0.0; }
+
+    // One linear pass over the cells split across the hardware threads, solution may be null
+    static MazeMetrics Compute(const Maze& maze, const PackedPath* solution = nullptr);
+
+    // Sums the counts and keeps the longest corridor
+    void Add(const MazeMetrics& other);
+
+    // Single object, indent is put in front of every line after the first
+    void WriteJson(std::ostream& stream, const std::string& indent = "") const;
+    bool WriteJson(const std::string& filePath) const;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+#include "maze.h"
+#include "tripleBuffer.h"
+
+class MazeGraph;
+
+struct MazeRaceResult
+{
+    uint8_t algorithm = 0;
+    bool completed = false;
+    // Steps taken, stale queue entries of Dijkstra and A* included
+    uint64_t expansions = 0;
+    // Largest stack or queue seen
+    uint64_t peakFrontier = 0;
+    // Time spent stepping, delays and pauses are left out
+    double milliseconds = 0.0;
+    // Only set once completed
+    uint64_t pathCells = 0;
+    // Sum of the weights of the path cells after the start, what Dijkstra minimizes
+    uint64_t pathCost = 0;
+};
+
+// Runs several solvers at once on their own threads over one maze. Every solver marks the cells it searched
+// in an overlay of its own, the maze and its graph are only read and must not change until Stop().
+// Each solver publishes snapshots of its overlay like the simulation thread does, for one reader thread.
+class MazeRace
+{
+public:
+    MazeRace() = default;
+    MazeRace(MazeRace&) = delete;
+    MazeRace(MazeRace&&) = delete;
+    ~MazeRace();
+
+    // Stops the previous race first. delay and paused are read on every step, they can be null
+    void Start(Maze& maze, const MazeGraph& graph, std::pair<uint32_t, uint32_t> route, const std::vector<uint8_t>& algorithms,
+        uint32_t seed, const std::atomic<int>* delay = nullptr, const std::atomic<bool>* paused = nullptr);
+    // Joins the solvers, their results and last snapshots are kept
+    void Stop();
+    // Stops and forgets the solvers, needed before the maze is deleted
+    void Clear();
+
+    bool IsRunning() const;
+    size_t GetRacerCount() const { return m_Racers.size(); }
+    MazeRaceResult GetResult(size_t racer) const;
+
+    // Latest snapshot of one solver, stays valid until the next call for the same solver
+    const MazeSnapshot& ConsumeSnapshot(size_t racer);
+
+private:
+    struct Racer
+    {
+        uint8_t algorithm = 0;
+        std::pair<uint32_t, uint32_t> route;
+        // Copy of the maze cell info the solver marks its searched cells in
+        std::vector<uint16_t> cellInfo;
+        TripleBuffer<MazeSnapshot> snapshots;
+        // Guarded by m_ResultMutex
+        MazeRaceResult result;
+        std::atomic<bool> running = false;
+        std::thread thread;
+    };
+
+    void Run(Racer& racer, uint32_t seed);
+    void Publish(Racer& racer, const PackedPath* path);
+
+    Maze* m_Maze = nullptr;
+    const MazeGraph* m_Graph = nullptr;
+    const std::atomic<int>* m_Delay = nullptr;
+    const std::atomic<bool>* m_Paused = nullptr;
+
+    std::vector<std::unique_ptr<Racer>> m_Racers;
+    std::atomic<bool> m_StopRequested = false;
+    mutable std::mutex m_ResultMutex;
+    // Shared by all the solvers so a snapshot never repeats the sequence of another one
+    std::atomic<uint64_t> m_SnapshotSequence = 0;
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// Binary step log of one builder or solver run, every value is little endian
+//   MazeLogHeader   32 bytes
+//   Events          one per step until the end of the file
+// An event is one byte with the cell flags after the step (Maze::CELL_* bits 0-5) followed by
+// the cell and the frontier size as zigzag varint deltas to the previous event, 3 bytes for most steps.
+struct MazeLogHeader
+{
+    char magic[4] = { 'M', 'L', 'O', 'G' };
+    // MazeRecorder::VERSION
+    uint16_t version = 4;
+    // MazeLogKind
+    uint8_t kind = 0;
+    // MazeBuilder::Algorithms or MazeSolver::Algorithms depending on kind
+    uint8_t algorithm = 0;
+    uint32_t cellsAcrossWidth = 0;
+    uint32_t cellsAcrossHeight = 0;
+    uint32_t seed = 0;
+    uint32_t routeStart = 0;
+    uint32_t routeEnd = 0;
+    uint32_t reserved = 0;
+};
+
+static_assert(sizeof(MazeLogHeader) == 32, "MazeLogHeader is written as is");
+
+enum MazeLogKind
+{
+    MAZE_LOG_BUILDER = 0,
+    MAZE_LOG_SOLVER
+};
+
+struct MazeLogEvent
+{
+    uint32_t cell = 0;
+    uint16_t flags = 0;
+    // Stack, queue or wall list size after the step
+    uint32_t frontier = 0;
+};
+
+// Encodes events into memory and writes them out in large blocks so recording stays cheap next to a step
+class MazeRecorder
+{
+public:
+    MazeRecorder() = default;
+    MazeRecorder(MazeRecorder&) = delete;
+    MazeRecorder(MazeRecorder&&) = delete;
+    ~MazeRecorder();
+
+    // The events did not change, what a seed replays did:
+    // 2 the recursive backtracker marks its start visited before the first step, the same seed builds a different maze
+    // 3 DFS and BFS mark their start searched when they are created. DFS no longer steps back into the start, so its
+    //   searched cells, steps and path change for the same seed. BFS no longer queues the start a second time, it takes
+    //   one step less and the start counts as searched from the first step
+    // 4 A* orders by the cost plus the heuristic of the cell instead of adding up the heuristics along the path,
+    //   it searches different cells
+    static constexpr uint16_t VERSION = 4;
+
+    bool Open(const std::string& filePath, const MazeLogHeader& header);
+    // Called after every step, inline so recording costs a few nanoseconds
+    void Record(uint32_t cell, uint16_t flags, uint32_t frontier)
+    {
+        uint8_t* out = m_Buffer.data() + m_BufferUsed;
+        *out++ = static_cast<uint8_t>(flags & 0x3F);
+        out = WriteVarint(out, static_cast<int64_t>(cell) - m_PreviousCell);
+        out = WriteVarint(out, static_cast<int64_t>(frontier) - m_PreviousFrontier);
+        m_BufferUsed = out - m_Buffer.data();
+        m_PreviousCell = cell;
+        m_PreviousFrontier = frontier;
+        m_EventCount++;
+
+        if (m_BufferUsed >= FLUSH_SIZE)
+            Flush();
+    }
+    // Writes what is left, a log which was never closed still reads fine up to the last block
+    bool Close();
+    bool IsOpen() const;
+    uint64_t GetEventCount() const;
+
+private:
+    static uint8_t* WriteVarint(uint8_t* out, int64_t delta)
+    {
+        // Zigzag so small negative deltas stay small
+        uint64_t value = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+        while (value >= 0x80)
+        {
+            *out++ = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        *out++ = static_cast<uint8_t>(value);
+        return out;
+    }
+    void Flush();
+
+    // Blocks written at once, the buffer has room for one more event past this
+    static constexpr size_t FLUSH_SIZE = 1 << 20;
+    // Flag byte and two 64 bit varints
+    static constexpr size_t MAX_EVENT_SIZE = 1 + 2 * 10;
+
+    std::ofstream m_File;
+    std::string m_FilePath;
+    std::vector<uint8_t> m_Buffer;
+    size_t m_BufferUsed = 0;
+    uint32_t m_PreviousCell = 0;
+    uint32_t m_PreviousFrontier = 0;
+    uint64_t m_EventCount = 0;
+};
+
+class MazeLogReader
+{
+public:
+    MazeLogReader() = default;
+    MazeLogReader(MazeLogReader&) = delete;
+    MazeLogReader(MazeLogReader&&) = delete;
+
+    bool Open(const std::string& filePath);
+    const MazeLogHeader& GetHeader() const;
+    // False at the end of the log or at a truncated event
+    bool Next(MazeLogEvent& event);
+    void Rewind();
+
+private:
+    bool ReadVarint(int64_t& delta);
+
+    MazeLogHeader m_Header;
+    std::vector<uint8_t> m_Data;
+    size_t m_Position = 0;
+    MazeLogEvent m_Previous;
+};
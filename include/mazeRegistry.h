@@ -0,0 +1,153 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "maze.h"
+#include "mazeBuilder.h"
+#include "mazeSolver.h"
+
+// Builder kept outside of MazeBuilder. It is constructed by MazeBuilder with the maze and seed already set, keeps its
+// own state and carves into builder.m_Maze. Once done it sets m_VisitedCellCount to the maze area like the others
+class MazeBuilderPlugin
+{
+public:
+    virtual ~MazeBuilderPlugin() = default;
+
+    virtual void Step(MazeBuilder& builder) = 0;
+    // For the step log
+    virtual uint32_t GetCurrentCell() const = 0;
+    virtual uint32_t GetFrontierSize() const = 0;
+};
+
+// Solver kept outside of MazeSolver. It marks the cells it searched in solver.m_CellInfo and once it reaches the
+// goal it fills in solver.m_Path and sets solver.m_Completed. A frontier of 0 means there is no path
+class MazeSolverPlugin
+{
+public:
+    virtual ~MazeSolverPlugin() = default;
+
+    virtual void Step(MazeSolver& solver) = 0;
+    virtual uint32_t GetCurrentCell() const = 0;
+    virtual uint32_t GetFrontierSize() const = 0;
+};
+
+struct MazeBuilderEntry
+{
+    // Stored in maze files, step logs and checkpoints
+    uint8_t algorithm = MazeBuilder::NONE;
+    // For the command line tools
+    std::string name;
+    // For the buttons
+    std::string label;
+    // One step, what MazeBuilder::Step calls
+    void (MazeBuilder::*step)() = nullptr;
+    // Steps until the maze is completed in a loop compiled for this algorithm, returns how many steps it took
+    uint64_t (*run)(MazeBuilder& builder) = nullptr;
+    // Same loop stopping after maxSteps, for callers which step on a time budget. run is this without the limit
+    uint64_t (*advance)(MazeBuilder& builder, uint64_t maxSteps) = nullptr;
+    // Null for the algorithms which are part of MazeBuilder
+    std::unique_ptr<MazeBuilderPlugin> (*createPlugin)(MazeBuilder& builder) = nullptr;
+};
+
+struct MazeSolverEntry
+{
+    uint8_t algorithm = MazeSolver::NONE;
+    std::string name;
+    std::string label;
+    // One step, returns false once the solver is completed or ran out of cells
+    bool (MazeSolver::*step)() = nullptr;
+    // Steps until completed or out of cells, returns how many steps it took
+    uint64_t (*run)(MazeSolver& solver) = nullptr;
+    uint64_t (*advance)(MazeSolver& solver, uint64_t maxSteps) = nullptr;
+    std::unique_ptr<MazeSolverPlugin> (*createPlugin)(MazeSolver& solver) = nullptr;
+};
+
+// Every builder and solver the application and the tools know about, the ones of MazeBuilder and MazeSolver first.
+// Plugins register themselves before main, a static initialized with RegisterBuilder in their source file is enough:
+//     static const uint8_t MY_BUILDER = MazeRegistry::RegisterBuilder<MyBuilder>("mine", "My Builder");
+// The source file has to be linked into the executable itself, a static library drops objects nothing refers to.
+class MazeRegistry
+{
+public:
+    MazeRegistry() = delete;
+
+    static const std::vector<MazeBuilderEntry>& GetBuilders() { return Builders(); }
+    static const std::vector<MazeSolverEntry>& GetSolvers() { return Solvers(); }
+
+    // Null when nothing is registered under it
+    static const MazeBuilderEntry* FindBuilder(uint8_t algorithm);
+    static const MazeBuilderEntry* FindBuilder(const std::string& name);
+    static const MazeSolverEntry* FindSolver(uint8_t algorithm);
+    static const MazeSolverEntry* FindSolver(const std::string& name);
+
+    // Plugin derives from MazeBuilderPlugin and is constructed from a MazeBuilder&. Returns the algorithm id it got,
+    // NONE when the name is taken or every id is used. Not thread safe, meant for static initialization
+    template<typename Plugin>
+    static uint8_t RegisterBuilder(const std::string& name, const std::string& label)
+    {
+        MazeBuilderEntry entry;
+        entry.name = name;
+        entry.label = label;
+        entry.step = &MazeBuilder::StepPlugin;
+        entry.run = &RunBuilderPlugin<Plugin>;
+        entry.advance = &AdvanceBuilderPlugin<Plugin>;
+        entry.createPlugin = [](MazeBuilder& builder) -> std::unique_ptr<MazeBuilderPlugin> { return std::make_unique<Plugin>(builder); };
+        return AddBuilder(entry);
+    }
+
+    // Plugin derives from MazeSolverPlugin and is constructed from a MazeSolver&
+    template<typename Plugin>
+    static uint8_t RegisterSolver(const std::string& name, const std::string& label)
+    {
+        MazeSolverEntry entry;
+        entry.name = name;
+        entry.label = label;
+        entry.step = &MazeSolver::StepPlugin;
+        entry.run = &RunSolverPlugin<Plugin>;
+        entry.advance = &AdvanceSolverPlugin<Plugin>;
+        entry.createPlugin = [](MazeSolver& solver) -> std::unique_ptr<MazeSolverPlugin> { return std::make_unique<Plugin>(solver); };
+        return AddSolver(entry);
+    }
+
+private:
+    static std::vector<MazeBuilderEntry>& Builders();
+    static std::vector<MazeSolverEntry>& Solvers();
+    static uint8_t AddBuilder(MazeBuilderEntry& entry);
+    static uint8_t AddSolver(MazeSolverEntry& entry);
+
+    // Naming Plugin in the call makes it a direct call the compiler can inline instead of going through the vtable
+    template<typename Plugin>
+    static uint64_t AdvanceBuilderPlugin(MazeBuilder& builder, uint64_t maxSteps)
+    {
+        Plugin& plugin = static_cast<Plugin&>(*builder.m_Plugin);
+        uint64_t steps = 0;
+        for (; steps < maxSteps && !builder.m_Maze->MazeCompleted(); steps++)
+            plugin.Plugin::Step(builder);
+        return steps;
+    }
+
+    template<typename Plugin>
+    static uint64_t RunBuilderPlugin(MazeBuilder& builder)
+    {
+        return AdvanceBuilderPlugin<Plugin>(builder, UINT64_MAX);
+    }
+
+    template<typename Plugin>
+    static uint64_t AdvanceSolverPlugin(MazeSolver& solver, uint64_t maxSteps)
+    {
+        Plugin& plugin = static_cast<Plugin&>(*solver.m_Plugin);
+        uint64_t steps = 0;
+        for (; steps < maxSteps && !solver.m_Completed && plugin.Plugin::GetFrontierSize() > 0; steps++)
+            plugin.Plugin::Step(solver);
+        return steps;
+    }
+
+    template<typename Plugin>
+    static uint64_t RunSolverPlugin(MazeSolver& solver)
+    {
+        return AdvanceSolverPlugin<Plugin>(solver, UINT64_MAX);
+    }
+};
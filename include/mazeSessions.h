@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+#include "maze.h"
+#include "mazeArena.h"
+#include "mazeBuilder.h"
+#include "mazeExporter.h"
+#include "mazeGraph.h"
+#include "mazeSolver.h"
+#include "tripleBuffer.h"
+
+struct MazeSessionSettings
+{
+    // Registered ids, see MazeRegistry
+    uint8_t builder = MazeBuilder::RECURSIVE_BACKTRACK;
+    uint8_t solver = MazeSolver::BFS;
+    uint32_t cellsAcrossWidth = 64;
+    uint32_t cellsAcrossHeight = 36;
+    // Builder, solver and weights all use it, the same settings always give the same run
+    uint32_t seed = 0;
+    // Start and goal, opposite corners when they are not two different cells of the maze
+    std::pair<uint32_t, uint32_t> route = { 0, 0 };
+};
+
+struct MazeSessionStats
+{
+    enum States : uint8_t
+    {
+        BUILDING = 0,
+        SOLVING,
+        // Solver reached the goal or ran out of cells
+        FINISHED
+    };
+
+    uint8_t state = BUILDING;
+    uint64_t builderSteps = 0;
+    uint64_t solverSteps = 0;
+    // Time spent stepping, delays and pauses are left out
+    double builderMilliseconds = 0.0;
+    double solverMilliseconds = 0.0;
+    // Largest stack or queue of the solver
+    uint64_t peakFrontier = 0;
+    // 0 until the solver reached the goal
+    uint64_t pathCells = 0;
+};
+
+// Thumbnail of a session with its statistics, RGB8 rows from top to bottom like MazeExporter
+struct MazeSessionFrame
+{
+    std::vector<uint8_t> pixels;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    MazeSessionStats stats;
+    // Increases with every frame of every session
+    uint64_t sequence = 0;
+};
+
+// Independent mazes, each with its own builder, solver, seed and route, advanced in parallel by one pool of worker
+// threads. A worker takes a session which is due, steps it for a short slice and hands it back, so there can be
+// many more sessions than workers. Sessions are added, removed and read by one thread, the render thread.
+class MazeSessions
+{
+public:
+    // delay and paused are read before every slice, they can be null
+    MazeSessions(const std::atomic<int>* delay = nullptr, const std::atomic<bool>* paused = nullptr);
+    MazeSessions(MazeSessions&) = delete;
+    MazeSessions(MazeSessions&&) = delete;
+    ~MazeSessions();
+
+    // Starts the workers with the first session, returns the id of the new session
+    uint32_t Add(const MazeSessionSettings& settings);
+    // Waits for the slice of a worker which is stepping it
+    void Remove(size_t index);
+    // Builds and solves the maze of a session again from the start, with the same settings
+    void Restart(size_t index);
+    // Removes every session and stops the workers
+    void Clear();
+
+    size_t GetCount() const { return m_Sessions.size(); }
+    // Stays the same while other sessions come and go
+    uint32_t GetId(size_t index) const { return m_Sessions[index]->id; }
+    const MazeSessionSettings& GetSettings(size_t index) const { return m_Sessions[index]->settings; }
+    // Latest frame of a session, stays valid until the next call for the same session
+    const MazeSessionFrame& ConsumeFrame(size_t index);
+
+public:
+    // Set before the first session. 0 leaves a hardware thread each to the renderer and the simulation thread
+    uint32_t m_ThreadCount = 0;
+    // Longer side of the thumbnails, cells get at least a pixel. Set before the first session
+    uint32_t m_ThumbnailPixels = 256;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Session
+    {
+        uint32_t id = 0;
+        MazeSessionSettings settings;
+        // Solver keeps a pointer to it
+        std::pair<uint32_t, uint32_t> route;
+
+        // Only touched by the worker holding the session. Declared so the solver goes first and the maze last
+        std::unique_ptr<Maze> maze;
+        MazeGraph graph;
+        std::unique_ptr<MazeBuilder> builder;
+        std::unique_ptr<MazeSolver> solver;
+        MazeSessionStats stats;
+        MazeExporter exporter;
+        Clock::time_point lastPublish;
+        TripleBuffer<MazeSessionFrame> frames;
+
+        // Guarded by m_Mutex
+        bool busy = false;
+        bool finished = false;
+        bool restartRequested = true;
+        Clock::time_point nextSlice;
+    };
+
+    void Work();
+    // Needs m_Mutex, marks the session it returns as busy. restart tells whether it has to be reset first
+    Session* Claim(bool& restart);
+    // One slice of stepping, returns true when the session has nothing left to do
+    bool Advance(Session& session);
+    // Fresh maze and builder for the settings of the session
+    void Reset(Session& session);
+    void Publish(Session& session);
+
+    const std::atomic<int>* m_Delay = nullptr;
+    const std::atomic<bool>* m_Paused = nullptr;
+    // Buffers of restarted and removed sessions for the next mazes
+    MazeArena m_Arena;
+
+    std::vector<std::unique_ptr<Session>> m_Sessions;
+    uint32_t m_NextId = 1;
+    // Where Claim starts looking, so every session gets its turn
+    size_t m_NextSession = 0;
+    std::mutex m_Mutex;
+    // Signalled when a session was handed back or there is new work
+    std::condition_variable m_Changed;
+    std::vector<std::thread> m_Workers;
+    bool m_StopRequested = false;
+    std::atomic<uint64_t> m_FrameSequence = 0;
+};
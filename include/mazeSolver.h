@@ -1,8 +1,21 @@
+#pragma once
+
+#include <limits>
+#include <memory>
 #include <queue>
+#include <random>
 #include <stack>
 #include <unordered_set>
 
+#include "packedPath.h"
+
 class Maze;
+class MazeGraph;
+class MazeArena;
+class MazeCheckpoint;
+class MappedMazeFile;
+class MazeSolverPlugin;
+class MazeMemoryReport;
 
 struct WeightDetails
 {
@@ -18,6 +31,45 @@ struct CompareWeights
 	bool operator()(const WeightDetails l, const WeightDetails r) const { return l.weight > r.weight; }
 };
 
+// Everything Dijkstra and A* read or write for a cell while relaxing it, so a neighbour costs one cache line instead of one per array
+struct MazeSolverNode
+{
+	enum Bits
+	{
+		// Parent as 0 north, 1 east, 2 south, 3 west
+		DIRECTION_MASK = 0x3,
+		CLOSED = 0x4,
+		WEIGHT_SHIFT = 3
+	};
+	// Larger weights are clamped when they are copied in
+	static constexpr uint32_t MAX_WEIGHT = std::numeric_limits<uint32_t>::max() >> WEIGHT_SHIFT;
+
+	// Cost so far, infinity until the cell is reached
+	uint32_t distance = std::numeric_limits<uint32_t>::max();
+	// Weight of the cell, closed flag and parent direction
+	uint32_t link = 0;
+};
+static_assert(sizeof(MazeSolverNode) == 8, "Eight records share a cache line");
+
+// Distance, closed flag and parent direction in one word, for weights of one or two bytes. The weight is read
+// from the narrow Maze::m_CellWeights instead of being copied in, so a relaxation touches 5 or 6 bytes instead
+// of 8. Only used while the longest possible distance fits in the bits above the flags
+struct MazeSolverCompactNode
+{
+	enum Bits
+	{
+		// Same as MazeSolverNode
+		DIRECTION_MASK = 0x3,
+		CLOSED = 0x4,
+		DISTANCE_SHIFT = 3
+	};
+	// Also what a cell which was not reached yet has
+	static constexpr uint32_t MAX_DISTANCE = std::numeric_limits<uint32_t>::max() >> DISTANCE_SHIFT;
+
+	uint32_t link = MAX_DISTANCE << DISTANCE_SHIFT;
+};
+static_assert(sizeof(MazeSolverCompactNode) == 4, "Sixteen records share a cache line");
+
 class MazeSolver
 {
 public:
@@ -25,7 +77,17 @@ public:
 	MazeSolver(MazeSolver&) = delete;
 	MazeSolver(MazeSolver&&) = delete;
 
-	MazeSolver(Maze* maze, uint8_t selectedAlgorithm, std::pair<uint32_t, uint32_t>& route);
+	// Only DFS makes random choices, the same seed always takes the same path.
+	// Graph has to be built from the completed maze and outlive the solver.
+	// With a search overlay, searched cells are marked there instead of in the maze so several solvers can share one maze.
+	// It has to be a copy of the maze cell info and outlive the solver
+	MazeSolver(Maze* maze, const MazeGraph& graph, uint8_t selectedAlgorithm, std::pair<uint32_t, uint32_t>& route, uint32_t seed = std::random_device{}(),
+		std::vector<uint16_t>* searchOverlay = nullptr);
+	// Solves a maze file through its mapping without decoding it, graph has to be built from the same file.
+	// m_Maze stays nullptr, the search overlay starts zeroed with one entry per cell and registered plugins are not available.
+	// Weights are the ones of the file, file and overlay have to outlive the solver
+	MazeSolver(const MappedMazeFile& file, const MazeGraph& graph, uint8_t selectedAlgorithm, std::pair<uint32_t, uint32_t>& route, uint32_t seed,
+		std::vector<uint16_t>& searchOverlay);
 	~MazeSolver();
 	
 	void DepthFirstSearch();
@@ -33,9 +95,28 @@ public:
 	void DijkstraSearch();
 	void AstarSearch();
 	void OnCompletion();
+	// One step of the selected algorithm, or OnCompletion once the goal is next
+	void Step();
+	// Step of one algorithm, false once completed or out of cells
+	bool StepDepthFirst();
+	bool StepBreadthFirst();
+	bool StepDijkstra();
+	bool StepAstar();
+	// Step of a registered MazeSolverPlugin
+	bool StepPlugin();
+
+	// Cell the next step expands and the size of the stack or queue, for the step log
+	uint32_t GetCurrentCell() const;
+	uint32_t GetFrontierSize() const;
+	// Frontier, nodes and path. Plugins and a search overlay passed in are not included
+	void ReportMemory(MazeMemoryReport& report) const;
+
+	// Label it was registered with
+	static const char* GetAlgorithmName(uint8_t algorithm);
 
 public:
-	const enum Algorithms
+	// Registered plugins get the ids after ASTAR
+	enum Algorithms : uint8_t
 	{
 		NONE = 0,
 		DFS,
@@ -44,13 +125,22 @@ public:
 		ASTAR
 	};
 
+	// nullptr when solving a mapped file
 	Maze* m_Maze = nullptr;
+	// Neighbours come from here instead of the wall flags
+	const MazeGraph* m_Graph = nullptr;
+	// Where CELL_SEARCHED is read and written, the maze cell info unless an overlay is set
+	std::vector<uint16_t>* m_CellInfo = nullptr;
 	bool m_Completed = false;
 	Algorithms m_SelectedAlgorithm = Algorithms::NONE;
 	// It can't access application class
 	std::pair<uint32_t, uint32_t>* m_Route;
-	std::vector<uint32_t> m_Path;
-	std::vector<uint32_t> m_Parent;
+	// Solution from the start to the goal once m_Completed is set, 2 bits per step
+	PackedPath m_Path;
+	// For BFS, wall of each cell which leads back to the cell it was reached from, a Maze::CELL_* direction or 0
+	std::vector<uint8_t> m_Parent;
+	uint32_t m_Seed = 0;
+	std::mt19937 m_Generator;
 
 	//For DFS
 	std::stack<uint32_t> m_Stack;
@@ -59,8 +149,45 @@ public:
 
 	// For Dijkstra, A-star
 	std::priority_queue<WeightDetails, std::vector<WeightDetails>, CompareWeights> m_PQueue;
-	std::vector<uint32_t> m_Distance;
+	// One record per cell, the A-star heuristic is computed when a neighbour is relaxed instead of stored.
+	// Only one of them is in use, compact ones while the weights are narrow and the distances fit
+	std::vector<MazeSolverNode> m_Nodes;
+	std::vector<MazeSolverCompactNode> m_CompactNodes;
+
+	// For registered solvers, see MazeRegistry
+	std::unique_ptr<MazeSolverPlugin> m_Plugin;
+
+private:
+	friend class MazeCheckpoint;
+	// Looked up in MazeRegistry on the first step
+	bool (MazeSolver::*m_StepFunction)() = nullptr;
+	// Empty solver which MazeCheckpoint fills in, m_Graph has to be set before stepping
+	explicit MazeSolver(Maze* maze);
+	// Set up of the selected algorithm at the start of the route
+	void Start(uint32_t start);
+
+	// Copied from the maze or the file header, so nothing past the constructors needs m_Maze for them
+	uint32_t m_CellsAcrossWidth = 0, m_CellsAcrossHeight = 0, m_MazeArea = 0;
+	MazeArena* m_Arena = nullptr;
+	// Only set when solving a mapped file
+	const MappedMazeFile* m_File = nullptr;
+
+	// Relaxes the neighbours of a cell that was just popped, instantiated for both node records and every weight width
+	template<bool WithHeuristic, typename Nodes>
+	void Expand(uint32_t currentCell, Nodes nodes);
+	template<bool WithHeuristic>
+	void ExpandNodes(uint32_t currentCell);
+	// Whether the longest possible distance with the current weights fits in MazeSolverCompactNode
+	bool FitsCompactNodes() const;
+	// When the maze weights changed since the last call, copies them into m_Nodes or switches from compact
+	// records to full ones if they no longer fit
+	void SyncNodeWeights();
 
-	// For A-star
-	std::vector<uint32_t> m_Heuristic;
+	// Maze::m_WeightsVersion the nodes were last synced with
+	uint32_t m_NodeWeightsVersion = std::numeric_limits<uint32_t>::max();
+	// Coordinates of the goal for the A* heuristic, worked out again only when the route changes
+	uint32_t m_GoalCell = std::numeric_limits<uint32_t>::max();
+	uint32_t m_GoalX = 0, m_GoalY = 0;
+	void SetParent(uint32_t cell, uint32_t parent);
+	uint32_t GetParent(uint32_t cell) const;
 };
\ No newline at end of file
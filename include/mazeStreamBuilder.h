@@ -0,0 +1,69 @@
+#pragma once
+
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+class MazeCheckpoint;
+class MazeMemoryReport;
+
+// Eller's algorithm, builds a perfect maze one column at a time and only keeps the set labels of the current column
+// so memory is O(cells across height) no matter how wide the maze gets.
+// A column is a run of consecutive cell numbers, the same order as the wall plane of a maze file,
+// so every column can be written out as soon as it is done.
+// Wall bits use the maze file layout, bit 0 is an open north wall and bit 1 an open east wall.
+class MazeStreamBuilder
+{
+public:
+    // Called for every finished column, returning false stops the build
+    using ColumnSink = std::function<bool(uint32_t column, const std::vector<uint8_t>& wallBits)>;
+
+    MazeStreamBuilder() = default;
+    MazeStreamBuilder(MazeStreamBuilder&) = delete;
+    MazeStreamBuilder(MazeStreamBuilder&&) = delete;
+
+    // The same size and seed always build the same maze
+    void Reset(uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight, uint32_t seed);
+    // Builds the next column into GetWallBits, false once every column is done
+    bool NextColumn();
+    // Builds every column left, false if the sink stopped early
+    bool Run(const ColumnSink& sink);
+
+    bool IsCompleted() const;
+    // Column built by the last NextColumn
+    uint32_t GetColumn() const;
+    const std::vector<uint8_t>& GetWallBits() const;
+    // All of the column arrays as one entry
+    void ReportMemory(MazeMemoryReport& report, const char* subsystem) const;
+
+    // Writes a maze file column by column, the maze itself is never held in memory
+    static bool WriteMazeFile(const std::string& filePath, uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight, uint32_t seed);
+
+private:
+    friend class MazeCheckpoint;
+
+    uint32_t FindSet(uint32_t set);
+    bool RandomBit();
+
+    uint32_t m_CellsAcrossWidth = 0;
+    uint32_t m_CellsAcrossHeight = 0;
+    uint32_t m_NextColumn = 0;
+    std::mt19937 m_Generator;
+    // One generator call gives 32 coin flips
+    uint32_t m_RandomBits = 0;
+    uint32_t m_RandomBitCount = 0;
+
+    // Everything below has one entry per cell of a column
+    // Set of every cell
+    std::vector<uint32_t> m_Sets;
+    // Union find over the set numbers for the joins inside a column
+    std::vector<uint32_t> m_Parents;
+    // Cells of a set which are still to decide on an east passage
+    std::vector<uint32_t> m_Remaining;
+    std::vector<uint8_t> m_HasEast;
+    // Set numbers of the next column
+    std::vector<uint32_t> m_Renumber;
+    std::vector<uint8_t> m_WallBits;
+};
@@ -0,0 +1,329 @@
+#pragma once
+
+#include <random>
+#include <stack>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+class DisjointSet;
+
+// Cells are numbered column by column like in Maze, cell = layer * width * height + x * height + y, y grows north.
+// A topology lists its directions with constexpr neighbour rules, the bit a cell has set when its passage in that
+// direction is open and the direction leading back. The kernels of TopologyMaze are written once against these and
+// every direction check is compiled separately for every topology, with nothing left to dispatch at runtime.
+// MIN_CELLS_ACROSS is the smallest width and height where every direction leads to a different neighbour.
+struct MazeTopologySize
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t layers = 1;
+
+    constexpr uint32_t GetCellCount() const { return width * height * layers; }
+};
+
+// Same layout and passage bits as Maze
+struct RectangularTopology
+{
+    enum Directions : uint32_t { NORTH = 0, EAST, SOUTH, WEST };
+    static constexpr uint32_t DIRECTIONS = 4;
+    static constexpr uint32_t MIN_CELLS_ACROSS = 1;
+    static constexpr uint16_t PASSAGES[DIRECTIONS] = { 0x01, 0x02, 0x04, 0x08 };
+    static constexpr uint32_t OPPOSITE[DIRECTIONS] = { SOUTH, WEST, NORTH, EAST };
+
+    template<uint32_t Direction>
+    static constexpr bool Neighbour(const MazeTopologySize& size, uint32_t cell, uint32_t& neighbour)
+    {
+        if constexpr (Direction == NORTH)
+        {
+            neighbour = cell + 1;
+            return neighbour % size.height != 0;
+        }
+        else if constexpr (Direction == EAST)
+        {
+            neighbour = cell + size.height;
+            return neighbour < size.width * size.height;
+        }
+        else if constexpr (Direction == SOUTH)
+        {
+            neighbour = cell - 1;
+            return cell % size.height != 0;
+        }
+        else
+        {
+            neighbour = cell - size.height;
+            return cell >= size.height;
+        }
+    }
+};
+
+// Rectangular with every edge joined to the opposite one
+struct TorusTopology
+{
+    enum Directions : uint32_t { NORTH = 0, EAST, SOUTH, WEST };
+    static constexpr uint32_t DIRECTIONS = 4;
+    static constexpr uint32_t MIN_CELLS_ACROSS = 3;
+    static constexpr uint16_t PASSAGES[DIRECTIONS] = { 0x01, 0x02, 0x04, 0x08 };
+    static constexpr uint32_t OPPOSITE[DIRECTIONS] = { SOUTH, WEST, NORTH, EAST };
+
+    template<uint32_t Direction>
+    static constexpr bool Neighbour(const MazeTopologySize& size, uint32_t cell, uint32_t& neighbour)
+    {
+        const uint32_t area = size.width * size.height;
+        if constexpr (Direction == NORTH)
+            neighbour = (cell + 1) % size.height != 0 ? cell + 1 : cell + 1 - size.height;
+        else if constexpr (Direction == EAST)
+            neighbour = cell + size.height < area ? cell + size.height : cell + size.height - area;
+        else if constexpr (Direction == SOUTH)
+            neighbour = cell % size.height != 0 ? cell - 1 : cell + size.height - 1;
+        else
+            neighbour = cell >= size.height ? cell - size.height : cell + area - size.height;
+        return true;
+    }
+};
+
+// Flat topped hexagons, every odd column is shifted half a cell north
+struct HexTopology
+{
+    enum Directions : uint32_t { NORTH = 0, NORTH_EAST, SOUTH_EAST, SOUTH, SOUTH_WEST, NORTH_WEST };
+    static constexpr uint32_t DIRECTIONS = 6;
+    static constexpr uint32_t MIN_CELLS_ACROSS = 1;
+    static constexpr uint16_t PASSAGES[DIRECTIONS] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20 };
+    static constexpr uint32_t OPPOSITE[DIRECTIONS] = { SOUTH, SOUTH_WEST, NORTH_WEST, NORTH, NORTH_EAST, SOUTH_EAST };
+
+    template<uint32_t Direction>
+    static constexpr bool Neighbour(const MazeTopologySize& size, uint32_t cell, uint32_t& neighbour)
+    {
+        const uint32_t x = cell / size.height;
+        const uint32_t y = cell % size.height;
+        if constexpr (Direction == NORTH)
+        {
+            neighbour = cell + 1;
+            return y + 1 < size.height;
+        }
+        else if constexpr (Direction == SOUTH)
+        {
+            neighbour = cell - 1;
+            return y > 0;
+        }
+        else
+        {
+            constexpr bool east = Direction == NORTH_EAST || Direction == SOUTH_EAST;
+            constexpr bool north = Direction == NORTH_EAST || Direction == NORTH_WEST;
+            if (east ? x + 1 >= size.width : x == 0)
+                return false;
+
+            // Odd columns reach one row further north, even columns one row further south
+            const uint32_t column = east ? cell + size.height : cell - size.height;
+            if (north)
+            {
+                neighbour = column + (x & 1);
+                return (x & 1) == 0 || y + 1 < size.height;
+            }
+            neighbour = column - ((x & 1) ^ 1);
+            return (x & 1) != 0 || y > 0;
+        }
+    }
+};
+
+// Triangles alternate pointing north and south, the one in the south west corner points north. A triangle shares
+// its flat side with the cell south of it if it points north and with the cell north of it otherwise
+struct TriangleTopology
+{
+    enum Directions : uint32_t { BASE = 0, EAST, WEST };
+    static constexpr uint32_t DIRECTIONS = 3;
+    static constexpr uint32_t MIN_CELLS_ACROSS = 1;
+    static constexpr uint16_t PASSAGES[DIRECTIONS] = { 0x01, 0x02, 0x04 };
+    static constexpr uint32_t OPPOSITE[DIRECTIONS] = { BASE, WEST, EAST };
+
+    static constexpr bool PointsNorth(const MazeTopologySize& size, uint32_t cell)
+    {
+        return ((cell / size.height + cell % size.height) & 1) == 0;
+    }
+
+    template<uint32_t Direction>
+    static constexpr bool Neighbour(const MazeTopologySize& size, uint32_t cell, uint32_t& neighbour)
+    {
+        if constexpr (Direction == BASE)
+        {
+            if (PointsNorth(size, cell))
+            {
+                neighbour = cell - 1;
+                return cell % size.height != 0;
+            }
+            neighbour = cell + 1;
+            return neighbour % size.height != 0;
+        }
+        else if constexpr (Direction == EAST)
+        {
+            neighbour = cell + size.height;
+            return neighbour < size.width * size.height;
+        }
+        else
+        {
+            neighbour = cell - size.height;
+            return cell >= size.height;
+        }
+    }
+};
+
+// Stack of rectangular layers with stairs between a cell and the ones right above and below it
+struct LayeredTopology
+{
+    enum Directions : uint32_t { NORTH = 0, EAST, SOUTH, WEST, UP, DOWN };
+    static constexpr uint32_t DIRECTIONS = 6;
+    static constexpr uint32_t MIN_CELLS_ACROSS = 1;
+    static constexpr uint16_t PASSAGES[DIRECTIONS] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20 };
+    static constexpr uint32_t OPPOSITE[DIRECTIONS] = { SOUTH, WEST, NORTH, EAST, DOWN, UP };
+
+    template<uint32_t Direction>
+    static constexpr bool Neighbour(const MazeTopologySize& size, uint32_t cell, uint32_t& neighbour)
+    {
+        const uint32_t area = size.width * size.height;
+        if constexpr (Direction == UP)
+        {
+            neighbour = cell + area;
+            return neighbour < size.GetCellCount();
+        }
+        else if constexpr (Direction == DOWN)
+        {
+            neighbour = cell - area;
+            return cell >= area;
+        }
+        else
+        {
+            // Layers are rectangular mazes of their own
+            const uint32_t layerStart = cell - cell % area;
+            const bool inside = RectangularTopology::Neighbour<Direction>(size, cell - layerStart, neighbour);
+            neighbour += layerStart;
+            return inside;
+        }
+    }
+};
+
+// Calls function with std::integral_constant<uint32_t, direction> for every direction of Topology in order,
+// unrolled so function can use the direction as a template argument
+template<typename Topology, typename Function, uint32_t... Directions>
+constexpr void ForEachDirection(Function&& function, std::integer_sequence<uint32_t, Directions...>)
+{
+    (function(std::integral_constant<uint32_t, Directions>()), ...);
+}
+
+template<typename Topology, typename Function>
+constexpr void ForEachDirection(Function&& function)
+{
+    ForEachDirection<Topology>(function, std::make_integer_sequence<uint32_t, Topology::DIRECTIONS>());
+}
+
+// Builder kernels, written once for every topology. MazeBuilder steps them on Maze with RectangularTopology, whose
+// visited flag sits right above the passage bits like it does here, and TopologyMaze runs them on the others.
+// They carve into the cell info and take every random choice from the generator, the state is kept by the caller,
+// which also reserves its buffers. Walls are numbered cell * DIRECTIONS + direction.
+// A step needs something left in the stack, walls or frontier it is given, or for Wilson a cell left. It puts the
+// cells it worked on into path for drawing, Wilson keeps its random walk there.
+// The Run functions are the batch loops of the steps, compiled with them so nothing is called per step. They take up
+// to maxSteps steps, the same ones in the same order as stepping until the stack, walls, frontier or cells left are
+// used up, and only put the cells of the last step into path. They return the steps they took
+template<typename Topology>
+class MazeCarver
+{
+public:
+    static constexpr uint16_t CELL_VISITED = 1 << Topology::DIRECTIONS;
+
+    MazeCarver() = delete;
+    MazeCarver(const MazeTopologySize& size, uint16_t* cellInfo, std::mt19937& generator)
+        : m_Size(size), m_CellInfo(cellInfo), m_Generator(generator) {}
+
+    void StartBacktrack(uint32_t start, std::stack<uint32_t>& stack);
+    // True when it carved into a new cell, false when it went back
+    bool StepBacktrack(std::stack<uint32_t>& stack, std::vector<uint32_t>& path);
+    // Also stops once cellsLeft cells were carved into, it counts them down
+    uint64_t RunBacktrack(std::stack<uint32_t>& stack, std::vector<uint32_t>& path, uint64_t maxSteps, uint32_t& cellsLeft);
+
+    // Every wall once, shuffled
+    void StartKruskal(std::vector<uint32_t>& walls);
+    void StepKruskal(std::vector<uint32_t>& walls, DisjointSet& cells, std::vector<uint32_t>& path);
+    uint64_t RunKruskal(std::vector<uint32_t>& walls, DisjointSet& cells, std::vector<uint32_t>& path, uint64_t maxSteps);
+
+    // Frontier holds the walls out of the maze in no particular order
+    void StartPrims(uint32_t start, std::vector<uint32_t>& frontier);
+    void StepPrims(std::vector<uint32_t>& frontier, std::vector<uint32_t>& path);
+    uint64_t RunPrims(std::vector<uint32_t>& frontier, std::vector<uint32_t>& path, uint64_t maxSteps);
+
+    // elementsLeft holds the cells not in the maze yet, elementIndex and walkIndex have an entry for every cell.
+    // IndexWilson fills them from elementsLeft and the walk, StartWilson puts the first cell into the maze
+    static void IndexWilson(const std::vector<uint32_t>& elementsLeft, const std::vector<uint32_t>& walk, std::vector<uint32_t>& elementIndex,
+        std::vector<uint32_t>& walkIndex);
+    void StartWilson(std::vector<uint32_t>& elementsLeft, std::vector<uint32_t>& elementIndex, uint32_t& walkStart);
+    void StepWilson(std::vector<uint32_t>& elementsLeft, std::vector<uint32_t>& elementIndex, std::vector<uint32_t>& walk,
+        std::vector<uint32_t>& walkIndex, uint32_t& walkStart);
+    uint64_t RunWilson(std::vector<uint32_t>& elementsLeft, std::vector<uint32_t>& elementIndex, std::vector<uint32_t>& walk,
+        std::vector<uint32_t>& walkIndex, uint32_t& walkStart, uint64_t maxSteps);
+
+private:
+    // Opens the passage and marks both cells visited
+    void Carve(uint32_t cell, uint32_t direction, uint32_t neighbour);
+    // Walls from cell to its neighbours which are not visited yet
+    void AddFrontier(uint32_t cell, std::vector<uint32_t>& frontier);
+    // What the steps do apart from filling in path, shared with the Run loops
+    bool ExtendBacktrack(std::stack<uint32_t>& stack);
+    void JoinKruskal(uint32_t wall, DisjointSet& cells);
+    uint32_t TakeFrontier(std::vector<uint32_t>& frontier);
+    void ExtendPrims(uint32_t wall, std::vector<uint32_t>& frontier);
+    // The two cells of a wall
+    void SetWallPath(uint32_t wall, std::vector<uint32_t>& path) const;
+    static void RemoveElementLeft(uint32_t cell, std::vector<uint32_t>& elementsLeft, std::vector<uint32_t>& elementIndex);
+
+    MazeTopologySize m_Size;
+    uint16_t* m_CellInfo = nullptr;
+    std::mt19937& m_Generator;
+};
+
+// Maze on any of the topologies above except the rectangular one, which is Maze with MazeBuilder and MazeSolver
+// stepping on it. Sizes below MIN_CELLS_ACROSS of the topology are raised to it.
+// Cell info holds the open passages in the low bits and the visited and searched flags right above them.
+// The builders run the MazeCarver kernels to completion and pick their first cell like MazeBuilder, the same seed
+// always builds the same maze. BFS is the only solver, for checking them, there is no DFS, Dijkstra or A star on
+// these topologies and nothing draws, saves or steps these mazes. MazeValidate checks them against MazeValidator
+template<typename Topology>
+class TopologyMaze
+{
+public:
+    static constexpr uint16_t CELL_VISITED = MazeCarver<Topology>::CELL_VISITED;
+    static constexpr uint16_t CELL_SEARCHED = 2 << Topology::DIRECTIONS;
+
+    TopologyMaze() = delete;
+    explicit TopologyMaze(const MazeTopologySize& size);
+
+    void BuildBacktrack(uint32_t seed);
+    void BuildKruskal(uint32_t seed);
+    void BuildPrims(uint32_t seed);
+    void BuildWilson(uint32_t seed);
+
+    // Breadth first, path runs from start to goal both included. False if goal can not be reached
+    bool Solve(uint32_t start, uint32_t goal, std::vector<uint32_t>& path);
+
+    bool IsOpen(uint32_t cell, uint32_t direction) const { return (m_CellInfo[cell] & Topology::PASSAGES[direction]) != 0; }
+    // A perfect maze has one passage less than cells
+    uint64_t GetPassageCount() const;
+
+public:
+    MazeTopologySize m_Size;
+    uint32_t m_CellCount = 0;
+    std::vector<uint16_t> m_CellInfo;
+
+private:
+    // Clears the cells and draws the first cell the way MazeBuilder does, before anything else
+    uint32_t Reset(std::mt19937& generator);
+};
+
+extern template class MazeCarver<RectangularTopology>;
+extern template class MazeCarver<TorusTopology>;
+extern template class MazeCarver<HexTopology>;
+extern template class MazeCarver<TriangleTopology>;
+extern template class MazeCarver<LayeredTopology>;
+
+extern template class TopologyMaze<TorusTopology>;
+extern template class TopologyMaze<HexTopology>;
+extern template class TopologyMaze<TriangleTopology>;
+extern template class TopologyMaze<LayeredTopology>;
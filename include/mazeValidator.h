@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+class Maze;
+class PackedPath;
+struct MazeTopologySize;
+
+struct MazeValidation
+{
+    // Passage bits whose neighbour does not have the opposite bit set, each pair counted once
+    uint64_t mismatchedWalls = 0;
+    // Passage bits leading out of the grid
+    uint64_t outerPassages = 0;
+    // Cells without CELL_VISITED
+    uint64_t unvisitedCells = 0;
+    // Open walls between two cells, counted once
+    uint64_t passages = 0;
+    // Passages between cells which were already connected, every one of them closes a loop
+    uint64_t loops = 0;
+    uint64_t components = 0;
+    // First thing found which a perfect maze would not have, empty if there is none
+    std::string error;
+
+    // Wall flags agree with each other and every cell was visited
+    bool IsConsistent() const { return mismatchedWalls == 0 && outerPassages == 0 && unvisitedCells == 0; }
+    // One passage less than cells and all of them connected, so there is exactly one path between any two cells
+    bool IsPerfect() const { return IsConsistent() && loops == 0 && components == 1; }
+};
+
+struct MazePathValidation
+{
+    // Starts and ends on the route and every step goes through an open passage to a neighbour
+    bool connected = false;
+    // Cost equals the reference cost
+    bool optimal = false;
+    uint64_t cost = 0;
+    uint64_t referenceCost = 0;
+    // First problem found, empty if there is none
+    std::string error;
+};
+
+// Invariants of finished mazes and solver paths, checked in time linear in the number of cells so they can run
+// after every build on large grids. The reference solver here shares no code with MazeSolver or MazeGraph.
+class MazeValidator
+{
+public:
+    MazeValidator() = delete;
+
+    enum Costs : uint8_t
+    {
+        // Number of steps, what BFS minimizes
+        STEPS = 0,
+        // Sum of the weights of the cells after the start, what Dijkstra minimizes
+        WEIGHTS
+    };
+
+    // cellInfo is laid out like Maze::m_VisitedCellInfo. One pass over the cells, every north and east passage
+    // goes through a union find
+    static MazeValidation CheckWalls(const std::vector<uint16_t>& cellInfo, uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight);
+    static MazeValidation CheckMaze(const Maze& maze);
+
+    // Cheapest cost from start to goal through the open passages, UINT64_MAX when the goal can not be reached.
+    // Breadth first for STEPS, Dijkstra with a binary heap for WEIGHTS
+    static uint64_t GetReferenceCost(const Maze& maze, std::pair<uint32_t, uint32_t> route, Costs costs);
+    static uint64_t GetPathCost(const Maze& maze, const PackedPath& path, Costs costs);
+    static MazePathValidation CheckPath(const Maze& maze, std::pair<uint32_t, uint32_t> route, const PackedPath& path, Costs costs);
+
+    // The same for TopologyMaze cell info, neighbours and passage bits come from Topology. Instantiated for the
+    // topologies TopologyMaze is, steps are the only cost
+    template<typename Topology>
+    static MazeValidation CheckTopologyWalls(const std::vector<uint16_t>& cellInfo, const MazeTopologySize& size);
+    template<typename Topology>
+    static uint64_t GetTopologyReferenceSteps(const std::vector<uint16_t>& cellInfo, const MazeTopologySize& size, std::pair<uint32_t, uint32_t> route);
+    template<typename Topology>
+    static MazePathValidation CheckTopologyPath(const std::vector<uint16_t>& cellInfo, const MazeTopologySize& size, std::pair<uint32_t, uint32_t> route,
+        const std::vector<uint32_t>& path);
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+class NarrowVector;
+
+struct MazeWeightSettings
+{
+    enum Generators
+    {
+        UNIFORM = 0,
+        // Fractal gradient noise, smooth hills and valleys
+        TERRAIN,
+        // Grows with the distance from a centre point
+        RADIAL,
+        // Grows along a direction
+        LINEAR,
+        // Cheap ground with expensive round patches
+        SWAMP
+    };
+
+    uint8_t generator = UNIFORM;
+    uint32_t seed = 0;
+    // Weights are in [0, maxWeight)
+    uint32_t maxWeight = 30;
+
+    // Terrain, size of the largest features in cells and number of halving octaves on top
+    float featureSize = 64.0f;
+    uint32_t octaves = 4;
+    // Radial, centre as a fraction of the maze size
+    float centerX = 0.5f, centerY = 0.5f;
+    // Linear, degrees counter clockwise from increasing x
+    float angle = 0.0f;
+    // Swamp, radius is in cells
+    uint32_t patchCount = 32;
+    float patchRadius = 24.0f;
+    // Reversing makes the far end cheap instead of expensive
+    bool invert = false;
+};
+
+// Fills the per cell weights of a maze with procedural fields or a weight map from disk.
+// Weights are stored as narrow as maxWeight allows.
+// Columns are split between the hardware threads and every cell only depends on the seed and its position,
+// so the result is the same for any number of threads. The inner loops run down a column without branches.
+class MazeWeights
+{
+public:
+    MazeWeights() = delete;
+
+    static const char* GetGeneratorName(uint8_t generator);
+    static void Generate(NarrowVector& weights, uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight, const MazeWeightSettings& settings);
+
+    // .pgm or .ppm images are scaled to the maze, any other file has to be a raw uint32_t per cell in cell order,
+    // the same as the weight plane of a maze file. Images map black to 0 and white to maxWeight - 1
+    static bool Load(const std::string& filePath, NarrowVector& weights, uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight, uint32_t maxWeight);
+    // .pgm writes a greyscale image with one pixel per cell, 16 bit when the weights need it, anything else raw uint32_t
+    static bool Write(const std::string& filePath, const NarrowVector& weights, uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight);
+    // uint32_t per cell whatever the width in memory, the layout of raw files and the weight plane of maze files
+    static void WriteRaw(std::ostream& stream, const NarrowVector& weights);
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include <stdint.h>
+
+// Array of unsigned values stored in the narrowest of uint8_t, uint16_t and uint32_t that holds the largest value
+// it was sized for. Only one of the vectors is ever in use. Hot loops should not go through Get/Set but Visit the
+// typed vector once and run a template instantiated for that element type.
+class NarrowVector
+{
+public:
+    enum Widths
+    {
+        WIDTH_8 = 1,
+        WIDTH_16 = 2,
+        WIDTH_32 = 4
+    };
+
+    NarrowVector() = default;
+
+    // Calls function with the std::vector of the current width
+    template<typename Function>
+    decltype(auto) Visit(Function&& function)
+    {
+        if (m_Width == WIDTH_8)
+            return function(m_Values8);
+        if (m_Width == WIDTH_16)
+            return function(m_Values16);
+        return function(m_Values32);
+    }
+
+    template<typename Function>
+    decltype(auto) Visit(Function&& function) const
+    {
+        if (m_Width == WIDTH_8)
+            return function(m_Values8);
+        if (m_Width == WIDTH_16)
+            return function(m_Values16);
+        return function(m_Values32);
+    }
+
+    static uint8_t GetWidthFor(uint32_t maxValue)
+    {
+        if (maxValue <= std::numeric_limits<uint8_t>::max())
+            return WIDTH_8;
+        if (maxValue <= std::numeric_limits<uint16_t>::max())
+            return WIDTH_16;
+        return WIDTH_32;
+    }
+
+    // Every value has to stay at or below maxValue, the width only changes here
+    void Assign(size_t size, uint32_t maxValue, uint32_t value = 0)
+    {
+        SetWidth(GetWidthFor(maxValue));
+        Visit([&](auto& values) { values.assign(size, static_cast<typename std::decay_t<decltype(values)>::value_type>(value)); });
+    }
+
+    // Width comes from the largest of the values
+    void Assign(const uint32_t* values, size_t size)
+    {
+        uint32_t maxValue = size ? *std::max_element(values, values + size) : 0;
+        SetWidth(GetWidthFor(maxValue));
+        Visit([&](auto& narrow) { narrow.assign(values, values + size); });
+    }
+
+    // Empties the vector and switches to width, for filling it through Visit.
+    // The allocation is kept when the width stays the same
+    void SetWidth(uint8_t width)
+    {
+        if (width == m_Width)
+        {
+            Visit([](auto& values) { values.clear(); });
+            return;
+        }
+        Clear();
+        m_Width = width;
+    }
+
+    void Clear()
+    {
+        // Swapped out so switching widths does not keep the old allocation around
+        std::vector<uint8_t>().swap(m_Values8);
+        std::vector<uint16_t>().swap(m_Values16);
+        std::vector<uint32_t>().swap(m_Values32);
+    }
+
+    void Swap(NarrowVector& other)
+    {
+        std::swap(m_Width, other.m_Width);
+        m_Values8.swap(other.m_Values8);
+        m_Values16.swap(other.m_Values16);
+        m_Values32.swap(other.m_Values32);
+    }
+
+    uint8_t GetWidth() const { return m_Width; }
+    // Largest value the current width can hold
+    uint32_t GetMaxValue() const
+    {
+        return m_Width == WIDTH_8 ? std::numeric_limits<uint8_t>::max() : m_Width == WIDTH_16 ? std::numeric_limits<uint16_t>::max() : std::numeric_limits<uint32_t>::max();
+    }
+
+    size_t size() const
+    {
+        return m_Width == WIDTH_8 ? m_Values8.size() : m_Width == WIDTH_16 ? m_Values16.size() : m_Values32.size();
+    }
+
+    bool empty() const { return size() == 0; }
+    size_t GetByteSize() const { return size() * m_Width; }
+    // Allocations of all three vectors, only one of them should ever hold any
+    size_t GetReservedByteSize() const
+    {
+        return m_Values8.capacity() * sizeof(uint8_t) + m_Values16.capacity() * sizeof(uint16_t) + m_Values32.capacity() * sizeof(uint32_t);
+    }
+
+    uint32_t Get(size_t index) const
+    {
+        return m_Width == WIDTH_8 ? m_Values8[index] : m_Width == WIDTH_16 ? m_Values16[index] : m_Values32[index];
+    }
+
+    void Set(size_t index, uint32_t value)
+    {
+        if (m_Width == WIDTH_8)
+            m_Values8[index] = static_cast<uint8_t>(value);
+        else if (m_Width == WIDTH_16)
+            m_Values16[index] = static_cast<uint16_t>(value);
+        else
+            m_Values32[index] = value;
+    }
+
+private:
+    uint8_t m_Width = WIDTH_32;
+    std::vector<uint8_t> m_Values8;
+    std::vector<uint16_t> m_Values16;
+    std::vector<uint32_t> m_Values32;
+};
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+// Path through neighbouring cells stored as its first cell and 2 bits per step, 4 steps to a byte.
+// Steps are 0 north, 1 east, 2 south, 3 west, the same as the parent directions of MazeSolverNode.
+// Cells are produced one at a time by the iterator, nothing ever expands the whole path.
+class PackedPath
+{
+public:
+    enum Steps
+    {
+        STEP_NORTH = 0,
+        STEP_EAST,
+        STEP_SOUTH,
+        STEP_WEST
+    };
+
+    class Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = uint32_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const uint32_t*;
+        using reference = const uint32_t&;
+
+        Iterator() = default;
+        Iterator(const PackedPath* path, size_t index, uint32_t cell) : m_Path(path), m_Index(index), m_Cell(cell) {}
+
+        const uint32_t& operator*() const { return m_Cell; }
+
+        Iterator& operator++()
+        {
+            // The step after the last cell does not exist, the end iterator compares by index only
+            if (++m_Index < m_Path->m_CellCount)
+                m_Cell += m_Path->m_Offsets[m_Path->GetStep(m_Index - 1)];
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const Iterator& other) const { return m_Index == other.m_Index; }
+        bool operator!=(const Iterator& other) const { return m_Index != other.m_Index; }
+
+    private:
+        const PackedPath* m_Path = nullptr;
+        size_t m_Index = 0;
+        uint32_t m_Cell = 0;
+    };
+
+    PackedPath() = default;
+
+    // Path of the single cell start
+    void Reset(uint32_t start, uint32_t cellsAcrossHeight)
+    {
+        m_Steps.clear();
+        m_Offsets[STEP_NORTH] = 1;
+        m_Offsets[STEP_EAST] = cellsAcrossHeight;
+        m_Offsets[STEP_SOUTH] = 0u - 1;
+        m_Offsets[STEP_WEST] = 0u - cellsAcrossHeight;
+        m_Front = m_Back = start;
+        m_CellCount = 1;
+    }
+
+    void Clear()
+    {
+        m_Steps.clear();
+        m_CellCount = 0;
+    }
+
+    // Direction of one step, with one cell across the height north and south come out as east and west
+    static uint8_t GetStepBetween(uint32_t from, uint32_t to, uint32_t cellsAcrossHeight)
+    {
+        const uint32_t offset = to - from;
+        return static_cast<uint8_t>(((offset == cellsAcrossHeight) | (offset == 0u - cellsAcrossHeight)) |
+            ((offset == 0u - 1) | (offset == 0u - cellsAcrossHeight)) << 1);
+    }
+
+    void PushStep(uint8_t step)
+    {
+        const size_t index = m_CellCount - 1;
+        if ((index & 3) == 0)
+            m_Steps.push_back(0);
+        m_Steps[index >> 2] |= static_cast<uint8_t>(step << ((index & 3) * 2));
+        m_Back += m_Offsets[step];
+        m_CellCount++;
+    }
+
+    // cell has to be a neighbour of back()
+    void Append(uint32_t cell)
+    {
+        PushStep(GetStepBetween(m_Back, cell, m_Offsets[STEP_EAST]));
+    }
+
+    // Same cells in the opposite order, for paths that were built by backtracking
+    void Reverse()
+    {
+        if (m_CellCount < 2)
+            return;
+
+        const size_t stepCount = m_CellCount - 1;
+        for (size_t i = 0, j = stepCount - 1; i < j; i++, j--)
+        {
+            uint8_t first = GetStep(i);
+            SetStep(i, GetStep(j) ^ 2);
+            SetStep(j, first ^ 2);
+        }
+        // The middle step of an odd count turns around in place
+        if (stepCount & 1)
+            SetStep(stepCount / 2, GetStep(stepCount / 2) ^ 2);
+        std::swap(m_Front, m_Back);
+    }
+
+    uint8_t GetStep(size_t index) const
+    {
+        return (m_Steps[index >> 2] >> ((index & 3) * 2)) & 3;
+    }
+
+    // Number of cells, one more than the steps
+    size_t size() const { return m_CellCount; }
+    bool empty() const { return m_CellCount == 0; }
+    uint32_t front() const { return m_Front; }
+    uint32_t back() const { return m_Back; }
+
+    Iterator begin() const { return Iterator(this, 0, m_Front); }
+    Iterator end() const { return Iterator(this, m_CellCount, 0); }
+
+    // Memory of the steps, the expanded path would be 4 bytes per cell
+    size_t GetByteSize() const { return m_Steps.size(); }
+    const std::vector<uint8_t>& GetSteps() const { return m_Steps; }
+    uint32_t GetCellsAcrossHeight() const { return m_Offsets[STEP_EAST]; }
+
+    // Restores a path from its parts, steps has to hold at least cellCount - 1 steps
+    void Assign(uint32_t start, uint32_t cellsAcrossHeight, size_t cellCount, const std::vector<uint8_t>& steps)
+    {
+        Reset(start, cellsAcrossHeight);
+        m_CellCount = cellCount;
+        m_Steps = steps;
+        m_Steps.resize((cellCount + 2) / 4);
+        m_Back = start;
+        for (size_t i = 0; i + 1 < cellCount; i++)
+            m_Back += m_Offsets[GetStep(i)];
+    }
+
+    bool operator==(const PackedPath& other) const
+    {
+        return m_CellCount == other.m_CellCount && (m_CellCount == 0 || (m_Front == other.m_Front && m_Steps == other.m_Steps));
+    }
+    bool operator!=(const PackedPath& other) const { return !(*this == other); }
+
+private:
+    void SetStep(size_t index, uint8_t step)
+    {
+        uint8_t& byte = m_Steps[index >> 2];
+        const uint8_t shift = static_cast<uint8_t>((index & 3) * 2);
+        byte = static_cast<uint8_t>((byte & ~(3 << shift)) | (step << shift));
+    }
+
+    std::vector<uint8_t> m_Steps;
+    // Cell offset of every step, filled in by Reset
+    uint32_t m_Offsets[4] = { 1, 1, 0u - 1, 0u - 1 };
+    uint32_t m_Front = 0, m_Back = 0;
+    size_t m_CellCount = 0;
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// Collects per phase timings of the render loop and counters coming from the simulation thread.
+// Timings are only recorded on the render thread, counters can be added from any thread.
+class Profiler
+{
+public:
+    Profiler();
+    Profiler(Profiler&) = delete;
+    Profiler(Profiler&&) = delete;
+
+    enum Phase
+    {
+        GET_BUTTON_STATES = 0,
+        DRAW_MAZE,
+        GET_PATH_IF_FOUND,
+        BUFFER_UPLOAD,
+        DRAW_CALLS,
+        IMGUI_RENDER,
+        PHASE_COUNT
+    };
+
+    enum Counter
+    {
+        BUILDER_STEPS = 0,
+        SOLVER_STEPS,
+        BYTES_UPLOADED,
+        CELLS_TOUCHED,
+        COUNTER_COUNT
+    };
+
+    struct FrameRecord
+    {
+        uint64_t frame = 0;
+        double frameMs = 0.0;
+        // A phase can run several times in a frame, these are the sums
+        double phaseMs[PHASE_COUNT]{};
+        uint64_t counters[COUNTER_COUNT]{};
+    };
+
+    struct TraceEvent
+    {
+        uint64_t frame = 0;
+        Phase phase = PHASE_COUNT;
+        // Microseconds since the profiler was created
+        double startUs = 0.0;
+        double durationUs = 0.0;
+    };
+
+    void BeginFrame();
+    void EndFrame();
+    void AddPhaseTime(Phase phase, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+    // Thread safe, accumulated into the frame that is currently being recorded
+    void AddCounter(Counter counter, uint64_t value);
+
+    bool ExportCSV(const std::string& filePath) const;
+    // Trace Event Format, can be opened in chrome://tracing or https://ui.perfetto.dev
+    bool ExportChromeTrace(const std::string& filePath) const;
+
+    // Oldest to newest, i = 0 is the oldest frame still kept
+    const FrameRecord& GetFrame(uint32_t i) const;
+    uint32_t GetFrameCount() const;
+    // Index to pass as offset to ImPlot so the ring buffer is plotted oldest to newest
+    uint32_t GetHistoryOffset() const;
+    // Rolling history of a single phase, usable directly with ImPlot::PlotLine and GetHistoryOffset
+    const float* GetPhaseHistory(Phase phase) const;
+    const float* GetCounterHistory(Counter counter) const;
+
+    static const char* GetPhaseName(Phase phase);
+    static const char* GetCounterName(Counter counter);
+
+public:
+    static constexpr uint32_t HISTORY_SIZE = 300;
+    static constexpr uint32_t TRACE_EVENTS_SIZE = 4096;
+
+    bool m_Paused = false;
+
+private:
+    double ToMicroseconds(std::chrono::steady_clock::time_point time) const;
+
+    std::chrono::steady_clock::time_point m_Epoch;
+    std::chrono::steady_clock::time_point m_FrameStart;
+    uint64_t m_FrameNumber = 0;
+    FrameRecord m_CurrentFrame;
+    std::atomic<uint64_t> m_PendingCounters[COUNTER_COUNT];
+
+    // Ring buffers, m_HistoryHead is the next slot to be written
+    std::vector<FrameRecord> m_Frames;
+    std::vector<float> m_PhaseHistory[PHASE_COUNT];
+    std::vector<float> m_CounterHistory[COUNTER_COUNT];
+    uint32_t m_HistoryHead = 0;
+    uint32_t m_HistoryCount = 0;
+
+    std::vector<TraceEvent> m_TraceEvents;
+    uint32_t m_TraceHead = 0;
+    uint32_t m_TraceCount = 0;
+};
+
+// Records the time between construction and destruction as one phase of the current frame
+class ScopedTimer
+{
+public:
+    ScopedTimer() = delete;
+    ScopedTimer(ScopedTimer&) = delete;
+    ScopedTimer(ScopedTimer&&) = delete;
+
+    ScopedTimer(Profiler& profiler, Profiler::Phase phase)
+        : m_Profiler(profiler), m_Phase(phase), m_Start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~ScopedTimer()
+    {
+        m_Profiler.AddPhaseTime(m_Phase, m_Start, std::chrono::steady_clock::now());
+    }
+
+private:
+    Profiler& m_Profiler;
+    Profiler::Phase m_Phase;
+    std::chrono::steady_clock::time_point m_Start;
+};
\ No newline at end of file
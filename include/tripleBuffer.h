@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+// Lock-free handoff of the latest value from exactly one writer thread to exactly one reader thread.
+// The writer always owns one slot, the reader owns another and the third one is exchanged between them.
+// Neither side ever waits, the reader simply keeps the last value until a newer one is published.
+template<typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+    TripleBuffer(TripleBuffer&) = delete;
+    TripleBuffer(TripleBuffer&&) = delete;
+
+    // Writer thread: fill this slot then call Publish()
+    T& GetWriteBuffer()
+    {
+        return m_Buffers[m_WriteIndex];
+    }
+
+    // Writer thread: hand the filled slot over and take back whichever slot was shared
+    void Publish()
+    {
+        uint8_t previous = m_Shared.exchange(m_WriteIndex | FRESH_BIT, std::memory_order_acq_rel);
+        m_WriteIndex = previous & INDEX_MASK;
+    }
+
+    // Reader thread: returns the newest published value, stays valid until the next Read()
+    const T& Read()
+    {
+        if (m_Shared.load(std::memory_order_relaxed) & FRESH_BIT)
+        {
+            uint8_t previous = m_Shared.exchange(m_ReadIndex, std::memory_order_acq_rel);
+            m_ReadIndex = previous & INDEX_MASK;
+        }
+        return m_Buffers[m_ReadIndex];
+    }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x03;
+    static constexpr uint8_t FRESH_BIT = 0x04;
+
+    T m_Buffers[3];
+    uint8_t m_WriteIndex = 0;
+    uint8_t m_ReadIndex = 1;
+    // Index of the exchanged slot, FRESH_BIT is set when the reader has not seen it yet
+    std::atomic<uint8_t> m_Shared{ 2 };
+};
\ No newline at end of file
@@ -0,0 +1,160 @@
+// Example builder and solver kept outside of MazeBuilder and MazeSolver, registered through MazeRegistry like any
+// third party one. Linked into the application and MazeValidate, which checks them with every other algorithm
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "mazeArena.h"
+#include "mazeGraph.h"
+#include "mazeRegistry.h"
+
+namespace
+{
+    // Goes through the cells column by column and opens the north or the east wall of each at random. The top row
+    // can only open east and the right column only north, which leaves long corridors along both
+    class BinaryTreeBuilder : public MazeBuilderPlugin
+    {
+    public:
+        explicit BinaryTreeBuilder(MazeBuilder& builder)
+            : m_MazeArea(builder.m_Maze->m_MazeArea)
+        {
+        }
+
+        void Step(MazeBuilder& builder) override
+        {
+            Maze& maze = *builder.m_Maze;
+            const uint32_t cellsAcrossHeight = maze.m_CellsAcrossHeight;
+            const uint32_t cell = m_Cell++;
+            const bool canGoNorth = cell % cellsAcrossHeight + 1 < cellsAcrossHeight;
+            const bool canGoEast = cell + cellsAcrossHeight < maze.m_MazeArea;
+
+            std::vector<uint16_t>& cellInfo = maze.m_VisitedCellInfo;
+            if (canGoNorth && (!canGoEast || builder.m_Generator() & 1))
+            {
+                cellInfo[cell] |= Maze::CELL_NORTH;
+                cellInfo[cell + 1] |= Maze::CELL_SOUTH;
+            }
+            else if (canGoEast)
+            {
+                cellInfo[cell] |= Maze::CELL_EAST;
+                cellInfo[cell + cellsAcrossHeight] |= Maze::CELL_WEST;
+            }
+            cellInfo[cell] |= Maze::CELL_VISITED;
+            maze.m_VisitedCellCount++;
+
+            // Drawn as the head of the builder
+            builder.m_Path.clear();
+            builder.m_Path.push_back(cell);
+        }
+
+        uint32_t GetCurrentCell() const override { return std::min(m_Cell, m_MazeArea - 1); }
+        // Cells not reached yet, nothing else is held
+        uint32_t GetFrontierSize() const override { return m_MazeArea - m_Cell; }
+
+    private:
+        uint32_t m_MazeArea = 0;
+        // Next one to decide
+        uint32_t m_Cell = 0;
+    };
+
+    // Always expands the open cell closest to the goal in rows and columns, ignoring the walls. Usually expands
+    // fewer cells than A*, but the path is only the shortest on perfect mazes
+    class GreedySolver : public MazeSolverPlugin
+    {
+    public:
+        explicit GreedySolver(MazeSolver& solver)
+            : m_Arena(solver.m_Maze->m_Arena), m_CellsAcrossHeight(solver.m_Maze->m_CellsAcrossHeight)
+        {
+            MazeArena::Assign(m_Arena, m_Parent, solver.m_Maze->m_MazeArea, UNREACHED);
+            m_Goal = solver.m_Route->second;
+            m_Parent[solver.m_Route->first] = solver.m_Route->first;
+            Push(solver.m_Route->first);
+        }
+
+        ~GreedySolver() override
+        {
+            MazeArena::Release(m_Arena, m_Parent);
+        }
+
+        void Step(MazeSolver& solver) override
+        {
+            // The goal was moved, what is queued is sorted by the distance to the old one
+            if (solver.m_Route->second != m_Goal)
+            {
+                m_Goal = solver.m_Route->second;
+                for (Open& open : m_Open)
+                    open.distance = GetDistance(open.cell);
+                std::make_heap(m_Open.begin(), m_Open.end(), FartherFirst());
+            }
+
+            std::pop_heap(m_Open.begin(), m_Open.end(), FartherFirst());
+            const uint32_t cell = m_Open.back().cell;
+            m_Open.pop_back();
+            (*solver.m_CellInfo)[cell] |= Maze::CELL_SEARCHED;
+
+            if (cell == m_Goal)
+            {
+                solver.m_Path.Reset(cell, m_CellsAcrossHeight);
+                for (uint32_t current = cell; current != solver.m_Route->first; )
+                {
+                    current = m_Parent[current];
+                    solver.m_Path.Append(current);
+                }
+                solver.m_Path.Reverse();
+                solver.m_Completed = true;
+                return;
+            }
+
+            for (const uint32_t* neighbour = solver.m_Graph->GetNeighboursBegin(cell); neighbour != solver.m_Graph->GetNeighboursEnd(cell); ++neighbour)
+            {
+                if (m_Parent[*neighbour] != UNREACHED)
+                    continue;
+                m_Parent[*neighbour] = cell;
+                Push(*neighbour);
+            }
+        }
+
+        uint32_t GetCurrentCell() const override { return m_Open.empty() ? m_Goal : m_Open.front().cell; }
+        uint32_t GetFrontierSize() const override { return static_cast<uint32_t>(m_Open.size()); }
+
+    private:
+        static constexpr uint32_t UNREACHED = std::numeric_limits<uint32_t>::max();
+
+        struct Open
+        {
+            uint32_t distance;
+            uint32_t cell;
+        };
+
+        // std::push_heap keeps the largest on top, this turns it around
+        struct FartherFirst
+        {
+            bool operator()(const Open& a, const Open& b) const { return a.distance > b.distance; }
+        };
+
+        // Manhattan distance, moves are only ever along a row or a column
+        uint32_t GetDistance(uint32_t cell) const
+        {
+            const uint32_t x = cell / m_CellsAcrossHeight, y = cell % m_CellsAcrossHeight;
+            const uint32_t goalX = m_Goal / m_CellsAcrossHeight, goalY = m_Goal % m_CellsAcrossHeight;
+            return (x > goalX ? x - goalX : goalX - x) + (y > goalY ? y - goalY : goalY - y);
+        }
+
+        void Push(uint32_t cell)
+        {
+            m_Open.push_back({ GetDistance(cell), cell });
+            std::push_heap(m_Open.begin(), m_Open.end(), FartherFirst());
+        }
+
+        MazeArena* m_Arena = nullptr;
+        uint32_t m_CellsAcrossHeight = 0;
+        uint32_t m_Goal = 0;
+        // Cell each one was reached from, the start is its own parent
+        std::vector<uint32_t> m_Parent;
+        std::vector<Open> m_Open;
+    };
+
+    const uint8_t BINARY_TREE = MazeRegistry::RegisterBuilder<BinaryTreeBuilder>("binarytree", "Binary Tree");
+    const uint8_t GREEDY = MazeRegistry::RegisterSolver<GreedySolver>("greedy", "Greedy Best First");
+}
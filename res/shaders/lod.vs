@@ -0,0 +1,15 @@
+std::string lodVertexShader = R"(
+
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout(location = 1) in vec2 aTexCoord;
+out vec2 ourTexCoord;
+// Grid coordinates to screen, xy is the scale and zw the offset
+uniform vec4 view;
+void main()
+{
+	gl_Position = vec4(aPos.xy * view.xy + view.zw, 1.0, 1.0);
+	ourTexCoord = aTexCoord;
+}
+
+)";
\ No newline at end of file
@@ -4,9 +4,11 @@ std::string mazeVertexShader = R"(
 layout (location = 0) in vec2 aPos;
 layout(location = 1) in vec4 aColor;
 out vec4 ourColor;
+// Grid coordinates to screen, xy is the scale and zw the offset
+uniform vec4 view;
 void main()
 {
-	gl_Position = vec4(aPos.xy, 1.0, 1.0);
+	gl_Position = vec4(aPos.xy * view.xy + view.zw, 1.0, 1.0);
 	ourColor = aColor;
 }
 
@@ -11,9 +11,12 @@ out vec2 ourPos;
 out vec2 ourRefPoint;
 out vec2 ourDimension;
 
+// Grid coordinates to screen, xy is the scale and zw the offset
+uniform vec4 view;
+
 void main()
 {
-    gl_Position = vec4(aPos.xy, 1.0, 1.0);
+    gl_Position = vec4(aPos.xy * view.xy + view.zw, 1.0, 1.0);
     ourColor = aColor;
     ourPos = aPos;
     ourRefPoint = aRefPoint;
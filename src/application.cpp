@@ -1,189 +1,374 @@
 #include <iostream>
+#include <chrono>
 
 #include "application.h"
 
 Application::Application(uint16_t * width, uint16_t * height)
     : m_Width(width), m_Height(height)
 {
-    m_Maze = new Maze(*width, *height);
+    m_Maze = new Maze(*width * m_MazeScale, *height * m_MazeScale, 10, 2, false, &m_Arena);
+    GenerateWeights();
     m_Route = std::make_pair<uint32_t, uint32_t>(rand() % (m_Maze->m_MazeArea - 1), rand() % (m_Maze->m_MazeArea - 1));
+    m_CurrentSnapshot = &m_Snapshots.Read();
+
+    m_SimulationThread = std::thread(&Application::SimulationLoop, this);
 }
 
 Application::~Application()
 {
+    m_SimulationRunning = false;
+    if (m_SimulationThread.joinable())
+        m_SimulationThread.join();
+    if (m_CheckpointThread.joinable())
+        m_CheckpointThread.join();
+
     DeleteMaze();
 }
 
 void Application::GetButtonStates()
 {
+    std::lock_guard<std::mutex> lock(m_SimulationMutex);
+
     if (!m_Maze)
         return;
 
-    if (!m_Maze->MazeCompleted())
+    if (!m_Maze->MazeCompleted() && !m_MazeBuilder && IsButtonPressed(BUILDER))
     {
-        // To get the offset
-        uint16_t j = BUILDER_RECURSIVE_BACKTRACK;
-
-        for (uint32_t i = MazeBuilder::Algorithms::RECURSIVE_BACKTRACK; i <= MazeBuilder::Algorithms::WILSON; i++, j*=2)
-        {
-            if (IsButtonPressed(j) && !m_MazeBuilder)
-            {
-                m_BuilderSelected = static_cast<MazeBuilder::Algorithms>(i);
-                m_MazeBuilder = new MazeBuilder(m_Maze, i);
-                break;
-            }
-        }
-
-        switch (m_BuilderSelected)
-        {
-        case MazeBuilder::Algorithms::RECURSIVE_BACKTRACK:
-        {
-            m_MazeBuilder->RecursiveBacktrack();
-            break;
-        }
-        case MazeBuilder::Algorithms::KRUSKAL:
-        {
-            m_MazeBuilder->RandomizedKruskal();
-            break;
-        }
-        case MazeBuilder::Algorithms::PRIMS:
-        {
-            m_MazeBuilder->RandomizedPrims();
-            break;
-        }
-        case MazeBuilder::Algorithms::WILSON:
-        {
-            m_MazeBuilder->Wilson();
-            break;
-        }
-        }
-    }
-    else if (m_MazeBuilder && !m_MazeBuilder->m_Completed)
-    {
-        std::cout << "Maze Generated\n";
-        m_MazeBuilder->m_Completed = true;
-        m_MazeBuilder->OnCompletion();
-
-        m_ButtonStates &= ~SOLVER_BFS;
-        m_ButtonStates &= ~SOLVER_DFS;
+        const uint8_t algorithm = m_BuilderRequested;
+        m_BuilderSelected = static_cast<MazeBuilder::Algorithms>(algorithm);
+        m_MazeBuilder = new MazeBuilder(m_Maze, algorithm);
+        m_BuilderCounters = MazeCounterSample();
+        if (m_RecordSteps)
+            StartRecording(m_BuilderRecorder, "builder.mlog", MAZE_LOG_BUILDER, algorithm);
+        m_SnapshotRequested = true;
     }
 
     if (IsButtonPressed(MAZE))
     {
         DeleteMaze();
-        m_Maze = new Maze(*m_Width, *m_Height);
-
-        m_ButtonStates &= ~BUILDER_RECURSIVE_BACKTRACK;
-        m_ButtonStates &= ~BUILDER_KRUSKAL;
-        m_ButtonStates &= ~BUILDER_PRIMS;
-        m_ButtonStates &= ~BUILDER_WILSON;
-        m_ButtonStates &= ~SOLVER_BFS;
-        m_ButtonStates &= ~SOLVER_DFS;
-        m_ButtonStates &= ~SOLVER_DIJKSTRA;
-        m_ButtonStates &= ~SOLVER_ASTAR;
+        m_Maze = new Maze(*m_Width * m_MazeScale, *m_Height * m_MazeScale, 10, 2, false, &m_Arena);
+        GenerateWeights();
+
+        m_ButtonStates &= ~BUILDER;
+        m_ButtonStates &= ~SOLVER;
+        m_SnapshotRequested = true;
     }
 
-    if (IsButtonPressed(PATH) && m_MazeSolver && m_MazeSolver->m_Completed)
+    // Also stops a solver which is still running
+    if (IsButtonPressed(PATH) && m_MazeSolver)
     {
         delete m_MazeSolver;
+        m_SolverRecorder.Close();
 
         m_MazeSolver = nullptr;
+        m_SolverSelected = MazeSolver::Algorithms::NONE;
+        m_MetricsValid = false;
+        m_SolverCounters = MazeCounterSample();
 
         for (uint32_t i = 0; m_Maze && i < m_Maze->m_VisitedCellInfo.size(); i++)
         {
             m_Maze->m_VisitedCellInfo[i] &= ~Maze::CELL_SEARCHED;
         }
 
-        m_ButtonStates &= ~SOLVER_BFS;
-        m_ButtonStates &= ~SOLVER_DFS;
-        m_ButtonStates &= ~SOLVER_DIJKSTRA;
-        m_ButtonStates &= ~SOLVER_ASTAR;
+        m_ButtonStates &= ~SOLVER;
+        m_SnapshotRequested = true;
     }
 
     // Always want to keep reset buttons pressable after maze completion
     m_ButtonStates &= ~MAZE;
     m_ButtonStates &= ~PATH;
 
-    if (m_MazeBuilder && m_MazeBuilder->m_Completed && 
-        (IsButtonPressed(SOLVER_DFS) || IsButtonPressed(SOLVER_BFS) || IsButtonPressed(SOLVER_DIJKSTRA) || IsButtonPressed(SOLVER_ASTAR)) &&
-        (!m_MazeSolver || !m_MazeSolver->m_Completed))
+    // This ensures that our initial range of route doesnt go out of maze range or they are not equal
+    if (std::max(m_Route.first, m_Route.second) >= m_Maze->m_MazeArea || m_Route.second == m_Route.first)
     {
-        if (IsButtonPressed(SOLVER_DFS))
-            m_SolverSelected = MazeSolver::DFS;
-        if (IsButtonPressed(SOLVER_BFS))
-            m_SolverSelected = MazeSolver::BFS;
-        if (IsButtonPressed(SOLVER_DIJKSTRA))
-            m_SolverSelected = MazeSolver::DIJKSTRA;
-        if (IsButtonPressed(SOLVER_ASTAR))
-            m_SolverSelected = MazeSolver::ASTAR;
-
-        if (!m_MazeSolver)
-        {
-            m_MazeSolver = new MazeSolver(m_Maze, static_cast<uint8_t>(m_SolverSelected), m_Route);
-            std::cout << m_Route.first << ',' << m_Route.second << std::endl;
-        }
+        m_Route.first = (rand() % m_Maze->m_MazeArea - 1);
+        m_Route.second = (rand() % m_Maze->m_MazeArea - 1);
+    }
 
-        switch (m_SolverSelected)
-        {
-        case MazeSolver::DFS:
+    if (m_MazeBuilder && m_MazeBuilder->m_Completed && !m_MazeSolver && IsButtonPressed(SOLVER))
+    {
+        m_SolverSelected = static_cast<MazeSolver::Algorithms>(m_SolverRequested.load());
+        m_MazeSolver = new MazeSolver(m_Maze, m_MazeGraph, static_cast<uint8_t>(m_SolverSelected), m_Route);
+        m_SolverCounters = MazeCounterSample();
+        if (m_RecordSteps)
+            StartRecording(m_SolverRecorder, "solver.mlog", MAZE_LOG_SOLVER, static_cast<uint8_t>(m_SolverSelected));
+        std::cout << m_Route.first << ',' << m_Route.second << std::endl;
+        m_SnapshotRequested = true;
+    }
+}
+
+void Application::SampleMemory()
+{
+    if (!m_MemoryHistory.Sample())
+        return;
+
+    m_MemoryReport.Clear();
+    {
+        std::lock_guard<std::mutex> lock(m_SimulationMutex);
+        if (m_Maze)
+            m_Maze->ReportMemory(m_MemoryReport);
+        if (m_MazeBuilder)
+            m_MazeBuilder->ReportMemory(m_MemoryReport);
+        if (m_MazeSolver)
+            m_MazeSolver->ReportMemory(m_MemoryReport);
+        m_MazeGraph.ReportMemory(m_MemoryReport);
+    }
+
+    // Everything below belongs to the render thread. The snapshot buffer holds three of these, about the same size
+    const MazeSnapshot& snapshot = *m_CurrentSnapshot;
+    m_MemoryReport.Add("Render", "snapshots", (snapshot.cellInfo.size() * sizeof(uint16_t) + snapshot.builderPath.size() * sizeof(uint32_t) +
+        snapshot.solverPath.GetByteSize()) * 3, (snapshot.cellInfo.capacity() * sizeof(uint16_t) + snapshot.builderPath.capacity() * sizeof(uint32_t) +
+        snapshot.solverPath.GetSteps().capacity()) * 3);
+    m_MazeLod.ReportMemory(m_MemoryReport);
+    m_MemoryReport.Add("Arena", "kept buffers", 0, m_Arena.GetKeptBytes());
+}
+
+void Application::RecreateMaze(uint16_t cellWidth, uint16_t wallThickness)
+{
+    std::lock_guard<std::mutex> lock(m_SimulationMutex);
+
+    DeleteMaze();
+    m_Maze = new Maze(*m_Width * m_MazeScale, *m_Height * m_MazeScale, cellWidth, wallThickness, false, &m_Arena);
+    GenerateWeights();
+    m_SnapshotRequested = true;
+}
+
+void Application::SimulationLoop()
+{
+    using Clock = std::chrono::steady_clock;
+    // The renderer does not need more than this many snapshots
+    const Clock::duration minPublishInterval = std::chrono::microseconds(8000);
+    Clock::duration publishInterval = minPublishInterval;
+    Clock::time_point lastPublish = Clock::now();
+    Clock::time_point lastCheckpoint = Clock::now();
+    // Steps taken since the last snapshot
+    bool pendingSteps = false;
+
+    // Counters only count the thread which opens them
+    if (!m_Counters.Open())
+        std::cout << "Hardware counters unavailable: " << m_Counters.GetError() << std::endl;
+
+    while (m_SimulationRunning)
+    {
+        bool stepped = false;
         {
-            if (!m_MazeSolver->m_Stack.empty() && m_MazeSolver->m_Stack.top() == m_Route.second)
+            std::lock_guard<std::mutex> lock(m_SimulationMutex);
+
+            if (!m_SimulationPaused)
             {
-                m_MazeSolver->OnCompletion();
+                // A batch only ever belongs to one of them, a solver can not start while the lock is held
+                MazeCounterSample* counters = nullptr;
+                if (m_MazeBuilder && !m_MazeBuilder->m_Completed)
+                    counters = &m_BuilderCounters;
+                else if (m_MazeSolver && !m_MazeSolver->m_Completed)
+                    counters = &m_SolverCounters;
+
+                const bool counting = counters && m_CountHardwareEvents && m_Counters.IsOpen();
+                const MazeCounterSample start = counting ? m_Counters.Read() : MazeCounterSample();
+                const uint32_t visitedCells = m_Maze ? m_Maze->m_VisitedCellCount : 0;
+                uint64_t steps = 0;
+
+                // Without delay keep stepping until it is time to publish
+                do
+                {
+                    const uint64_t taken = StepSimulation(m_Delay == 0 ? STEPS_PER_CLOCK_CHECK : 1);
+                    stepped = taken > 0;
+                    pendingSteps |= stepped;
+                    steps += taken;
+                } while (stepped && m_Delay == 0 && Clock::now() - lastPublish < publishInterval);
+
+                if (counters)
+                {
+                    MazeCounterSample batch = counting ? MazeCounters::Difference(start, m_Counters.Read()) : MazeCounterSample();
+                    // Builders process the cells they visit, solvers the cell they expand in each step
+                    if (counters == &m_BuilderCounters)
+                        batch.cells = m_Maze->m_VisitedCellCount - visitedCells;
+                    else
+                        batch.cells = steps;
+                    counters->Add(batch);
+                }
             }
-            else
+
+            // Publishing copies the whole maze, so for huge mazes it must not eat the simulation time
+            bool publishDue = Clock::now() - lastPublish >= publishInterval;
+            if (m_SnapshotRequested || (pendingSteps && (publishDue || !stepped)))
             {
-                m_MazeSolver->DepthFirstSearch();
+                m_SnapshotRequested = false;
+                pendingSteps = false;
+
+                Clock::time_point publishStart = Clock::now();
+                PublishSnapshot();
+                lastPublish = Clock::now();
+                publishInterval = std::max(minPublishInterval, 10 * (lastPublish - publishStart));
             }
-            break;
-        }
-        case MazeSolver::BFS:
-        {
-            if (!m_MazeSolver->m_Queue.empty() && m_MazeSolver->m_Queue.front() == m_Route.second)
+
+            // Only runs which are still going are worth a checkpoint
+            bool running = (m_MazeBuilder && !m_MazeBuilder->m_Completed) || (m_MazeSolver && !m_MazeSolver->m_Completed);
+            if (!running || m_CheckpointInterval <= 0)
             {
-                m_MazeSolver->OnCompletion();
+                lastCheckpoint = Clock::now();
             }
-            else
+            else if (Clock::now() - lastCheckpoint >= std::chrono::seconds(m_CheckpointInterval))
             {
-                m_MazeSolver->BreadthFirstSearch();
+                CaptureCheckpoint();
+                lastCheckpoint = Clock::now();
             }
-            break;
         }
-        case MazeSolver::DIJKSTRA:
+
+        if (!stepped)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        else if (m_Delay > 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(m_Delay));
+    }
+}
+
+uint64_t Application::StepSimulation(uint64_t maxSteps)
+{
+    if (!m_Maze)
+        return 0;
+
+    if (m_MazeBuilder && !m_Maze->MazeCompleted())
+    {
+        uint64_t steps = 0;
+        // Step logs need every single step, otherwise the loop compiled for the algorithm does the work
+        if (m_BuilderRecorder.IsOpen())
         {
-            // Waiting for queue to be empty guarentees shortest path
-            //if (m_MazeSolver->m_PQueue.empty())
-            if (!m_MazeSolver->m_PQueue.empty() && m_MazeSolver->m_PQueue.top().id == m_Route.second)
-            {
-                m_MazeSolver->OnCompletion();
-            }
-            else
-            {
-                m_MazeSolver->DijkstraSearch();
-            }
-            break;
+            m_MazeBuilder->Step();
+            steps = 1;
+
+            uint32_t cell = m_MazeBuilder->GetCurrentCell();
+            m_BuilderRecorder.Record(cell, m_Maze->m_VisitedCellInfo[cell], m_MazeBuilder->GetFrontierSize());
         }
-        case MazeSolver::ASTAR:
+        else if (const MazeBuilderEntry* entry = MazeRegistry::FindBuilder(m_MazeBuilder->m_SelectedAlgorithm))
         {
-            // Waiting for queue to be empty guarentees shortest path
-            //if (m_MazeSolver->m_PQueue.empty())
-            if (!m_MazeSolver->m_PQueue.empty() && m_MazeSolver->m_PQueue.top().id == m_Route.second)
-            {
-                m_MazeSolver->OnCompletion();
-            }
-            else
-            {
-                m_MazeSolver->AstarSearch();
-            }
-            break;
-        }
+            steps = entry->advance(*m_MazeBuilder, maxSteps);
         }
+        m_Profiler.AddCounter(Profiler::BUILDER_STEPS, steps);
+        return steps;
+    }
+    else if (m_MazeBuilder && !m_MazeBuilder->m_Completed)
+    {
+        std::cout << "Maze Generated\n";
+        m_MazeBuilder->m_Completed = true;
+        m_MazeBuilder->OnCompletion();
+        m_MazeGraph.Build(*m_Maze);
+        m_BuilderRecorder.Close();
+        return 1;
+    }
+
+    if (!m_MazeSolver || m_MazeSolver->m_Completed)
+        return 0;
+
+    uint64_t steps = 0;
+    if (m_SolverRecorder.IsOpen())
+    {
+        // Solver steps pop the cell they expand so it has to be taken before
+        uint32_t solverCell = m_MazeSolver->GetCurrentCell();
+
+        m_MazeSolver->Step();
+        steps = 1;
+
+        if (m_MazeSolver->m_Completed)
+            m_SolverRecorder.Close();
+        else
+            m_SolverRecorder.Record(solverCell, m_Maze->m_VisitedCellInfo[solverCell], m_MazeSolver->GetFrontierSize());
     }
+    else if (const MazeSolverEntry* entry = MazeRegistry::FindSolver(m_MazeSolver->m_SelectedAlgorithm))
+    {
+        steps = entry->advance(*m_MazeSolver, maxSteps);
+    }
+    m_Profiler.AddCounter(Profiler::SOLVER_STEPS, steps);
+    return steps;
+}
+
+void Application::StartRecording(MazeRecorder& recorder, const std::string& filePath, MazeLogKind kind, uint8_t algorithm)
+{
+    MazeLogHeader header;
+    header.kind = kind;
+    header.algorithm = algorithm;
+    header.cellsAcrossWidth = m_Maze->m_CellsAcrossWidth;
+    header.cellsAcrossHeight = m_Maze->m_CellsAcrossHeight;
+    header.seed = m_Maze->m_Seed;
+    header.routeStart = m_Route.first;
+    header.routeEnd = m_Route.second;
+    recorder.Open(filePath, header);
+}
+
+void Application::PublishSnapshot()
+{
+    // Assigning into the old slot reuses its memory, so this is a plain copy once warmed up
+    MazeSnapshot& snapshot = m_Snapshots.GetWriteBuffer();
+
+    if (m_Maze)
+    {
+        snapshot.cellInfo = m_Maze->m_VisitedCellInfo;
+        snapshot.mazeArea = m_Maze->m_MazeArea;
+    }
+    else
+    {
+        snapshot.cellInfo.clear();
+        snapshot.mazeArea = 0;
+    }
+
+    snapshot.builderStarted = m_MazeBuilder != nullptr;
+    snapshot.builderCompleted = m_MazeBuilder && m_MazeBuilder->m_Completed;
+    if (m_MazeBuilder)
+        snapshot.builderPath = m_MazeBuilder->m_Path;
+    else
+        snapshot.builderPath.clear();
+
+    snapshot.solverStarted = m_MazeSolver != nullptr;
+    snapshot.solverCompleted = m_MazeSolver && m_MazeSolver->m_Completed;
+    if (snapshot.solverCompleted)
+        snapshot.solverPath = m_MazeSolver->m_Path;
+    else
+        snapshot.solverPath.Clear();
+
+    snapshot.builderCounters = m_BuilderCounters;
+    snapshot.solverCounters = m_SolverCounters;
+
+    snapshot.sequence = ++m_SnapshotSequence;
+    m_Snapshots.Publish();
+}
+
+const MazeSnapshot& Application::ConsumeSnapshot()
+{
+    if (m_RaceView >= 0 && static_cast<size_t>(m_RaceView) < m_Race.GetRacerCount())
+        m_CurrentSnapshot = &m_Race.ConsumeSnapshot(m_RaceView);
+    else
+        m_CurrentSnapshot = &m_Snapshots.Read();
+    return *m_CurrentSnapshot;
+}
+
+bool Application::IsBuilderCompleted() const
+{
+    return m_CurrentSnapshot->builderCompleted;
+}
+
+bool Application::IsSolverCompleted() const
+{
+    return m_CurrentSnapshot->solverCompleted;
+}
+
+void Application::UpdateLevelOfDetail()
+{
+    const MazeSnapshot& snapshot = *m_CurrentSnapshot;
+    if (snapshot.sequence == m_MazeLod.m_BuiltSequence || snapshot.mazeArea != m_Maze->m_MazeArea)
+        return;
+
+    // Rebuilding is linear in the maze size, keep it to a fraction of the frames on huge mazes
+    std::chrono::duration<double> sinceLastBuild = std::chrono::steady_clock::now() - m_MazeLod.m_LastBuild;
+    bool finished = snapshot.builderCompleted && (!snapshot.solverStarted || snapshot.solverCompleted);
+    if (m_MazeLod.GetLevelCount() > 0 && !finished && sinceLastBuild.count() < 10.0 * m_MazeLod.m_BuildSeconds)
+        return;
+
+    m_MazeLod.Build(snapshot.cellInfo, snapshot.solverPath, m_Maze->m_CellsAcrossWidth, m_Maze->m_CellsAcrossHeight);
+    m_MazeLod.m_BuiltSequence = snapshot.sequence;
 }
 
 uint32_t Application::GetPathIfFound()
 {
-    if (!m_MazeSolver || !m_MazeSolver->m_Completed)
+    if (!m_CurrentSnapshot->solverCompleted || m_CurrentSnapshot->mazeArea != m_Maze->m_MazeArea)
         return 0;
 
     struct Rect
@@ -205,29 +390,19 @@ uint32_t Application::GetPathIfFound()
             m_Maze->m_LineVertices.push_back({std::abs(line.x2 - line.x1), std::abs(line.y1 - line.y3)});
         };
 
-    std::vector<uint32_t> path = m_MazeSolver->m_Path;
-    // This is first element to indicate start of line
-    path.push_back(m_Maze->m_MazeArea);
-
-    float aspectRatioX = static_cast<float>(*m_Height) / *m_Width;
-    float aspectRatioY = static_cast<float>(*m_Width) / *m_Height;
-
-    if (aspectRatioX > 1)
-        aspectRatioX = 1;
-    if (aspectRatioY > 1)
-        aspectRatioY = 1;
+    uint32_t xBegin = 0, xEnd = 0, yBegin = 0, yEnd = 0;
+    m_Maze->GetVisibleCells(xBegin, xEnd, yBegin, yEnd);
 
-    // We are multiplying by 2 because the coordinate go from -1 to 1 instead of 0 to 1
-    // Easier to think as dividing by 2 in denominator
-    float normalizedHalfCellWidth = static_cast<float>(2 * m_Maze->m_HalfCellHeight) / (m_Maze->m_MazeWidth);
-    float normalizedHalfCellHeight = static_cast<float>(2 * m_Maze->m_HalfCellHeight) / (m_Maze->m_MazeHeight);
-    float normalizedWallThickness = static_cast<float>(2 * m_Maze->m_WallThickness) / (m_Maze->m_MazeHeight);
-
-    float normalizedTotalCellWidth = static_cast<float>(2 * m_Maze->m_TotalCellHeight) / (m_Maze->m_MazeWidth);
-    float normalizedTotalCellHeight = static_cast<float>(2 * m_Maze->m_TotalCellHeight) / (m_Maze->m_MazeHeight);
+    auto isCellVisible = [&](uint32_t cell)
+        {
+            uint32_t x = cell / m_Maze->m_CellsAcrossHeight;
+            uint32_t y = cell % m_Maze->m_CellsAcrossHeight;
+            return x >= xBegin && x < xEnd && y >= yBegin && y < yEnd;
+        };
 
-    float normalizedHalfLineThickness = static_cast<float>(m_Maze->m_LineThickness) / (m_Maze->m_MazeHeight);
-    float normalizedLineThickness = 2 * normalizedHalfLineThickness;
+    // Grid coordinates have the same unit on both axes so the line needs no aspect correction
+    float gridHalfLineThickness = static_cast<float>(m_Maze->m_LineThickness) / (2 * m_Maze->m_TotalCellHeight);
+    float gridLineThickness = 2 * gridHalfLineThickness;
 
     enum Directions
     {
@@ -240,34 +415,22 @@ uint32_t Application::GetPathIfFound()
 
     Directions direction = NONE;
 
-    while (!path.empty())
+    // Cells come out of the packed path in order, every segment goes from the later cell back to the earlier one.
+    // The area is past the last cell so it marks the missing neighbours at both ends of the path
+    const PackedPath& path = m_CurrentSnapshot->solverPath;
+    PackedPath::Iterator cell = path.begin();
+    const PackedPath::Iterator pathEnd = path.end();
+    uint32_t thirdCell = m_Maze->m_MazeArea;
+    uint32_t secondCell = m_Maze->m_MazeArea;
+    if (cell != pathEnd)
+        secondCell = *cell++;
+
+    for (; cell != pathEnd; thirdCell = secondCell, secondCell = *cell, ++cell)
     {
-        // This is the previous cell from the current drawing one
-        uint32_t zeroCell = path.back();
-        path.pop_back();
-
-        if (path.empty())
-            break;
-        uint32_t firstCell = path.back();
-        path.pop_back();
-
-        if (path.empty())
-            break;
-        uint32_t secondCell = path.back();
-        path.pop_back();
-
-        // Initialized to be max value
-        uint32_t thirdCell = m_Maze->m_MazeArea;
-        if (!path.empty())
-        {
-            thirdCell = path.back();
-            path.pop_back();
-        }
-
-        if (thirdCell != m_Maze->m_MazeArea)
-            path.push_back(thirdCell);
-        path.push_back(secondCell);
-        path.push_back(firstCell);
+        uint32_t firstCell = *cell;
+        // This is the next cell from the current drawing one
+        PackedPath::Iterator after = cell;
+        uint32_t zeroCell = ++after != pathEnd ? *after : m_Maze->m_MazeArea;
 
         // Go from cell1 to cell2
         auto getDirectionToDraw = [&](uint32_t cell1, uint32_t cell2)
@@ -295,68 +458,72 @@ uint32_t Application::GetPathIfFound()
         Directions mainDir = getDirectionToDraw(firstCell, secondCell);
         Directions nextDir = getDirectionToDraw(secondCell, thirdCell);
 
-        std::pair<float, float> firstPoint = m_Maze->m_CellOrigin[firstCell];
-        std::pair<float, float> secondPoint = m_Maze->m_CellOrigin[secondCell];
+        // Segments outside of the view are not drawn
+        if (mainDir == NONE || (!isCellVisible(firstCell) && !isCellVisible(secondCell)))
+            continue;
+
+        std::pair<float, float> firstPoint = m_Maze->GetCellOrigin(firstCell);
+        std::pair<float, float> secondPoint = m_Maze->GetCellOrigin(secondCell);
 
         if (mainDir == NORTH)
         {
             // bottom left
-            line.x1 = secondPoint.first - (normalizedHalfLineThickness) * aspectRatioX;
-            line.y1 = secondPoint.second + (normalizedHalfLineThickness - (nextDir == EAST ? normalizedLineThickness : 0.0f)) * aspectRatioY;
+            line.x1 = secondPoint.first - gridHalfLineThickness;
+            line.y1 = secondPoint.second + (gridHalfLineThickness - (nextDir == EAST ? gridLineThickness : 0.0f));
             // bottom right
-            line.x2 = secondPoint.first + (normalizedHalfLineThickness) * aspectRatioX;
-            line.y2 = secondPoint.second + (normalizedHalfLineThickness - (nextDir == WEST ? normalizedLineThickness : 0.0f)) * aspectRatioY;
+            line.x2 = secondPoint.first + gridHalfLineThickness;
+            line.y2 = secondPoint.second + (gridHalfLineThickness - (nextDir == WEST ? gridLineThickness : 0.0f));
             // top left
-            line.x3 = firstPoint.first - (normalizedHalfLineThickness) * aspectRatioX;
-            line.y3 = firstPoint.second + (normalizedHalfLineThickness - (previousDir == EAST ? normalizedLineThickness : 0.0f)) * aspectRatioY;
+            line.x3 = firstPoint.first - gridHalfLineThickness;
+            line.y3 = firstPoint.second + (gridHalfLineThickness - (previousDir == EAST ? gridLineThickness : 0.0f));
             // top right
-            line.x4 = firstPoint.first + (normalizedHalfLineThickness) * aspectRatioX;
-            line.y4 = firstPoint.second + (normalizedHalfLineThickness - (previousDir == WEST ? normalizedLineThickness : 0.0f)) * aspectRatioY;
+            line.x4 = firstPoint.first + gridHalfLineThickness;
+            line.y4 = firstPoint.second + (gridHalfLineThickness - (previousDir == WEST ? gridLineThickness : 0.0f));
         }
         else if (mainDir == SOUTH)
         {
             // top left
-            line.x1 = firstPoint.first - (normalizedHalfLineThickness)*aspectRatioX;
-            line.y1 = firstPoint.second + (normalizedHalfLineThickness - (previousDir == WEST ? normalizedLineThickness : 0.0f)) * aspectRatioY;
+            line.x1 = firstPoint.first - gridHalfLineThickness;
+            line.y1 = firstPoint.second + (gridHalfLineThickness - (previousDir == WEST ? gridLineThickness : 0.0f));
             // top right
-            line.x2 = firstPoint.first + (normalizedHalfLineThickness)*aspectRatioX;
-            line.y2 = firstPoint.second + (normalizedHalfLineThickness - (previousDir == EAST ? normalizedLineThickness : 0.0f)) * aspectRatioY;
+            line.x2 = firstPoint.first + gridHalfLineThickness;
+            line.y2 = firstPoint.second + (gridHalfLineThickness - (previousDir == EAST ? gridLineThickness : 0.0f));
             // bottom left
-            line.x3 = secondPoint.first - (normalizedHalfLineThickness)*aspectRatioX;
-            line.y3 = secondPoint.second + (normalizedHalfLineThickness - (nextDir == WEST ? normalizedLineThickness : 0.0f)) * aspectRatioY;
+            line.x3 = secondPoint.first - gridHalfLineThickness;
+            line.y3 = secondPoint.second + (gridHalfLineThickness - (nextDir == WEST ? gridLineThickness : 0.0f));
             // bottom right
-            line.x4 = secondPoint.first + (normalizedHalfLineThickness)*aspectRatioX;
-            line.y4 = secondPoint.second + (normalizedHalfLineThickness - (nextDir == EAST ? normalizedLineThickness : 0.0f)) * aspectRatioY;
+            line.x4 = secondPoint.first + gridHalfLineThickness;
+            line.y4 = secondPoint.second + (gridHalfLineThickness - (nextDir == EAST ? gridLineThickness : 0.0f));
         }
         else if (mainDir == EAST)
         {
             // top left
-            line.x1 = firstPoint.first + (normalizedHalfLineThickness - (previousDir == SOUTH ? normalizedLineThickness : 0.0f)) * aspectRatioX;
-            line.y1 = firstPoint.second + (normalizedHalfLineThickness) * aspectRatioY;
+            line.x1 = firstPoint.first + (gridHalfLineThickness - (previousDir == SOUTH ? gridLineThickness : 0.0f));
+            line.y1 = firstPoint.second + gridHalfLineThickness;
             // top right
-            line.x2 = secondPoint.first + (normalizedHalfLineThickness - (nextDir == SOUTH ? normalizedLineThickness : 0.0f)) * aspectRatioX;
-            line.y2 = secondPoint.second + (normalizedHalfLineThickness) * aspectRatioY;
+            line.x2 = secondPoint.first + (gridHalfLineThickness - (nextDir == SOUTH ? gridLineThickness : 0.0f));
+            line.y2 = secondPoint.second + gridHalfLineThickness;
             // bottom left
-            line.x3 = firstPoint.first + (normalizedHalfLineThickness - (previousDir == NORTH ? normalizedLineThickness : 0.0f)) * aspectRatioX;
-            line.y3 = firstPoint.second - (normalizedHalfLineThickness) * aspectRatioY;
+            line.x3 = firstPoint.first + (gridHalfLineThickness - (previousDir == NORTH ? gridLineThickness : 0.0f));
+            line.y3 = firstPoint.second - gridHalfLineThickness;
             // bottom right
-            line.x4 = secondPoint.first + (normalizedHalfLineThickness - (nextDir == NORTH ? normalizedLineThickness : 0.0f)) * aspectRatioX;
-            line.y4 = secondPoint.second - (normalizedHalfLineThickness) * aspectRatioY;
+            line.x4 = secondPoint.first + (gridHalfLineThickness - (nextDir == NORTH ? gridLineThickness : 0.0f));
+            line.y4 = secondPoint.second - gridHalfLineThickness;
         }
         else if (mainDir == WEST)
         {
             // bottom left
-            line.x1 = secondPoint.first + (normalizedHalfLineThickness - (nextDir == NORTH ? normalizedLineThickness : 0.0f)) * aspectRatioX;
-            line.y1 = secondPoint.second + (normalizedHalfLineThickness) * aspectRatioY;
+            line.x1 = secondPoint.first + (gridHalfLineThickness - (nextDir == NORTH ? gridLineThickness : 0.0f));
+            line.y1 = secondPoint.second + gridHalfLineThickness;
             // bottom right
-            line.x2 = firstPoint.first + (normalizedHalfLineThickness - (previousDir == NORTH ? normalizedLineThickness : 0.0f)) * aspectRatioX;
-            line.y2 = firstPoint.second + (normalizedHalfLineThickness) * aspectRatioY;
+            line.x2 = firstPoint.first + (gridHalfLineThickness - (previousDir == NORTH ? gridLineThickness : 0.0f));
+            line.y2 = firstPoint.second + gridHalfLineThickness;
             // top left
-            line.x3 = secondPoint.first + (normalizedHalfLineThickness - (nextDir == SOUTH ? normalizedLineThickness : 0.0f)) * aspectRatioX;
-            line.y3 = secondPoint.second - (normalizedHalfLineThickness) * aspectRatioY;
+            line.x3 = secondPoint.first + (gridHalfLineThickness - (nextDir == SOUTH ? gridLineThickness : 0.0f));
+            line.y3 = secondPoint.second - gridHalfLineThickness;
             // top right
-            line.x4 = firstPoint.first + (normalizedHalfLineThickness - (previousDir == SOUTH ? normalizedLineThickness : 0.0f)) * aspectRatioX;
-            line.y4 = firstPoint.second - (normalizedHalfLineThickness) * aspectRatioY;
+            line.x4 = firstPoint.first + (gridHalfLineThickness - (previousDir == SOUTH ? gridLineThickness : 0.0f));
+            line.y4 = firstPoint.second - gridHalfLineThickness;
         }
 
         if (mainDir != NONE)
@@ -384,6 +551,274 @@ uint32_t Application::GetPathIfFound()
     return elementsToDraw;
 }
 
+bool Application::ExportImage(const std::string& filePath, uint16_t cellPixelSize)
+{
+    MazeExporter exporter;
+    std::copy(m_ColorPath, m_ColorPath + 4, exporter.m_ColorPath);
+
+    {
+        // Only the rasterization needs the maze to hold still, writing the file does not
+        std::lock_guard<std::mutex> lock(m_SimulationMutex);
+        exporter.Render(*m_Maze, cellPixelSize, m_MazeSolver, &m_Route);
+    }
+
+    if (!exporter.Write(filePath))
+        return false;
+
+    std::cout << "Image exported to " << filePath << " [" << exporter.GetWidth() << "x" << exporter.GetHeight() << "]" << std::endl;
+    return true;
+}
+
+bool Application::SaveMaze(const std::string& filePath, bool withWeights)
+{
+    std::lock_guard<std::mutex> lock(m_SimulationMutex);
+    return MazeFile::Save(filePath, *m_Maze, withWeights);
+}
+
+bool Application::LoadMaze(const std::string& filePath)
+{
+    // Decoding happens before taking the lock so the simulation is not held up by the file
+    Maze* maze = MazeFile::Load(filePath, m_Maze->m_HalfCellHeight, m_Maze->m_WallThickness);
+    if (!maze)
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_SimulationMutex);
+
+    DeleteMaze();
+    m_Maze = maze;
+    // Its buffers were allocated while decoding, they go to the arena once it is deleted
+    m_Maze->m_Arena = &m_Arena;
+    m_Arena.Fit(m_Maze->m_MazeArea);
+    // Finished mazes get a builder which is already completed, same as after building one
+    m_BuilderSelected = static_cast<MazeBuilder::Algorithms>(maze->m_Builder);
+    m_MazeBuilder = new MazeBuilder(m_Maze, maze->m_Builder, maze->m_Seed);
+    m_MazeGraph.Build(*m_Maze);
+
+    m_ButtonStates = 0x00;
+    m_SnapshotRequested = true;
+    return true;
+}
+
+void Application::SaveCheckpoint()
+{
+    std::lock_guard<std::mutex> lock(m_SimulationMutex);
+    if (UsesPlugin())
+    {
+        std::cout << "Registered plugin builders and solvers can not be checkpointed" << std::endl;
+        return;
+    }
+    CaptureCheckpoint();
+}
+
+bool Application::UsesPlugin() const
+{
+    return (m_MazeBuilder && m_MazeBuilder->m_Plugin) || (m_MazeSolver && m_MazeSolver->m_Plugin);
+}
+
+void Application::CaptureCheckpoint()
+{
+    // State of plugins is their own, automatic checkpoints skip them
+    if (!m_Maze || m_CheckpointWriting || UsesPlugin())
+        return;
+
+    if (m_CheckpointThread.joinable())
+        m_CheckpointThread.join();
+
+    // The simulation only waits for the copy into memory
+    MazeCheckpoint::Capture(m_CheckpointData, *m_Maze, m_MazeBuilder, m_MazeSolver, m_Route);
+
+    m_CheckpointWriting = true;
+    m_CheckpointThread = std::thread([this, filePath = m_CheckpointPath]()
+        {
+            MazeCheckpoint::Write(filePath, m_CheckpointData);
+            m_CheckpointWriting = false;
+        });
+}
+
+bool Application::LoadCheckpoint(const std::string& filePath)
+{
+    // Restoring happens before taking the lock so the simulation is not held up by the file
+    MazeCheckpointState state;
+    if (!MazeCheckpoint::Load(filePath, state))
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_SimulationMutex);
+
+    DeleteMaze();
+    m_Maze = state.maze;
+    m_Maze->m_Arena = &m_Arena;
+    m_Arena.Fit(m_Maze->m_MazeArea);
+    m_MazeBuilder = state.builder;
+    m_MazeSolver = state.solver;
+    m_Route = state.route;
+    m_ButtonStates = 0x00;
+    if (m_Maze->MazeCompleted())
+        m_MazeGraph.Build(*m_Maze);
+
+    // Pressed buttons are what keeps the UI from starting another builder or solver
+    if (m_MazeBuilder)
+    {
+        m_BuilderSelected = m_MazeBuilder->m_SelectedAlgorithm;
+        m_BuilderRequested = m_BuilderSelected;
+        m_ButtonStates |= BUILDER;
+    }
+    if (m_MazeSolver)
+    {
+        m_MazeSolver->m_Route = &m_Route;
+        m_MazeSolver->m_Graph = &m_MazeGraph;
+        m_SolverSelected = m_MazeSolver->m_SelectedAlgorithm;
+        m_SolverRequested = m_SolverSelected;
+        m_ButtonStates |= SOLVER;
+    }
+
+    m_SnapshotRequested = true;
+    return true;
+}
+
+bool Application::ExportGraph(const std::string& filePath, bool withWeights)
+{
+    std::lock_guard<std::mutex> lock(m_SimulationMutex);
+
+    if (!m_MazeGraph.IsBuilt())
+    {
+        std::cout << "Maze has to be completed before it can be exported as a graph" << std::endl;
+        return false;
+    }
+
+    // Weights can be changed at any time so they are only copied in for the export
+    if (withWeights)
+        m_MazeGraph.SetWeights(m_Maze->m_CellWeights);
+
+    bool written = false;
+    std::string extension = filePath.substr(filePath.find_last_of('.') + 1);
+    if (extension == "csr")
+        written = m_MazeGraph.WriteBinary(filePath);
+    else if (extension == "edges")
+        written = m_MazeGraph.WriteEdgeList(filePath);
+    else if (extension == "gr")
+        written = m_MazeGraph.WriteDimacs(filePath);
+    else
+        std::cout << "Unknown graph format " << filePath << std::endl;
+
+    m_MazeGraph.m_Weights.clear();
+    return written;
+}
+
+void Application::ReassignWeights()
+{
+    std::lock_guard<std::mutex> lock(m_SimulationMutex);
+    GenerateWeights();
+}
+
+void Application::GenerateWeights()
+{
+    if (!m_Maze)
+        return;
+
+    // Racing solvers read the weights without the lock
+    m_Race.Stop();
+
+    if (!m_FixedWeightSeed)
+        m_WeightSettings.seed = rand();
+
+    auto start = std::chrono::steady_clock::now();
+    m_Maze->SetCellWeights(m_WeightSettings);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << MazeWeights::GetGeneratorName(m_WeightSettings.generator) << " weights for " << m_Maze->m_MazeArea
+        << " cells in " << elapsed.count() << " ms" << std::endl;
+}
+
+bool Application::LoadWeights(const std::string& filePath)
+{
+    std::lock_guard<std::mutex> lock(m_SimulationMutex);
+
+    // Read into a copy so a bad file leaves the current weights alone
+    NarrowVector weights;
+    if (!MazeWeights::Load(filePath, weights, m_Maze->m_CellsAcrossWidth, m_Maze->m_CellsAcrossHeight, m_WeightSettings.maxWeight))
+        return false;
+
+    m_Race.Stop();
+    m_Maze->m_CellWeights.Swap(weights);
+    m_Maze->m_WeightsVersion++;
+    std::cout << "Weights loaded from " << filePath << std::endl;
+    return true;
+}
+
+bool Application::SaveWeights(const std::string& filePath)
+{
+    std::lock_guard<std::mutex> lock(m_SimulationMutex);
+    return MazeWeights::Write(filePath, m_Maze->m_CellWeights, m_Maze->m_CellsAcrossWidth, m_Maze->m_CellsAcrossHeight);
+}
+
+void Application::ComputeMetrics()
+{
+    std::lock_guard<std::mutex> lock(m_SimulationMutex);
+
+    if (!m_Maze || !m_Maze->MazeCompleted())
+    {
+        std::cout << "Maze has to be completed before its metrics can be computed" << std::endl;
+        m_MetricsValid = false;
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    const PackedPath* solution = m_MazeSolver && m_MazeSolver->m_Completed ? &m_MazeSolver->m_Path : nullptr;
+    m_Metrics = MazeMetrics::Compute(*m_Maze, solution);
+    m_MetricsValid = true;
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Metrics of " << m_Maze->m_MazeArea << " cells in " << elapsed.count() << " ms" << std::endl;
+}
+
+bool Application::ExportMetrics(const std::string& filePath)
+{
+    // A solver may have finished since the last time they were computed
+    ComputeMetrics();
+    return m_MetricsValid && m_Metrics.WriteJson(filePath);
+}
+
+void Application::SetRoute(uint32_t start, uint32_t end)
+{
+    std::lock_guard<std::mutex> lock(m_SimulationMutex);
+    m_Route = std::make_pair(start, end);
+}
+
+void Application::StartRace()
+{
+    std::lock_guard<std::mutex> lock(m_SimulationMutex);
+
+    if (!m_MazeGraph.IsBuilt())
+    {
+        std::cout << "Maze has to be completed before solvers can race on it" << std::endl;
+        return;
+    }
+
+    std::vector<uint8_t> algorithms;
+    for (const MazeSolverEntry& entry : MazeRegistry::GetSolvers())
+        algorithms.push_back(entry.algorithm);
+    // The snapshot being shown may belong to a racer which Start is about to destroy
+    SetRaceView(-1);
+    m_Race.Start(*m_Maze, m_MazeGraph, m_Route, algorithms, rand(), &m_Delay, &m_SimulationPaused);
+    SetRaceView(0);
+    std::cout << "Race of " << algorithms.size() << " solvers from " << m_Route.first << " to " << m_Route.second << std::endl;
+}
+
+void Application::StopRace()
+{
+    m_Race.Stop();
+}
+
+void Application::SetRaceView(int racer)
+{
+    if (racer == m_RaceView)
+        return;
+
+    m_RaceView = racer;
+    // Sequences of the race and of the simulation thread are counted separately
+    m_MazeLod.m_BuiltSequence = 0;
+    // The current snapshot may belong to a race which is about to be cleared
+    ConsumeSnapshot();
+}
+
 bool Application::IsButtonPressed(uint16_t buttonPressed) const
 {
     return (m_ButtonStates & buttonPressed) == 0 ? false : true;
@@ -391,16 +826,28 @@ bool Application::IsButtonPressed(uint16_t buttonPressed) const
 
 void Application::DeleteMaze()
 {
-    if (m_Maze)
-        delete m_Maze;
-    if (m_MazeBuilder)
-        delete m_MazeBuilder;
+    SetRaceView(-1);
+    m_Race.Clear();
+
+    // Logs of runs which did not finish are kept as they are
+    m_BuilderRecorder.Close();
+    m_SolverRecorder.Close();
+
+    // Builder and solver give their buffers back through the maze, it goes last
     if (m_MazeSolver)
         delete m_MazeSolver;
+    if (m_MazeBuilder)
+        delete m_MazeBuilder;
+    if (m_Maze)
+        delete m_Maze;
 
     m_Maze = nullptr;
     m_MazeBuilder = nullptr;
     m_MazeSolver = nullptr;
+    m_MazeGraph.Clear();
+    m_MetricsValid = false;
+    m_BuilderCounters = MazeCounterSample();
+    m_SolverCounters = MazeCounterSample();
     m_BuilderSelected = MazeBuilder::Algorithms::NONE;
     m_SolverSelected = MazeSolver::Algorithms::NONE;
 }
\ No newline at end of file
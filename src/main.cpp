@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <iostream>
+#include <unordered_map>
 #include <vector>
 #include <thread>
 #include <chrono>
@@ -12,6 +14,7 @@
 
 void callbackResize(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window, double& mouseX, double& mouseY, ImVec2& vMin, ImVec2& vMax, Application& application);
+void uploadSessionFrames(Application& application, std::unordered_map<uint32_t, ImGuiHandler::SessionView>& views);
 
 // settings
 uint16_t SCR_WIDTH = 1280;
@@ -75,9 +78,13 @@ int main()
     #include "../../res/shaders/maze.ps"
     #include "../../res/shaders/path.vs"
     #include "../../res/shaders/path.ps"
+    // lodVertexShader, lodFragmentShader
+    #include "../../res/shaders/lod.vs"
+    #include "../../res/shaders/lod.ps"
 
     Shader mazeShader(mazeVertexShader.c_str(), mazeFragmentShader.c_str(), true);
     Shader pathShader(pathVertexShader.c_str(), pathFragmentShader.c_str(), true);
+    Shader lodShader(lodVertexShader.c_str(), lodFragmentShader.c_str(), true);
 
     uint32_t VAO, VBO, EBO, VBOLine, EBOLine;
     glGenVertexArrays(1, &VAO);
@@ -87,6 +94,21 @@ int main()
     glGenBuffers(1, &EBOLine);
     glBindVertexArray(0);
 
+    // Used once cells get smaller than a pixel, a single quad textured with one level of the pyramid
+    uint32_t VAOLod, VBOLod, lodTexture;
+    glGenVertexArrays(1, &VAOLod);
+    glGenBuffers(1, &VBOLod);
+    glGenTextures(1, &lodTexture);
+    glBindTexture(GL_TEXTURE_2D, lodTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Every session of the Sessions window has a texture of its own, by session id
+    std::unordered_map<uint32_t, ImGuiHandler::SessionView> sessionViews;
+
     Application application(&SCR_WIDTH, &SCR_HEIGHT);
     
     static float f = 0.0f;
@@ -100,6 +122,11 @@ int main()
     float localAccumulator = 0.0f;                  // This gets reset to 0 to keep 60fps
     float globalAccumulator = 0.0f;                 // This is the time uniform for shader
     const float shaderDelay = 1.0f / 60.0f;         // Shader updated at 60 FPS
+    const float frameDelay = 1.0f / 60.0f;          // UI rendered at 60 FPS
+
+    bool mazeRefitPending = false;
+    float lastResizeTime = 0.0f;
+    const float refitDelay = 0.25f;                 // Time without resizes before the cells are refitted
 
     while (!glfwWindowShouldClose(window))
     {
@@ -110,6 +137,9 @@ int main()
 
         double mouseX = 0.0, mouseY = 0.0;
 
+        Profiler& profiler = application.m_Profiler;
+        profiler.BeginFrame();
+
         ImGuiID dockSpaceID;
         ImGuiHandler::BeginFrame(dockSpaceID, showDemoWindow, application);
 
@@ -118,92 +148,220 @@ int main()
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
+        // Geometry of the last frame is still there to be counted
+        application.SampleMemory();
+
         // Clear states of the Maze per frame
         // TDL: This is very inefficient and can be improved?
         application.m_Maze->m_Vertices.clear();
         application.m_Maze->m_Indices.clear();
-        application.m_Maze->m_CellOrigin.clear();
         application.m_Maze->m_LineVertices.clear();
         application.m_Maze->m_LineIndices.clear();
-        
-        // This ensures that our initial range of route doesnt go out of maze range or they are not equal
-        if (std::max(application.m_Route.first, application.m_Route.second) >= application.m_Maze->m_MazeArea ||
-            application.m_Route.second == application.m_Route.first)
+
+        // Builders and solvers are stepped on the simulation thread, this only reacts to the buttons
         {
-            application.m_Route.first = (rand() % application.m_Maze->m_MazeArea - 1);
-            application.m_Route.second = (rand() % application.m_Maze->m_MazeArea - 1);
+            ScopedTimer timer(profiler, Profiler::GET_BUTTON_STATES);
+            application.GetButtonStates();
         }
 
-        application.GetButtonStates();
+        {
+            ScopedTimer timer(profiler, Profiler::BUFFER_UPLOAD);
+            uploadSessionFrames(application, sessionViews);
+        }
 
-        uint32_t rectangleCount = 0;
-        if (!application.m_MazeBuilder)
-            rectangleCount = application.m_Maze->DrawMaze();
-        else
-            rectangleCount = application.m_Maze->DrawMaze(&application.m_MazeBuilder->m_Path, &application.m_Route);
+        // Never blocks, we keep drawing the previous snapshot until a newer one is published
+        const MazeSnapshot& snapshot = application.ConsumeSnapshot();
 
-        uint32_t rectangleCount2 = 0;
-        rectangleCount2 = application.GetPathIfFound();
+        Maze& maze = *application.m_Maze;
+        const float cellPixelSize = maze.GetCellPixelSize(SCR_WIDTH);
 
-        mazeShader.use();
+        // Geometry stays in grid coordinates, panning, zooming and resizing only change this
+        float viewTransform[4];
+        maze.GetViewTransform(viewTransform);
 
-        glBindVertexArray(VAO);
+        if (cellPixelSize >= 1.0f)
+        {
+            uint32_t rectangleCount = 0;
+            {
+                ScopedTimer timer(profiler, Profiler::DRAW_MAZE);
+                if (!snapshot.builderStarted)
+                    rectangleCount = application.m_Maze->DrawMaze(snapshot.cellInfo);
+                else
+                    rectangleCount = application.m_Maze->DrawMaze(snapshot.cellInfo, &snapshot.builderPath, &application.m_Route);
+            }
 
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, application.m_Maze->m_Vertices.size() * sizeof(float) * 2, application.m_Maze->m_Vertices.data(), GL_STATIC_DRAW);
+            uint32_t rectangleCount2 = 0;
+            {
+                ScopedTimer timer(profiler, Profiler::GET_PATH_IF_FOUND);
+                rectangleCount2 = application.GetPathIfFound();
+            }
+            profiler.AddCounter(Profiler::CELLS_TOUCHED, rectangleCount + rectangleCount2);
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, application.m_Maze->m_Indices.size() * sizeof(uint32_t), application.m_Maze->m_Indices.data(), GL_STATIC_DRAW);
+            mazeShader.use();
+            mazeShader.setVec4("view", viewTransform[0], viewTransform[1], viewTransform[2], viewTransform[3]);
 
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
+            glBindVertexArray(VAO);
 
-        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(2 * sizeof(float)));
-        glEnableVertexAttribArray(1);
+            {
+                ScopedTimer timer(profiler, Profiler::BUFFER_UPLOAD);
 
-        // 6 values in index buffer per cell
-        glDrawElements(GL_TRIANGLES, rectangleCount * 6, GL_UNSIGNED_INT, 0);
+                uint64_t vertexBytes = application.m_Maze->m_Vertices.size() * sizeof(float) * 2;
+                uint64_t indexBytes = application.m_Maze->m_Indices.size() * sizeof(uint32_t);
 
-        pathShader.use();
+                glBindBuffer(GL_ARRAY_BUFFER, VBO);
+                glBufferData(GL_ARRAY_BUFFER, vertexBytes, application.m_Maze->m_Vertices.data(), GL_STATIC_DRAW);
 
-        if (application.m_PathAnimation)
-            pathShader.setBool("enableAnimation", true);
-        else
-            pathShader.setBool("enableAnimation", false);
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, application.m_Maze->m_Indices.data(), GL_STATIC_DRAW);
 
-        pathShader.setFloat("colorCycle", application.m_PathSpeed);
+                profiler.AddCounter(Profiler::BYTES_UPLOADED, vertexBytes + indexBytes);
+            }
 
-        if (localAccumulator > shaderDelay)
-        {
-            globalAccumulator += localAccumulator;
-            localAccumulator = 0.0f;
-            pathShader.setFloat("time", globalAccumulator);
-        }
+            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+            glEnableVertexAttribArray(0);
 
-        glBindBuffer(GL_ARRAY_BUFFER, VBOLine);
-        glBufferData(GL_ARRAY_BUFFER, application.m_Maze->m_LineVertices.size() * sizeof(float) * 2, application.m_Maze->m_LineVertices.data(), GL_STATIC_DRAW);
+            glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(2 * sizeof(float)));
+            glEnableVertexAttribArray(1);
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOLine);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, application.m_Maze->m_LineIndices.size() * sizeof(uint32_t), application.m_Maze->m_LineIndices.data(), GL_STATIC_DRAW);
+            // 6 values in index buffer per cell
+            {
+                ScopedTimer timer(profiler, Profiler::DRAW_CALLS);
+                glDrawElements(GL_TRIANGLES, rectangleCount * 6, GL_UNSIGNED_INT, 0);
+            }
+
+            pathShader.use();
+            pathShader.setVec4("view", viewTransform[0], viewTransform[1], viewTransform[2], viewTransform[3]);
+
+            if (application.m_PathAnimation)
+                pathShader.setBool("enableAnimation", true);
+            else
+                pathShader.setBool("enableAnimation", false);
+
+            pathShader.setFloat("colorCycle", application.m_PathSpeed);
+
+            if (localAccumulator > shaderDelay)
+            {
+                globalAccumulator += localAccumulator;
+                localAccumulator = 0.0f;
+                pathShader.setFloat("time", globalAccumulator);
+            }
+
+            {
+                ScopedTimer timer(profiler, Profiler::BUFFER_UPLOAD);
 
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
+                uint64_t vertexBytes = application.m_Maze->m_LineVertices.size() * sizeof(float) * 2;
+                uint64_t indexBytes = application.m_Maze->m_LineIndices.size() * sizeof(uint32_t);
 
-        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)(2 * sizeof(float))); 
-        glEnableVertexAttribArray(1);
+                glBindBuffer(GL_ARRAY_BUFFER, VBOLine);
+                glBufferData(GL_ARRAY_BUFFER, vertexBytes, application.m_Maze->m_LineVertices.data(), GL_STATIC_DRAW);
 
-        // Reference point
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)(6 * sizeof(float)));
-        glEnableVertexAttribArray(2);
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOLine);
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, application.m_Maze->m_LineIndices.data(), GL_STATIC_DRAW);
 
-        // Width, Height
-        glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)(8 * sizeof(float)));
-        glEnableVertexAttribArray(3);
+                profiler.AddCounter(Profiler::BYTES_UPLOADED, vertexBytes + indexBytes);
+            }
+
+            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)0);
+            glEnableVertexAttribArray(0);
+
+            glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)(2 * sizeof(float))); 
+            glEnableVertexAttribArray(1);
+
+            // Reference point
+            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)(6 * sizeof(float)));
+            glEnableVertexAttribArray(2);
+
+            // Width, Height
+            glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)(8 * sizeof(float)));
+            glEnableVertexAttribArray(3);
+
+            //glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+            // 6 values in index buffer per cell
+            {
+                ScopedTimer timer(profiler, Profiler::DRAW_CALLS);
+                glDrawElements(GL_TRIANGLES, rectangleCount2 * 6, GL_UNSIGNED_INT, 0);
+            }
+            //glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        }
+        else
+        {
+            // Cells are smaller than a pixel so drawing them one by one would only produce aliasing
+            {
+                ScopedTimer timer(profiler, Profiler::DRAW_MAZE);
+                application.UpdateLevelOfDetail();
+            }
 
-        //glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        // 6 values in index buffer per cell
-        glDrawElements(GL_TRIANGLES, rectangleCount2 * 6, GL_UNSIGNED_INT, 0);
-        //glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+            MazeLod& lod = application.m_MazeLod;
+            if (lod.GetLevelCount() > 0)
+            {
+                uint32_t level = lod.SelectLevel(cellPixelSize);
+                uint32_t cellsPerTexel = lod.GetCellsPerTexel(level);
+
+                uint32_t xBegin, xEnd, yBegin, yEnd;
+                maze.GetVisibleCells(xBegin, xEnd, yBegin, yEnd);
+                uint32_t texelXBegin = xBegin / cellsPerTexel;
+                uint32_t texelXEnd = std::min((xEnd + cellsPerTexel - 1) / cellsPerTexel, lod.GetLevelWidth(level));
+                uint32_t texelYBegin = yBegin / cellsPerTexel;
+                uint32_t texelYEnd = std::min((yEnd + cellsPerTexel - 1) / cellsPerTexel, lod.GetLevelHeight(level));
+
+                {
+                    ScopedTimer timer(profiler, Profiler::BUFFER_UPLOAD);
+
+                    // Only the visible part of the level is uploaded, texels are stored column by column
+                    // so the texture is transposed, u follows the rows and v follows the columns of the maze
+                    glBindTexture(GL_TEXTURE_2D, lodTexture);
+                    glPixelStorei(GL_UNPACK_ROW_LENGTH, lod.GetLevelHeight(level));
+                    glPixelStorei(GL_UNPACK_SKIP_PIXELS, texelYBegin);
+                    glPixelStorei(GL_UNPACK_SKIP_ROWS, texelXBegin);
+                    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, texelYEnd - texelYBegin, texelXEnd - texelXBegin, 0, GL_RGBA, GL_UNSIGNED_BYTE, lod.GetLevelData(level));
+                    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+                    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+                    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+
+                    profiler.AddCounter(Profiler::BYTES_UPLOADED, static_cast<uint64_t>(texelYEnd - texelYBegin) * (texelXEnd - texelXBegin) * 4);
+                }
+
+                // Grid coordinates are in cells
+                float left = static_cast<float>(texelXBegin * cellsPerTexel);
+                float right = static_cast<float>(texelXEnd * cellsPerTexel);
+                float bottom = static_cast<float>(texelYBegin * cellsPerTexel);
+                float top = static_cast<float>(texelYEnd * cellsPerTexel);
+
+                // x, y, u, v
+                float quad[16] =
+                {
+                    left, bottom, 0.0f, 0.0f,
+                    right, bottom, 0.0f, 1.0f,
+                    right, top, 1.0f, 1.0f,
+                    left, top, 1.0f, 0.0f
+                };
+
+                lodShader.use();
+                lodShader.setVec4("view", viewTransform[0], viewTransform[1], viewTransform[2], viewTransform[3]);
+                lodShader.setInt("cellStates", 0);
+                lodShader.setVec4("colorBackground", maze.m_ColorBackground[0], maze.m_ColorBackground[1], maze.m_ColorBackground[2], maze.m_ColorBackground[3]);
+                lodShader.setVec4("colorMaze", maze.m_ColorMaze[0], maze.m_ColorMaze[1], maze.m_ColorMaze[2], maze.m_ColorMaze[3]);
+                lodShader.setVec4("colorSearched", maze.m_ColorSearched[0], maze.m_ColorSearched[1], maze.m_ColorSearched[2], maze.m_ColorSearched[3]);
+                lodShader.setVec4("colorPath", application.m_ColorPath[0], application.m_ColorPath[1], application.m_ColorPath[2], application.m_ColorPath[3]);
+
+                glBindVertexArray(VAOLod);
+                glBindBuffer(GL_ARRAY_BUFFER, VBOLod);
+                glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STREAM_DRAW);
+
+                glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+                glEnableVertexAttribArray(0);
+
+                glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+                glEnableVertexAttribArray(1);
+
+                glActiveTexture(GL_TEXTURE0);
+                {
+                    ScopedTimer timer(profiler, Profiler::DRAW_CALLS);
+                    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+                }
+                glBindTexture(GL_TEXTURE_2D, 0);
+            }
+        }
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -215,7 +373,7 @@ int main()
         // For Controls menu
         ImGui::End();
 
-        ImGuiHandler::EndFrame(dockSpaceID, &texture, getRegion, windowResized);
+        ImGuiHandler::EndFrame(dockSpaceID, &texture, getRegion, windowResized, application);
 
         ImVec2 vMin = ImGui::GetWindowContentRegionMin();
         ImVec2 vMax = ImGui::GetWindowContentRegionMax();
@@ -230,54 +388,63 @@ int main()
         processInput(window, mouseX, mouseY, vMin, vMax, application);
 
         ImGui::End();
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        ImGuiHandler::SessionsWindow(application, sessionViews);
+        {
+            ScopedTimer timer(profiler, Profiler::IMGUI_RENDER);
+            ImGui::Render();
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
 
-        // Delete old framebuffer and create a new one
+        // Resize the storage of the framebuffer texture, the maze keeps its grid and is only stretched by the view transform
         if (windowResized)
         {
-            glDeleteFramebuffers(1, &framebuffer);
-            glDeleteTextures(1, &texture);
-
-            glGenFramebuffers(1, &framebuffer);
-            glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
-
-            // Create a texture to render to
-            glGenTextures(1, &texture);
             glBindTexture(GL_TEXTURE_2D, texture);
             glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, getRegion.x, getRegion.y, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+            glBindTexture(GL_TEXTURE_2D, 0);
 
             callbackResize(window, getRegion.x, getRegion.y);
 
+            windowResized = false;
+            mazeRefitPending = true;
+            lastResizeTime = currentFrameTime;
+        }
+
+        // Dragging a dock splitter resizes every frame, so the cells are only refitted once it settles
+        if (mazeRefitPending && !ImGui::IsMouseDown(ImGuiMouseButton_Left) && currentFrameTime - lastResizeTime > refitDelay)
+        {
             // Rebuild the maze if we have not yet started maze generation
             if (!application.m_MazeBuilder)
-            {
-                delete application.m_Maze;
-                application.m_Maze = new Maze(SCR_WIDTH, SCR_HEIGHT);
-            }
+                application.RecreateMaze(application.m_Maze->m_HalfCellHeight, application.m_Maze->m_WallThickness);
 
-            windowResized = false;
+            mazeRefitPending = false;
         }
 
         ImGuiIO& io = ImGui::GetIO();
         if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
         {
+            ScopedTimer timer(profiler, Profiler::IMGUI_RENDER);
             GLFWwindow* backup_current_context = glfwGetCurrentContext();
             ImGui::UpdatePlatformWindows();
             ImGui::RenderPlatformWindowsDefault();
             glfwMakeContextCurrent(backup_current_context);
         }
         glfwSwapBuffers(window);
+        profiler.EndFrame();
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(application.m_Delay));
+        // Algorithms run on their own thread now, so the UI only has to keep up with 60 FPS
+        float frameTime = static_cast<float>(glfwGetTime()) - currentFrameTime;
+        if (frameTime < frameDelay)
+            std::this_thread::sleep_for(std::chrono::duration<float>(frameDelay - frameTime));
     }
 
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
+    glDeleteVertexArrays(1, &VAOLod);
+    glDeleteBuffers(1, &VBOLod);
+    glDeleteTextures(1, &lodTexture);
+    for (auto& view : sessionViews)
+        glDeleteTextures(1, &view.second.texture);
 
     // Cleanup
     ImGui_ImplOpenGL3_Shutdown();
@@ -309,23 +476,75 @@ void processInput(GLFWwindow* window, double& mouseX, double& mouseY, ImVec2& vM
         if (xPos < 0 || yPos < 0 || xPos > 1 || yPos > 1)
             return;
 
-        float normalizedTotalCellWidth = static_cast<float>(application.m_Maze->m_TotalCellHeight) / (application.m_Maze->m_MazeWidth);
-        float normalizedTotalCellHeight = static_cast<float>(application.m_Maze->m_TotalCellHeight) / (application.m_Maze->m_MazeHeight);
+        // Undo the pan and zoom, maze coordinates go from -1 to 1 as well
+        std::pair<float, float> mazePos = application.m_Maze->ScreenToMaze(static_cast<float>(2.0 * xPos - 1.0), static_cast<float>(2.0 * yPos - 1.0));
 
-        int cellInX = static_cast<int>(xPos / normalizedTotalCellWidth);
-        int cellInY = static_cast<int>(yPos / normalizedTotalCellHeight);
-
-        uint32_t cellNumber = cellInX * application.m_Maze->m_CellsAcrossHeight + cellInY;
+        uint32_t cellNumber = application.m_Maze->GetCellAt(mazePos.first, mazePos.second);
+        if (cellNumber >= application.m_Maze->m_MazeArea)
+            return;
 
         if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS)
         {
-            application.m_Route.first = cellNumber;
+            application.SetRoute(cellNumber, application.m_Route.second);
         }
         else
         {
-            application.m_Route.second = cellNumber;
+            application.SetRoute(application.m_Route.first, cellNumber);
+        }
+    }
+}
+
+void uploadSessionFrames(Application& application, std::unordered_map<uint32_t, ImGuiHandler::SessionView>& views)
+{
+    MazeSessions& sessions = application.m_Sessions;
+
+    // Textures of removed sessions are deleted
+    for (auto view = views.begin(); view != views.end();)
+    {
+        bool found = false;
+        for (size_t i = 0; i < sessions.GetCount() && !found; i++)
+            found = sessions.GetId(i) == view->first;
+
+        if (found)
+        {
+            ++view;
+            continue;
         }
+        glDeleteTextures(1, &view->second.texture);
+        view = views.erase(view);
+    }
+
+    for (size_t i = 0; i < sessions.GetCount(); i++)
+    {
+        const MazeSessionFrame& frame = sessions.ConsumeFrame(i);
+        ImGuiHandler::SessionView& view = views[sessions.GetId(i)];
+        if (view.texture == 0)
+        {
+            glGenTextures(1, &view.texture);
+            glBindTexture(GL_TEXTURE_2D, view.texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+
+        // Only frames which were not uploaded yet
+        if (frame.sequence == view.sequence || frame.pixels.empty())
+            continue;
+
+        // Rows of 3 byte pixels are not padded to 4 bytes
+        glBindTexture(GL_TEXTURE_2D, view.texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, frame.width, frame.height, 0, GL_RGB, GL_UNSIGNED_BYTE, frame.pixels.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        view.sequence = frame.sequence;
+        view.width = frame.width;
+        view.height = frame.height;
+        view.stats = frame.stats;
+        application.m_Profiler.AddCounter(Profiler::BYTES_UPLOADED, frame.pixels.size());
     }
+    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void callbackResize(GLFWwindow* window, int width, int height)
@@ -1,39 +1,48 @@
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <random>
 
 #include "maze.h"
+#include "mazeArena.h"
+#include "mazeMemory.h"
+#include "mazeWeights.h"
 
-Maze::Maze(uint16_t width, uint16_t height, uint16_t cellWidth, uint16_t wallThickness)
-    : m_MazeWidth(width), m_MazeHeight(height), m_HalfCellHeight(cellWidth), m_WallThickness(wallThickness)
+Maze::Maze(uint32_t width, uint32_t height, uint16_t cellWidth, uint16_t wallThickness, bool randomWeights, MazeArena* arena)
+    : m_MazeWidth(width), m_MazeHeight(height), m_HalfCellHeight(cellWidth), m_WallThickness(wallThickness), m_Arena(arena)
 {
     std::cout << "Maze Created [" << width << "x" << height << "]" << std::endl;
     m_TotalCellHeight = 2 * m_HalfCellHeight + m_WallThickness;
-    m_CellsAcrossWidth = static_cast<uint16_t>(floor(width / m_TotalCellHeight));
-    m_CellsAcrossHeight = static_cast<uint16_t>(floor(height / m_TotalCellHeight));
+    m_CellsAcrossWidth = width / m_TotalCellHeight;
+    m_CellsAcrossHeight = height / m_TotalCellHeight;
     m_MazeArea = m_CellsAcrossHeight * m_CellsAcrossWidth;
 
-    m_CellOrigin.resize(m_MazeArea);
+    if (m_Arena)
+        m_Arena->Fit(m_MazeArea);
+    MazeArena::Assign<uint16_t>(m_Arena, m_VisitedCellInfo, m_MazeArea, 0);
     // Specifying color using uniform will be way more efficient?
     // Corners use 1 vertex, Colors use 2 vertices
     // 12 Vertices make a cell: 4 corners + 4 colors
-    m_Vertices.resize(static_cast<size_t>(12 * m_MazeArea));
-    m_Indices.resize(static_cast<size_t>(6 * m_MazeArea));
+    // Only the visible cells are drawn so these grow to the size of the view instead of the maze
 
-    m_LineVertices.resize(static_cast<size_t>(12 * m_MazeArea));
-    m_LineIndices.resize(static_cast<size_t>(6 * m_MazeArea));
-
-    m_CellWeights.reserve(m_MazeArea);
-    SetCellWeights();
+    if (randomWeights)
+        SetCellWeights();
 }
 
 Maze::~Maze()
 {
+    MazeArena::Release(m_Arena, m_VisitedCellInfo);
+    m_CellWeights.Visit([&](auto& weights) { MazeArena::Release(m_Arena, weights); });
     std::cout << "Maze Destroyed" << std::endl;
 }
 
-uint32_t Maze::DrawMaze(std::vector<uint32_t>* path, std::pair<uint32_t, uint32_t>* route)
+uint32_t Maze::DrawMaze(const std::vector<uint16_t>& cellInfo, const std::vector<uint32_t>* path, const std::pair<uint32_t, uint32_t>* route)
 {
     uint32_t currentCell = 0;
 
+    // Snapshot can still belong to the previous maze for a frame after a reset
+    bool hasCellInfo = cellInfo.size() == m_MazeArea;
+
     auto colorOfVertex = [&](float uvX, float uvY)
         {
             // RG, BA color of each block
@@ -52,12 +61,12 @@ uint32_t Maze::DrawMaze(std::vector<uint32_t>* path, std::pair<uint32_t, uint32_
                 m_Vertices.push_back(std::make_pair(m_ColorSearchTop[0], m_ColorSearchTop[1]));
                 m_Vertices.push_back(std::make_pair(m_ColorSearchTop[2], m_ColorSearchTop[3]));
             }
-            else if (m_VisitedCellInfo.find(currentCell) != m_VisitedCellInfo.end() && (m_VisitedCellInfo[currentCell] & Maze::CELL_SEARCHED))
+            else if (hasCellInfo && (cellInfo[currentCell] & Maze::CELL_SEARCHED))
             {
                 m_Vertices.push_back(std::make_pair(m_ColorSearched[0], m_ColorSearched[1]));
                 m_Vertices.push_back(std::make_pair(m_ColorSearched[2], m_ColorSearched[3]));
             }
-            else if (m_VisitedCellInfo.find(currentCell) != m_VisitedCellInfo.end() && (m_VisitedCellInfo[currentCell] & Maze::CELL_VISITED))
+            else if (hasCellInfo && (cellInfo[currentCell] & Maze::CELL_VISITED))
             {
                 m_Vertices.push_back(std::make_pair(m_ColorMaze[0], m_ColorMaze[1]));
                 m_Vertices.push_back(std::make_pair(m_ColorMaze[2], m_ColorMaze[3]));
@@ -69,16 +78,10 @@ uint32_t Maze::DrawMaze(std::vector<uint32_t>* path, std::pair<uint32_t, uint32_
             }
         };
 
-    // We are multiplying by 2 because the coordinate go from -1 to 1 instead of 0 to 1
-    // Easier to think as dividing by 2 in denominator
-    float normalizedHalfCellWidth = static_cast<float>(2 * m_HalfCellHeight) / (m_MazeWidth);
-    float normalizedHalfCellHeight = static_cast<float>(2 * m_HalfCellHeight) / (m_MazeHeight);
-    float normalizedWallThickness = static_cast<float>(2 * m_WallThickness) / (m_MazeHeight);
-
-    float normalizedTotalCellWidth = static_cast<float>(2 * m_TotalCellHeight) / (m_MazeWidth);
-    float normalizedTotalCellHeight = static_cast<float>(2 * m_TotalCellHeight) / (m_MazeHeight);
-
-    float normalizedLineThickness = static_cast<float>(2 * m_LineThickness) / (m_MazeHeight);
+    // Geometry is in grid coordinates where one cell including its wall is 1 unit wide
+    // so it does not depend on the size of the window, the view transform maps it to the screen
+    float gridHalfCell = static_cast<float>(m_HalfCellHeight) / m_TotalCellHeight;
+    float gridWallThickness = static_cast<float>(m_WallThickness) / m_TotalCellHeight;
 
     struct Rect
     {
@@ -87,51 +90,49 @@ uint32_t Maze::DrawMaze(std::vector<uint32_t>* path, std::pair<uint32_t, uint32_
 
     Rect line;
 
-    // This goes from bottomRight (-1, -1) to topLeft (1, 1)
+    // Only cells inside the view are emitted, the view transform is applied in the shader
+    uint32_t xBegin = 0, xEnd = 0, yBegin = 0, yEnd = 0;
+    GetVisibleCells(xBegin, xEnd, yBegin, yEnd);
+
+    uint32_t cellsDrawn = 0;
+
+    // This goes from bottomRight (0, 0) to topLeft (m_CellsAcrossWidth, m_CellsAcrossHeight)
     // WIDTH
-    for (float i = -1.0f; i < 1.0f; i += normalizedTotalCellWidth)
+    for (uint32_t x = xBegin; x < xEnd; x++)
     {
-        // To not draw out of bound cells
-        if (i + 2 * normalizedHalfCellWidth > 1)
-        {
-            continue;
-        }
         // HEIGHT
-        for (float j = -1.0f; j < 1.0f; j += normalizedTotalCellHeight)
+        for (uint32_t y = yBegin; y < yEnd; y++)
         {
-            if (j + 2 * normalizedHalfCellHeight > 1)
-            {
-                continue;
-            }
+            currentCell = x * m_CellsAcrossHeight + y;
 
             bool isWallEast = true;
-            if (m_VisitedCellInfo.find(currentCell) != m_VisitedCellInfo.end() && (m_VisitedCellInfo[currentCell] & Maze::CELL_EAST))
+            if (hasCellInfo && (cellInfo[currentCell] & Maze::CELL_EAST))
                 isWallEast = false;
 
             bool isWallNorth = true;
-            if (m_VisitedCellInfo.find(currentCell) != m_VisitedCellInfo.end() && (m_VisitedCellInfo[currentCell] & Maze::CELL_NORTH))
+            if (hasCellInfo && (cellInfo[currentCell] & Maze::CELL_NORTH))
                 isWallNorth = false;
 
-            m_Indices.push_back((4 * currentCell) + 0);
-            m_Indices.push_back((4 * currentCell) + 1);
-            m_Indices.push_back((4 * currentCell) + 3);
-            m_Indices.push_back((4 * currentCell) + 1);
-            m_Indices.push_back((4 * currentCell) + 2);
-            m_Indices.push_back((4 * currentCell) + 3);
+            m_Indices.push_back((4 * cellsDrawn) + 0);
+            m_Indices.push_back((4 * cellsDrawn) + 1);
+            m_Indices.push_back((4 * cellsDrawn) + 3);
+            m_Indices.push_back((4 * cellsDrawn) + 1);
+            m_Indices.push_back((4 * cellsDrawn) + 2);
+            m_Indices.push_back((4 * cellsDrawn) + 3);
 
-            m_CellOrigin.push_back(std::make_pair<float, float>(i + normalizedHalfCellWidth, j + normalizedHalfCellHeight));
+            std::pair<float, float> cellOrigin = GetCellOrigin(currentCell);
 
-            line.x1 = m_CellOrigin[currentCell].first + normalizedHalfCellWidth + (isWallEast ? 0 : normalizedWallThickness);
-            line.y1 = m_CellOrigin[currentCell].second + normalizedHalfCellHeight + (isWallNorth ? 0 : normalizedWallThickness);
+            line.x1 = cellOrigin.first + gridHalfCell + (isWallEast ? 0 : gridWallThickness);
+            line.y1 = cellOrigin.second + gridHalfCell + (isWallNorth ? 0 : gridWallThickness);
 
-            line.x2 = m_CellOrigin[currentCell].first + normalizedHalfCellWidth + (isWallEast ? 0 : normalizedWallThickness);
-            line.y2 = m_CellOrigin[currentCell].second - normalizedHalfCellHeight;
+            line.x2 = cellOrigin.first + gridHalfCell + (isWallEast ? 0 : gridWallThickness);
+            line.y2 = cellOrigin.second - gridHalfCell;
 
-            line.x3 = m_CellOrigin[currentCell].first - normalizedHalfCellWidth;
-            line.y3 = m_CellOrigin[currentCell].second - normalizedHalfCellHeight;
+            line.x3 = cellOrigin.first - gridHalfCell;
+            line.y3 = cellOrigin.second - gridHalfCell;
 
-            line.x4 = m_CellOrigin[currentCell].first - normalizedHalfCellWidth;
-            line.y4 = m_CellOrigin[currentCell].second + normalizedHalfCellHeight + (isWallNorth ? 0 : normalizedWallThickness);
+            line.x4 = cellOrigin.first - gridHalfCell;
+            line.y4 = cellOrigin.second + gridHalfCell + (isWallNorth ? 0 : gridWallThickness);
 
             // Draw the cell
             // right top
@@ -147,11 +148,98 @@ uint32_t Maze::DrawMaze(std::vector<uint32_t>* path, std::pair<uint32_t, uint32_
             m_Vertices.push_back(std::make_pair(line.x4, line.y4));
             colorOfVertex(line.x4, line.y4);
 
-            currentCell++;
+            cellsDrawn++;
         }
     }
 
-    return currentCell;
+    return cellsDrawn;
+}
+
+std::pair<float, float> Maze::GetCellOrigin(uint32_t cell) const
+{
+    float gridHalfCell = static_cast<float>(m_HalfCellHeight) / m_TotalCellHeight;
+
+    uint32_t x = cell / m_CellsAcrossHeight;
+    uint32_t y = cell % m_CellsAcrossHeight;
+
+    return std::make_pair(x + gridHalfCell, y + gridHalfCell);
+}
+
+void Maze::GetVisibleCells(uint32_t& xBegin, uint32_t& xEnd, uint32_t& yBegin, uint32_t& yEnd) const
+{
+    // Screen goes from -1 to 1, in maze coordinates that is center -+ 1/zoom
+    float left = m_ViewCenterX - 1.0f / m_ViewZoom;
+    float right = m_ViewCenterX + 1.0f / m_ViewZoom;
+    float bottom = m_ViewCenterY - 1.0f / m_ViewZoom;
+    float top = m_ViewCenterY + 1.0f / m_ViewZoom;
+
+    auto toCell = [](float coordinate, uint32_t cellCount)
+        {
+            float cell = std::floor((coordinate + 1.0f) * 0.5f * cellCount);
+            if (cell < 0.0f)
+                return 0u;
+            if (cell > static_cast<float>(cellCount))
+                return cellCount;
+            return static_cast<uint32_t>(cell);
+        };
+
+    xBegin = toCell(left, m_CellsAcrossWidth);
+    xEnd = std::min(toCell(right, m_CellsAcrossWidth) + 1, m_CellsAcrossWidth);
+    yBegin = toCell(bottom, m_CellsAcrossHeight);
+    yEnd = std::min(toCell(top, m_CellsAcrossHeight) + 1, m_CellsAcrossHeight);
+}
+
+void Maze::GetViewTransform(float transform[4]) const
+{
+    // grid -> maze -1..1 -> screen, the grid always fills the whole framebuffer
+    transform[0] = 2.0f * m_ViewZoom / m_CellsAcrossWidth;
+    transform[1] = 2.0f * m_ViewZoom / m_CellsAcrossHeight;
+    transform[2] = (-1.0f - m_ViewCenterX) * m_ViewZoom;
+    transform[3] = (-1.0f - m_ViewCenterY) * m_ViewZoom;
+}
+
+uint32_t Maze::GetCellAt(float mazeX, float mazeY) const
+{
+    float x = std::floor((mazeX + 1.0f) * 0.5f * m_CellsAcrossWidth);
+    float y = std::floor((mazeY + 1.0f) * 0.5f * m_CellsAcrossHeight);
+
+    if (x < 0.0f || y < 0.0f || x >= static_cast<float>(m_CellsAcrossWidth) || y >= static_cast<float>(m_CellsAcrossHeight))
+        return m_MazeArea;
+
+    return static_cast<uint32_t>(x) * m_CellsAcrossHeight + static_cast<uint32_t>(y);
+}
+
+float Maze::GetCellPixelSize(uint32_t framebufferWidth) const
+{
+    return static_cast<float>(framebufferWidth) / m_CellsAcrossWidth * m_ViewZoom;
+}
+
+void Maze::SetView(float zoom, float centerX, float centerY)
+{
+    m_ViewZoom = std::clamp(zoom, 1.0f, m_MaxViewZoom);
+
+    // Keep the view inside the maze
+    float limit = 1.0f - 1.0f / m_ViewZoom;
+    m_ViewCenterX = std::clamp(centerX, -limit, limit);
+    m_ViewCenterY = std::clamp(centerY, -limit, limit);
+}
+
+void Maze::ZoomView(float factor, float screenX, float screenY)
+{
+    // Point under the cursor stays where it is
+    std::pair<float, float> anchor = ScreenToMaze(screenX, screenY);
+    float zoom = std::clamp(m_ViewZoom * factor, 1.0f, m_MaxViewZoom);
+    SetView(zoom, anchor.first - screenX / zoom, anchor.second - screenY / zoom);
+}
+
+void Maze::PanView(float screenDeltaX, float screenDeltaY)
+{
+    SetView(m_ViewZoom, m_ViewCenterX - screenDeltaX / m_ViewZoom, m_ViewCenterY - screenDeltaY / m_ViewZoom);
+}
+
+std::pair<float, float> Maze::ScreenToMaze(float screenX, float screenY) const
+{
+    return std::make_pair(m_ViewCenterX + screenX / m_ViewZoom, m_ViewCenterY + screenY / m_ViewZoom);
 }
 
 bool Maze::MazeCompleted() const
@@ -161,12 +249,32 @@ bool Maze::MazeCompleted() const
 
 void Maze::SetCellWeights()
 {
-    m_CellWeights.clear();
+    MazeWeightSettings settings;
+    settings.seed = rand();
+    settings.maxWeight = m_RandUpperLimit;
+    SetCellWeights(settings);
+}
 
-    for (uint32_t i = 0; i < m_MazeArea; i++)
+void Maze::SetCellWeights(const MazeWeightSettings& settings)
+{
+    m_RandUpperLimit = std::max<int>(settings.maxWeight, 1);
+    // First weights of the maze, taken from the arena at the width Generate picks
+    if (m_Arena && m_CellWeights.empty())
     {
-        m_CellWeights.push_back(rand() % m_RandUpperLimit);
-        // Favours top
-        // m_CellWeights.push_back(i % m_CellsAcrossHeight);
+        m_CellWeights.SetWidth(NarrowVector::GetWidthFor(std::max(settings.maxWeight, 1u) - 1));
+        m_CellWeights.Visit([&](auto& weights) { MazeArena::Reserve(m_Arena, weights, m_MazeArea); });
     }
-}
\ No newline at end of file
+    MazeWeights::Generate(m_CellWeights, m_CellsAcrossWidth, m_CellsAcrossHeight, settings);
+    m_WeightsVersion++;
+}
+
+void Maze::ReportMemory(MazeMemoryReport& report) const
+{
+    report.AddVector("Maze", "cell info", m_VisitedCellInfo);
+    report.Add("Maze", "cell weights", m_CellWeights.GetByteSize(), m_CellWeights.GetReservedByteSize());
+    // Cleared every frame but they keep the capacity of the largest frame so far
+    report.AddVector("Maze", "vertices", m_Vertices);
+    report.AddVector("Maze", "indices", m_Indices);
+    report.AddVector("Maze", "line vertices", m_LineVertices);
+    report.AddVector("Maze", "line indices", m_LineIndices);
+}
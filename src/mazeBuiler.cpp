@@ -1,109 +1,104 @@
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <random>
 #include <numeric>
 
 #include "maze.h"
+#include "mazeArena.h"
 #include "mazeBuilder.h"
+#include "mazeMemory.h"
+#include "mazeRegistry.h"
+#include "mazeTopology.h"
 
-MazeBuilder::MazeBuilder(Maze* maze, uint8_t selectedAlgorithm)
-	: m_Maze(maze)
+namespace
+{
+	// Carves into the maze of the builder with the builder's generator
+	MazeCarver<RectangularTopology> MakeCarver(MazeBuilder& builder)
+	{
+		return MazeCarver<RectangularTopology>({ builder.m_Maze->m_CellsAcrossWidth, builder.m_Maze->m_CellsAcrossHeight },
+			builder.m_Maze->m_VisitedCellInfo.data(), builder.m_Generator);
+	}
+}
+
+MazeBuilder::MazeBuilder(Maze* maze, uint8_t selectedAlgorithm, uint32_t seed)
+	: m_Maze(maze), m_Seed(seed), m_Generator(seed)
 {
-	m_StartCoordinate = rand() % m_Maze->m_MazeArea;
+	m_StartCoordinate = m_Generator() % m_Maze->m_MazeArea;
 	m_SelectedAlgorithm = static_cast<Algorithms>(selectedAlgorithm);
-	m_Walls.resize(2 * m_Maze->m_MazeArea);
-	m_Path.reserve(m_Maze->m_MazeArea);
+	m_Maze->m_Builder = selectedAlgorithm;
+	m_Maze->m_Seed = seed;
+
+	// Maze loaded from a file is already finished, nothing left to set up
+	if (m_Maze->MazeCompleted())
+	{
+		m_Completed = true;
+		return;
+	}
+
+	MazeArena::Reserve(m_Maze->m_Arena, m_Path, m_Maze->m_MazeArea);
 
 	switch (m_SelectedAlgorithm)
 	{
 	case Algorithms::RECURSIVE_BACKTRACK:
 	{
-		m_Stack.push(m_StartCoordinate);
+		MakeCarver(*this).StartBacktrack(m_StartCoordinate, m_Stack);
+		m_Maze->m_VisitedCellCount++;
 		break;
 	}
 	case Algorithms::KRUSKAL:
 	{
-		m_Cells = new DisjointSet(maze->m_MazeArea);
-
-		// Add north walls first
-		for (uint32_t i = 0; i < m_Maze->m_MazeArea; i++)
-		{
-			if (i % m_Maze->m_CellsAcrossHeight == 0)
-				m_Walls[i] = std::make_pair<int32_t, int32_t>(i, -1);
-			else
-				m_Walls[i] = std::make_pair<int32_t, int32_t>(i, i - 1);
-		}
-
-		// Add east walls now
-		for (uint32_t i = m_Maze->m_MazeArea; i < m_Walls.size(); i++)
-		{
-			// This makes the walls index to start from 0
-			uint32_t normalizedEastWall = i - m_Maze->m_MazeArea;
-
-			if (normalizedEastWall >= m_Maze->m_MazeArea - m_Maze->m_CellsAcrossHeight)
-				m_Walls[i] = std::make_pair<int32_t, int32_t>(normalizedEastWall, -1);
-			else
-				m_Walls[i] = std::make_pair<int32_t, int32_t>(normalizedEastWall, normalizedEastWall + m_Maze->m_CellsAcrossHeight);
-		}
-
-		std::random_device rd;
-		std::mt19937 g(rd());
-		m_WallShuffler.resize(2 * m_Maze->m_MazeArea);
-		m_WallShuffler[0] = 0;
-		std::iota(m_WallShuffler.begin() + 1, m_WallShuffler.end() - 1, 1);
-		std::shuffle(m_WallShuffler.begin(), m_WallShuffler.end(), g);
+		m_Cells = new DisjointSet(maze->m_MazeArea, m_Maze->m_Arena);
+		// North and east wall of every cell at most
+		MazeArena::Reserve(m_Maze->m_Arena, m_WallShuffler, 2 * m_Maze->m_MazeArea);
+		MakeCarver(*this).StartKruskal(m_WallShuffler);
 		break;
 	}
 	case Algorithms::PRIMS:
 	{
-		// Add north walls first
-		for (uint32_t i = 0; i < m_Maze->m_MazeArea; i++)
-		{
-			if (i % m_Maze->m_CellsAcrossHeight == 0)
-				m_Walls[i] = std::make_pair<int32_t, int32_t>(i, -1);
-			else
-				m_Walls[i] = std::make_pair<int32_t, int32_t>(i, i - 1);
-		}
-
-		// Add east walls now
-		for (uint32_t i = m_Maze->m_MazeArea; i < m_Walls.size(); i++)
-		{
-			// This makes the walls index to start from 0
-			uint32_t normalizedEastWall = i - m_Maze->m_MazeArea;
-
-			if (normalizedEastWall >= m_Maze->m_MazeArea - m_Maze->m_CellsAcrossHeight)
-				m_Walls[i] = std::make_pair<int32_t, int32_t>(normalizedEastWall, -1);
-			else
-				m_Walls[i] = std::make_pair<int32_t, int32_t>(normalizedEastWall, normalizedEastWall + m_Maze->m_CellsAcrossHeight);
-		}
-
-		m_WallShuffler.clear();
-		m_WallShuffler.reserve(2 * m_Maze->m_MazeArea);
-
-		// N
-		if (((m_StartCoordinate + 1) % m_Maze->m_CellsAcrossHeight) != 0)
-			m_WallShuffler.push_back(m_StartCoordinate + 1);
-		// S
-		m_WallShuffler.push_back(m_StartCoordinate);
-		// E
-		m_WallShuffler.push_back(m_Maze->m_MazeArea + m_StartCoordinate);
-		// W
-		if (m_StartCoordinate >= m_Maze->m_CellsAcrossHeight)
-			m_WallShuffler.push_back((static_cast<int32_t>(m_Maze->m_MazeArea) - static_cast<int32_t>(m_Maze->m_CellsAcrossHeight)) + m_StartCoordinate);
-
-		m_Maze->m_VisitedCellInfo[m_StartCoordinate] |= Maze::CELL_VISITED;
-
-		m_LastCell = m_StartCoordinate;
+		MazeArena::Reserve(m_Maze->m_Arena, m_WallShuffler, 2 * m_Maze->m_MazeArea);
+		MakeCarver(*this).StartPrims(m_StartCoordinate, m_WallShuffler);
 		break;
 	}
 	case Algorithms::WILSON:
 	{
-		m_ElementsLeft.resize(m_Maze->m_MazeArea);
+		MazeArena::Assign<uint32_t>(m_Maze->m_Arena, m_ElementsLeft, m_Maze->m_MazeArea);
 		m_ElementsLeft[0] = 0;
 		std::iota(m_ElementsLeft.begin() + 1, m_ElementsLeft.end(), 1);
+		IndexWilson();
+		StartWilson();
 		break;
 	}
+	case Algorithms::ELLER:
+	{
+		m_Eller.Reset(m_Maze->m_CellsAcrossWidth, m_Maze->m_CellsAcrossHeight, m_Seed);
+		break;
+	}
+	default:
+		break;
 	}
+
+	// Plugins come last so they see the builder set up
+	const MazeBuilderEntry* entry = MazeRegistry::FindBuilder(selectedAlgorithm);
+	if (entry && entry->createPlugin)
+		m_Plugin = entry->createPlugin(*this);
+}
+
+MazeBuilder::MazeBuilder(Maze* maze)
+	: m_Maze(maze)
+{
+}
+
+MazeBuilder::~MazeBuilder()
+{
+	delete m_Cells;
+
+	// Maze is still alive here, the next builder takes these over
+	MazeArena::Release(m_Maze->m_Arena, m_Path);
+	MazeArena::Release(m_Maze->m_Arena, m_WallShuffler);
+	MazeArena::Release(m_Maze->m_Arena, m_ElementsLeft);
+	MazeArena::Release(m_Maze->m_Arena, m_ElementIndex);
+	MazeArena::Release(m_Maze->m_Arena, m_WalkIndex);
 }
 
 void MazeBuilder::OnCompletion()
@@ -123,366 +118,175 @@ void MazeBuilder::OnCompletion()
 		break;
 	case Algorithms::PRIMS:
 		break;
+	default:
+		break;
 	}
 }
 
-void MazeBuilder::RecursiveBacktrack()
+void MazeBuilder::Step()
 {
-	std::vector<uint8_t> neighbours;
-
-	// To get negative results for checks
-	int64_t currentCell = static_cast<int64_t>(m_Stack.top());
-	if (!m_Path.empty())
+	// Looked up here instead of in the constructor because MazeCheckpoint sets the algorithm afterwards
+	if (!m_StepFunction)
 	{
-		m_Path.clear();
+		const MazeBuilderEntry* entry = MazeRegistry::FindBuilder(m_SelectedAlgorithm);
+		if (!entry)
+			return;
+		m_StepFunction = entry->step;
 	}
-	m_Path.push_back(currentCell);
+	(this->*m_StepFunction)();
+}
 
-	uint32_t northIndex = currentCell + 1;
-	uint32_t eastIndex = currentCell + (m_Maze->m_CellsAcrossHeight);
-	int64_t southIndex = currentCell - 1;
-	int64_t westIndex = currentCell - (m_Maze->m_CellsAcrossHeight);
+void MazeBuilder::StepPlugin()
+{
+	if (m_Plugin)
+		m_Plugin->Step(*this);
+}
 
-	// North
-	if ((northIndex % m_Maze->m_CellsAcrossHeight) != 0 && (m_Maze->m_VisitedCellInfo[northIndex] & Maze::CELL_VISITED) == 0)
-	{
-		neighbours.push_back(0);
-	}
-	// East
-	if (eastIndex < (static_cast<uint64_t>(m_Maze->m_CellsAcrossWidth) * m_Maze->m_CellsAcrossHeight) && (m_Maze->m_VisitedCellInfo[eastIndex] & Maze::CELL_VISITED) == 0)
-	{
-		neighbours.push_back(1);
-	}
-	// South
-	if ((currentCell % m_Maze->m_CellsAcrossHeight) != 0 && (m_Maze->m_VisitedCellInfo[southIndex] & Maze::CELL_VISITED) == 0)
-	{
-		neighbours.push_back(2);
-	}
-	// West
-	if (westIndex >= 0 && (m_Maze->m_VisitedCellInfo[westIndex] & Maze::CELL_VISITED) == 0)
+uint32_t MazeBuilder::GetCurrentCell() const
+{
+	switch (m_SelectedAlgorithm)
 	{
-		neighbours.push_back(3);
+	case Algorithms::RECURSIVE_BACKTRACK:
+		return m_Stack.empty() ? m_StartCoordinate : m_Stack.top();
+	case Algorithms::KRUSKAL:
+	case Algorithms::PRIMS:
+		// First cell of the wall, the second one can be outside of the maze
+		return m_Path.empty() ? m_StartCoordinate : m_Path.front();
+	case Algorithms::WILSON:
+		return m_RandomWalkStart;
+	case Algorithms::ELLER:
+		return m_Path.empty() ? 0 : m_Path.back();
+	default:
+		return m_Plugin ? m_Plugin->GetCurrentCell() : 0;
 	}
+}
 
-	if (!neighbours.empty())
+uint32_t MazeBuilder::GetFrontierSize() const
+{
+	switch (m_SelectedAlgorithm)
 	{
-		uint8_t cellToVisit = neighbours[rand() % neighbours.size()];
-
-		switch (cellToVisit)
-		{
-		case 0:
-			m_Maze->m_VisitedCellInfo[northIndex] |= (Maze::CELL_VISITED | Maze::CELL_SOUTH);
-			m_Maze->m_VisitedCellInfo[currentCell] |= Maze::CELL_NORTH;
-			m_Stack.push(northIndex);
-			break;
-
-		case 1:
-			m_Maze->m_VisitedCellInfo[eastIndex] |= (Maze::CELL_VISITED | Maze::CELL_WEST);
-			m_Maze->m_VisitedCellInfo[currentCell] |= Maze::CELL_EAST;
-			m_Stack.push(eastIndex);
-			break;
-
-		case 2:
-			m_Maze->m_VisitedCellInfo[southIndex] |= (Maze::CELL_VISITED | Maze::CELL_NORTH);
-			m_Maze->m_VisitedCellInfo[currentCell] |= Maze::CELL_SOUTH;
-			m_Stack.push(southIndex);
-			break;
-
-		case 3:
-			m_Maze->m_VisitedCellInfo[westIndex] |= (Maze::CELL_VISITED | Maze::CELL_EAST);
-			m_Maze->m_VisitedCellInfo[currentCell] |= Maze::CELL_WEST;
-			m_Stack.push(westIndex);
-			break;
-		}
+	case Algorithms::RECURSIVE_BACKTRACK:
+		return static_cast<uint32_t>(m_Stack.size());
+	case Algorithms::KRUSKAL:
+	case Algorithms::PRIMS:
+		return static_cast<uint32_t>(m_WallShuffler.size());
+	case Algorithms::WILSON:
+		return static_cast<uint32_t>(m_ElementsLeft.size());
+	case Algorithms::ELLER:
+		// Only one column is ever held
+		return m_Maze->m_CellsAcrossHeight;
+	default:
+		return m_Plugin ? m_Plugin->GetFrontierSize() : 0;
+	}
+}
 
+void MazeBuilder::RecursiveBacktrack()
+{
+	if (MakeCarver(*this).StepBacktrack(m_Stack, m_Path))
 		m_Maze->m_VisitedCellCount++;
-	}
-	else
-	{
-		m_Stack.pop();
-	}
 }
 
 void MazeBuilder::RandomizedKruskal()
 {
 	if (m_WallShuffler.empty())
 	{
-		m_Maze->m_VisitedCellCount = m_Maze->m_CellsAcrossWidth * m_Maze->m_CellsAcrossHeight;
+		m_Maze->m_VisitedCellCount = m_Maze->m_MazeArea;
 		return;
 	}
 
-	uint32_t index = m_WallShuffler.back();
-	m_WallShuffler.pop_back();
-
-	std::pair<int32_t, int32_t> wallToPop = m_Walls[index];
-	if (!m_Path.empty())
-	{
-		m_Path.clear();
-	}
-	m_Path.push_back(wallToPop.first);
-	m_Path.push_back(wallToPop.second);
-	// dont erase from wall to keep the indexes relevant
-	// walls.erase(walls.begin()+index);
-
-	// When parent is distinct
-	if (wallToPop.second != -1 && m_Cells->Find(static_cast<uint32_t>(wallToPop.first)) != m_Cells->Find(static_cast<uint32_t>(wallToPop.second)))
-	{
-		if (index < static_cast<uint64_t>(m_Maze->m_CellsAcrossHeight * m_Maze->m_CellsAcrossWidth))
-		{
-			m_Maze->m_VisitedCellInfo[wallToPop.first] |= (Maze::CELL_VISITED | Maze::CELL_SOUTH);
-			m_Maze->m_VisitedCellInfo[wallToPop.second] |= (Maze::CELL_VISITED | Maze::CELL_NORTH);
-		}
-		else if (index >= static_cast<uint64_t>(m_Maze->m_CellsAcrossHeight * m_Maze->m_CellsAcrossWidth))
-		{
-			m_Maze->m_VisitedCellInfo[wallToPop.first] |= (Maze::CELL_VISITED | Maze::CELL_EAST);
-			m_Maze->m_VisitedCellInfo[wallToPop.second] |= (Maze::CELL_VISITED | Maze::CELL_WEST);
-		}
-
-		m_Cells->UnionSets(wallToPop.first, wallToPop.second);
-	}
+	MakeCarver(*this).StepKruskal(m_WallShuffler, *m_Cells, m_Path);
 }
 
 void MazeBuilder::RandomizedPrims()
 {
 	if (m_WallShuffler.empty())
 	{
-		m_Maze->m_VisitedCellCount = m_Maze->m_CellsAcrossWidth * m_Maze->m_CellsAcrossHeight;
+		m_Maze->m_VisitedCellCount = m_Maze->m_MazeArea;
 		return;
 	}
-	/*
-	std::random_device rd;
-	std::mt19937 g(rd());
-	std::shuffle(m_WallShuffler.begin(), m_WallShuffler.end(), g);
-
-	uint32_t index = m_WallShuffler.back();
-	m_WallShuffler.pop_back();
-	*/
-
-	uint32_t wallShufflerIndex = rand() % m_WallShuffler.size();
-	uint32_t index = m_WallShuffler[wallShufflerIndex];
-	m_WallShuffler.erase(m_WallShuffler.begin() + wallShufflerIndex);
 
-	std::pair<int32_t, int32_t> wallToPop = m_Walls[index];
-	if (!m_Path.empty())
-	{
-		m_Path.clear();
-	}
-	m_Path.push_back(wallToPop.first);
-	m_Path.push_back(wallToPop.second);
-
-	if (wallToPop.second == -1)
-	{
-		//std::cout << "Out of bound\n";
-		return;
-	}
-
-	if ((m_Maze->m_VisitedCellInfo[wallToPop.second] & Maze::CELL_VISITED) != 0 && (m_Maze->m_VisitedCellInfo[wallToPop.first] & Maze::CELL_VISITED) != 0)
-	{
-		//std::cout << "Visited already\n";
-		return;
-	}
-
-	// Always stores the cell which wasnt visited by this route
-	if ((m_Maze->m_VisitedCellInfo[wallToPop.second] & Maze::CELL_VISITED) != 0)
-		m_LastCell = wallToPop.first;
-	else
-		m_LastCell = wallToPop.second;
-
-	if (index < static_cast<uint64_t>(m_Maze->m_CellsAcrossHeight * m_Maze->m_CellsAcrossWidth))
-	{
-		m_Maze->m_VisitedCellInfo[wallToPop.first] |= (Maze::CELL_VISITED | Maze::CELL_SOUTH);
-		m_Maze->m_VisitedCellInfo[wallToPop.second] |= (Maze::CELL_VISITED | Maze::CELL_NORTH);
-
-		if (m_LastCell == wallToPop.second)
-		{
-			// S
-			m_WallShuffler.push_back(m_LastCell);
-		}
-		else
-		{
-			// N
-			if (((m_LastCell + 1) % m_Maze->m_CellsAcrossHeight) != 0)
-				m_WallShuffler.push_back(m_LastCell + 1);
-		}
-
-		// E
-		m_WallShuffler.push_back(m_Maze->m_MazeArea + m_LastCell);
-		// W
-		if (m_LastCell >= m_Maze->m_CellsAcrossHeight)
-			m_WallShuffler.push_back((static_cast<int64_t>(m_Maze->m_MazeArea) - m_Maze->m_CellsAcrossHeight) + m_LastCell);
-	}
-	else if (index >= static_cast<uint64_t>(m_Maze->m_CellsAcrossHeight * m_Maze->m_CellsAcrossWidth))
-	{
-		m_Maze->m_VisitedCellInfo[wallToPop.first] |= (Maze::CELL_VISITED | Maze::CELL_EAST);
-		m_Maze->m_VisitedCellInfo[wallToPop.second] |= (Maze::CELL_VISITED | Maze::CELL_WEST);
+	MakeCarver(*this).StepPrims(m_WallShuffler, m_Path);
+}
 
-		// N
-		if (((m_LastCell + 1) % m_Maze->m_CellsAcrossHeight) != 0)
-			m_WallShuffler.push_back(m_LastCell + 1);
-		// S
-		m_WallShuffler.push_back(m_LastCell);
+void MazeBuilder::StartWilson()
+{
+	MakeCarver(*this).StartWilson(m_ElementsLeft, m_ElementIndex, m_RandomWalkStart);
+}
 
-		if (m_LastCell == wallToPop.second)
-		{
-			// E
-			m_WallShuffler.push_back(m_Maze->m_MazeArea + m_LastCell);
-		}
-		else
-		{
-			// W
-			if (m_LastCell >= m_Maze->m_CellsAcrossHeight)
-				m_WallShuffler.push_back((static_cast<int64_t>(m_Maze->m_MazeArea) - m_Maze->m_CellsAcrossHeight) + m_LastCell);
-		}
-	}
+void MazeBuilder::IndexWilson()
+{
+	MazeArena::Assign<uint32_t>(m_Maze->m_Arena, m_ElementIndex, m_Maze->m_MazeArea, 0);
+	MazeArena::Assign<uint32_t>(m_Maze->m_Arena, m_WalkIndex, m_Maze->m_MazeArea, 0);
+	MazeCarver<RectangularTopology>::IndexWilson(m_ElementsLeft, m_Path, m_ElementIndex, m_WalkIndex);
 }
 
 void MazeBuilder::Wilson()
 {
 	if (m_ElementsLeft.empty())
 	{
-		m_Maze->m_VisitedCellCount = m_Maze->m_CellsAcrossWidth * m_Maze->m_CellsAcrossHeight;
+		m_Maze->m_VisitedCellCount = m_Maze->m_MazeArea;
 		return;
 	}
 
-	if (m_ElementsLeft.size() == m_Maze->m_MazeArea)
-	{
-		m_RandomWalkStart = m_ElementsLeft[rand() % m_ElementsLeft.size()];
-		m_Maze->m_VisitedCellInfo[m_RandomWalkStart] |= Maze::CELL_VISITED;
-
-		std::vector<uint32_t>::iterator iterator = std::find(m_ElementsLeft.begin(), m_ElementsLeft.end(), m_RandomWalkStart);
-		if (iterator != m_ElementsLeft.end())
-			m_ElementsLeft.erase(iterator);
-	}
-
-	std::vector<uint8_t> neighbours;
+	MakeCarver(*this).StepWilson(m_ElementsLeft, m_ElementIndex, m_Path, m_WalkIndex, m_RandomWalkStart);
+}
 
-	int64_t currentCell = static_cast<int64_t>(m_RandomWalkStart);
+uint64_t MazeBuilder::AdvanceRecursiveBacktrack(uint64_t maxSteps)
+{
+	uint32_t cellsLeft = m_Maze->m_MazeArea - m_Maze->m_VisitedCellCount;
+	const uint64_t steps = MakeCarver(*this).RunBacktrack(m_Stack, m_Path, maxSteps, cellsLeft);
+	m_Maze->m_VisitedCellCount = m_Maze->m_MazeArea - cellsLeft;
+	return steps;
+}
 
-	// Pick a random neighbour of start cell
-	uint32_t northIndex = currentCell + 1;
-	uint32_t eastIndex = currentCell + (m_Maze->m_CellsAcrossHeight);
-	int64_t southIndex = currentCell - 1;
-	int64_t westIndex = currentCell - (m_Maze->m_CellsAcrossHeight);
+// The step after the last wall or cell is the one that completes the maze, like RandomizedKruskal does
+uint64_t MazeBuilder::AdvanceKruskal(uint64_t maxSteps)
+{
+	if (m_Maze->MazeCompleted())
+		return 0;
 
-	// North
-	if ((northIndex % m_Maze->m_CellsAcrossHeight) != 0)
-	{
-		neighbours.push_back(0);
-	}
-	// East
-	if (eastIndex < (static_cast<uint64_t>(m_Maze->m_CellsAcrossWidth) * m_Maze->m_CellsAcrossHeight))
+	uint64_t steps = MakeCarver(*this).RunKruskal(m_WallShuffler, *m_Cells, m_Path, maxSteps);
+	if (steps < maxSteps && m_WallShuffler.empty())
 	{
-		neighbours.push_back(1);
+		m_Maze->m_VisitedCellCount = m_Maze->m_MazeArea;
+		steps++;
 	}
-	// South
-	if ((currentCell % m_Maze->m_CellsAcrossHeight) != 0)
-	{
-		neighbours.push_back(2);
-	}
-	// West
-	if (westIndex >= 0)
-	{
-		neighbours.push_back(3);
-	}
-
-	if (!neighbours.empty())
-	{
-		uint8_t cellToVisit = neighbours[rand() % neighbours.size()];
+	return steps;
+}
 
-		switch (cellToVisit)
-		{
-		case 0:
-		{
-			m_RandomWalkStart = northIndex;
-			m_Path.push_back(northIndex);
-			break;
-		}
-		case 1:
-		{
-			m_RandomWalkStart = eastIndex;
-			m_Path.push_back(eastIndex);
-			break;
-		}
-		case 2:
-		{
-			m_RandomWalkStart = southIndex;
-			m_Path.push_back(southIndex);
-			break;
-		}
-		case 3:
-		{
-			m_RandomWalkStart = westIndex;
-			m_Path.push_back(westIndex);
-			break;
-		}
-		}
-	}
+uint64_t MazeBuilder::AdvancePrims(uint64_t maxSteps)
+{
+	if (m_Maze->MazeCompleted())
+		return 0;
 
-	if ((m_Maze->m_VisitedCellInfo[m_Path.back()] & Maze::CELL_VISITED) != 0)
+	uint64_t steps = MakeCarver(*this).RunPrims(m_WallShuffler, m_Path, maxSteps);
+	if (steps < maxSteps && m_WallShuffler.empty())
 	{
-		// set visited
-		for (uint32_t i = 0; i < m_Path.size() - 1; i++)
-		{
-			if (m_Path[i + 1] > m_Path[i])
-			{
-				if (m_Path[i + 1] - m_Path[i] != 1)
-				{
-					m_Maze->m_VisitedCellInfo[m_Path[i]] |= (Maze::CELL_VISITED | Maze::CELL_EAST);
-					m_Maze->m_VisitedCellInfo[m_Path[i + 1]] |= (Maze::CELL_VISITED | Maze::CELL_WEST);
-				}
-				else
-				{
-					m_Maze->m_VisitedCellInfo[m_Path[i]] |= (Maze::CELL_VISITED | Maze::CELL_NORTH);
-					m_Maze->m_VisitedCellInfo[m_Path[i + 1]] |= (Maze::CELL_VISITED | Maze::CELL_SOUTH);
-				}
-			}
-			else
-			{
-				if (m_Path[i] - m_Path[i + 1] != 1)
-				{
-					m_Maze->m_VisitedCellInfo[m_Path[i]] |= (Maze::CELL_VISITED | Maze::CELL_WEST);
-					m_Maze->m_VisitedCellInfo[m_Path[i + 1]] |= (Maze::CELL_VISITED | Maze::CELL_EAST);
-				}
-				else
-				{
-					m_Maze->m_VisitedCellInfo[m_Path[i]] |= (Maze::CELL_VISITED | Maze::CELL_SOUTH);
-					m_Maze->m_VisitedCellInfo[m_Path[i + 1]] |= (Maze::CELL_VISITED | Maze::CELL_NORTH);
-				}
-			}
-
-			// TDL: this can be made more efficient
-			// erase all elements
-			std::vector<uint32_t>::iterator iterator = std::find(m_ElementsLeft.begin(), m_ElementsLeft.end() - 1, m_Path[i]);
-			m_ElementsLeft.erase(iterator);
-		}
+		m_Maze->m_VisitedCellCount = m_Maze->m_MazeArea;
+		steps++;
+	}
+	return steps;
+}
 
-		// remove randomwalk
-		uint32_t backElement = m_Path.back();
-		m_Path.clear();
+uint64_t MazeBuilder::AdvanceWilson(uint64_t maxSteps)
+{
+	if (m_Maze->MazeCompleted())
+		return 0;
 
-		if (m_ElementsLeft.empty())
-			return;
-		
-		// add random value as start of randomwalk
-		m_RandomWalkStart = m_ElementsLeft[rand() % m_ElementsLeft.size()];
-		m_Path.push_back(m_RandomWalkStart);
-	}
-	else
+	uint64_t steps = MakeCarver(*this).RunWilson(m_ElementsLeft, m_ElementIndex, m_Path, m_WalkIndex, m_RandomWalkStart, maxSteps);
+	if (steps < maxSteps && m_ElementsLeft.empty())
 	{
-		// if last element is in randomwalk then erase elements in randomwalk till we find that last element again
-		std::vector<uint32_t>::iterator iterator = std::find(m_Path.begin(), m_Path.end() - 1, m_Path.back());
-		if (iterator != m_Path.end() - 1)
-		{
-			m_Path.erase(iterator + 1, m_Path.end());
-			m_RandomWalkStart = *iterator;
-		}
+		m_Maze->m_VisitedCellCount = m_Maze->m_MazeArea;
+		steps++;
 	}
+	return steps;
 }
 
-DisjointSet::DisjointSet(uint32_t n)
+DisjointSet::DisjointSet(uint32_t n, MazeArena* arena)
+	: m_Arena(arena)
 {
-	parent.resize(n);
-	rank.resize(n, 0);
+	MazeArena::Assign<uint32_t>(m_Arena, parent, n);
+	MazeArena::Assign<uint32_t>(m_Arena, rank, n, 0);
 
 	if (n == 0)
 		return;
@@ -491,6 +295,12 @@ DisjointSet::DisjointSet(uint32_t n)
 	std::iota(parent.begin() + 1, parent.end(), 1);
 }
 
+DisjointSet::~DisjointSet()
+{
+	MazeArena::Release(m_Arena, parent);
+	MazeArena::Release(m_Arena, rank);
+}
+
 uint32_t DisjointSet::Find(uint32_t x)
 {
 	if (parent[x] != x)
@@ -521,4 +331,54 @@ void DisjointSet::UnionSets(uint32_t x, uint32_t y)
 		parent[rootY] = rootX;
 		rank[rootX]++;
 	}
-}
\ No newline at end of file
+}
+void MazeBuilder::Eller()
+{
+	if (!m_Eller.NextColumn())
+	{
+		m_Maze->m_VisitedCellCount = m_Maze->m_MazeArea;
+		return;
+	}
+
+	const uint32_t cellsAcrossHeight = m_Maze->m_CellsAcrossHeight;
+	const std::vector<uint8_t>& wallBits = m_Eller.GetWallBits();
+	uint32_t cell = m_Eller.GetColumn() * cellsAcrossHeight;
+
+	m_Path.clear();
+	for (uint32_t y = 0; y < cellsAcrossHeight; y++, cell++)
+	{
+		m_Maze->m_VisitedCellInfo[cell] |= Maze::CELL_VISITED;
+		if (wallBits[y] & 0x01)
+		{
+			m_Maze->m_VisitedCellInfo[cell] |= Maze::CELL_NORTH;
+			m_Maze->m_VisitedCellInfo[cell + 1] |= Maze::CELL_SOUTH;
+		}
+		if (wallBits[y] & 0x02)
+		{
+			m_Maze->m_VisitedCellInfo[cell] |= Maze::CELL_EAST;
+			m_Maze->m_VisitedCellInfo[cell + cellsAcrossHeight] |= Maze::CELL_WEST;
+		}
+	}
+	m_Path.push_back(cell - 1);
+
+	m_Maze->m_VisitedCellCount += cellsAcrossHeight;
+}
+
+void MazeBuilder::ReportMemory(MazeMemoryReport& report) const
+{
+	report.AddVector("Builder", "path", m_Path);
+	report.AddAdapter("Builder", "stack", m_Stack);
+	report.AddVector("Builder", "walls", m_WallShuffler);
+	report.AddVector("Builder", "elements left", m_ElementsLeft);
+	report.AddVector("Builder", "element index", m_ElementIndex);
+	report.AddVector("Builder", "walk index", m_WalkIndex);
+	if (m_Cells)
+		m_Cells->ReportMemory(report, "Builder");
+	m_Eller.ReportMemory(report, "Builder");
+}
+
+void DisjointSet::ReportMemory(MazeMemoryReport& report, const char* subsystem) const
+{
+	report.AddVector(subsystem, "set parents", parent);
+	report.AddVector(subsystem, "set ranks", rank);
+}
@@ -0,0 +1,471 @@
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <type_traits>
+
+#include "maze.h"
+#include "mazeBuilder.h"
+#include "mazeSolver.h"
+#include "mazeCheckpoint.h"
+
+namespace
+{
+    // Container inside std::stack, std::queue and std::priority_queue, it is a protected member named c
+    template<typename Adaptor>
+    typename Adaptor::container_type& GetContainer(Adaptor& adaptor)
+    {
+        struct Access : Adaptor
+        {
+            static typename Adaptor::container_type& Get(Adaptor& adaptor) { return adaptor.*&Access::c; }
+        };
+        return Access::Get(adaptor);
+    }
+
+    template<typename Adaptor>
+    const typename Adaptor::container_type& GetContainer(const Adaptor& adaptor)
+    {
+        return GetContainer(const_cast<Adaptor&>(adaptor));
+    }
+
+    class CheckpointWriter
+    {
+    public:
+        explicit CheckpointWriter(std::vector<uint8_t>& data) : m_Data(data) {}
+
+        template<typename T>
+        void Write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only plain values are written as bytes");
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+            m_Data.insert(m_Data.end(), bytes, bytes + sizeof(T));
+        }
+
+        template<typename First, typename Second>
+        void Write(const std::pair<First, Second>& value)
+        {
+            Write(value.first);
+            Write(value.second);
+        }
+
+        template<typename T>
+        void WriteVector(const std::vector<T>& values)
+        {
+            Write<uint64_t>(values.size());
+            if constexpr (std::is_trivially_copyable<T>::value)
+            {
+                const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values.data());
+                m_Data.insert(m_Data.end(), bytes, bytes + values.size() * sizeof(T));
+            }
+            else
+            {
+                for (const T& value : values)
+                    Write(value);
+            }
+        }
+
+        template<typename T>
+        void WriteDeque(const std::deque<T>& values)
+        {
+            Write<uint64_t>(values.size());
+            for (const T& value : values)
+                Write(value);
+        }
+
+        // Width followed by the vector of that width
+        void WriteNarrow(const NarrowVector& values)
+        {
+            Write(values.GetWidth());
+            values.Visit([&](const auto& narrow) { WriteVector(narrow); });
+        }
+
+        // First cell, number of cells and the packed steps
+        void WritePath(const PackedPath& path)
+        {
+            Write(path.front());
+            Write<uint64_t>(path.size());
+            WriteVector(path.GetSteps());
+        }
+
+        void WriteGenerator(const std::mt19937& generator)
+        {
+            // The text form is the only portable way to get the whole state out
+            std::ostringstream stream;
+            stream << generator;
+            std::string text = stream.str();
+            Write<uint64_t>(text.size());
+            m_Data.insert(m_Data.end(), text.begin(), text.end());
+        }
+
+    private:
+        std::vector<uint8_t>& m_Data;
+    };
+
+    class CheckpointReader
+    {
+    public:
+        explicit CheckpointReader(const std::vector<uint8_t>& data) : m_Data(data) {}
+
+        template<typename T>
+        void Read(T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only plain values are read as bytes");
+            if (!Has(sizeof(T)))
+                return;
+            std::memcpy(&value, m_Data.data() + m_Position, sizeof(T));
+            m_Position += sizeof(T);
+        }
+
+        template<typename First, typename Second>
+        void Read(std::pair<First, Second>& value)
+        {
+            Read(value.first);
+            Read(value.second);
+        }
+
+        template<typename T>
+        void ReadVector(std::vector<T>& values)
+        {
+            uint64_t count = 0;
+            Read(count);
+            // Checked before resizing so a corrupt count can not allocate everything
+            if (!Has(count * sizeof(T)))
+                return;
+
+            values.resize(count);
+            if constexpr (std::is_trivially_copyable<T>::value)
+            {
+                std::memcpy(values.data(), m_Data.data() + m_Position, count * sizeof(T));
+                m_Position += count * sizeof(T);
+            }
+            else
+            {
+                for (T& value : values)
+                    Read(value);
+            }
+        }
+
+        template<typename T>
+        void ReadDeque(std::deque<T>& values)
+        {
+            uint64_t count = 0;
+            Read(count);
+            if (!Has(count * sizeof(T)))
+                return;
+
+            values.clear();
+            for (uint64_t i = 0; i < count; i++)
+            {
+                T value{};
+                Read(value);
+                values.push_back(value);
+            }
+        }
+
+        void ReadNarrow(NarrowVector& values)
+        {
+            uint8_t width = 0;
+            Read(width);
+            if (width != NarrowVector::WIDTH_8 && width != NarrowVector::WIDTH_16 && width != NarrowVector::WIDTH_32)
+            {
+                m_Failed = true;
+                return;
+            }
+            values.SetWidth(width);
+            values.Visit([&](auto& narrow) { ReadVector(narrow); });
+        }
+
+        void ReadPath(PackedPath& path, uint32_t cellsAcrossHeight)
+        {
+            uint32_t start = 0;
+            uint64_t cellCount = 0;
+            std::vector<uint8_t> steps;
+            Read(start);
+            Read(cellCount);
+            ReadVector(steps);
+            m_Failed |= cellCount > 4 * steps.size() + 1;
+            if (m_Failed || cellCount == 0)
+                path.Clear();
+            else
+                path.Assign(start, cellsAcrossHeight, static_cast<size_t>(cellCount), steps);
+        }
+
+        void ReadGenerator(std::mt19937& generator)
+        {
+            uint64_t size = 0;
+            Read(size);
+            if (!Has(size))
+                return;
+
+            std::istringstream stream(std::string(reinterpret_cast<const char*>(m_Data.data() + m_Position), static_cast<size_t>(size)));
+            m_Position += static_cast<size_t>(size);
+            stream >> generator;
+            m_Failed |= stream.fail();
+        }
+
+        bool Failed() const { return m_Failed; }
+
+    private:
+        bool Has(uint64_t size)
+        {
+            m_Failed |= size > m_Data.size() - m_Position;
+            return !m_Failed;
+        }
+
+        const std::vector<uint8_t>& m_Data;
+        size_t m_Position = 0;
+        bool m_Failed = false;
+    };
+}
+
+void MazeCheckpoint::Capture(std::vector<uint8_t>& data, const Maze& maze, const MazeBuilder* builder, const MazeSolver* solver, const std::pair<uint32_t, uint32_t>& route)
+{
+    // Keeps its capacity so only the first checkpoint of a run allocates
+    data.clear();
+    CheckpointWriter writer(data);
+
+    writer.Write("MCKP");
+    writer.Write(VERSION);
+    writer.Write<uint16_t>((builder ? MAZE_CHECKPOINT_BUILDER : 0) | (solver ? MAZE_CHECKPOINT_SOLVER : 0));
+
+    writer.Write(maze.m_MazeWidth);
+    writer.Write(maze.m_MazeHeight);
+    writer.Write(maze.m_HalfCellHeight);
+    writer.Write(maze.m_WallThickness);
+    writer.Write<int32_t>(maze.m_RandUpperLimit);
+    writer.Write(maze.m_VisitedCellCount);
+    writer.Write(maze.m_Builder);
+    writer.Write(maze.m_Seed);
+    writer.WriteVector(maze.m_VisitedCellInfo);
+    writer.WriteNarrow(maze.m_CellWeights);
+
+    if (builder)
+    {
+        writer.Write<uint8_t>(builder->m_SelectedAlgorithm);
+        writer.Write(builder->m_Completed);
+        writer.Write(builder->m_StartCoordinate);
+        writer.Write(builder->m_Seed);
+        writer.WriteGenerator(builder->m_Generator);
+        writer.WriteVector(builder->m_Path);
+        writer.WriteDeque(GetContainer(builder->m_Stack));
+
+        writer.Write<uint8_t>(builder->m_Cells != nullptr);
+        if (builder->m_Cells)
+        {
+            writer.WriteVector(builder->m_Cells->parent);
+            writer.WriteVector(builder->m_Cells->rank);
+        }
+        writer.WriteVector(builder->m_WallShuffler);
+
+        writer.WriteVector(builder->m_ElementsLeft);
+        writer.Write(builder->m_RandomWalkStart);
+        writer.Write(builder->m_RandomWalkEnd);
+
+        // Only the set labels carry over between columns, the rest is scratch space
+        const MazeStreamBuilder& eller = builder->m_Eller;
+        writer.Write(eller.m_CellsAcrossWidth);
+        writer.Write(eller.m_CellsAcrossHeight);
+        writer.Write(eller.m_NextColumn);
+        writer.WriteGenerator(eller.m_Generator);
+        writer.Write(eller.m_RandomBits);
+        writer.Write(eller.m_RandomBitCount);
+        writer.WriteVector(eller.m_Sets);
+    }
+
+    if (solver)
+    {
+        writer.Write<uint8_t>(solver->m_SelectedAlgorithm);
+        writer.Write(solver->m_Completed);
+        writer.Write(route);
+        writer.Write(solver->m_Seed);
+        writer.WriteGenerator(solver->m_Generator);
+        writer.WritePath(solver->m_Path);
+        writer.WriteVector(solver->m_Parent);
+        writer.WriteDeque(GetContainer(solver->m_Stack));
+        writer.WriteDeque(GetContainer(solver->m_Queue));
+        // Heap order is kept as is so ties pop in the same order after a restore
+        writer.WriteVector(GetContainer(solver->m_PQueue));
+        // Weights in the nodes are copied again from the maze on the first step after a restore
+        writer.WriteVector(solver->m_Nodes);
+        writer.WriteVector(solver->m_CompactNodes);
+    }
+    else
+    {
+        writer.Write(route);
+    }
+}
+
+bool MazeCheckpoint::Write(const std::string& filePath, const std::vector<uint8_t>& data)
+{
+    std::string temporaryPath = filePath + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cout << "Failed to open " << temporaryPath << " for writing" << std::endl;
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        if (!file.good())
+        {
+            std::cout << "Failed to write " << temporaryPath << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, filePath, error);
+    if (error)
+    {
+        std::cout << "Failed to replace " << filePath << ": " << error.message() << std::endl;
+        return false;
+    }
+
+    std::cout << "Checkpoint written to " << filePath << std::endl;
+    return true;
+}
+
+bool MazeCheckpoint::Load(const std::string& filePath, MazeCheckpointState& state)
+{
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Failed to open " << filePath << std::endl;
+        return false;
+    }
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!Restore(data, state))
+    {
+        std::cout << filePath << " is not a checkpoint this version can read" << std::endl;
+        return false;
+    }
+
+    std::cout << "Checkpoint restored from " << filePath << std::endl;
+    return true;
+}
+
+bool MazeCheckpoint::Restore(const std::vector<uint8_t>& data, MazeCheckpointState& state)
+{
+    CheckpointReader reader(data);
+
+    char magic[5]{};
+    uint16_t version = 0, flags = 0;
+    reader.Read(magic);
+    reader.Read(version);
+    reader.Read(flags);
+    // Only the current layout is read, older checkpoints are not converted
+    if (reader.Failed() || std::memcmp(magic, "MCKP", 4) != 0 || version != VERSION)
+        return false;
+
+    uint32_t mazeWidth = 0, mazeHeight = 0;
+    uint16_t halfCellHeight = 0, wallThickness = 0;
+    int32_t randUpperLimit = 0;
+    reader.Read(mazeWidth);
+    reader.Read(mazeHeight);
+    reader.Read(halfCellHeight);
+    reader.Read(wallThickness);
+    reader.Read(randUpperLimit);
+    if (reader.Failed() || 2 * halfCellHeight + wallThickness == 0)
+        return false;
+
+    Maze* maze = new Maze(mazeWidth, mazeHeight, halfCellHeight, wallThickness, false);
+    maze->m_RandUpperLimit = randUpperLimit;
+    reader.Read(maze->m_VisitedCellCount);
+    reader.Read(maze->m_Builder);
+    reader.Read(maze->m_Seed);
+    reader.ReadVector(maze->m_VisitedCellInfo);
+    reader.ReadNarrow(maze->m_CellWeights);
+
+    MazeBuilder* builder = nullptr;
+    if (!reader.Failed() && (flags & MAZE_CHECKPOINT_BUILDER))
+    {
+        builder = new MazeBuilder(maze);
+
+        uint8_t algorithm = 0;
+        reader.Read(algorithm);
+        builder->m_SelectedAlgorithm = static_cast<MazeBuilder::Algorithms>(algorithm);
+        reader.Read(builder->m_Completed);
+        reader.Read(builder->m_StartCoordinate);
+        reader.Read(builder->m_Seed);
+        reader.ReadGenerator(builder->m_Generator);
+        reader.ReadVector(builder->m_Path);
+        reader.ReadDeque(GetContainer(builder->m_Stack));
+
+        uint8_t hasCells = 0;
+        reader.Read(hasCells);
+        if (hasCells)
+        {
+            builder->m_Cells = new DisjointSet(0);
+            reader.ReadVector(builder->m_Cells->parent);
+            reader.ReadVector(builder->m_Cells->rank);
+        }
+        reader.ReadVector(builder->m_WallShuffler);
+
+        reader.ReadVector(builder->m_ElementsLeft);
+        reader.Read(builder->m_RandomWalkStart);
+        reader.Read(builder->m_RandomWalkEnd);
+
+        MazeStreamBuilder& eller = builder->m_Eller;
+        uint32_t cellsAcrossWidth = 0, cellsAcrossHeight = 0;
+        reader.Read(cellsAcrossWidth);
+        reader.Read(cellsAcrossHeight);
+        eller.Reset(cellsAcrossWidth, cellsAcrossHeight, 0);
+        reader.Read(eller.m_NextColumn);
+        reader.ReadGenerator(eller.m_Generator);
+        reader.Read(eller.m_RandomBits);
+        reader.Read(eller.m_RandomBitCount);
+        reader.ReadVector(eller.m_Sets);
+
+        if (!reader.Failed() && builder->m_SelectedAlgorithm == MazeBuilder::WILSON && !builder->m_Completed)
+        {
+            builder->IndexWilson();
+            // Wilson used to pick its first cell in its first step, checkpoints from before that step still have every cell left
+            if (builder->m_ElementsLeft.size() == maze->m_MazeArea)
+                builder->StartWilson();
+        }
+    }
+
+    MazeSolver* solver = nullptr;
+    if (!reader.Failed() && (flags & MAZE_CHECKPOINT_SOLVER))
+    {
+        solver = new MazeSolver(maze);
+
+        uint8_t algorithm = 0;
+        reader.Read(algorithm);
+        solver->m_SelectedAlgorithm = static_cast<MazeSolver::Algorithms>(algorithm);
+        reader.Read(solver->m_Completed);
+        reader.Read(state.route);
+        solver->m_Route = &state.route;
+        reader.Read(solver->m_Seed);
+        reader.ReadGenerator(solver->m_Generator);
+        reader.ReadPath(solver->m_Path, maze->m_CellsAcrossHeight);
+        reader.ReadVector(solver->m_Parent);
+        reader.ReadDeque(GetContainer(solver->m_Stack));
+        reader.ReadDeque(GetContainer(solver->m_Queue));
+        reader.ReadVector(GetContainer(solver->m_PQueue));
+        reader.ReadVector(solver->m_Nodes);
+        reader.ReadVector(solver->m_CompactNodes);
+    }
+    else
+    {
+        reader.Read(state.route);
+    }
+
+    if (reader.Failed() || maze->m_VisitedCellInfo.size() != maze->m_MazeArea)
+    {
+        delete solver;
+        delete builder;
+        delete maze;
+        return false;
+    }
+
+    state.maze = maze;
+    state.builder = builder;
+    state.solver = solver;
+    return true;
+}
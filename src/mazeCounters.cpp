@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+
+#ifdef __linux__
+    #include <linux/perf_event.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+#include "mazeCounters.h"
+
+namespace
+{
+#ifdef __linux__
+    struct EventConfig
+    {
+        uint32_t type;
+        uint64_t config;
+    };
+
+    const EventConfig EVENT_CONFIGS[MazeCounterSample::EVENT_COUNT] =
+    {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+    };
+
+    int OpenEvent(const EventConfig& event)
+    {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = event.type;
+        attributes.config = event.config;
+        // Counting starts right away and keeps going, the work is measured by reading before and after
+        attributes.disabled = 0;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // This thread on whichever CPU it runs
+        return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+    }
+#endif
+}
+
+double MazeCounterSample::GetIpc() const
+{
+    if (!IsAvailable(CYCLES) || !IsAvailable(INSTRUCTIONS) || counts[CYCLES] == 0)
+        return 0.0;
+    return static_cast<double>(counts[INSTRUCTIONS]) / counts[CYCLES];
+}
+
+void MazeCounterSample::Add(const MazeCounterSample& other)
+{
+    for (uint32_t i = 0; i < EVENT_COUNT; i++)
+        counts[i] += other.counts[i];
+    cells += other.cells;
+    available |= other.available;
+}
+
+const char* MazeCounterSample::GetEventName(Events event)
+{
+    switch (event)
+    {
+    case CYCLES: return "Cycles";
+    case INSTRUCTIONS: return "Instructions";
+    case L1D_MISSES: return "L1D Misses";
+    case LLC_MISSES: return "LLC Misses";
+    case BRANCH_MISSES: return "Branch Misses";
+    default: return "Unknown";
+    }
+}
+
+MazeCounters::MazeCounters()
+{
+    std::fill(std::begin(m_Files), std::end(m_Files), -1);
+}
+
+MazeCounters::~MazeCounters()
+{
+    Close();
+}
+
+bool MazeCounters::Open()
+{
+    Close();
+
+#ifdef __linux__
+    for (uint32_t i = 0; i < MazeCounterSample::EVENT_COUNT; i++)
+    {
+        m_Files[i] = OpenEvent(EVENT_CONFIGS[i]);
+        if (m_Files[i] >= 0)
+            m_Available |= 1 << i;
+        else if (m_Error.empty())
+            m_Error = std::string(MazeCounterSample::GetEventName(static_cast<MazeCounterSample::Events>(i))) + ": " + std::strerror(errno);
+    }
+
+    if (m_Available == 0)
+    {
+        // EACCES and EPERM come from perf_event_paranoid, ENOENT and EOPNOTSUPP from a CPU or VM without counters
+        m_Error = "perf_event_open failed, " + m_Error;
+        return false;
+    }
+    return true;
+#else
+    m_Error = "hardware counters are only read on Linux";
+    return false;
+#endif
+}
+
+void MazeCounters::Close()
+{
+#ifdef __linux__
+    for (int& file : m_Files)
+    {
+        if (file >= 0)
+            close(file);
+        file = -1;
+    }
+#endif
+    m_Available = 0;
+    m_Error.clear();
+}
+
+MazeCounterSample MazeCounters::Read() const
+{
+    MazeCounterSample sample;
+#ifdef __linux__
+    for (uint32_t i = 0; i < MazeCounterSample::EVENT_COUNT; i++)
+    {
+        if (m_Files[i] < 0)
+            continue;
+
+        // Value, time enabled and time running
+        uint64_t values[3]{};
+        if (read(m_Files[i], values, sizeof(values)) != sizeof(values))
+            continue;
+
+        if (values[2] > 0 && values[2] < values[1])
+            values[0] = static_cast<uint64_t>(static_cast<double>(values[0]) * values[1] / values[2]);
+        sample.counts[i] = values[0];
+        sample.available |= 1 << i;
+    }
+#endif
+    return sample;
+}
+
+MazeCounterSample MazeCounters::Difference(const MazeCounterSample& start, const MazeCounterSample& end)
+{
+    MazeCounterSample difference;
+    difference.available = start.available & end.available;
+    for (uint32_t i = 0; i < MazeCounterSample::EVENT_COUNT; i++)
+    {
+        // Scaling of multiplexed counters can make a total go down a little
+        if (difference.IsAvailable(static_cast<MazeCounterSample::Events>(i)) && end.counts[i] > start.counts[i])
+            difference.counts[i] = end.counts[i] - start.counts[i];
+    }
+    difference.cells = end.cells > start.cells ? end.cells - start.cells : 0;
+    return difference;
+}
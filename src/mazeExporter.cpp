@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#include "maze.h"
+#include "mazeSolver.h"
+#include "mazeExporter.h"
+
+namespace
+{
+    // Colours are blended over the black clear colour the same way the renderer does
+    void ToRgb(const float color[4], uint8_t rgb[3])
+    {
+        for (uint32_t i = 0; i < 3; i++)
+            rgb[i] = static_cast<uint8_t>(std::clamp(color[i] * color[3], 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc)
+    {
+        static const std::vector<uint32_t> table = []()
+            {
+                std::vector<uint32_t> values(256);
+                for (uint32_t i = 0; i < 256; i++)
+                {
+                    uint32_t value = i;
+                    for (uint32_t j = 0; j < 8; j++)
+                        value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+                    values[i] = value;
+                }
+                return values;
+            }();
+
+        crc = ~crc;
+        for (size_t i = 0; i < size; i++)
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    void PushBigEndian(std::vector<uint8_t>& buffer, uint32_t value)
+    {
+        buffer.push_back(static_cast<uint8_t>(value >> 24));
+        buffer.push_back(static_cast<uint8_t>(value >> 16));
+        buffer.push_back(static_cast<uint8_t>(value >> 8));
+        buffer.push_back(static_cast<uint8_t>(value));
+    }
+
+    void WriteChunk(std::ofstream& file, const char* type, const std::vector<uint8_t>& data)
+    {
+        std::vector<uint8_t> header;
+        PushBigEndian(header, static_cast<uint32_t>(data.size()));
+        header.insert(header.end(), type, type + 4);
+
+        uint32_t crc = Crc32(header.data() + 4, 4, 0);
+        crc = Crc32(data.data(), data.size(), crc);
+
+        std::vector<uint8_t> footer;
+        PushBigEndian(footer, crc);
+
+        file.write(reinterpret_cast<const char*>(header.data()), header.size());
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        file.write(reinterpret_cast<const char*>(footer.data()), footer.size());
+    }
+}
+
+void MazeExporter::Render(const Maze& maze, uint16_t cellPixelSize, const MazeSolver* solver, const std::pair<uint32_t, uint32_t>* route)
+{
+    const uint32_t cellsAcrossWidth = maze.m_CellsAcrossWidth;
+    const uint32_t cellsAcrossHeight = maze.m_CellsAcrossHeight;
+    const uint32_t pitch = std::max<uint32_t>(1, cellPixelSize);
+
+    m_Width = cellsAcrossWidth * pitch;
+    m_Height = cellsAcrossHeight * pitch;
+    // Walls are whatever is not covered by a cell, black like the cleared framebuffer
+    m_Pixels.assign(static_cast<size_t>(m_Width) * m_Height * 3, 0);
+
+    if (m_Pixels.empty() || maze.m_VisitedCellInfo.size() != maze.m_MazeArea)
+        return;
+
+    // Same proportions as the renderer, a wall never disappears as long as there is room for it
+    uint32_t wallPixels = (pitch * maze.m_WallThickness + maze.m_TotalCellHeight / 2) / maze.m_TotalCellHeight;
+    if (maze.m_WallThickness > 0 && pitch > 1)
+        wallPixels = std::max(wallPixels, 1u);
+    wallPixels = std::min(wallPixels, pitch - 1);
+    const uint32_t innerPixels = pitch - wallPixels;
+
+    uint32_t linePixels = (pitch * maze.m_LineThickness + maze.m_TotalCellHeight / 2) / maze.m_TotalCellHeight;
+    linePixels = std::clamp(linePixels, 1u, innerPixels);
+
+    enum Palette
+    {
+        BACKGROUND = 0,
+        VISITED,
+        SEARCHED,
+        START,
+        END,
+        PALETTE_COUNT
+    };
+
+    uint8_t palette[PALETTE_COUNT][3];
+    ToRgb(maze.m_ColorBackground, palette[BACKGROUND]);
+    ToRgb(maze.m_ColorMaze, palette[VISITED]);
+    ToRgb(maze.m_ColorSearched, palette[SEARCHED]);
+    ToRgb(maze.m_ColorStart, palette[START]);
+    ToRgb(maze.m_ColorEnd, palette[END]);
+
+    uint8_t pathColor[3];
+    ToRgb(m_ColorPath, pathColor);
+
+    const PackedPath* path = (solver && solver->m_Completed) ? &solver->m_Path : nullptr;
+
+    auto fillRect = [&](uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1, const uint8_t rgb[3])
+        {
+            for (uint32_t y = y0; y < y1; y++)
+            {
+                uint8_t* pixel = &m_Pixels[(static_cast<size_t>(y) * m_Width + x0) * 3];
+                for (uint32_t x = x0; x < x1; x++, pixel += 3)
+                {
+                    pixel[0] = rgb[0];
+                    pixel[1] = rgb[1];
+                    pixel[2] = rgb[2];
+                }
+            }
+        };
+
+    // Image row 0 is cell row 0, which is also what the scene window shows at the top
+    auto renderRows = [&](uint32_t rowBegin, uint32_t rowEnd)
+        {
+            for (uint32_t y = rowBegin; y < rowEnd; y++)
+            {
+                for (uint32_t x = 0; x < cellsAcrossWidth; x++)
+                {
+                    uint32_t cell = x * cellsAcrossHeight + y;
+                    uint16_t info = maze.m_VisitedCellInfo[cell];
+
+                    Palette color = BACKGROUND;
+                    if (route && cell == route->first)
+                        color = START;
+                    else if (route && cell == route->second)
+                        color = END;
+                    else if (info & Maze::CELL_SEARCHED)
+                        color = SEARCHED;
+                    else if (info & Maze::CELL_VISITED)
+                        color = VISITED;
+
+                    // Like DrawMaze, an open wall is covered by stretching the cell over it
+                    uint32_t right = x * pitch + ((info & Maze::CELL_EAST) ? pitch : innerPixels);
+                    uint32_t bottom = y * pitch + ((info & Maze::CELL_NORTH) ? pitch : innerPixels);
+                    fillRect(x * pitch, right, y * pitch, bottom, palette[color]);
+                }
+            }
+
+            if (!path || path->size() < 2)
+                return;
+
+            // Every band draws the part of the path inside its own rows
+            uint32_t pixelBegin = rowBegin * pitch;
+            uint32_t pixelEnd = rowEnd * pitch;
+            uint32_t halfInner = innerPixels / 2;
+            uint32_t halfLine = linePixels / 2;
+
+            uint32_t first = path->front();
+            for (auto cell = ++path->begin(); cell != path->end(); first = *cell, ++cell)
+            {
+                uint32_t second = *cell;
+                if (first >= maze.m_MazeArea || second >= maze.m_MazeArea)
+                    continue;
+
+                uint32_t x1 = (first / cellsAcrossHeight) * pitch + halfInner;
+                uint32_t y1 = (first % cellsAcrossHeight) * pitch + halfInner;
+                uint32_t x2 = (second / cellsAcrossHeight) * pitch + halfInner;
+                uint32_t y2 = (second % cellsAcrossHeight) * pitch + halfInner;
+
+                // Rectangle between the two centres, as thick as the line in both directions
+                uint32_t left = std::min(x1, x2) - std::min(std::min(x1, x2), halfLine);
+                uint32_t right = std::min(std::max(x1, x2) - halfLine + linePixels, m_Width);
+                uint32_t top = std::min(y1, y2) - std::min(std::min(y1, y2), halfLine);
+                uint32_t bottom = std::min(std::max(y1, y2) - halfLine + linePixels, m_Height);
+
+                top = std::max(top, pixelBegin);
+                bottom = std::min(bottom, pixelEnd);
+                if (top < bottom)
+                    fillRect(left, right, top, bottom, pathColor);
+            }
+        };
+
+    uint32_t threadCount = m_ThreadCount ? m_ThreadCount : std::thread::hardware_concurrency();
+    // Small thumbnails are faster on one thread than with the cost of starting more
+    threadCount = std::max(1u, std::min(threadCount, m_Height / 256));
+
+    uint32_t rowsPerThread = (cellsAcrossHeight + threadCount - 1) / threadCount;
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < threadCount; i++)
+    {
+        uint32_t rowBegin = std::min(i * rowsPerThread, cellsAcrossHeight);
+        uint32_t rowEnd = std::min((i + 1) * rowsPerThread, cellsAcrossHeight);
+        if (rowBegin < rowEnd)
+            threads.emplace_back(renderRows, rowBegin, rowEnd);
+    }
+    renderRows(0, std::min(rowsPerThread, cellsAcrossHeight));
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+bool MazeExporter::WritePPM(const std::string& filePath) const
+{
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Failed to open " << filePath << " for writing" << std::endl;
+        return false;
+    }
+
+    file << "P6\n" << m_Width << ' ' << m_Height << "\n255\n";
+    file.write(reinterpret_cast<const char*>(m_Pixels.data()), m_Pixels.size());
+
+    return file.good();
+}
+
+bool MazeExporter::WritePNG(const std::string& filePath) const
+{
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Failed to open " << filePath << " for writing" << std::endl;
+        return false;
+    }
+
+    const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    // 8 bit depth, RGB, default compression/filter, no interlace
+    std::vector<uint8_t> header;
+    PushBigEndian(header, m_Width);
+    PushBigEndian(header, m_Height);
+    header.insert(header.end(), { 8, 2, 0, 0, 0 });
+    WriteChunk(file, "IHDR", header);
+
+    // Every row starts with filter type 0, the zlib stream is made of stored blocks of up to 65535 bytes
+    const size_t rowBytes = static_cast<size_t>(m_Width) * 3;
+    const size_t rawBytes = (rowBytes + 1) * m_Height;
+    const size_t maxBlock = 65535;
+
+    std::vector<uint8_t> data;
+    data.reserve(rawBytes + (rawBytes / maxBlock + 1) * 5 + 6);
+    data.push_back(0x78);
+    data.push_back(0x01);
+
+    uint32_t adlerA = 1, adlerB = 0;
+    size_t blockLeft = 0;
+    size_t rawLeft = rawBytes;
+
+    auto pushRaw = [&](const uint8_t* bytes, size_t size)
+        {
+            while (size > 0)
+            {
+                if (blockLeft == 0)
+                {
+                    blockLeft = std::min(rawLeft, maxBlock);
+                    rawLeft -= blockLeft;
+                    uint16_t length = static_cast<uint16_t>(blockLeft);
+                    data.push_back(rawLeft == 0 ? 1 : 0);
+                    data.push_back(static_cast<uint8_t>(length));
+                    data.push_back(static_cast<uint8_t>(length >> 8));
+                    data.push_back(static_cast<uint8_t>(~length));
+                    data.push_back(static_cast<uint8_t>(~length >> 8));
+                }
+
+                size_t count = std::min(size, blockLeft);
+                data.insert(data.end(), bytes, bytes + count);
+
+                // 5552 is the most bytes that can be summed before the 32 bit sums could overflow
+                for (size_t i = 0; i < count; i += 5552)
+                {
+                    size_t end = std::min(count, i + 5552);
+                    for (size_t j = i; j < end; j++)
+                    {
+                        adlerA += bytes[j];
+                        adlerB += adlerA;
+                    }
+                    adlerA %= 65521;
+                    adlerB %= 65521;
+                }
+
+                bytes += count;
+                size -= count;
+                blockLeft -= count;
+            }
+        };
+
+    const uint8_t filter = 0;
+    for (uint32_t y = 0; y < m_Height; y++)
+    {
+        pushRaw(&filter, 1);
+        pushRaw(&m_Pixels[y * rowBytes], rowBytes);
+    }
+
+    PushBigEndian(data, (adlerB << 16) | adlerA);
+    WriteChunk(file, "IDAT", data);
+    WriteChunk(file, "IEND", {});
+
+    return file.good();
+}
+
+bool MazeExporter::Write(const std::string& filePath) const
+{
+    std::string extension = filePath.substr(filePath.find_last_of('.') + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (extension == "ppm")
+        return WritePPM(filePath);
+    if (extension == "png")
+        return WritePNG(filePath);
+
+    std::cout << "Unknown image format " << filePath << ", use .png or .ppm" << std::endl;
+    return false;
+}
+
+uint32_t MazeExporter::GetWidth() const
+{
+    return m_Width;
+}
+
+uint32_t MazeExporter::GetHeight() const
+{
+    return m_Height;
+}
+
+const std::vector<uint8_t>& MazeExporter::GetPixels() const
+{
+    return m_Pixels;
+}
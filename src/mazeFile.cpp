@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "maze.h"
+#include "mazeFile.h"
+#include "mazeWeights.h"
+
+namespace
+{
+    // Runs function(begin, end) over [0, count) split between the hardware threads,
+    // ranges start at multiples of alignment so no two threads share a byte of the wall plane
+    template<typename Function>
+    void ForEachRange(uint64_t count, uint64_t alignment, Function function)
+    {
+        uint64_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+        // Not worth starting threads for small mazes
+        threadCount = std::min<uint64_t>(threadCount, count / (1 << 16) + 1);
+
+        uint64_t perThread = (count + threadCount - 1) / threadCount;
+        perThread = (perThread + alignment - 1) / alignment * alignment;
+
+        std::vector<std::thread> threads;
+        for (uint64_t begin = perThread; begin < count; begin += perThread)
+            threads.emplace_back(function, begin, std::min(begin + perThread, count));
+        function(0, std::min(perThread, count));
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+}
+
+uint64_t MazeFile::GetWallPlaneSize(uint64_t mazeArea)
+{
+    return ((mazeArea + 3) / 4 + 7) / 8 * 8;
+}
+
+bool MazeFile::Save(const std::string& filePath, const Maze& maze, bool withWeights)
+{
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Failed to open " << filePath << " for writing" << std::endl;
+        return false;
+    }
+
+    withWeights = withWeights && maze.m_CellWeights.size() == maze.m_MazeArea;
+
+    MazeFileHeader header;
+    header.flags = withWeights ? MAZE_FILE_WEIGHTS : 0;
+    header.cellsAcrossWidth = maze.m_CellsAcrossWidth;
+    header.cellsAcrossHeight = maze.m_CellsAcrossHeight;
+    header.seed = maze.m_Seed;
+    header.builder = maze.m_Builder;
+
+    std::vector<uint8_t> wallPlane(GetWallPlaneSize(maze.m_MazeArea), 0);
+    const std::vector<uint16_t>& cellInfo = maze.m_VisitedCellInfo;
+
+    ForEachRange(maze.m_MazeArea, 4, [&](uint64_t begin, uint64_t end)
+        {
+            for (uint64_t cell = begin; cell < end; cell++)
+            {
+                uint8_t bits = ((cellInfo[cell] & Maze::CELL_NORTH) ? 0x01 : 0x00) | ((cellInfo[cell] & Maze::CELL_EAST) ? 0x02 : 0x00);
+                wallPlane[cell / 4] |= bits << ((cell % 4) * 2);
+            }
+        });
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(wallPlane.data()), wallPlane.size());
+    if (withWeights)
+        MazeWeights::WriteRaw(file, maze.m_CellWeights);
+
+    if (!file.good())
+    {
+        std::cout << "Failed to write " << filePath << std::endl;
+        return false;
+    }
+
+    std::cout << "Maze saved to " << filePath << std::endl;
+    return true;
+}
+
+Maze* MazeFile::Load(const std::string& filePath, uint16_t cellWidth, uint16_t wallThickness)
+{
+    MappedMazeFile mapped;
+    if (!mapped.Open(filePath))
+        return nullptr;
+
+    return mapped.CreateMaze(cellWidth, wallThickness);
+}
+
+MappedMazeFile::~MappedMazeFile()
+{
+    Close();
+}
+
+bool MappedMazeFile::Open(const std::string& filePath)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER size{};
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(MazeFileHeader)))
+    {
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        std::cout << "Failed to open " << filePath << std::endl;
+        return false;
+    }
+
+    m_File = file;
+    m_Size = static_cast<uint64_t>(size.QuadPart);
+    m_Mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_Mapping)
+        m_Data = static_cast<const uint8_t*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+    int file = open(filePath.c_str(), O_RDONLY);
+    struct stat status{};
+    if (file < 0 || fstat(file, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(MazeFileHeader)))
+    {
+        if (file >= 0)
+            close(file);
+        std::cout << "Failed to open " << filePath << std::endl;
+        return false;
+    }
+
+    m_Size = static_cast<uint64_t>(status.st_size);
+    void* data = mmap(nullptr, m_Size, PROT_READ, MAP_SHARED, file, 0);
+    // The mapping keeps the file alive on its own
+    close(file);
+    if (data != MAP_FAILED)
+        m_Data = static_cast<const uint8_t*>(data);
+#endif
+
+    if (!m_Data)
+    {
+        std::cout << "Failed to map " << filePath << std::endl;
+        Close();
+        return false;
+    }
+
+    m_Header = reinterpret_cast<const MazeFileHeader*>(m_Data);
+    uint64_t mazeArea = static_cast<uint64_t>(m_Header->cellsAcrossWidth) * m_Header->cellsAcrossHeight;
+    uint64_t wallPlaneSize = MazeFile::GetWallPlaneSize(mazeArea);
+    uint64_t expectedSize = sizeof(MazeFileHeader) + wallPlaneSize + ((m_Header->flags & MAZE_FILE_WEIGHTS) ? mazeArea * sizeof(uint32_t) : 0);
+
+    if (std::memcmp(m_Header->magic, "MAZE", 4) != 0 || m_Header->version == 0 || m_Header->version > MazeFile::VERSION)
+    {
+        std::cout << filePath << " is not a maze file this version can read" << std::endl;
+        Close();
+        return false;
+    }
+    if (mazeArea == 0 || m_Size < expectedSize)
+    {
+        std::cout << filePath << " is truncated or has invalid dimensions" << std::endl;
+        Close();
+        return false;
+    }
+
+    m_WallPlane = m_Data + sizeof(MazeFileHeader);
+    if (m_Header->flags & MAZE_FILE_WEIGHTS)
+        m_Weights = reinterpret_cast<const uint32_t*>(m_WallPlane + wallPlaneSize);
+
+    return true;
+}
+
+void MappedMazeFile::Close()
+{
+#ifdef _WIN32
+    if (m_Data)
+        UnmapViewOfFile(m_Data);
+    if (m_Mapping)
+        CloseHandle(m_Mapping);
+    if (m_File)
+        CloseHandle(m_File);
+    m_Mapping = nullptr;
+    m_File = nullptr;
+#else
+    if (m_Data)
+        munmap(const_cast<uint8_t*>(m_Data), m_Size);
+#endif
+
+    m_Data = nullptr;
+    m_Size = 0;
+    m_Header = nullptr;
+    m_WallPlane = nullptr;
+    m_Weights = nullptr;
+}
+
+bool MappedMazeFile::IsOpen() const
+{
+    return m_Data != nullptr;
+}
+
+const MazeFileHeader& MappedMazeFile::GetHeader() const
+{
+    return *m_Header;
+}
+
+uint64_t MappedMazeFile::GetMazeArea() const
+{
+    return m_Header ? static_cast<uint64_t>(m_Header->cellsAcrossWidth) * m_Header->cellsAcrossHeight : 0;
+}
+
+uint8_t MappedMazeFile::GetWallBits(uint64_t cell) const
+{
+    return (m_WallPlane[cell / 4] >> ((cell % 4) * 2)) & 0x03;
+}
+
+uint16_t MappedMazeFile::GetCellInfo(uint64_t cell) const
+{
+    const uint32_t cellsAcrossHeight = m_Header->cellsAcrossHeight;
+
+    uint8_t bits = GetWallBits(cell);
+    uint16_t info = Maze::CELL_VISITED;
+    if (bits & 0x01)
+        info |= Maze::CELL_NORTH;
+    if (bits & 0x02)
+        info |= Maze::CELL_EAST;
+    if (cell % cellsAcrossHeight != 0 && (GetWallBits(cell - 1) & 0x01))
+        info |= Maze::CELL_SOUTH;
+    if (cell >= cellsAcrossHeight && (GetWallBits(cell - cellsAcrossHeight) & 0x02))
+        info |= Maze::CELL_WEST;
+
+    return info;
+}
+
+const uint32_t* MappedMazeFile::GetWeights() const
+{
+    return m_Weights;
+}
+
+Maze* MappedMazeFile::CreateMaze(uint16_t cellWidth, uint16_t wallThickness) const
+{
+    if (!IsOpen())
+        return nullptr;
+
+    if (GetMazeArea() > std::numeric_limits<uint32_t>::max())
+    {
+        std::cout << "Maze has too many cells to load, it can only be read through the mapping" << std::endl;
+        return nullptr;
+    }
+
+    // Pixel size is chosen so that the maze ends up with exactly the cells of the file
+    uint64_t totalCellHeight = 2 * static_cast<uint64_t>(cellWidth) + wallThickness;
+    uint64_t width = m_Header->cellsAcrossWidth * totalCellHeight;
+    uint64_t height = m_Header->cellsAcrossHeight * totalCellHeight;
+    if (width > std::numeric_limits<uint32_t>::max() || height > std::numeric_limits<uint32_t>::max())
+    {
+        std::cout << "Maze is too large for a cell width of " << cellWidth << std::endl;
+        return nullptr;
+    }
+
+    Maze* maze = new Maze(static_cast<uint32_t>(width), static_cast<uint32_t>(height), cellWidth, wallThickness, false);
+    uint32_t mazeArea = maze->m_MazeArea;
+
+    // Column by column so the south and west walls come from the previous cell and column without any division
+    const uint32_t cellsAcrossHeight = maze->m_CellsAcrossHeight;
+    ForEachRange(maze->m_CellsAcrossWidth, 1, [&](uint64_t columnBegin, uint64_t columnEnd)
+        {
+            for (uint64_t x = columnBegin; x < columnEnd; x++)
+            {
+                uint32_t cell = static_cast<uint32_t>(x) * cellsAcrossHeight;
+                uint16_t* info = &maze->m_VisitedCellInfo[cell];
+                uint8_t previousBits = 0;
+
+                for (uint32_t y = 0; y < cellsAcrossHeight; y++, cell++)
+                {
+                    uint8_t bits = GetWallBits(cell);
+                    uint16_t value = Maze::CELL_VISITED;
+                    value |= (bits & 0x01) ? Maze::CELL_NORTH : 0;
+                    value |= (bits & 0x02) ? Maze::CELL_EAST : 0;
+                    value |= (previousBits & 0x01) ? Maze::CELL_SOUTH : 0;
+                    if (x > 0 && (GetWallBits(cell - cellsAcrossHeight) & 0x02))
+                        value |= Maze::CELL_WEST;
+
+                    info[y] = value;
+                    previousBits = bits;
+                }
+            }
+        });
+    maze->m_VisitedCellCount = mazeArea;
+
+    if (m_Weights)
+        maze->m_CellWeights.Assign(m_Weights, mazeArea);
+    else
+        maze->SetCellWeights();
+
+    maze->m_Builder = m_Header->builder;
+    maze->m_Seed = static_cast<uint32_t>(m_Header->seed);
+
+    return maze;
+}
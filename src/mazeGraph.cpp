@@ -0,0 +1,280 @@
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+#include "maze.h"
+#include "mazeFile.h"
+#include "mazeGraph.h"
+#include "mazeMemory.h"
+
+namespace
+{
+    // Text output is formatted into a block and written out whenever it fills up
+    class TextWriter
+    {
+    public:
+        explicit TextWriter(std::ofstream& file) : m_File(file) { m_Buffer.reserve(BLOCK_SIZE + 64); }
+        ~TextWriter() { Flush(); }
+
+        void Write(const char* text)
+        {
+            for (; *text; text++)
+                m_Buffer.push_back(*text);
+        }
+
+        void Write(uint64_t value)
+        {
+            char digits[24];
+            char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+            m_Buffer.insert(m_Buffer.end(), digits, end);
+        }
+
+        void EndLine()
+        {
+            m_Buffer.push_back('\n');
+            if (m_Buffer.size() >= BLOCK_SIZE)
+                Flush();
+        }
+
+        void Flush()
+        {
+            m_File.write(m_Buffer.data(), m_Buffer.size());
+            m_Buffer.clear();
+        }
+
+    private:
+        static constexpr size_t BLOCK_SIZE = 1 << 20;
+        std::ofstream& m_File;
+        std::vector<char> m_Buffer;
+    };
+
+    bool OpenForWriting(std::ofstream& file, const std::string& filePath, std::ios::openmode mode)
+    {
+        file.open(filePath, mode);
+        if (!file.is_open())
+            std::cout << "Failed to open " << filePath << " for writing" << std::endl;
+        return file.is_open();
+    }
+
+    bool FinishWriting(std::ofstream& file, const std::string& filePath)
+    {
+        file.flush();
+        if (!file.good())
+        {
+            std::cout << "Failed to write " << filePath << std::endl;
+            return false;
+        }
+        std::cout << "Graph written to " << filePath << std::endl;
+        return true;
+    }
+}
+
+bool MazeGraph::Build(const Maze& maze, bool withWeights)
+{
+    const std::vector<uint16_t>& cellInfo = maze.m_VisitedCellInfo;
+    if (!BuildAdjacency(maze.m_MazeArea, maze.m_CellsAcrossHeight, [&](uint32_t cell) { return cellInfo[cell]; }))
+        return false;
+
+    m_Weights.clear();
+    if (withWeights)
+        SetWeights(maze.m_CellWeights);
+
+    return true;
+}
+
+bool MazeGraph::Build(const MappedMazeFile& file, bool withWeights)
+{
+    if (!file.IsOpen() || file.GetMazeArea() > std::numeric_limits<uint32_t>::max())
+    {
+        std::cout << "Maze file has too many cells for a graph" << std::endl;
+        Clear();
+        return false;
+    }
+
+    if (!BuildAdjacency(static_cast<uint32_t>(file.GetMazeArea()), file.GetHeader().cellsAcrossHeight,
+        [&](uint32_t cell) { return file.GetCellInfo(cell); }))
+        return false;
+
+    m_Weights.clear();
+    const uint32_t* weights = file.GetWeights();
+    if (withWeights && weights)
+    {
+        m_Weights.resize(m_Targets.size());
+        for (size_t edge = 0; edge < m_Targets.size(); edge++)
+            m_Weights[edge] = weights[m_Targets[edge]];
+    }
+
+    return true;
+}
+
+template<typename CellInfo>
+bool MazeGraph::BuildAdjacency(uint32_t mazeArea, uint32_t cellsAcrossHeight, CellInfo cellInfo)
+{
+    // Wall flags are only ever set towards cells inside the maze so the degree is just the open walls
+    uint64_t edgeCount = 0;
+    for (uint32_t cell = 0; cell < mazeArea; cell++)
+    {
+        uint16_t walls = cellInfo(cell);
+        edgeCount += ((walls >> 0) & 1) + ((walls >> 1) & 1) + ((walls >> 2) & 1) + ((walls >> 3) & 1);
+    }
+    if (edgeCount > std::numeric_limits<uint32_t>::max())
+    {
+        std::cout << "Maze has too many passages for a graph" << std::endl;
+        Clear();
+        return false;
+    }
+
+    m_Offsets.resize(static_cast<size_t>(mazeArea) + 1);
+    m_Targets.resize(edgeCount);
+
+    uint32_t edge = 0;
+    for (uint32_t cell = 0; cell < mazeArea; cell++)
+    {
+        m_Offsets[cell] = edge;
+        uint16_t walls = cellInfo(cell);
+        if (walls & Maze::CELL_NORTH)
+            m_Targets[edge++] = cell + 1;
+        if (walls & Maze::CELL_EAST)
+            m_Targets[edge++] = cell + cellsAcrossHeight;
+        if (walls & Maze::CELL_SOUTH)
+            m_Targets[edge++] = cell - 1;
+        if (walls & Maze::CELL_WEST)
+            m_Targets[edge++] = cell - cellsAcrossHeight;
+    }
+    m_Offsets[mazeArea] = edge;
+    return true;
+}
+
+void MazeGraph::Clear()
+{
+    m_Offsets.clear();
+    m_Targets.clear();
+    m_Weights.clear();
+}
+
+bool MazeGraph::IsBuilt() const
+{
+    return !m_Offsets.empty();
+}
+
+void MazeGraph::SetWeights(const NarrowVector& cellWeights)
+{
+    if (cellWeights.size() + 1 != m_Offsets.size())
+    {
+        m_Weights.clear();
+        return;
+    }
+
+    m_Weights.resize(m_Targets.size());
+    cellWeights.Visit([&](const auto& weights)
+        {
+            for (size_t edge = 0; edge < m_Targets.size(); edge++)
+                m_Weights[edge] = weights[m_Targets[edge]];
+        });
+}
+
+uint32_t MazeGraph::GetVertexCount() const
+{
+    return m_Offsets.empty() ? 0 : static_cast<uint32_t>(m_Offsets.size() - 1);
+}
+
+uint64_t MazeGraph::GetEdgeCount() const
+{
+    return m_Targets.size();
+}
+
+bool MazeGraph::WriteBinary(const std::string& filePath) const
+{
+    std::ofstream file;
+    if (!OpenForWriting(file, filePath, std::ios::binary))
+        return false;
+
+    MazeGraphHeader header;
+    header.flags = m_Weights.empty() ? 0 : MAZE_FILE_WEIGHTS;
+    header.vertexCount = GetVertexCount();
+    header.edgeCount = GetEdgeCount();
+
+    // Straight from the arrays, nothing is converted
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(m_Offsets.data()), m_Offsets.size() * sizeof(uint32_t));
+    file.write(reinterpret_cast<const char*>(m_Targets.data()), m_Targets.size() * sizeof(uint32_t));
+    file.write(reinterpret_cast<const char*>(m_Weights.data()), m_Weights.size() * sizeof(uint32_t));
+
+    return FinishWriting(file, filePath);
+}
+
+bool MazeGraph::WriteEdgeList(const std::string& filePath) const
+{
+    std::ofstream file;
+    if (!OpenForWriting(file, filePath, std::ios::binary))
+        return false;
+
+    {
+        TextWriter writer(file);
+        const uint32_t vertexCount = GetVertexCount();
+        for (uint32_t cell = 0; cell < vertexCount; cell++)
+        {
+            for (uint32_t edge = m_Offsets[cell]; edge < m_Offsets[cell + 1]; edge++)
+            {
+                // Each passage is stored twice, only write it from the lower cell
+                if (m_Targets[edge] < cell)
+                    continue;
+
+                writer.Write(cell);
+                writer.Write(" ");
+                writer.Write(m_Targets[edge]);
+                if (!m_Weights.empty())
+                {
+                    writer.Write(" ");
+                    writer.Write(m_Weights[edge]);
+                }
+                writer.EndLine();
+            }
+        }
+    }
+
+    return FinishWriting(file, filePath);
+}
+
+bool MazeGraph::WriteDimacs(const std::string& filePath) const
+{
+    std::ofstream file;
+    if (!OpenForWriting(file, filePath, std::ios::binary))
+        return false;
+
+    {
+        TextWriter writer(file);
+        writer.Write("c Maze passages, cell numbers are x * cells across height + y + 1");
+        writer.EndLine();
+        writer.Write("p sp ");
+        writer.Write(GetVertexCount());
+        writer.Write(" ");
+        writer.Write(GetEdgeCount());
+        writer.EndLine();
+
+        const uint32_t vertexCount = GetVertexCount();
+        for (uint32_t cell = 0; cell < vertexCount; cell++)
+        {
+            for (uint32_t edge = m_Offsets[cell]; edge < m_Offsets[cell + 1]; edge++)
+            {
+                writer.Write("a ");
+                writer.Write(static_cast<uint64_t>(cell) + 1);
+                writer.Write(" ");
+                writer.Write(static_cast<uint64_t>(m_Targets[edge]) + 1);
+                writer.Write(" ");
+                writer.Write(m_Weights.empty() ? 1 : m_Weights[edge]);
+                writer.EndLine();
+            }
+        }
+    }
+
+    return FinishWriting(file, filePath);
+}
+
+void MazeGraph::ReportMemory(MazeMemoryReport& report) const
+{
+    report.AddVector("Graph", "offsets", m_Offsets);
+    report.AddVector("Graph", "targets", m_Targets);
+    report.AddVector("Graph", "weights", m_Weights);
+}
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "maze.h"
+#include "mazeLod.h"
+#include "mazeMemory.h"
+#include "packedPath.h"
+
+void MazeLod::Build(const std::vector<uint16_t>& cellInfo, const PackedPath& path, uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    if (cellInfo.size() != static_cast<size_t>(cellsAcrossWidth) * cellsAcrossHeight || cellInfo.empty())
+    {
+        Clear();
+        return;
+    }
+
+    // Reuses the memory of the previous build when the maze did not change size
+    m_Levels.resize(1);
+    Level& base = m_Levels[0];
+    base.width = (cellsAcrossWidth + 1) / 2;
+    base.height = (cellsAcrossHeight + 1) / 2;
+    base.texels.resize(static_cast<size_t>(base.width) * base.height * 4);
+
+    // Every thread aggregates its own band of columns, reads and writes are both sequential
+    auto buildColumns = [&](uint32_t columnBegin, uint32_t columnEnd)
+        {
+            for (uint32_t tx = columnBegin; tx < columnEnd; tx++)
+            {
+                uint32_t xCount = std::min(2u, cellsAcrossWidth - 2 * tx);
+                for (uint32_t ty = 0; ty < base.height; ty++)
+                {
+                    uint32_t yCount = std::min(2u, cellsAcrossHeight - 2 * ty);
+                    uint32_t visited = 0, searched = 0;
+
+                    for (uint32_t i = 0; i < xCount; i++)
+                    {
+                        for (uint32_t j = 0; j < yCount; j++)
+                        {
+                            uint16_t info = cellInfo[(2 * tx + i) * cellsAcrossHeight + 2 * ty + j];
+                            visited += (info & Maze::CELL_VISITED) ? 1 : 0;
+                            searched += (info & Maze::CELL_SEARCHED) ? 1 : 0;
+                        }
+                    }
+
+                    uint32_t cells = xCount * yCount;
+                    uint8_t* texel = &base.texels[(static_cast<size_t>(tx) * base.height + ty) * 4];
+                    texel[0] = static_cast<uint8_t>(visited * 255 / cells);
+                    texel[1] = static_cast<uint8_t>(searched * 255 / cells);
+                    texel[2] = 0;
+                    texel[3] = 255;
+                }
+            }
+        };
+
+    uint32_t threadCount = std::max(1u, std::min(std::thread::hardware_concurrency(), base.width / 64));
+    std::vector<std::thread> threads;
+    uint32_t columnsPerThread = (base.width + threadCount - 1) / threadCount;
+    for (uint32_t i = 1; i < threadCount; i++)
+        threads.emplace_back(buildColumns, std::min(i * columnsPerThread, base.width), std::min((i + 1) * columnsPerThread, base.width));
+    buildColumns(0, std::min(columnsPerThread, base.width));
+    for (std::thread& thread : threads)
+        thread.join();
+
+    for (uint32_t cell : path)
+    {
+        if (cell >= cellInfo.size())
+            continue;
+
+        uint32_t x = cell / cellsAcrossHeight;
+        uint32_t y = cell % cellsAcrossHeight;
+        uint32_t cells = std::min(2u, cellsAcrossWidth - (x & ~1u)) * std::min(2u, cellsAcrossHeight - (y & ~1u));
+        uint8_t& onPath = base.texels[(static_cast<size_t>(x / 2) * base.height + y / 2) * 4 + 2];
+        onPath = static_cast<uint8_t>(std::min(255u, onPath + 255u / cells));
+    }
+
+    // Every next level is the average of 2x2 texels of the previous one
+    while (m_Levels.back().width > 1 || m_Levels.back().height > 1)
+    {
+        Level level;
+        const Level& previous = m_Levels.back();
+        level.width = (previous.width + 1) / 2;
+        level.height = (previous.height + 1) / 2;
+        level.texels.resize(static_cast<size_t>(level.width) * level.height * 4);
+
+        for (uint32_t tx = 0; tx < level.width; tx++)
+        {
+            uint32_t xCount = std::min(2u, previous.width - 2 * tx);
+            for (uint32_t ty = 0; ty < level.height; ty++)
+            {
+                uint32_t yCount = std::min(2u, previous.height - 2 * ty);
+                uint32_t sum[3] = { 0, 0, 0 };
+
+                for (uint32_t i = 0; i < xCount; i++)
+                {
+                    for (uint32_t j = 0; j < yCount; j++)
+                    {
+                        const uint8_t* child = &previous.texels[(static_cast<size_t>(2 * tx + i) * previous.height + 2 * ty + j) * 4];
+                        sum[0] += child[0];
+                        sum[1] += child[1];
+                        sum[2] += child[2];
+                    }
+                }
+
+                uint32_t children = xCount * yCount;
+                uint8_t* texel = &level.texels[(static_cast<size_t>(tx) * level.height + ty) * 4];
+                texel[0] = static_cast<uint8_t>(sum[0] / children);
+                texel[1] = static_cast<uint8_t>(sum[1] / children);
+                texel[2] = static_cast<uint8_t>(sum[2] / children);
+                texel[3] = 255;
+            }
+        }
+
+        m_Levels.push_back(std::move(level));
+    }
+
+    m_LastBuild = std::chrono::steady_clock::now();
+    m_BuildSeconds = std::chrono::duration<double>(m_LastBuild - start).count();
+}
+
+void MazeLod::Clear()
+{
+    m_Levels.clear();
+    m_BuiltSequence = 0;
+}
+
+uint32_t MazeLod::SelectLevel(float cellPixelSize) const
+{
+    if (m_Levels.empty() || cellPixelSize <= 0.0f)
+        return 0;
+
+    // Level n has 2^(n+1) cells per texel
+    int32_t level = static_cast<int32_t>(std::ceil(std::log2(1.0f / cellPixelSize))) - 1;
+    return static_cast<uint32_t>(std::clamp(level, 0, static_cast<int32_t>(m_Levels.size()) - 1));
+}
+
+uint32_t MazeLod::GetLevelCount() const
+{
+    return static_cast<uint32_t>(m_Levels.size());
+}
+
+uint32_t MazeLod::GetLevelWidth(uint32_t level) const
+{
+    return m_Levels[level].width;
+}
+
+uint32_t MazeLod::GetLevelHeight(uint32_t level) const
+{
+    return m_Levels[level].height;
+}
+
+uint32_t MazeLod::GetCellsPerTexel(uint32_t level) const
+{
+    return 2u << level;
+}
+
+const uint8_t* MazeLod::GetLevelData(uint32_t level) const
+{
+    return m_Levels[level].texels.data();
+}
+
+void MazeLod::ReportMemory(MazeMemoryReport& report) const
+{
+    uint64_t used = 0, reserved = 0;
+    for (const Level& level : m_Levels)
+    {
+        used += level.texels.size();
+        reserved += level.texels.capacity();
+    }
+    report.Add("Render", "level of detail", used, reserved);
+}
@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <string>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <unistd.h>
+#endif
+
+#include "mazeMemory.h"
+
+namespace
+{
+    double ToMegabytes(uint64_t bytes)
+    {
+        return bytes / (1024.0 * 1024.0);
+    }
+}
+
+void MazeMemoryReport::Add(const char* subsystem, const char* name, uint64_t usedBytes, uint64_t reservedBytes)
+{
+    MazeMemoryEntry entry;
+    entry.subsystem = subsystem;
+    entry.name = name;
+    entry.usedBytes = usedBytes;
+    entry.reservedBytes = reservedBytes;
+    m_Entries.push_back(entry);
+}
+
+uint64_t MazeMemoryReport::GetUsedBytes() const
+{
+    uint64_t bytes = 0;
+    for (const MazeMemoryEntry& entry : m_Entries)
+        bytes += entry.usedBytes;
+    return bytes;
+}
+
+uint64_t MazeMemoryReport::GetReservedBytes() const
+{
+    uint64_t bytes = 0;
+    for (const MazeMemoryEntry& entry : m_Entries)
+        bytes += entry.reservedBytes;
+    return bytes;
+}
+
+std::vector<MazeMemoryEntry> MazeMemoryReport::GetSubsystems() const
+{
+    std::vector<MazeMemoryEntry> subsystems;
+    for (const MazeMemoryEntry& entry : m_Entries)
+    {
+        auto subsystem = std::find_if(subsystems.begin(), subsystems.end(),
+            [&](const MazeMemoryEntry& total) { return std::strcmp(total.subsystem, entry.subsystem) == 0; });
+        if (subsystem == subsystems.end())
+        {
+            subsystems.push_back(MazeMemoryEntry());
+            subsystem = subsystems.end() - 1;
+            subsystem->subsystem = entry.subsystem;
+        }
+        subsystem->usedBytes += entry.usedBytes;
+        subsystem->reservedBytes += entry.reservedBytes;
+    }
+    return subsystems;
+}
+
+void MazeMemoryReport::Print(std::ostream& stream) const
+{
+    std::vector<MazeMemoryEntry> entries = m_Entries;
+    std::stable_sort(entries.begin(), entries.end(),
+        [](const MazeMemoryEntry& a, const MazeMemoryEntry& b) { return a.reservedBytes > b.reservedBytes; });
+
+    const std::ios_base::fmtflags flags = stream.flags();
+    const std::streamsize precision = stream.precision();
+    stream << std::fixed << std::setprecision(2);
+
+    stream << std::left << std::setw(34) << "Structure" << std::right << std::setw(12) << "Used MB" << std::setw(12) << "Reserved MB" << "\n";
+    for (const MazeMemoryEntry& entry : entries)
+    {
+        // Empty ones only make the table longer
+        if (entry.reservedBytes == 0)
+            continue;
+        stream << std::left << std::setw(34) << (std::string(entry.subsystem) + " " + entry.name) << std::right
+            << std::setw(12) << ToMegabytes(entry.usedBytes) << std::setw(12) << ToMegabytes(entry.reservedBytes) << "\n";
+    }
+    for (const MazeMemoryEntry& subsystem : GetSubsystems())
+    {
+        stream << std::left << std::setw(34) << (std::string(subsystem.subsystem) + " total") << std::right
+            << std::setw(12) << ToMegabytes(subsystem.usedBytes) << std::setw(12) << ToMegabytes(subsystem.reservedBytes) << "\n";
+    }
+    stream << std::left << std::setw(34) << "All structures" << std::right
+        << std::setw(12) << ToMegabytes(GetUsedBytes()) << std::setw(12) << ToMegabytes(GetReservedBytes()) << "\n";
+    stream << "Process resident " << ToMegabytes(GetResidentBytes()) << " MB, peak " << ToMegabytes(GetPeakResidentBytes()) << " MB" << std::endl;
+
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+uint64_t MazeMemoryReport::GetResidentBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.WorkingSetSize;
+    return 0;
+#else
+    // Second field is the resident size in pages
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0, resident = 0;
+    if (!(statm >> size >> resident))
+        return 0;
+    return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+uint64_t MazeMemoryReport::GetPeakResidentBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+    return 0;
+#else
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+    }
+    return 0;
+#endif
+}
+
+MazeMemoryHistory::MazeMemoryHistory()
+{
+    m_History.resize(HISTORY_SIZE, 0.0f);
+}
+
+bool MazeMemoryHistory::Sample(uint32_t intervalMs)
+{
+    const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (m_Count > 0 && now - m_LastSample < intervalMs)
+        return false;
+    m_LastSample = now;
+
+    m_LastBytes = MazeMemoryReport::GetResidentBytes();
+    m_History[m_Head] = static_cast<float>(ToMegabytes(m_LastBytes));
+    m_Head = (m_Head + 1) % HISTORY_SIZE;
+    if (m_Count < HISTORY_SIZE)
+        m_Count++;
+    return true;
+}
@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "maze.h"
+#include "mazeMetrics.h"
+#include "packedPath.h"
+
+namespace
+{
+    constexpr uint8_t WALLS = Maze::CELL_NORTH | Maze::CELL_EAST | Maze::CELL_SOUTH | Maze::CELL_WEST;
+    // Open walls of a cell by its wall bits
+    constexpr uint8_t DEGREE[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+    inline uint8_t Opposite(uint8_t wall)
+    {
+        return static_cast<uint8_t>(((wall << 2) | (wall >> 2)) & WALLS);
+    }
+
+    inline uint32_t Step(uint32_t cell, uint8_t wall, uint32_t cellsAcrossHeight)
+    {
+        switch (wall)
+        {
+        case Maze::CELL_NORTH: return cell + 1;
+        case Maze::CELL_EAST: return cell + cellsAcrossHeight;
+        case Maze::CELL_SOUTH: return cell - 1;
+        }
+        return cell - cellsAcrossHeight;
+    }
+
+    uint32_t HistogramBucket(uint64_t steps)
+    {
+        uint32_t bucket = 0;
+        while (steps > 1 && bucket + 1 < MazeMetrics::HISTOGRAM_SIZE)
+        {
+            steps >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+    // Columns are split between the hardware threads, every thread fills in its own metrics
+    template<typename Function>
+    void ForEachColumn(uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight, std::vector<MazeMetrics>& partials, Function function)
+    {
+        uint64_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+        // Not worth starting threads for small mazes
+        uint64_t mazeArea = static_cast<uint64_t>(cellsAcrossWidth) * cellsAcrossHeight;
+        threadCount = std::max<uint64_t>(1, std::min<uint64_t>({ threadCount, mazeArea / (1 << 16) + 1, cellsAcrossWidth }));
+
+        uint32_t perThread = static_cast<uint32_t>((cellsAcrossWidth + threadCount - 1) / threadCount);
+        partials.assign(threadCount, MazeMetrics());
+
+        std::vector<std::thread> threads;
+        for (uint32_t begin = perThread, i = 1; begin < cellsAcrossWidth; begin += perThread, i++)
+            threads.emplace_back(function, begin, std::min(begin + perThread, cellsAcrossWidth), std::ref(partials[i]));
+        function(0, std::min(perThread, cellsAcrossWidth), partials[0]);
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+}
+
+MazeMetrics MazeMetrics::Compute(const Maze& maze, const PackedPath* solution)
+{
+    const uint16_t* cellInfo = maze.m_VisitedCellInfo.data();
+    const uint32_t cellsAcrossWidth = maze.m_CellsAcrossWidth;
+    const uint32_t cellsAcrossHeight = maze.m_CellsAcrossHeight;
+
+    std::vector<MazeMetrics> partials;
+    ForEachColumn(cellsAcrossWidth, cellsAcrossHeight, partials, [&](uint32_t columnBegin, uint32_t columnEnd, MazeMetrics& metrics)
+        {
+            const uint32_t cellBegin = columnBegin * cellsAcrossHeight;
+            const uint32_t cellEnd = columnEnd * cellsAcrossHeight;
+            for (uint32_t cell = cellBegin; cell < cellEnd; cell++)
+            {
+                const uint8_t walls = cellInfo[cell] & WALLS;
+                const uint8_t degree = DEGREE[walls];
+
+                // Every passage is counted from the cell below or left of it
+                metrics.horizontalPassages += (walls & Maze::CELL_EAST) != 0;
+                metrics.verticalPassages += (walls & Maze::CELL_NORTH) != 0;
+                metrics.deadEnds += degree == 1;
+                metrics.corridorCells += degree == 2;
+                metrics.junctions += degree == 3;
+                metrics.crossroads += degree == 4;
+                metrics.straightCells += walls == (Maze::CELL_NORTH | Maze::CELL_SOUTH) || walls == (Maze::CELL_EAST | Maze::CELL_WEST);
+
+                if (degree == 2 || degree == 0)
+                    continue;
+
+                // Corridors are walked from both of their ends, only the walk from the lower cell counts them.
+                // Corridor cells are only ever walked through, so the pass stays linear
+                for (uint8_t wall = Maze::CELL_NORTH; wall <= Maze::CELL_WEST; wall <<= 1)
+                {
+                    if ((walls & wall) == 0)
+                        continue;
+
+                    uint64_t steps = 0;
+                    uint8_t out = wall;
+                    uint32_t end = cell;
+                    uint8_t back = 0;
+                    for (;;)
+                    {
+                        end = Step(end, out, cellsAcrossHeight);
+                        back = Opposite(out);
+                        steps++;
+                        const uint8_t endWalls = cellInfo[end] & WALLS;
+                        if (DEGREE[endWalls] != 2)
+                            break;
+                        out = endWalls & ~back;
+                    }
+
+                    if (degree == 1)
+                        metrics.deadEndSteps += steps;
+                    if (cell < end || (cell == end && wall < back))
+                    {
+                        metrics.corridors++;
+                        metrics.corridorSteps += steps;
+                        metrics.longestCorridor = std::max(metrics.longestCorridor, steps);
+                        metrics.corridorHistogram[HistogramBucket(steps)]++;
+                    }
+                }
+            }
+        });
+
+    MazeMetrics metrics;
+    for (const MazeMetrics& partial : partials)
+        metrics.Add(partial);
+    metrics.samples = 1;
+    metrics.cells = maze.m_MazeArea;
+    metrics.passages = metrics.horizontalPassages + metrics.verticalPassages;
+
+    if (solution && !solution->empty())
+    {
+        metrics.solvedSamples = 1;
+        metrics.solutionSteps = solution->size() - 1;
+        for (size_t i = 1; i < metrics.solutionSteps; i++)
+            metrics.solutionTurns += solution->GetStep(i) != solution->GetStep(i - 1);
+
+        uint32_t xFront = solution->front() / cellsAcrossHeight, yFront = solution->front() % cellsAcrossHeight;
+        uint32_t xBack = solution->back() / cellsAcrossHeight, yBack = solution->back() % cellsAcrossHeight;
+        uint64_t manhattan = static_cast<uint64_t>(std::max(xFront, xBack) - std::min(xFront, xBack)) + (std::max(yFront, yBack) - std::min(yFront, yBack));
+        metrics.tortuositySum = manhattan ? static_cast<double>(metrics.solutionSteps) / manhattan : 1.0;
+    }
+
+    return metrics;
+}
+
+void MazeMetrics::Add(const MazeMetrics& other)
+{
+    samples += other.samples;
+    cells += other.cells;
+    passages += other.passages;
+    horizontalPassages += other.horizontalPassages;
+    verticalPassages += other.verticalPassages;
+    deadEnds += other.deadEnds;
+    corridorCells += other.corridorCells;
+    junctions += other.junctions;
+    crossroads += other.crossroads;
+    straightCells += other.straightCells;
+    corridors += other.corridors;
+    corridorSteps += other.corridorSteps;
+    longestCorridor = std::max(longestCorridor, other.longestCorridor);
+    for (uint32_t i = 0; i < HISTOGRAM_SIZE; i++)
+        corridorHistogram[i] += other.corridorHistogram[i];
+    deadEndSteps += other.deadEndSteps;
+    solvedSamples += other.solvedSamples;
+    solutionSteps += other.solutionSteps;
+    solutionTurns += other.solutionTurns;
+    tortuositySum += other.tortuositySum;
+}
+
+void MazeMetrics::WriteJson(std::ostream& stream, const std::string& indent) const
+{
+    const std::string field = indent + "  ";
+    auto ratio = [](uint64_t part, uint64_t whole) { return whole ? static_cast<double>(part) / whole : 0.0; };
+
+    stream << "{\n";
+    stream << field << "\"samples\": " << samples << ",\n";
+    stream << field << "\"cells\": " << cells << ",\n";
+    stream << field << "\"passages\": " << passages << ",\n";
+    stream << field << "\"horizontalPassages\": " << horizontalPassages << ",\n";
+    stream << field << "\"verticalPassages\": " << verticalPassages << ",\n";
+    stream << field << "\"deadEnds\": " << deadEnds << ",\n";
+    stream << field << "\"corridorCells\": " << corridorCells << ",\n";
+    stream << field << "\"straightCells\": " << straightCells << ",\n";
+    stream << field << "\"junctions\": " << junctions << ",\n";
+    stream << field << "\"crossroads\": " << crossroads << ",\n";
+    stream << field << "\"deadEndRatio\": " << GetDeadEndRatio() << ",\n";
+    stream << field << "\"junctionRatio\": " << ratio(junctions + crossroads, cells) << ",\n";
+    stream << field << "\"straightRatio\": " << ratio(straightCells, corridorCells) << ",\n";
+    stream << field << "\"corridors\": " << corridors << ",\n";
+    stream << field << "\"meanCorridor\": " << GetMeanCorridor() << ",\n";
+    stream << field << "\"longestCorridor\": " << longestCorridor << ",\n";
+
+    // Trailing empty buckets are left out
+    uint32_t bucketCount = HISTOGRAM_SIZE;
+    while (bucketCount > 1 && corridorHistogram[bucketCount - 1] == 0)
+        bucketCount--;
+    stream << field << "\"corridorHistogram\": [";
+    for (uint32_t i = 0; i < bucketCount; i++)
+        stream << (i ? ", " : "") << corridorHistogram[i];
+    stream << "],\n";
+
+    stream << field << "\"river\": " << GetRiver();
+    if (solvedSamples)
+    {
+        stream << ",\n" << field << "\"solution\": {\n";
+        stream << field << "  \"samples\": " << solvedSamples << ",\n";
+        stream << field << "  \"meanSteps\": " << ratio(solutionSteps, solvedSamples) << ",\n";
+        stream << field << "  \"turnRatio\": " << ratio(solutionTurns, solutionSteps) << ",\n";
+        stream << field << "  \"tortuosity\": " << GetTortuosity() << "\n";
+        stream << field << "}";
+    }
+    stream << "\n" << indent << "}";
+}
+
+bool MazeMetrics::WriteJson(const std::string& filePath) const
+{
+    std::ofstream file(filePath);
+    if (!file.is_open())
+    {
+        std::cout << "Failed to open " << filePath << " for writing" << std::endl;
+        return false;
+    }
+
+    WriteJson(file);
+    file << "\n";
+    std::cout << "Metrics written to " << filePath << std::endl;
+    return file.good();
+}
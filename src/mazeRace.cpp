@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <chrono>
+
+#include "mazeGraph.h"
+#include "mazeRace.h"
+#include "mazeSolver.h"
+
+MazeRace::~MazeRace()
+{
+    Stop();
+}
+
+void MazeRace::Start(Maze& maze, const MazeGraph& graph, std::pair<uint32_t, uint32_t> route, const std::vector<uint8_t>& algorithms,
+    uint32_t seed, const std::atomic<int>* delay, const std::atomic<bool>* paused)
+{
+    Clear();
+
+    m_Maze = &maze;
+    m_Graph = &graph;
+    m_Delay = delay;
+    m_Paused = paused;
+    m_StopRequested = false;
+
+    // Overlays start out from the maze without the cells a previous solver searched
+    std::vector<uint16_t> cellInfo = maze.m_VisitedCellInfo;
+    for (uint16_t& cell : cellInfo)
+        cell &= ~Maze::CELL_SEARCHED;
+
+    for (uint8_t algorithm : algorithms)
+    {
+        std::unique_ptr<Racer> racer = std::make_unique<Racer>();
+        racer->algorithm = algorithm;
+        racer->route = route;
+        racer->cellInfo = cellInfo;
+        racer->result.algorithm = algorithm;
+        m_Racers.push_back(std::move(racer));
+    }
+
+    // Every solver has its first snapshot before any of them is started
+    for (std::unique_ptr<Racer>& racer : m_Racers)
+        Publish(*racer, nullptr);
+    for (std::unique_ptr<Racer>& racer : m_Racers)
+    {
+        racer->running = true;
+        racer->thread = std::thread(&MazeRace::Run, this, std::ref(*racer), seed);
+    }
+}
+
+void MazeRace::Stop()
+{
+    m_StopRequested = true;
+    for (std::unique_ptr<Racer>& racer : m_Racers)
+    {
+        if (racer->thread.joinable())
+            racer->thread.join();
+    }
+}
+
+void MazeRace::Clear()
+{
+    Stop();
+    m_Racers.clear();
+    m_Maze = nullptr;
+    m_Graph = nullptr;
+}
+
+bool MazeRace::IsRunning() const
+{
+    for (const std::unique_ptr<Racer>& racer : m_Racers)
+    {
+        if (racer->running)
+            return true;
+    }
+    return false;
+}
+
+MazeRaceResult MazeRace::GetResult(size_t racer) const
+{
+    std::lock_guard<std::mutex> lock(m_ResultMutex);
+    return m_Racers[racer]->result;
+}
+
+const MazeSnapshot& MazeRace::ConsumeSnapshot(size_t racer)
+{
+    return m_Racers[racer]->snapshots.Read();
+}
+
+void MazeRace::Run(Racer& racer, uint32_t seed)
+{
+    using Clock = std::chrono::steady_clock;
+    // Same rate as the simulation thread, slowed down when copying the overlay gets expensive
+    const Clock::duration minPublishInterval = std::chrono::microseconds(8000);
+    Clock::duration publishInterval = minPublishInterval;
+    Clock::time_point lastPublish = Clock::now();
+
+    MazeSolver solver(m_Maze, *m_Graph, racer.algorithm, racer.route, seed, &racer.cellInfo);
+
+    uint64_t expansions = 0, peakFrontier = solver.GetFrontierSize();
+    Clock::duration stepping = Clock::duration::zero();
+    while (!m_StopRequested && !solver.m_Completed && solver.GetFrontierSize() > 0)
+    {
+        if (m_Paused && *m_Paused)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        // Without delay keep stepping until it is time to publish
+        const bool delayed = m_Delay && *m_Delay > 0;
+        Clock::time_point batchStart = Clock::now();
+        do
+        {
+            solver.Step();
+            expansions += !solver.m_Completed;
+            peakFrontier = std::max<uint64_t>(peakFrontier, solver.GetFrontierSize());
+        } while (!delayed && !solver.m_Completed && solver.GetFrontierSize() > 0 && !m_StopRequested &&
+            (expansions & 1023 || Clock::now() - lastPublish < publishInterval));
+        stepping += Clock::now() - batchStart;
+
+        {
+            std::lock_guard<std::mutex> lock(m_ResultMutex);
+            racer.result.expansions = expansions;
+            racer.result.peakFrontier = peakFrontier;
+            racer.result.milliseconds = std::chrono::duration<double, std::milli>(stepping).count();
+        }
+
+        if (Clock::now() - lastPublish >= publishInterval)
+        {
+            Clock::time_point publishStart = Clock::now();
+            Publish(racer, nullptr);
+            lastPublish = Clock::now();
+            publishInterval = std::max(minPublishInterval, 10 * (lastPublish - publishStart));
+        }
+
+        if (delayed)
+            std::this_thread::sleep_for(std::chrono::milliseconds(*m_Delay));
+    }
+
+    if (solver.m_Completed)
+    {
+        uint64_t pathCost = 0;
+        m_Maze->m_CellWeights.Visit([&](const auto& weights)
+            {
+                for (uint32_t cell : solver.m_Path)
+                    pathCost += cell != racer.route.first ? weights[cell] : 0;
+            });
+
+        std::lock_guard<std::mutex> lock(m_ResultMutex);
+        racer.result.completed = true;
+        racer.result.pathCells = solver.m_Path.size();
+        racer.result.pathCost = pathCost;
+    }
+
+    Publish(racer, solver.m_Completed ? &solver.m_Path : nullptr);
+    racer.running = false;
+}
+
+void MazeRace::Publish(Racer& racer, const PackedPath* path)
+{
+    MazeSnapshot& snapshot = racer.snapshots.GetWriteBuffer();
+    snapshot.cellInfo = racer.cellInfo;
+    snapshot.mazeArea = m_Maze->m_MazeArea;
+    snapshot.builderStarted = true;
+    snapshot.builderCompleted = true;
+    snapshot.builderPath.clear();
+    snapshot.solverStarted = true;
+    snapshot.solverCompleted = path != nullptr;
+    if (path)
+        snapshot.solverPath = *path;
+    else
+        snapshot.solverPath.Clear();
+    snapshot.sequence = ++m_SnapshotSequence;
+    racer.snapshots.Publish();
+}
@@ -0,0 +1,137 @@
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+#include "mazeRecorder.h"
+
+MazeRecorder::~MazeRecorder()
+{
+    Close();
+}
+
+bool MazeRecorder::Open(const std::string& filePath, const MazeLogHeader& header)
+{
+    Close();
+
+    m_File.open(filePath, std::ios::binary);
+    if (!m_File.is_open())
+    {
+        std::cout << "Failed to open " << filePath << " for writing" << std::endl;
+        return false;
+    }
+
+    m_File.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_FilePath = filePath;
+    m_Buffer.resize(FLUSH_SIZE + MAX_EVENT_SIZE);
+    m_BufferUsed = 0;
+    m_PreviousCell = 0;
+    m_PreviousFrontier = 0;
+    m_EventCount = 0;
+    return true;
+}
+
+void MazeRecorder::Flush()
+{
+    m_File.write(reinterpret_cast<const char*>(m_Buffer.data()), m_BufferUsed);
+    m_BufferUsed = 0;
+}
+
+bool MazeRecorder::Close()
+{
+    if (!m_File.is_open())
+        return true;
+
+    Flush();
+    bool good = m_File.good();
+    m_File.close();
+
+    if (good)
+        std::cout << m_EventCount << " steps recorded to " << m_FilePath << std::endl;
+    else
+        std::cout << "Failed to write " << m_FilePath << std::endl;
+    return good;
+}
+
+bool MazeRecorder::IsOpen() const
+{
+    return m_File.is_open();
+}
+
+uint64_t MazeRecorder::GetEventCount() const
+{
+    return m_EventCount;
+}
+
+bool MazeLogReader::Open(const std::string& filePath)
+{
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Failed to open " << filePath << std::endl;
+        return false;
+    }
+
+    m_Data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (m_Data.size() < sizeof(MazeLogHeader))
+    {
+        std::cout << filePath << " is too short to be a step log" << std::endl;
+        return false;
+    }
+
+    std::memcpy(&m_Header, m_Data.data(), sizeof(MazeLogHeader));
+    if (std::memcmp(m_Header.magic, "MLOG", 4) != 0 || m_Header.version == 0 || m_Header.version > MazeRecorder::VERSION)
+    {
+        std::cout << filePath << " is not a step log this version can read" << std::endl;
+        return false;
+    }
+
+    Rewind();
+    return true;
+}
+
+const MazeLogHeader& MazeLogReader::GetHeader() const
+{
+    return m_Header;
+}
+
+bool MazeLogReader::ReadVarint(int64_t& delta)
+{
+    uint64_t value = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7)
+    {
+        if (m_Position >= m_Data.size())
+            return false;
+
+        uint8_t byte = m_Data[m_Position++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            delta = static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MazeLogReader::Next(MazeLogEvent& event)
+{
+    if (m_Position >= m_Data.size())
+        return false;
+
+    int64_t cellDelta = 0, frontierDelta = 0;
+    uint16_t flags = m_Data[m_Position++];
+    if (!ReadVarint(cellDelta) || !ReadVarint(frontierDelta))
+        return false;
+
+    m_Previous.cell = static_cast<uint32_t>(m_Previous.cell + cellDelta);
+    m_Previous.flags = flags;
+    m_Previous.frontier = static_cast<uint32_t>(m_Previous.frontier + frontierDelta);
+    event = m_Previous;
+    return true;
+}
+
+void MazeLogReader::Rewind()
+{
+    m_Position = sizeof(MazeLogHeader);
+    m_Previous = MazeLogEvent();
+}
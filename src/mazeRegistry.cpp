@@ -0,0 +1,186 @@
+#include <iostream>
+
+#include "mazeRegistry.h"
+
+namespace
+{
+    // Step is a template argument so every algorithm gets a loop of its own with the step called directly
+    template<void (MazeBuilder::*Step)()>
+    uint64_t AdvanceBuilder(MazeBuilder& builder, uint64_t maxSteps)
+    {
+        uint64_t steps = 0;
+        for (; steps < maxSteps && !builder.m_Maze->MazeCompleted(); steps++)
+            (builder.*Step)();
+        return steps;
+    }
+
+    template<void (MazeBuilder::*Step)()>
+    uint64_t RunBuilder(MazeBuilder& builder)
+    {
+        return AdvanceBuilder<Step>(builder, UINT64_MAX);
+    }
+
+    template<bool (MazeSolver::*Step)()>
+    uint64_t AdvanceSolver(MazeSolver& solver, uint64_t maxSteps)
+    {
+        // Only checked once, after that the step itself says when the solver is done
+        if (solver.m_Completed || solver.GetFrontierSize() == 0)
+            return 0;
+
+        uint64_t steps = 0;
+        while (steps < maxSteps)
+        {
+            steps++;
+            if (!(solver.*Step)())
+                break;
+        }
+        return steps;
+    }
+
+    template<bool (MazeSolver::*Step)()>
+    uint64_t RunSolver(MazeSolver& solver)
+    {
+        return AdvanceSolver<Step>(solver, UINT64_MAX);
+    }
+
+    // Builders with a batch loop of their own in MazeBuilder
+    template<uint64_t (MazeBuilder::*Advance)(uint64_t)>
+    uint64_t AdvanceBuilderLoop(MazeBuilder& builder, uint64_t maxSteps)
+    {
+        return (builder.*Advance)(maxSteps);
+    }
+
+    template<uint64_t (MazeBuilder::*Advance)(uint64_t)>
+    uint64_t RunBuilderLoop(MazeBuilder& builder)
+    {
+        return (builder.*Advance)(UINT64_MAX);
+    }
+
+    template<void (MazeBuilder::*Step)()>
+    MazeBuilderEntry MakeBuilder(uint8_t algorithm, const char* name, const char* label)
+    {
+        MazeBuilderEntry entry;
+        entry.algorithm = algorithm;
+        entry.name = name;
+        entry.label = label;
+        entry.step = Step;
+        entry.run = &RunBuilder<Step>;
+        entry.advance = &AdvanceBuilder<Step>;
+        return entry;
+    }
+
+    template<void (MazeBuilder::*Step)(), uint64_t (MazeBuilder::*Advance)(uint64_t)>
+    MazeBuilderEntry MakeBuilder(uint8_t algorithm, const char* name, const char* label)
+    {
+        MazeBuilderEntry entry = MakeBuilder<Step>(algorithm, name, label);
+        entry.run = &RunBuilderLoop<Advance>;
+        entry.advance = &AdvanceBuilderLoop<Advance>;
+        return entry;
+    }
+
+    template<bool (MazeSolver::*Step)()>
+    MazeSolverEntry MakeSolver(uint8_t algorithm, const char* name, const char* label)
+    {
+        MazeSolverEntry entry;
+        entry.algorithm = algorithm;
+        entry.name = name;
+        entry.label = label;
+        entry.step = Step;
+        entry.run = &RunSolver<Step>;
+        entry.advance = &AdvanceSolver<Step>;
+        return entry;
+    }
+}
+
+std::vector<MazeBuilderEntry>& MazeRegistry::Builders()
+{
+    // Built on first use so plugins registering during static initialization always find it
+    static std::vector<MazeBuilderEntry> builders = {
+        MakeBuilder<&MazeBuilder::RecursiveBacktrack, &MazeBuilder::AdvanceRecursiveBacktrack>(MazeBuilder::RECURSIVE_BACKTRACK, "backtrack", "Recursive Backtrack"),
+        MakeBuilder<&MazeBuilder::RandomizedKruskal, &MazeBuilder::AdvanceKruskal>(MazeBuilder::KRUSKAL, "kruskal", "Kruskal"),
+        MakeBuilder<&MazeBuilder::RandomizedPrims, &MazeBuilder::AdvancePrims>(MazeBuilder::PRIMS, "prims", "Prims"),
+        MakeBuilder<&MazeBuilder::Wilson, &MazeBuilder::AdvanceWilson>(MazeBuilder::WILSON, "wilson", "Wilson"),
+        MakeBuilder<&MazeBuilder::Eller>(MazeBuilder::ELLER, "eller", "Eller")
+    };
+    return builders;
+}
+
+std::vector<MazeSolverEntry>& MazeRegistry::Solvers()
+{
+    static std::vector<MazeSolverEntry> solvers = {
+        MakeSolver<&MazeSolver::StepDepthFirst>(MazeSolver::DFS, "dfs", "Depth First Search"),
+        MakeSolver<&MazeSolver::StepBreadthFirst>(MazeSolver::BFS, "bfs", "Breadth First Search"),
+        MakeSolver<&MazeSolver::StepDijkstra>(MazeSolver::DIJKSTRA, "dijkstra", "Dijkstra"),
+        MakeSolver<&MazeSolver::StepAstar>(MazeSolver::ASTAR, "astar", "A star")
+    };
+    return solvers;
+}
+
+const MazeBuilderEntry* MazeRegistry::FindBuilder(uint8_t algorithm)
+{
+    for (const MazeBuilderEntry& entry : Builders())
+    {
+        if (entry.algorithm == algorithm)
+            return &entry;
+    }
+    return nullptr;
+}
+
+const MazeBuilderEntry* MazeRegistry::FindBuilder(const std::string& name)
+{
+    for (const MazeBuilderEntry& entry : Builders())
+    {
+        if (entry.name == name)
+            return &entry;
+    }
+    return nullptr;
+}
+
+const MazeSolverEntry* MazeRegistry::FindSolver(uint8_t algorithm)
+{
+    for (const MazeSolverEntry& entry : Solvers())
+    {
+        if (entry.algorithm == algorithm)
+            return &entry;
+    }
+    return nullptr;
+}
+
+const MazeSolverEntry* MazeRegistry::FindSolver(const std::string& name)
+{
+    for (const MazeSolverEntry& entry : Solvers())
+    {
+        if (entry.name == name)
+            return &entry;
+    }
+    return nullptr;
+}
+
+uint8_t MazeRegistry::AddBuilder(MazeBuilderEntry& entry)
+{
+    std::vector<MazeBuilderEntry>& builders = Builders();
+    if (FindBuilder(entry.name) || builders.back().algorithm == UINT8_MAX)
+    {
+        std::cout << "Builder " << entry.name << " could not be registered" << std::endl;
+        return MazeBuilder::NONE;
+    }
+
+    // Plugin ids follow the order of registration, mazes and logs of a plugin only make sense to builds with the same plugins
+    entry.algorithm = builders.back().algorithm + 1;
+    builders.push_back(entry);
+    return entry.algorithm;
+}
+
+uint8_t MazeRegistry::AddSolver(MazeSolverEntry& entry)
+{
+    std::vector<MazeSolverEntry>& solvers = Solvers();
+    if (FindSolver(entry.name) || solvers.back().algorithm == UINT8_MAX)
+    {
+        std::cout << "Solver " << entry.name << " could not be registered" << std::endl;
+        return MazeSolver::NONE;
+    }
+
+    entry.algorithm = solvers.back().algorithm + 1;
+    solvers.push_back(entry);
+    return entry.algorithm;
+}
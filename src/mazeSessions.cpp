@@ -0,0 +1,249 @@
+#include <algorithm>
+
+#include "mazeSessions.h"
+#include "mazeRegistry.h"
+#include "mazeWeights.h"
+
+namespace
+{
+    // Steps a worker takes on a session before it looks at the others, unless there is a delay
+    const std::chrono::microseconds SLICE(2000);
+    // Steps between two looks at the clock within a slice
+    const uint64_t STEPS_PER_CLOCK_CHECK = 256;
+    // Thumbnails are not worth drawing much more often than the screen refreshes
+    const std::chrono::microseconds PUBLISH_INTERVAL(16000);
+}
+
+MazeSessions::MazeSessions(const std::atomic<int>* delay, const std::atomic<bool>* paused)
+    : m_Delay(delay), m_Paused(paused)
+{
+}
+
+MazeSessions::~MazeSessions()
+{
+    Clear();
+}
+
+uint32_t MazeSessions::Add(const MazeSessionSettings& settings)
+{
+    std::unique_ptr<Session> session = std::make_unique<Session>();
+    session->id = m_NextId++;
+    session->settings = settings;
+    // Anything smaller has no room for a route
+    session->settings.cellsAcrossWidth = std::max(settings.cellsAcrossWidth, 2u);
+    session->settings.cellsAcrossHeight = std::max(settings.cellsAcrossHeight, 2u);
+    // Sessions already run in parallel, each one is drawn on the worker stepping it
+    session->exporter.m_ThreadCount = 1;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Sessions.push_back(std::move(session));
+
+    if (m_Workers.empty())
+    {
+        uint32_t threadCount = m_ThreadCount;
+        if (threadCount == 0)
+            threadCount = std::max(std::thread::hardware_concurrency(), 3u) - 2;
+
+        m_StopRequested = false;
+        for (uint32_t i = 0; i < threadCount; i++)
+            m_Workers.emplace_back(&MazeSessions::Work, this);
+    }
+
+    m_Changed.notify_all();
+    return m_Sessions.back()->id;
+}
+
+void MazeSessions::Remove(size_t index)
+{
+    std::unique_ptr<Session> session;
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Changed.wait(lock, [&]() { return !m_Sessions[index]->busy; });
+        session = std::move(m_Sessions[index]);
+        m_Sessions.erase(m_Sessions.begin() + index);
+    }
+    // Destroyed without the lock, the workers carry on with the others meanwhile
+}
+
+void MazeSessions::Restart(size_t index)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Sessions[index]->restartRequested = true;
+    m_Sessions[index]->finished = false;
+    m_Changed.notify_all();
+}
+
+void MazeSessions::Clear()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_StopRequested = true;
+    }
+    m_Changed.notify_all();
+
+    for (std::thread& worker : m_Workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+    m_Workers.clear();
+    m_Sessions.clear();
+    m_NextSession = 0;
+}
+
+const MazeSessionFrame& MazeSessions::ConsumeFrame(size_t index)
+{
+    return m_Sessions[index]->frames.Read();
+}
+
+void MazeSessions::Work()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (!m_StopRequested)
+    {
+        bool restart = false;
+        Session* session = Claim(restart);
+        if (!session)
+        {
+            // Delays are whole milliseconds so checking again after one is soon enough
+            m_Changed.wait_for(lock, std::chrono::milliseconds(1));
+            continue;
+        }
+
+        lock.unlock();
+        if (restart)
+            Reset(*session);
+        const bool finished = Advance(*session);
+        lock.lock();
+
+        session->busy = false;
+        session->finished = finished;
+        const int delay = m_Delay ? m_Delay->load() : 0;
+        session->nextSlice = Clock::now() + std::chrono::milliseconds(std::max(delay, 0));
+        m_Changed.notify_all();
+    }
+}
+
+MazeSessions::Session* MazeSessions::Claim(bool& restart)
+{
+    const bool paused = m_Paused && *m_Paused;
+    const Clock::time_point now = Clock::now();
+
+    for (size_t i = 0; i < m_Sessions.size(); i++)
+    {
+        const size_t index = (m_NextSession + i) % m_Sessions.size();
+        Session& session = *m_Sessions[index];
+        // Restarts go through while paused so the new maze shows up
+        if (session.busy || (!session.restartRequested && (paused || session.finished || now < session.nextSlice)))
+            continue;
+
+        m_NextSession = index + 1;
+        session.busy = true;
+        restart = session.restartRequested;
+        session.restartRequested = false;
+        return &session;
+    }
+    return nullptr;
+}
+
+bool MazeSessions::Advance(Session& session)
+{
+    MazeSessionStats& stats = session.stats;
+    const MazeSessionStats::States state = static_cast<MazeSessionStats::States>(stats.state);
+    // With a delay a slice is a single step, like on the simulation thread
+    const bool delayed = m_Delay && *m_Delay > 0;
+    const Clock::time_point sliceStart = Clock::now();
+
+    if (state == MazeSessionStats::BUILDING)
+    {
+        Maze& maze = *session.maze;
+        MazeBuilder& builder = *session.builder;
+        // Chunks run through the loop compiled for the algorithm, the clock is only read in between
+        const MazeBuilderEntry* entry = MazeRegistry::FindBuilder(builder.m_SelectedAlgorithm);
+        while (entry)
+        {
+            stats.builderSteps += entry->advance(builder, delayed ? 1 : STEPS_PER_CLOCK_CHECK);
+            if (delayed || maze.MazeCompleted() || Clock::now() - sliceStart >= SLICE)
+                break;
+        }
+        stats.builderMilliseconds += std::chrono::duration<double, std::milli>(Clock::now() - sliceStart).count();
+
+        // An algorithm nobody registered can not get anywhere
+        if (!entry)
+            stats.state = MazeSessionStats::FINISHED;
+        else if (maze.MazeCompleted())
+        {
+            builder.m_Completed = true;
+            builder.OnCompletion();
+            session.graph.Build(maze);
+            session.solver = std::make_unique<MazeSolver>(&maze, session.graph, session.settings.solver, session.route, session.settings.seed);
+            stats.peakFrontier = session.solver->GetFrontierSize();
+            stats.state = MazeSessionStats::SOLVING;
+        }
+    }
+    else if (state == MazeSessionStats::SOLVING)
+    {
+        MazeSolver& solver = *session.solver;
+        do
+        {
+            solver.Step();
+            stats.solverSteps += !solver.m_Completed;
+            stats.peakFrontier = std::max<uint64_t>(stats.peakFrontier, solver.GetFrontierSize());
+        } while (!delayed && !solver.m_Completed && solver.GetFrontierSize() > 0 &&
+            (stats.solverSteps % STEPS_PER_CLOCK_CHECK || Clock::now() - sliceStart < SLICE));
+        stats.solverMilliseconds += std::chrono::duration<double, std::milli>(Clock::now() - sliceStart).count();
+
+        if (solver.m_Completed || solver.GetFrontierSize() == 0)
+        {
+            stats.pathCells = solver.m_Completed ? solver.m_Path.size() : 0;
+            stats.state = MazeSessionStats::FINISHED;
+        }
+    }
+
+    if (stats.state != state || Clock::now() - session.lastPublish >= PUBLISH_INTERVAL)
+        Publish(session);
+    return stats.state == MazeSessionStats::FINISHED;
+}
+
+void MazeSessions::Reset(Session& session)
+{
+    session.solver.reset();
+    session.builder.reset();
+    session.graph.Clear();
+    session.maze.reset();
+
+    const MazeSessionSettings& settings = session.settings;
+    // Sessions are only seen as thumbnails, the pixel size of the maze just has to give the right number of cells
+    session.maze = std::make_unique<Maze>(settings.cellsAcrossWidth * 5, settings.cellsAcrossHeight * 5, 2, 1, false, &m_Arena);
+    session.maze->m_LineThickness = 2;
+
+    MazeWeightSettings weights;
+    weights.seed = settings.seed;
+    session.maze->SetCellWeights(weights);
+
+    const uint32_t area = session.maze->m_MazeArea;
+    session.route = settings.route;
+    if (std::max(session.route.first, session.route.second) >= area || session.route.first == session.route.second)
+        session.route = { 0, area - 1 };
+
+    session.builder = std::make_unique<MazeBuilder>(session.maze.get(), settings.builder, settings.seed);
+    session.stats = MazeSessionStats();
+    Publish(session);
+}
+
+void MazeSessions::Publish(Session& session)
+{
+    // Whole pixels per cell so the walls do not get lost
+    const uint32_t cellsAcross = std::max(session.maze->m_CellsAcrossWidth, session.maze->m_CellsAcrossHeight);
+    const uint16_t cellPixels = static_cast<uint16_t>(std::clamp<uint32_t>(m_ThumbnailPixels / cellsAcross, 1, UINT16_MAX));
+    session.exporter.Render(*session.maze, cellPixels, session.solver.get(), &session.route);
+
+    MazeSessionFrame& frame = session.frames.GetWriteBuffer();
+    frame.pixels = session.exporter.GetPixels();
+    frame.width = session.exporter.GetWidth();
+    frame.height = session.exporter.GetHeight();
+    frame.stats = session.stats;
+    frame.sequence = ++m_FrameSequence;
+    session.frames.Publish();
+    session.lastPublish = Clock::now();
+}
@@ -1,56 +1,123 @@
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 #include "maze.h"
+#include "mazeArena.h"
+#include "mazeFile.h"
+#include "mazeGraph.h"
+#include "mazeMemory.h"
+#include "mazeRegistry.h"
 #include "mazeSolver.h"
 
-MazeSolver::MazeSolver(Maze* maze, uint8_t selectedAlgorithm, std::pair<uint32_t, uint32_t>& route)
-	:m_Maze(maze)
+namespace
+{
+	// Reads and writes of one node record, so Expand is written once for both of them
+	struct FullNodes
+	{
+		MazeSolverNode* nodes;
+
+		bool IsClosed(uint32_t cell) const { return (nodes[cell].link & MazeSolverNode::CLOSED) != 0; }
+		void Close(uint32_t cell) { nodes[cell].link |= MazeSolverNode::CLOSED; }
+		uint32_t GetDistance(uint32_t cell) const { return nodes[cell].distance; }
+		uint32_t GetWeight(uint32_t cell) const { return nodes[cell].link >> MazeSolverNode::WEIGHT_SHIFT; }
+		void Reach(uint32_t cell, uint32_t distance, uint32_t direction)
+		{
+			nodes[cell].distance = distance;
+			nodes[cell].link = (nodes[cell].link & ~static_cast<uint32_t>(MazeSolverNode::DIRECTION_MASK)) | direction;
+		}
+	};
+
+	template<typename Weight>
+	struct CompactNodes
+	{
+		MazeSolverCompactNode* nodes;
+		const Weight* weights;
+
+		bool IsClosed(uint32_t cell) const { return (nodes[cell].link & MazeSolverCompactNode::CLOSED) != 0; }
+		void Close(uint32_t cell) { nodes[cell].link |= MazeSolverCompactNode::CLOSED; }
+		uint32_t GetDistance(uint32_t cell) const { return nodes[cell].link >> MazeSolverCompactNode::DISTANCE_SHIFT; }
+		uint32_t GetWeight(uint32_t cell) const { return weights[cell]; }
+		// Only cells which are not closed are reached, so the flags are just the direction
+		void Reach(uint32_t cell, uint32_t distance, uint32_t direction) { nodes[cell].link = distance << MazeSolverCompactNode::DISTANCE_SHIFT | direction; }
+	};
+
+	// Weights above MazeSolverNode::MAX_WEIGHT are clamped, the closed flag and direction are kept
+	template<typename Weight>
+	void CopyNodeWeights(MazeSolverNode* nodes, size_t count, const Weight* weights)
+	{
+		for (size_t cell = 0; cell < count; cell++)
+		{
+			uint32_t weight = std::min<uint32_t>(weights[cell], MazeSolverNode::MAX_WEIGHT);
+			nodes[cell].link = (nodes[cell].link & ((1u << MazeSolverNode::WEIGHT_SHIFT) - 1)) | weight << MazeSolverNode::WEIGHT_SHIFT;
+		}
+	}
+}
+
+MazeSolver::MazeSolver(Maze* maze, const MazeGraph& graph, uint8_t selectedAlgorithm, std::pair<uint32_t, uint32_t>& route, uint32_t seed,
+	std::vector<uint16_t>* searchOverlay)
+	:m_Maze(maze), m_Graph(&graph), m_CellInfo(searchOverlay ? searchOverlay : &maze->m_VisitedCellInfo), m_Route(&route), m_Seed(seed), m_Generator(seed),
+	m_CellsAcrossWidth(maze->m_CellsAcrossWidth), m_CellsAcrossHeight(maze->m_CellsAcrossHeight), m_MazeArea(maze->m_MazeArea), m_Arena(maze->m_Arena)
+{
+	m_SelectedAlgorithm = static_cast<Algorithms>(selectedAlgorithm);
+	Start(route.first);
+
+	// Plugins come last so they see the solver set up
+	const MazeSolverEntry* entry = MazeRegistry::FindSolver(selectedAlgorithm);
+	if (entry && entry->createPlugin)
+		m_Plugin = entry->createPlugin(*this);
+}
+
+MazeSolver::MazeSolver(const MappedMazeFile& file, const MazeGraph& graph, uint8_t selectedAlgorithm, std::pair<uint32_t, uint32_t>& route, uint32_t seed,
+	std::vector<uint16_t>& searchOverlay)
+	:m_Graph(&graph), m_CellInfo(&searchOverlay), m_Route(&route), m_Seed(seed), m_Generator(seed),
+	m_CellsAcrossWidth(file.GetHeader().cellsAcrossWidth), m_CellsAcrossHeight(file.GetHeader().cellsAcrossHeight),
+	m_MazeArea(graph.GetVertexCount()), m_File(&file)
 {
 	m_SelectedAlgorithm = static_cast<Algorithms>(selectedAlgorithm);
+	Start(route.first);
+}
+
+MazeSolver::MazeSolver(Maze* maze)
+	:m_Maze(maze), m_CellInfo(&maze->m_VisitedCellInfo), m_Route(nullptr),
+	m_CellsAcrossWidth(maze->m_CellsAcrossWidth), m_CellsAcrossHeight(maze->m_CellsAcrossHeight), m_MazeArea(maze->m_MazeArea), m_Arena(maze->m_Arena)
+{
+}
 
+void MazeSolver::Start(uint32_t start)
+{
 	switch (m_SelectedAlgorithm)
 	{
 	case Algorithms::DFS:
-		m_Stack.push(route.first);
+		// Start has to be searched already or DFS can step back into it and put it on the path twice
+		(*m_CellInfo)[start] |= Maze::CELL_SEARCHED;
+		m_Stack.push(start);
 		break;
 	case Algorithms::BFS:
-		m_Queue.push(route.first);
+		(*m_CellInfo)[start] |= Maze::CELL_SEARCHED;
+		m_Queue.push(start);
 		break;
 	case Algorithms::DIJKSTRA:
-		m_Distance.resize(m_Maze->m_MazeArea);
-		std::fill(m_Distance.begin(), m_Distance.end(), std::numeric_limits<uint32_t>::max());
-		m_Distance[route.first] = 0;
-		m_PQueue.push({ route.first, 0 });
-		break;
-
 	case Algorithms::ASTAR:
-		m_Heuristic.reserve(m_Maze->m_MazeArea);
-		uint32_t xEnd = route.second / m_Maze->m_CellsAcrossHeight;
-		uint32_t yEnd = route.second % m_Maze->m_CellsAcrossHeight;
-		uint32_t amplifier = 1;
-
-		for (uint32_t i = 0; i < m_Maze->m_MazeArea; i++)
+		if (FitsCompactNodes())
 		{
-			uint32_t xCurrent = i / m_Maze->m_CellsAcrossHeight;
-			uint32_t yCurrent = i % m_Maze->m_CellsAcrossHeight;
-			
-			uint32_t xDifference = xCurrent > xEnd ? (xCurrent - xEnd) : (xEnd - xCurrent);
-			uint32_t yDifference = yCurrent > yEnd ? (yCurrent - yEnd) : (yEnd - yCurrent);
-
-			uint32_t euclidianDistance = std::sqrt(xDifference * xDifference + yDifference * yDifference);
-			m_Heuristic.push_back(amplifier * euclidianDistance);
+			MazeArena::Assign(m_Arena, m_CompactNodes, m_MazeArea);
+			m_CompactNodes[start].link = 0;
 		}
-
-		m_Distance.resize(m_Maze->m_MazeArea);
-		std::fill(m_Distance.begin(), m_Distance.end(), std::numeric_limits<uint32_t>::max());
-		m_Distance[route.first] = 0;
-		m_PQueue.push({route.first, 0});
+		else
+		{
+			MazeArena::Assign(m_Arena, m_Nodes, m_MazeArea);
+			m_Nodes[start].distance = 0;
+		}
+		SyncNodeWeights();
+		m_PQueue.push({ start, 0 });
+		break;
+	default:
 		break;
 	}
 
-	m_Parent.resize(m_Maze->m_MazeArea);
-	std::fill(m_Parent.begin(), m_Parent.end(), std::numeric_limits<uint32_t>::max());
-	m_Route = &route;
+	if (m_SelectedAlgorithm == Algorithms::BFS)
+		MazeArena::Assign<uint8_t>(m_Arena, m_Parent, m_MazeArea, 0);
 }
 
 MazeSolver::~MazeSolver()
@@ -60,75 +127,131 @@ MazeSolver::~MazeSolver()
 
 	while (!m_Queue.empty())
 		m_Queue.pop();
+
+	MazeArena::Release(m_Arena, m_Nodes);
+	MazeArena::Release(m_Arena, m_CompactNodes);
+	MazeArena::Release(m_Arena, m_Parent);
 }
 
-void MazeSolver::DepthFirstSearch()
+void MazeSolver::Step()
 {
-	if (m_Stack.empty())
+	// Looked up here instead of in the constructor because MazeCheckpoint sets the algorithm afterwards
+	if (!m_StepFunction)
 	{
-		return;
+		const MazeSolverEntry* entry = MazeRegistry::FindSolver(m_SelectedAlgorithm);
+		if (!entry)
+			return;
+		m_StepFunction = entry->step;
 	}
+	(this->*m_StepFunction)();
+}
 
-	// To get negative results for checks
-	int64_t currentCell = static_cast<int64_t>(m_Stack.top());
-	std::vector<uint8_t> neighbours;
+bool MazeSolver::StepDepthFirst()
+{
+	if (!m_Stack.empty() && m_Stack.top() == m_Route->second)
+		OnCompletion();
+	else
+		DepthFirstSearch();
+	return !m_Completed && !m_Stack.empty();
+}
 
-	uint32_t northIndex = currentCell + 1;
-	uint32_t eastIndex = currentCell + (m_Maze->m_CellsAcrossHeight);
-	int64_t southIndex = currentCell - 1;
-	int64_t westIndex = currentCell - (m_Maze->m_CellsAcrossHeight);
+bool MazeSolver::StepBreadthFirst()
+{
+	if (!m_Queue.empty() && m_Queue.front() == m_Route->second)
+		OnCompletion();
+	else
+		BreadthFirstSearch();
+	return !m_Completed && !m_Queue.empty();
+}
 
-	// North
-	if ((northIndex % m_Maze->m_CellsAcrossHeight) != 0 &&
-		(m_Maze->m_VisitedCellInfo[currentCell] & Maze::CELL_NORTH) != 0 && (m_Maze->m_VisitedCellInfo[northIndex] & Maze::CELL_SEARCHED) == 0)
+bool MazeSolver::StepDijkstra()
+{
+	// Waiting for queue to be empty guarentees shortest path
+	if (!m_PQueue.empty() && m_PQueue.top().id == m_Route->second)
+		OnCompletion();
+	else
+		DijkstraSearch();
+	return !m_Completed && !m_PQueue.empty();
+}
+
+bool MazeSolver::StepAstar()
+{
+	if (!m_PQueue.empty() && m_PQueue.top().id == m_Route->second)
+		OnCompletion();
+	else
+		AstarSearch();
+	return !m_Completed && !m_PQueue.empty();
+}
+
+bool MazeSolver::StepPlugin()
+{
+	if (m_Plugin)
+		m_Plugin->Step(*this);
+	return !m_Completed && m_Plugin && m_Plugin->GetFrontierSize() > 0;
+}
+
+const char* MazeSolver::GetAlgorithmName(uint8_t algorithm)
+{
+	const MazeSolverEntry* entry = MazeRegistry::FindSolver(algorithm);
+	return entry ? entry->label.c_str() : "None";
+}
+
+uint32_t MazeSolver::GetCurrentCell() const
+{
+	switch (m_SelectedAlgorithm)
 	{
-		neighbours.push_back(0);
+	case Algorithms::DFS:
+		return m_Stack.empty() ? m_Route->first : m_Stack.top();
+	case Algorithms::BFS:
+		return m_Queue.empty() ? m_Route->first : m_Queue.front();
+	case Algorithms::DIJKSTRA:
+	case Algorithms::ASTAR:
+		return m_PQueue.empty() ? m_Route->first : m_PQueue.top().id;
+	default:
+		return m_Plugin ? m_Plugin->GetCurrentCell() : m_Route->first;
 	}
-	// East
-	if (eastIndex < (m_Maze->m_CellsAcrossWidth * m_Maze->m_CellsAcrossHeight) &&
-		(m_Maze->m_VisitedCellInfo[currentCell] & Maze::CELL_EAST) != 0 && (m_Maze->m_VisitedCellInfo[eastIndex] & Maze::CELL_SEARCHED) == 0)
+}
+
+uint32_t MazeSolver::GetFrontierSize() const
+{
+	switch (m_SelectedAlgorithm)
 	{
-		neighbours.push_back(1);
+	case Algorithms::DFS:
+		return static_cast<uint32_t>(m_Stack.size());
+	case Algorithms::BFS:
+		return static_cast<uint32_t>(m_Queue.size());
+	case Algorithms::DIJKSTRA:
+	case Algorithms::ASTAR:
+		return static_cast<uint32_t>(m_PQueue.size());
+	default:
+		return m_Plugin ? m_Plugin->GetFrontierSize() : 0;
 	}
-	// South
-	if ((currentCell % m_Maze->m_CellsAcrossHeight) != 0 &&
-		(m_Maze->m_VisitedCellInfo[currentCell] & Maze::CELL_SOUTH) != 0 && (m_Maze->m_VisitedCellInfo[southIndex] & Maze::CELL_SEARCHED) == 0)
+}
+
+void MazeSolver::DepthFirstSearch()
+{
+	if (m_Stack.empty())
 	{
-		neighbours.push_back(2);
+		return;
 	}
-	// West
-	if (westIndex >= 0 &&
-		(m_Maze->m_VisitedCellInfo[currentCell] & Maze::CELL_WEST) != 0 && (m_Maze->m_VisitedCellInfo[westIndex] & Maze::CELL_SEARCHED) == 0)
+
+	uint32_t currentCell = m_Stack.top();
+	uint16_t* cellInfo = m_CellInfo->data();
+	// A cell never has more than 4 neighbours
+	uint32_t neighbours[4];
+	uint32_t neighbourCount = 0;
+
+	for (const uint32_t* neighbour = m_Graph->GetNeighboursBegin(currentCell); neighbour != m_Graph->GetNeighboursEnd(currentCell); neighbour++)
 	{
-		neighbours.push_back(3);
+		neighbours[neighbourCount] = *neighbour;
+		neighbourCount += (cellInfo[*neighbour] & Maze::CELL_SEARCHED) == 0;
 	}
 
-	if (!neighbours.empty())
+	if (neighbourCount != 0)
 	{
-		uint8_t cellToVisit = neighbours[rand() % neighbours.size()];
-
-		switch (cellToVisit)
-		{
-		case 0:
-			m_Maze->m_VisitedCellInfo[northIndex] |= Maze::CELL_SEARCHED;
-			m_Stack.push(northIndex);
-			break;
-
-		case 1:
-			m_Maze->m_VisitedCellInfo[eastIndex] |= Maze::CELL_SEARCHED;
-			m_Stack.push(eastIndex);
-			break;
-
-		case 2:
-			m_Maze->m_VisitedCellInfo[southIndex] |= Maze::CELL_SEARCHED;
-			m_Stack.push(southIndex);
-			break;
-
-		case 3:
-			m_Maze->m_VisitedCellInfo[westIndex] |= Maze::CELL_SEARCHED;
-			m_Stack.push(westIndex);
-			break;
-		}
+		uint32_t cellToVisit = neighbours[m_Generator() % neighbourCount];
+		cellInfo[cellToVisit] |= Maze::CELL_SEARCHED;
+		m_Stack.push(cellToVisit);
 	}
 	else
 	{
@@ -138,146 +261,117 @@ void MazeSolver::DepthFirstSearch()
 
 void MazeSolver::BreadthFirstSearch()
 {
-	std::vector<uint8_t> neighbours;
-
 	if (m_Queue.empty())
 	{
 		return;
 	}
 
-	// To get negative results for checks
-	int64_t currentCell = static_cast<int64_t>(m_Queue.front());
-	uint32_t northIndex = currentCell + 1;
-	uint32_t eastIndex = currentCell + (m_Maze->m_CellsAcrossHeight);
-	int64_t southIndex = currentCell - 1;
-	int64_t westIndex = currentCell - (m_Maze->m_CellsAcrossHeight);
-
+	uint32_t currentCell = m_Queue.front();
 	m_Queue.pop();
+	uint16_t* cellInfo = m_CellInfo->data();
 
-	// North
-	if ((northIndex % m_Maze->m_CellsAcrossHeight) != 0 &&
-		(m_Maze->m_VisitedCellInfo[currentCell] & Maze::CELL_NORTH) != 0 && (m_Maze->m_VisitedCellInfo[northIndex] & Maze::CELL_SEARCHED) == 0)
-	{
-		neighbours.push_back(0);
-	}
-	// East
-	if (eastIndex < (m_Maze->m_CellsAcrossWidth * m_Maze->m_CellsAcrossHeight) &&
-		(m_Maze->m_VisitedCellInfo[currentCell] & Maze::CELL_EAST) != 0 && (m_Maze->m_VisitedCellInfo[eastIndex] & Maze::CELL_SEARCHED) == 0)
-	{
-		neighbours.push_back(1);
-	}
-	// South
-	if ((currentCell % m_Maze->m_CellsAcrossHeight) != 0 &&
-		(m_Maze->m_VisitedCellInfo[currentCell] & Maze::CELL_SOUTH) != 0 && (m_Maze->m_VisitedCellInfo[southIndex] & Maze::CELL_SEARCHED) == 0)
+	for (const uint32_t* neighbour = m_Graph->GetNeighboursBegin(currentCell); neighbour != m_Graph->GetNeighboursEnd(currentCell); neighbour++)
 	{
-		neighbours.push_back(2);
-	}
-	// West
-	if (westIndex >= 0 &&
-		(m_Maze->m_VisitedCellInfo[currentCell] & Maze::CELL_WEST) != 0 && (m_Maze->m_VisitedCellInfo[westIndex] & Maze::CELL_SEARCHED) == 0)
-	{
-		neighbours.push_back(3);
+		if ((cellInfo[*neighbour] & Maze::CELL_SEARCHED) == 0)
+		{
+			cellInfo[*neighbour] |= Maze::CELL_SEARCHED;
+			m_Queue.push(*neighbour);
+			SetParent(*neighbour, currentCell);
+		}
 	}
+}
 
-	if (!neighbours.empty())
-	{
-		//std::shuffle(std::begin(neighbours), std::end(neighbours), std::mt19937{ std::random_device{}() });
+template<bool WithHeuristic, typename Nodes>
+void MazeSolver::Expand(uint32_t currentCell, Nodes nodes)
+{
+	uint16_t* cellInfo = m_CellInfo->data();
+	// Stale entry of a cell that was already expanded with a shorter distance, the weights are never negative
+	// so nothing it reaches could get shorter
+	if (nodes.IsClosed(currentCell))
+		return;
+	nodes.Close(currentCell);
 
-		for (uint8_t i = 0; i < neighbours.size(); i++)
+	const uint32_t currentDistance = nodes.GetDistance(currentCell);
+	const uint32_t cellsAcrossHeight = m_CellsAcrossHeight;
+
+	// Neighbours are one step from the current cell so their coordinates come without another division.
+	// With one cell across the height every step is along x
+	uint32_t xCurrent = 0, yCurrent = 0;
+	int32_t yStep = cellsAcrossHeight != 1;
+	if constexpr (WithHeuristic)
+	{
+		xCurrent = currentCell / cellsAcrossHeight;
+		yCurrent = currentCell - xCurrent * cellsAcrossHeight;
+		if (m_GoalCell != m_Route->second)
 		{
-			uint8_t cellToVisit = neighbours[i];
-			switch (cellToVisit)
-			{
-			case 0:
-			{
-				m_Maze->m_VisitedCellInfo[northIndex] |= Maze::CELL_SEARCHED;
-				m_Queue.push(northIndex);
-				m_Parent[northIndex] = currentCell;
-				break;
-			}
+			m_GoalCell = m_Route->second;
+			m_GoalX = m_GoalCell / cellsAcrossHeight;
+			m_GoalY = m_GoalCell - m_GoalX * cellsAcrossHeight;
+		}
+	}
+	const uint32_t xEnd = m_GoalX, yEnd = m_GoalY;
 
-			case 1:
-			{
-				m_Maze->m_VisitedCellInfo[eastIndex] |= Maze::CELL_SEARCHED;
-				m_Queue.push(eastIndex);
-				m_Parent[eastIndex] = currentCell;
-				break;
-			}
+	for (const uint32_t* neighbour = m_Graph->GetNeighboursBegin(currentCell); neighbour != m_Graph->GetNeighboursEnd(currentCell); neighbour++)
+	{
+		uint32_t nextCell = *neighbour;
+		if (nodes.IsClosed(nextCell))
+			continue;
 
-			case 2:
-			{
-				m_Maze->m_VisitedCellInfo[southIndex] |= Maze::CELL_SEARCHED;
-				m_Queue.push(southIndex);
-				m_Parent[southIndex] = currentCell;
-				break;
-			}
+		// Cost only, A* adds the heuristic to the queue entry so the records never hold it
+		const uint32_t nextDistance = currentDistance + nodes.GetWeight(nextCell);
 
-			case 3:
+		// Relaxation
+		if (nodes.GetDistance(nextCell) > nextDistance)
+		{
+			// Direction back to the current cell, with one cell across the height north and south read as east and west
+			const uint32_t offset = currentCell - nextCell;
+			const uint32_t direction = ((offset == cellsAcrossHeight) | (offset == 0u - cellsAcrossHeight)) |
+				((offset == 0u - 1) | (offset == 0u - cellsAcrossHeight)) << 1;
+			nodes.Reach(nextCell, nextDistance, direction);
+
+			uint32_t priority = nextDistance;
+			if constexpr (WithHeuristic)
 			{
-				m_Maze->m_VisitedCellInfo[westIndex] |= Maze::CELL_SEARCHED;
-				m_Queue.push(westIndex);
-				m_Parent[westIndex] = currentCell;
-				break;
-			}
+				uint32_t xNext = xCurrent + (offset == 0u - cellsAcrossHeight) - (offset == cellsAcrossHeight);
+				uint32_t yNext = yCurrent + yStep * ((offset == 0u - 1) - (offset == 1));
+				uint64_t xDifference = xNext > xEnd ? (xNext - xEnd) : (xEnd - xNext);
+				uint64_t yDifference = yNext > yEnd ? (yNext - yEnd) : (yEnd - yNext);
+				priority += static_cast<uint32_t>(std::sqrt(static_cast<double>(xDifference * xDifference + yDifference * yDifference)));
 			}
+			m_PQueue.push({ nextCell, priority });
+			cellInfo[nextCell] |= Maze::CELL_SEARCHED;
 		}
 	}
 }
 
-void MazeSolver::DijkstraSearch()
+template<bool WithHeuristic>
+void MazeSolver::ExpandNodes(uint32_t currentCell)
 {
-	if (m_PQueue.empty())
+	SyncNodeWeights();
+	if (m_CompactNodes.empty())
 	{
+		Expand<WithHeuristic>(currentCell, FullNodes{ m_Nodes.data() });
 		return;
 	}
 
-	WeightDetails weightInfo = m_PQueue.top();
-	int64_t currentCell = static_cast<int64_t>(weightInfo.id);
-	uint32_t currentWeight = weightInfo.weight;
-
-	// To get negative results for checks
-	uint32_t northIndex = currentCell + 1;
-	uint32_t eastIndex = currentCell + (m_Maze->m_CellsAcrossHeight);
-	int64_t southIndex = currentCell - 1;
-	int64_t westIndex = currentCell - (m_Maze->m_CellsAcrossHeight);
-
-	m_PQueue.pop();
-
-	auto updateNeighbourWeights = [&](uint32_t neighbourCell)
+	m_Maze->m_CellWeights.Visit([&](const auto& weights)
 		{
-			uint32_t nextCell = neighbourCell;
-			uint32_t nextWeight = m_Maze->m_CellWeights[neighbourCell];
-
-			// Relaxation
-			if (m_Distance[nextCell] > m_Distance[currentCell] + nextWeight)
-			{
-				m_Distance[nextCell] = m_Distance[currentCell] + nextWeight;
-				m_PQueue.push({ nextCell, m_Distance[nextCell] });
-				m_Maze->m_VisitedCellInfo[neighbourCell] |= Maze::CELL_SEARCHED;
-				m_Parent[nextCell] = currentCell;
-			}
-		};
+			using Weight = typename std::decay_t<decltype(weights)>::value_type;
+			Expand<WithHeuristic>(currentCell, CompactNodes<Weight>{ m_CompactNodes.data(), weights.data() });
+		});
+}
 
-	// North
-	if ((northIndex % m_Maze->m_CellsAcrossHeight) != 0 && (m_Maze->m_VisitedCellInfo[currentCell] & Maze::CELL_NORTH) != 0)
-	{
-		updateNeighbourWeights(northIndex);
-	}
-	// East
-	if (eastIndex < (m_Maze->m_CellsAcrossWidth * m_Maze->m_CellsAcrossHeight) && (m_Maze->m_VisitedCellInfo[currentCell] & Maze::CELL_EAST) != 0)
-	{
-		updateNeighbourWeights(eastIndex);
-	}
-	// South
-	if ((currentCell % m_Maze->m_CellsAcrossHeight) != 0 && (m_Maze->m_VisitedCellInfo[currentCell] & Maze::CELL_SOUTH) != 0)
-	{
-		updateNeighbourWeights(southIndex);
-	}
-	// West
-	if (westIndex >= 0 && (m_Maze->m_VisitedCellInfo[currentCell] & Maze::CELL_WEST) != 0)
+void MazeSolver::DijkstraSearch()
+{
+	if (m_PQueue.empty())
 	{
-		updateNeighbourWeights(westIndex);
+		return;
 	}
+
+	uint32_t currentCell = m_PQueue.top().id;
+	m_PQueue.pop();
+
+	ExpandNodes<false>(currentCell);
 }
 
 void MazeSolver::AstarSearch()
@@ -287,86 +381,148 @@ void MazeSolver::AstarSearch()
 		return;
 	}
 
-	WeightDetails weightInfo = m_PQueue.top();
-	int64_t currentCell = static_cast<int64_t>(weightInfo.id);
-	uint32_t currentWeight = weightInfo.weight;
+	uint32_t currentCell = m_PQueue.top().id;
+	m_PQueue.pop();
 
-	// To get negative results for checks
-	uint32_t northIndex = currentCell + 1;
-	uint32_t eastIndex = currentCell + (m_Maze->m_CellsAcrossHeight);
-	int64_t southIndex = currentCell - 1;
-	int64_t westIndex = currentCell - (m_Maze->m_CellsAcrossHeight);
+	ExpandNodes<true>(currentCell);
+}
 
-	m_PQueue.pop();
+bool MazeSolver::FitsCompactNodes() const
+{
+	// Weights of a mapped file are 32 bit
+	if (!m_Maze)
+		return false;
 
-	auto updateNeighbourWeights = [&](uint32_t neighbourCell)
-		{
-			uint32_t nextCell = neighbourCell;
-			uint32_t nextWeight = m_Maze->m_CellWeights[neighbourCell];
+	const NarrowVector& weights = m_Maze->m_CellWeights;
+	if (weights.GetWidth() > NarrowVector::WIDTH_16 || weights.size() != m_MazeArea)
+		return false;
 
-			// Relaxation
-			if (m_Distance[nextCell] > m_Distance[currentCell] + nextWeight + m_Heuristic[nextCell])
-			{
-				m_Distance[nextCell] = m_Distance[currentCell] + nextWeight + m_Heuristic[nextCell];
-				m_PQueue.push({ nextCell, m_Distance[nextCell] });
-				m_Maze->m_VisitedCellInfo[neighbourCell] |= Maze::CELL_SEARCHED;
-				m_Parent[nextCell] = currentCell;
-			}
-		};
+	uint64_t maxWeight = 0;
+	weights.Visit([&](const auto& values)
+		{
+			if (!values.empty())
+				maxWeight = *std::max_element(values.begin(), values.end());
+		});
+	// A path visits every cell at most once. The records only hold the cost, the A* heuristic is only in the queue
+	return maxWeight * m_MazeArea < MazeSolverCompactNode::MAX_DISTANCE;
+}
 
-	// North
-	if ((northIndex % m_Maze->m_CellsAcrossHeight) != 0 && (m_Maze->m_VisitedCellInfo[currentCell] & Maze::CELL_NORTH) != 0)
-	{
-		updateNeighbourWeights(northIndex);
-	}
-	// East
-	if (eastIndex < (m_Maze->m_CellsAcrossWidth * m_Maze->m_CellsAcrossHeight) && (m_Maze->m_VisitedCellInfo[currentCell] & Maze::CELL_EAST) != 0)
+void MazeSolver::SyncNodeWeights()
+{
+	// A mapped file never changes, its weights are copied on the first call
+	if (!m_Maze)
 	{
-		updateNeighbourWeights(eastIndex);
+		if (m_NodeWeightsVersion == 0)
+			return;
+		m_NodeWeightsVersion = 0;
+		if (m_File->GetWeights())
+			CopyNodeWeights(m_Nodes.data(), m_Nodes.size(), m_File->GetWeights());
+		return;
 	}
-	// South
-	if ((currentCell % m_Maze->m_CellsAcrossHeight) != 0 && (m_Maze->m_VisitedCellInfo[currentCell] & Maze::CELL_SOUTH) != 0)
+
+	// Weights only change when they are regenerated or loaded, which is rare
+	if (m_NodeWeightsVersion == m_Maze->m_WeightsVersion)
+		return;
+	m_NodeWeightsVersion = m_Maze->m_WeightsVersion;
+
+	// Wider weights or a larger maximum can make distances overflow, from then on the full records are used
+	if (!m_CompactNodes.empty())
 	{
-		updateNeighbourWeights(southIndex);
+		if (FitsCompactNodes())
+			return;
+
+		MazeArena::Assign(m_Arena, m_Nodes, m_CompactNodes.size());
+		for (size_t cell = 0; cell < m_CompactNodes.size(); cell++)
+		{
+			const uint32_t link = m_CompactNodes[cell].link;
+			const uint32_t distance = link >> MazeSolverCompactNode::DISTANCE_SHIFT;
+			m_Nodes[cell].distance = distance == MazeSolverCompactNode::MAX_DISTANCE ? std::numeric_limits<uint32_t>::max() : distance;
+			m_Nodes[cell].link = link & (MazeSolverCompactNode::DIRECTION_MASK | MazeSolverCompactNode::CLOSED);
+		}
+		MazeArena::Release(m_Arena, m_CompactNodes);
+		std::vector<MazeSolverCompactNode>().swap(m_CompactNodes);
 	}
-	// West
-	if (westIndex >= 0 && (m_Maze->m_VisitedCellInfo[currentCell] & Maze::CELL_WEST) != 0)
+
+	m_Maze->m_CellWeights.Visit([&](const auto& weights)
+		{
+			CopyNodeWeights(m_Nodes.data(), std::min(weights.size(), m_Nodes.size()), weights.data());
+		});
+}
+
+void MazeSolver::SetParent(uint32_t cell, uint32_t parent)
+{
+	// Without branches, the direction to a neighbour is as good as random.
+	// With one cell across the height north and east are the same cell so both bits are set, which GetParent handles
+	const uint32_t offset = parent - cell;
+	const uint32_t cellsAcrossHeight = m_CellsAcrossHeight;
+	m_Parent[cell] = static_cast<uint8_t>((offset == 1) * Maze::CELL_NORTH | (offset == cellsAcrossHeight) * Maze::CELL_EAST |
+		(offset == 0u - 1) * Maze::CELL_SOUTH | (offset == 0u - cellsAcrossHeight) * Maze::CELL_WEST);
+}
+
+uint32_t MazeSolver::GetParent(uint32_t cell) const
+{
+	if (!m_Nodes.empty() || !m_CompactNodes.empty())
 	{
-		updateNeighbourWeights(westIndex);
+		const uint32_t cellsAcrossHeight = m_CellsAcrossHeight;
+		const uint32_t offsets[4] = { 1, cellsAcrossHeight, 0u - 1, 0u - cellsAcrossHeight };
+		const uint32_t link = m_Nodes.empty() ? m_CompactNodes[cell].link : m_Nodes[cell].link;
+		return cell + offsets[link & MazeSolverNode::DIRECTION_MASK];
 	}
+
+	uint8_t direction = m_Parent[cell];
+	if (direction & Maze::CELL_NORTH)
+		return cell + 1;
+	if (direction & Maze::CELL_EAST)
+		return cell + m_CellsAcrossHeight;
+	if (direction & Maze::CELL_SOUTH)
+		return cell - 1;
+	if (direction & Maze::CELL_WEST)
+		return cell - m_CellsAcrossHeight;
+	// Never happens on a path that was found, ends the backtracking instead of looping
+	return m_Route->first;
 }
 
 void MazeSolver::OnCompletion()
 {
+	const uint32_t cellsAcrossHeight = m_CellsAcrossHeight;
+
+	// Both are walked from the goal back to the start, the path is turned around once at the end
 	if (m_SelectedAlgorithm == MazeSolver::Algorithms::DFS)
 	{
 		std::stack<uint32_t> tempStack = m_Stack;
-		int32_t size = tempStack.size();
-		m_Path.clear();
-		m_Path.resize(tempStack.size());
-		for (int32_t i = size - 1; i >= 0; i--)
-		{
-			m_Path[i] = tempStack.top();
-			tempStack.pop();
-		}
+		m_Path.Reset(tempStack.top(), cellsAcrossHeight);
+		for (tempStack.pop(); !tempStack.empty(); tempStack.pop())
+			m_Path.Append(tempStack.top());
+		m_Path.Reverse();
 	}
 
 	if (m_SelectedAlgorithm == MazeSolver::Algorithms::BFS || m_SelectedAlgorithm == MazeSolver::Algorithms::DIJKSTRA || m_SelectedAlgorithm == MazeSolver::Algorithms::ASTAR)
 	{
 		uint32_t currentCell = m_Route->second;
+		m_Path.Reset(currentCell, cellsAcrossHeight);
 
 		// Backtracking
 		while (currentCell != m_Route->first)
 		{
-			m_Path.push_back(currentCell);
-			currentCell = m_Parent[currentCell];
+			currentCell = GetParent(currentCell);
+			m_Path.Append(currentCell);
 		}
 
-		m_Path.push_back(m_Route->first);
-		std::reverse(m_Path.begin(), m_Path.end());
+		m_Path.Reverse();
 	}
 
 	m_Completed = true;
 	// Cells - 1 = Paths
 	std::cout << "Maze Solved. Goal is " << m_Path.size() - 1  << " cells away!" << std::endl;
-}
\ No newline at end of file
+}
+
+void MazeSolver::ReportMemory(MazeMemoryReport& report) const
+{
+	report.AddVector("Solver", "nodes", m_Nodes);
+	report.AddVector("Solver", "compact nodes", m_CompactNodes);
+	report.AddVector("Solver", "parents", m_Parent);
+	report.Add("Solver", "path", m_Path.GetByteSize(), m_Path.GetSteps().capacity());
+	report.AddAdapter("Solver", "stack", m_Stack);
+	report.AddAdapter("Solver", "queue", m_Queue);
+	report.AddAdapter("Solver", "priority queue", m_PQueue);
+}
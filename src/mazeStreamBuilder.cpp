@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+#include "mazeBuilder.h"
+#include "mazeFile.h"
+#include "mazeMemory.h"
+#include "mazeStreamBuilder.h"
+
+void MazeStreamBuilder::Reset(uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight, uint32_t seed)
+{
+    m_CellsAcrossWidth = cellsAcrossWidth;
+    m_CellsAcrossHeight = cellsAcrossHeight;
+    m_NextColumn = 0;
+    m_Generator.seed(seed);
+    m_RandomBits = 0;
+    m_RandomBitCount = 0;
+
+    m_Sets.resize(cellsAcrossHeight);
+    m_Parents.resize(cellsAcrossHeight);
+    m_Remaining.resize(cellsAcrossHeight);
+    m_HasEast.resize(cellsAcrossHeight);
+    m_Renumber.resize(cellsAcrossHeight);
+    m_WallBits.resize(cellsAcrossHeight);
+
+    // Every cell of the first column starts in a set of its own
+    for (uint32_t y = 0; y < cellsAcrossHeight; y++)
+        m_Sets[y] = y;
+}
+
+bool MazeStreamBuilder::RandomBit()
+{
+    if (m_RandomBitCount == 0)
+    {
+        m_RandomBits = m_Generator();
+        m_RandomBitCount = 32;
+    }
+
+    bool bit = m_RandomBits & 1;
+    m_RandomBits >>= 1;
+    m_RandomBitCount--;
+    return bit;
+}
+
+uint32_t MazeStreamBuilder::FindSet(uint32_t set)
+{
+    // Path halving
+    while (m_Parents[set] != set)
+    {
+        m_Parents[set] = m_Parents[m_Parents[set]];
+        set = m_Parents[set];
+    }
+    return set;
+}
+
+bool MazeStreamBuilder::NextColumn()
+{
+    if (IsCompleted())
+        return false;
+
+    const uint32_t cellsAcrossHeight = m_CellsAcrossHeight;
+    // Last column has to join every set left or the maze would fall apart
+    const bool lastColumn = m_NextColumn + 1 == m_CellsAcrossWidth;
+
+    m_WallBits[cellsAcrossHeight - 1] = 0;
+    for (uint32_t set = 0; set < cellsAcrossHeight; set++)
+        m_Parents[set] = set;
+
+    // Randomly open north walls between neighbours of different sets.
+    // Choices are random so the loops below avoid branching on them
+    for (uint32_t y = 0; y + 1 < cellsAcrossHeight; y++)
+    {
+        uint32_t set = FindSet(m_Sets[y]);
+        uint32_t northSet = FindSet(m_Sets[y + 1]);
+        bool join = set != northSet && (lastColumn || RandomBit());
+        m_WallBits[y] = join ? 0x01 : 0x00;
+        m_Parents[northSet] = join ? set : northSet;
+    }
+
+    if (!lastColumn)
+    {
+        std::fill(m_Remaining.begin(), m_Remaining.end(), 0);
+        std::fill(m_HasEast.begin(), m_HasEast.end(), 0);
+
+        for (uint32_t y = 0; y < cellsAcrossHeight; y++)
+        {
+            m_Sets[y] = FindSet(m_Sets[y]);
+            m_Remaining[m_Sets[y]]++;
+        }
+
+        // Random east passages, the last cell of a set without one always gets it
+        for (uint32_t y = 0; y < cellsAcrossHeight; y++)
+        {
+            uint32_t set = m_Sets[y];
+            uint32_t remaining = --m_Remaining[set];
+            bool east = RandomBit() | ((remaining == 0) & !m_HasEast[set]);
+            m_WallBits[y] |= east ? 0x02 : 0x00;
+            m_HasEast[set] |= east;
+        }
+
+        // Cells behind an east passage carry their set over, the rest start new ones.
+        // Numbers stay below cellsAcrossHeight since a column never has more sets than cells
+        std::fill(m_Renumber.begin(), m_Renumber.end(), std::numeric_limits<uint32_t>::max());
+        uint32_t nextSet = 0;
+        for (uint32_t y = 0; y < cellsAcrossHeight; y++)
+        {
+            bool east = m_WallBits[y] & 0x02;
+            uint32_t& renumbered = m_Renumber[m_Sets[y]];
+            bool newSet = !east || renumbered == std::numeric_limits<uint32_t>::max();
+            uint32_t set = newSet ? nextSet : renumbered;
+            nextSet += newSet;
+            renumbered = east ? set : renumbered;
+            m_Sets[y] = set;
+        }
+    }
+
+    m_NextColumn++;
+    return true;
+}
+
+bool MazeStreamBuilder::Run(const ColumnSink& sink)
+{
+    while (NextColumn())
+    {
+        if (!sink(GetColumn(), m_WallBits))
+            return false;
+    }
+    return true;
+}
+
+bool MazeStreamBuilder::IsCompleted() const
+{
+    return m_NextColumn >= m_CellsAcrossWidth;
+}
+
+uint32_t MazeStreamBuilder::GetColumn() const
+{
+    return m_NextColumn - 1;
+}
+
+const std::vector<uint8_t>& MazeStreamBuilder::GetWallBits() const
+{
+    return m_WallBits;
+}
+
+bool MazeStreamBuilder::WriteMazeFile(const std::string& filePath, uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight, uint32_t seed)
+{
+    if (cellsAcrossWidth == 0 || cellsAcrossHeight == 0)
+    {
+        std::cout << "Maze needs at least one cell" << std::endl;
+        return false;
+    }
+
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Failed to open " << filePath << " for writing" << std::endl;
+        return false;
+    }
+
+    MazeFileHeader header;
+    header.cellsAcrossWidth = cellsAcrossWidth;
+    header.cellsAcrossHeight = cellsAcrossHeight;
+    header.seed = seed;
+    header.builder = MazeBuilder::Algorithms::ELLER;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Columns rarely end on a byte so up to 3 cells are carried over to the next one
+    const size_t bufferSize = 1 << 20;
+    std::vector<uint8_t> buffer;
+    buffer.reserve(bufferSize);
+    uint64_t bytesWritten = 0;
+    uint8_t pendingByte = 0;
+    uint32_t pendingCells = 0;
+
+    MazeStreamBuilder builder;
+    builder.Reset(cellsAcrossWidth, cellsAcrossHeight, seed);
+    builder.Run([&](uint32_t, const std::vector<uint8_t>& wallBits)
+        {
+            for (uint8_t bits : wallBits)
+            {
+                pendingByte |= bits << (pendingCells * 2);
+                if (++pendingCells == 4)
+                {
+                    buffer.push_back(pendingByte);
+                    pendingByte = 0;
+                    pendingCells = 0;
+                }
+            }
+
+            if (buffer.size() >= bufferSize)
+            {
+                file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+                bytesWritten += buffer.size();
+                buffer.clear();
+            }
+            return file.good();
+        });
+
+    if (pendingCells != 0)
+        buffer.push_back(pendingByte);
+    uint64_t wallPlaneSize = MazeFile::GetWallPlaneSize(static_cast<uint64_t>(cellsAcrossWidth) * cellsAcrossHeight);
+    buffer.resize(static_cast<size_t>(wallPlaneSize - bytesWritten), 0);
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+
+    if (!file.good())
+    {
+        std::cout << "Failed to write " << filePath << std::endl;
+        return false;
+    }
+
+    std::cout << "Maze streamed to " << filePath << std::endl;
+    return true;
+}
+
+void MazeStreamBuilder::ReportMemory(MazeMemoryReport& report, const char* subsystem) const
+{
+    uint64_t used = 0, reserved = 0;
+    auto add = [&](const auto& vector)
+        {
+            used += vector.size() * sizeof(vector[0]);
+            reserved += vector.capacity() * sizeof(vector[0]);
+        };
+    add(m_Sets);
+    add(m_Parents);
+    add(m_Remaining);
+    add(m_HasEast);
+    add(m_Renumber);
+    add(m_WallBits);
+    report.Add(subsystem, "eller columns", used, reserved);
+}
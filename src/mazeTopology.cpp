@@ -0,0 +1,474 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include "maze.h"
+#include "mazeBuilder.h"
+#include "mazeTopology.h"
+
+// MazeBuilder carves into Maze with MazeCarver<RectangularTopology>, so the passage bits and the visited flag have to match
+static_assert(RectangularTopology::PASSAGES[RectangularTopology::NORTH] == Maze::CELL_NORTH);
+static_assert(RectangularTopology::PASSAGES[RectangularTopology::EAST] == Maze::CELL_EAST);
+static_assert(RectangularTopology::PASSAGES[RectangularTopology::SOUTH] == Maze::CELL_SOUTH);
+static_assert(RectangularTopology::PASSAGES[RectangularTopology::WEST] == Maze::CELL_WEST);
+static_assert(MazeCarver<RectangularTopology>::CELL_VISITED == Maze::CELL_VISITED);
+
+namespace
+{
+    // Neighbour in a direction only known at runtime, which has to exist
+    template<typename Topology>
+    uint32_t GetNeighbour(const MazeTopologySize& size, uint32_t cell, uint32_t direction)
+    {
+        uint32_t neighbour = 0;
+        ForEachDirection<Topology>([&](auto candidate)
+            {
+                if (candidate == direction)
+                    Topology::template Neighbour<decltype(candidate)::value>(size, cell, neighbour);
+            });
+        return neighbour;
+    }
+
+    // Direction from cell to a neighbour of it
+    template<typename Topology>
+    uint32_t GetDirection(const MazeTopologySize& size, uint32_t cell, uint32_t neighbour)
+    {
+        uint32_t direction = 0;
+        ForEachDirection<Topology>([&](auto candidate)
+            {
+                uint32_t next = 0;
+                if (Topology::template Neighbour<decltype(candidate)::value>(size, cell, next) && next == neighbour)
+                    direction = candidate;
+            });
+        return direction;
+    }
+}
+
+template<typename Topology>
+void MazeCarver<Topology>::Carve(uint32_t cell, uint32_t direction, uint32_t neighbour)
+{
+    m_CellInfo[cell] |= CELL_VISITED | Topology::PASSAGES[direction];
+    m_CellInfo[neighbour] |= CELL_VISITED | Topology::PASSAGES[Topology::OPPOSITE[direction]];
+}
+
+template<typename Topology>
+void MazeCarver<Topology>::StartBacktrack(uint32_t start, std::stack<uint32_t>& stack)
+{
+    // Start has to be visited or the search can carve back into it, which leaves a loop and a cell cut off
+    m_CellInfo[start] |= CELL_VISITED;
+    stack.push(start);
+}
+
+template<typename Topology>
+bool MazeCarver<Topology>::ExtendBacktrack(std::stack<uint32_t>& stack)
+{
+    const uint32_t cell = stack.top();
+
+    // Unvisited neighbours, in the order of the directions
+    uint32_t neighbours[Topology::DIRECTIONS], directions[Topology::DIRECTIONS];
+    uint32_t count = 0;
+    ForEachDirection<Topology>([&](auto direction)
+        {
+            if (Topology::template Neighbour<decltype(direction)::value>(m_Size, cell, neighbours[count]) &&
+                (m_CellInfo[neighbours[count]] & CELL_VISITED) == 0)
+                directions[count++] = direction;
+        });
+
+    if (count == 0)
+    {
+        stack.pop();
+        return false;
+    }
+
+    const uint32_t choice = m_Generator() % count;
+    Carve(cell, directions[choice], neighbours[choice]);
+    stack.push(neighbours[choice]);
+    return true;
+}
+
+template<typename Topology>
+bool MazeCarver<Topology>::StepBacktrack(std::stack<uint32_t>& stack, std::vector<uint32_t>& path)
+{
+    path.clear();
+    path.push_back(stack.top());
+    return ExtendBacktrack(stack);
+}
+
+template<typename Topology>
+uint64_t MazeCarver<Topology>::RunBacktrack(std::stack<uint32_t>& stack, std::vector<uint32_t>& path, uint64_t maxSteps, uint32_t& cellsLeft)
+{
+    uint64_t steps = 0;
+    uint32_t cell = 0;
+    for (; steps < maxSteps && cellsLeft > 0; steps++)
+    {
+        cell = stack.top();
+        cellsLeft -= ExtendBacktrack(stack);
+    }
+    if (steps > 0)
+    {
+        path.clear();
+        path.push_back(cell);
+    }
+    return steps;
+}
+
+template<typename Topology>
+void MazeCarver<Topology>::StartKruskal(std::vector<uint32_t>& walls)
+{
+    // Every passage once, from its lower cell
+    walls.clear();
+    const uint32_t cellCount = m_Size.GetCellCount();
+    for (uint32_t cell = 0; cell < cellCount; cell++)
+    {
+        ForEachDirection<Topology>([&](auto direction)
+            {
+                uint32_t neighbour = 0;
+                if (Topology::template Neighbour<decltype(direction)::value>(m_Size, cell, neighbour) && cell < neighbour)
+                    walls.push_back(cell * Topology::DIRECTIONS + direction);
+            });
+    }
+    std::shuffle(walls.begin(), walls.end(), m_Generator);
+}
+
+template<typename Topology>
+void MazeCarver<Topology>::SetWallPath(uint32_t wall, std::vector<uint32_t>& path) const
+{
+    const uint32_t cell = wall / Topology::DIRECTIONS;
+    path.clear();
+    path.push_back(cell);
+    path.push_back(GetNeighbour<Topology>(m_Size, cell, wall % Topology::DIRECTIONS));
+}
+
+template<typename Topology>
+void MazeCarver<Topology>::JoinKruskal(uint32_t wall, DisjointSet& cells)
+{
+    const uint32_t cell = wall / Topology::DIRECTIONS;
+    const uint32_t direction = wall % Topology::DIRECTIONS;
+    const uint32_t neighbour = GetNeighbour<Topology>(m_Size, cell, direction);
+    if (cells.Find(cell) != cells.Find(neighbour))
+    {
+        cells.UnionSets(cell, neighbour);
+        Carve(cell, direction, neighbour);
+    }
+}
+
+template<typename Topology>
+void MazeCarver<Topology>::StepKruskal(std::vector<uint32_t>& walls, DisjointSet& cells, std::vector<uint32_t>& path)
+{
+    const uint32_t wall = walls.back();
+    walls.pop_back();
+    SetWallPath(wall, path);
+    JoinKruskal(wall, cells);
+}
+
+template<typename Topology>
+uint64_t MazeCarver<Topology>::RunKruskal(std::vector<uint32_t>& walls, DisjointSet& cells, std::vector<uint32_t>& path, uint64_t maxSteps)
+{
+    uint64_t steps = 0;
+    uint32_t wall = 0;
+    for (; steps < maxSteps && !walls.empty(); steps++)
+    {
+        wall = walls.back();
+        walls.pop_back();
+        JoinKruskal(wall, cells);
+    }
+    if (steps > 0)
+        SetWallPath(wall, path);
+    return steps;
+}
+
+template<typename Topology>
+void MazeCarver<Topology>::AddFrontier(uint32_t cell, std::vector<uint32_t>& frontier)
+{
+    ForEachDirection<Topology>([&](auto direction)
+        {
+            uint32_t neighbour = 0;
+            if (Topology::template Neighbour<decltype(direction)::value>(m_Size, cell, neighbour) && (m_CellInfo[neighbour] & CELL_VISITED) == 0)
+                frontier.push_back(cell * Topology::DIRECTIONS + direction);
+        });
+}
+
+template<typename Topology>
+void MazeCarver<Topology>::StartPrims(uint32_t start, std::vector<uint32_t>& frontier)
+{
+    frontier.clear();
+    m_CellInfo[start] |= CELL_VISITED;
+    AddFrontier(start, frontier);
+}
+
+template<typename Topology>
+uint32_t MazeCarver<Topology>::TakeFrontier(std::vector<uint32_t>& frontier)
+{
+    // Order of the walls does not matter, the last one takes the place of the picked one
+    const uint32_t index = m_Generator() % frontier.size();
+    const uint32_t wall = frontier[index];
+    frontier[index] = frontier.back();
+    frontier.pop_back();
+    return wall;
+}
+
+template<typename Topology>
+void MazeCarver<Topology>::ExtendPrims(uint32_t wall, std::vector<uint32_t>& frontier)
+{
+    const uint32_t cell = wall / Topology::DIRECTIONS;
+    const uint32_t direction = wall % Topology::DIRECTIONS;
+    const uint32_t neighbour = GetNeighbour<Topology>(m_Size, cell, direction);
+
+    // Another wall got there first
+    if ((m_CellInfo[neighbour] & CELL_VISITED) != 0)
+        return;
+
+    Carve(cell, direction, neighbour);
+    AddFrontier(neighbour, frontier);
+}
+
+template<typename Topology>
+void MazeCarver<Topology>::StepPrims(std::vector<uint32_t>& frontier, std::vector<uint32_t>& path)
+{
+    const uint32_t wall = TakeFrontier(frontier);
+    SetWallPath(wall, path);
+    ExtendPrims(wall, frontier);
+}
+
+template<typename Topology>
+uint64_t MazeCarver<Topology>::RunPrims(std::vector<uint32_t>& frontier, std::vector<uint32_t>& path, uint64_t maxSteps)
+{
+    uint64_t steps = 0;
+    uint32_t wall = 0;
+    for (; steps < maxSteps && !frontier.empty(); steps++)
+    {
+        wall = TakeFrontier(frontier);
+        ExtendPrims(wall, frontier);
+    }
+    if (steps > 0)
+        SetWallPath(wall, path);
+    return steps;
+}
+
+template<typename Topology>
+void MazeCarver<Topology>::IndexWilson(const std::vector<uint32_t>& elementsLeft, const std::vector<uint32_t>& walk, std::vector<uint32_t>& elementIndex,
+    std::vector<uint32_t>& walkIndex)
+{
+    for (uint32_t i = 0; i < elementsLeft.size(); i++)
+        elementIndex[elementsLeft[i]] = i;
+    for (uint32_t i = 0; i < walk.size(); i++)
+        walkIndex[walk[i]] = i;
+}
+
+template<typename Topology>
+void MazeCarver<Topology>::RemoveElementLeft(uint32_t cell, std::vector<uint32_t>& elementsLeft, std::vector<uint32_t>& elementIndex)
+{
+    const uint32_t position = elementIndex[cell];
+    const uint32_t last = elementsLeft.back();
+    elementsLeft[position] = last;
+    elementIndex[last] = position;
+    elementsLeft.pop_back();
+}
+
+template<typename Topology>
+void MazeCarver<Topology>::StartWilson(std::vector<uint32_t>& elementsLeft, std::vector<uint32_t>& elementIndex, uint32_t& walkStart)
+{
+    walkStart = elementsLeft[m_Generator() % elementsLeft.size()];
+    m_CellInfo[walkStart] |= CELL_VISITED;
+    RemoveElementLeft(walkStart, elementsLeft, elementIndex);
+}
+
+template<typename Topology>
+void MazeCarver<Topology>::StepWilson(std::vector<uint32_t>& elementsLeft, std::vector<uint32_t>& elementIndex, std::vector<uint32_t>& walk,
+    std::vector<uint32_t>& walkIndex, uint32_t& walkStart)
+{
+    // Walk on to a random neighbour
+    uint32_t neighbours[Topology::DIRECTIONS];
+    uint32_t count = 0;
+    ForEachDirection<Topology>([&](auto direction)
+        {
+            count += Topology::template Neighbour<decltype(direction)::value>(m_Size, walkStart, neighbours[count]);
+        });
+
+    if (count > 0)
+    {
+        walkStart = neighbours[m_Generator() % count];
+        walk.push_back(walkStart);
+    }
+
+    if ((m_CellInfo[walk.back()] & CELL_VISITED) != 0)
+    {
+        // Reached the maze, the walk becomes part of it
+        for (size_t i = 0; i + 1 < walk.size(); i++)
+        {
+            Carve(walk[i], GetDirection<Topology>(m_Size, walk[i], walk[i + 1]), walk[i + 1]);
+            RemoveElementLeft(walk[i], elementsLeft, elementIndex);
+        }
+        walk.clear();
+
+        if (elementsLeft.empty())
+            return;
+
+        // Next walk starts from a random cell which is not in the maze yet
+        walkStart = elementsLeft[m_Generator() % elementsLeft.size()];
+        walk.push_back(walkStart);
+        walkIndex[walkStart] = 0;
+    }
+    else
+    {
+        // Walked into itself, the loop since the last time it was here is erased
+        const uint32_t last = walk.back();
+        const uint32_t position = walkIndex[last];
+        if (position + 1 < walk.size() && walk[position] == last)
+        {
+            walk.resize(position + 1);
+            walkStart = last;
+        }
+        else
+            walkIndex[last] = static_cast<uint32_t>(walk.size() - 1);
+    }
+}
+
+template<typename Topology>
+uint64_t MazeCarver<Topology>::RunWilson(std::vector<uint32_t>& elementsLeft, std::vector<uint32_t>& elementIndex, std::vector<uint32_t>& walk,
+    std::vector<uint32_t>& walkIndex, uint32_t& walkStart, uint64_t maxSteps)
+{
+    // The walk is the path already, nothing is left to skip
+    uint64_t steps = 0;
+    for (; steps < maxSteps && !elementsLeft.empty(); steps++)
+        StepWilson(elementsLeft, elementIndex, walk, walkIndex, walkStart);
+    return steps;
+}
+
+template<typename Topology>
+TopologyMaze<Topology>::TopologyMaze(const MazeTopologySize& size)
+    : m_Size{ std::max(size.width, Topology::MIN_CELLS_ACROSS), std::max(size.height, Topology::MIN_CELLS_ACROSS), std::max(size.layers, 1u) }
+{
+    m_CellCount = m_Size.GetCellCount();
+    m_CellInfo.assign(m_CellCount, 0);
+}
+
+template<typename Topology>
+uint32_t TopologyMaze<Topology>::Reset(std::mt19937& generator)
+{
+    std::fill(m_CellInfo.begin(), m_CellInfo.end(), 0);
+    return generator() % m_CellCount;
+}
+
+template<typename Topology>
+void TopologyMaze<Topology>::BuildBacktrack(uint32_t seed)
+{
+    std::mt19937 generator(seed);
+    const uint32_t start = Reset(generator);
+    MazeCarver<Topology> carver(m_Size, m_CellInfo.data(), generator);
+
+    std::stack<uint32_t> stack;
+    std::vector<uint32_t> path;
+    uint32_t cellsLeft = m_CellCount - 1;
+    carver.StartBacktrack(start, stack);
+    carver.RunBacktrack(stack, path, UINT64_MAX, cellsLeft);
+}
+
+template<typename Topology>
+void TopologyMaze<Topology>::BuildKruskal(uint32_t seed)
+{
+    std::mt19937 generator(seed);
+    Reset(generator);
+    MazeCarver<Topology> carver(m_Size, m_CellInfo.data(), generator);
+
+    std::vector<uint32_t> walls, path;
+    DisjointSet cells(m_CellCount);
+    carver.StartKruskal(walls);
+    carver.RunKruskal(walls, cells, path, UINT64_MAX);
+}
+
+template<typename Topology>
+void TopologyMaze<Topology>::BuildPrims(uint32_t seed)
+{
+    std::mt19937 generator(seed);
+    const uint32_t start = Reset(generator);
+    MazeCarver<Topology> carver(m_Size, m_CellInfo.data(), generator);
+
+    std::vector<uint32_t> frontier, path;
+    carver.StartPrims(start, frontier);
+    carver.RunPrims(frontier, path, UINT64_MAX);
+}
+
+template<typename Topology>
+void TopologyMaze<Topology>::BuildWilson(uint32_t seed)
+{
+    std::mt19937 generator(seed);
+    Reset(generator);
+    MazeCarver<Topology> carver(m_Size, m_CellInfo.data(), generator);
+
+    std::vector<uint32_t> elementsLeft(m_CellCount), elementIndex(m_CellCount), walk, walkIndex(m_CellCount, 0);
+    std::iota(elementsLeft.begin(), elementsLeft.end(), 0);
+    MazeCarver<Topology>::IndexWilson(elementsLeft, walk, elementIndex, walkIndex);
+    uint32_t walkStart = 0;
+    carver.StartWilson(elementsLeft, elementIndex, walkStart);
+    carver.RunWilson(elementsLeft, elementIndex, walk, walkIndex, walkStart, UINT64_MAX);
+}
+
+template<typename Topology>
+bool TopologyMaze<Topology>::Solve(uint32_t start, uint32_t goal, std::vector<uint32_t>& path)
+{
+    path.clear();
+    for (uint16_t& cell : m_CellInfo)
+        cell &= ~CELL_SEARCHED;
+    if (std::max(start, goal) >= m_CellCount)
+        return false;
+
+    std::vector<uint32_t> parent(m_CellCount, m_CellCount);
+    // Cells are queued once, a plain vector with a read position is enough
+    std::vector<uint32_t> queue;
+    queue.reserve(m_CellCount);
+    queue.push_back(start);
+    m_CellInfo[start] |= CELL_SEARCHED;
+
+    for (size_t next = 0; next < queue.size() && (m_CellInfo[goal] & CELL_SEARCHED) == 0; next++)
+    {
+        const uint32_t cell = queue[next];
+        const uint16_t info = m_CellInfo[cell];
+        ForEachDirection<Topology>([&](auto direction)
+            {
+                uint32_t neighbour = 0;
+                if ((info & Topology::PASSAGES[direction]) != 0 && Topology::template Neighbour<decltype(direction)::value>(m_Size, cell, neighbour) &&
+                    (m_CellInfo[neighbour] & CELL_SEARCHED) == 0)
+                {
+                    m_CellInfo[neighbour] |= CELL_SEARCHED;
+                    parent[neighbour] = cell;
+                    queue.push_back(neighbour);
+                }
+            });
+    }
+
+    if ((m_CellInfo[goal] & CELL_SEARCHED) == 0)
+        return false;
+
+    for (uint32_t cell = goal; cell != start; cell = parent[cell])
+        path.push_back(cell);
+    path.push_back(start);
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+template<typename Topology>
+uint64_t TopologyMaze<Topology>::GetPassageCount() const
+{
+    uint64_t passages = 0;
+    for (uint32_t cell = 0; cell < m_CellCount; cell++)
+    {
+        ForEachDirection<Topology>([&](auto direction)
+            {
+                uint32_t neighbour = 0;
+                if (IsOpen(cell, direction) && Topology::template Neighbour<decltype(direction)::value>(m_Size, cell, neighbour) && cell < neighbour)
+                    passages++;
+            });
+    }
+    return passages;
+}
+
+template class MazeCarver<RectangularTopology>;
+template class MazeCarver<TorusTopology>;
+template class MazeCarver<HexTopology>;
+template class MazeCarver<TriangleTopology>;
+template class MazeCarver<LayeredTopology>;
+
+template class TopologyMaze<TorusTopology>;
+template class TopologyMaze<HexTopology>;
+template class TopologyMaze<TriangleTopology>;
+template class TopologyMaze<LayeredTopology>;
@@ -0,0 +1,432 @@
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+#include "maze.h"
+#include "mazeBuilder.h"
+#include "mazeTopology.h"
+#include "mazeValidator.h"
+#include "packedPath.h"
+
+namespace
+{
+    // Open wall from a to b when b is a neighbour of a, false for anything else
+    bool IsPassage(const std::vector<uint16_t>& cellInfo, uint32_t cellsAcrossHeight, uint32_t a, uint32_t b)
+    {
+        const uint32_t area = static_cast<uint32_t>(cellInfo.size());
+        if (a >= area || b >= area)
+            return false;
+
+        if (b == a + 1 && b % cellsAcrossHeight != 0)
+            return (cellInfo[a] & Maze::CELL_NORTH) != 0;
+        if (a == b + 1 && a % cellsAcrossHeight != 0)
+            return (cellInfo[a] & Maze::CELL_SOUTH) != 0;
+        if (b == a + cellsAcrossHeight)
+            return (cellInfo[a] & Maze::CELL_EAST) != 0;
+        if (a == b + cellsAcrossHeight)
+            return (cellInfo[a] & Maze::CELL_WEST) != 0;
+        return false;
+    }
+
+    // Open passage from a to b when both sides agree, b has to be a neighbour of a
+    template<typename Topology>
+    bool IsTopologyPassage(const std::vector<uint16_t>& cellInfo, const MazeTopologySize& size, uint32_t a, uint32_t b)
+    {
+        bool open = false;
+        ForEachDirection<Topology>([&](auto direction)
+            {
+                uint32_t neighbour = 0;
+                if (!open && (cellInfo[a] & Topology::PASSAGES[direction]) != 0 && Topology::template Neighbour<decltype(direction)::value>(size, a, neighbour) &&
+                    neighbour == b && (cellInfo[b] & Topology::PASSAGES[Topology::OPPOSITE[direction]]) != 0)
+                    open = true;
+            });
+        return open;
+    }
+}
+
+MazeValidation MazeValidator::CheckWalls(const std::vector<uint16_t>& cellInfo, uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight)
+{
+    MazeValidation validation;
+    const uint32_t area = cellsAcrossWidth * cellsAcrossHeight;
+    if (cellInfo.size() != area)
+    {
+        validation.error = "cell info has " + std::to_string(cellInfo.size()) + " cells instead of " + std::to_string(area);
+        validation.mismatchedWalls = 1;
+        return validation;
+    }
+
+    auto fail = [&](uint64_t& counter, const char* problem, uint32_t cell)
+        {
+            if (validation.error.empty())
+            {
+                validation.error = std::string(problem) + " at cell " + std::to_string(cell) + " (" + std::to_string(cell / cellsAcrossHeight) +
+                    ", " + std::to_string(cell % cellsAcrossHeight) + ")";
+            }
+            counter++;
+        };
+
+    // Every successful union merges two components
+    DisjointSet sets(area);
+    validation.components = area;
+
+    for (uint32_t x = 0, cell = 0; x < cellsAcrossWidth; x++)
+    {
+        for (uint32_t y = 0; y < cellsAcrossHeight; y++, cell++)
+        {
+            const uint16_t info = cellInfo[cell];
+            if ((info & Maze::CELL_VISITED) == 0)
+                fail(validation.unvisitedCells, "unvisited cell", cell);
+
+            // South and west only need the mirror check, north and east also count the passage
+            if (info & Maze::CELL_SOUTH)
+            {
+                if (y == 0)
+                    fail(validation.outerPassages, "south passage out of the maze", cell);
+                else if ((cellInfo[cell - 1] & Maze::CELL_NORTH) == 0)
+                    fail(validation.mismatchedWalls, "south passage without a north passage back", cell);
+            }
+            if (info & Maze::CELL_WEST)
+            {
+                if (x == 0)
+                    fail(validation.outerPassages, "west passage out of the maze", cell);
+                else if ((cellInfo[cell - cellsAcrossHeight] & Maze::CELL_EAST) == 0)
+                    fail(validation.mismatchedWalls, "west passage without an east passage back", cell);
+            }
+
+            auto connect = [&](uint32_t neighbour)
+                {
+                    validation.passages++;
+                    const uint32_t a = sets.Find(cell);
+                    const uint32_t b = sets.Find(neighbour);
+                    if (a == b)
+                    {
+                        fail(validation.loops, "loop closed", cell);
+                        return;
+                    }
+                    sets.UnionSets(a, b);
+                    validation.components--;
+                };
+
+            if (info & Maze::CELL_NORTH)
+            {
+                if (y + 1 == cellsAcrossHeight)
+                    fail(validation.outerPassages, "north passage out of the maze", cell);
+                else if ((cellInfo[cell + 1] & Maze::CELL_SOUTH) == 0)
+                    fail(validation.mismatchedWalls, "north passage without a south passage back", cell);
+                else
+                    connect(cell + 1);
+            }
+            if (info & Maze::CELL_EAST)
+            {
+                if (x + 1 == cellsAcrossWidth)
+                    fail(validation.outerPassages, "east passage out of the maze", cell);
+                else if ((cellInfo[cell + cellsAcrossHeight] & Maze::CELL_WEST) == 0)
+                    fail(validation.mismatchedWalls, "east passage without a west passage back", cell);
+                else
+                    connect(cell + cellsAcrossHeight);
+            }
+        }
+    }
+
+    if (validation.error.empty() && validation.components != 1)
+        validation.error = std::to_string(validation.components) + " separate regions";
+    return validation;
+}
+
+MazeValidation MazeValidator::CheckMaze(const Maze& maze)
+{
+    return CheckWalls(maze.m_VisitedCellInfo, maze.m_CellsAcrossWidth, maze.m_CellsAcrossHeight);
+}
+
+uint64_t MazeValidator::GetReferenceCost(const Maze& maze, std::pair<uint32_t, uint32_t> route, Costs costs)
+{
+    const uint64_t unreachable = std::numeric_limits<uint64_t>::max();
+    const uint32_t area = maze.m_MazeArea;
+    const uint32_t cellsAcrossHeight = maze.m_CellsAcrossHeight;
+    if (std::max(route.first, route.second) >= area || maze.m_VisitedCellInfo.size() != area)
+        return unreachable;
+
+    const std::vector<uint16_t>& cellInfo = maze.m_VisitedCellInfo;
+    std::vector<uint64_t> cost(area, unreachable);
+
+    // Passages are only taken when both sides agree, so a broken wall never makes the reference cheaper
+    auto forEachNeighbour = [&](uint32_t cell, auto&& function)
+        {
+            const uint16_t info = cellInfo[cell];
+            if ((info & Maze::CELL_NORTH) && cell % cellsAcrossHeight + 1 < cellsAcrossHeight && (cellInfo[cell + 1] & Maze::CELL_SOUTH))
+                function(cell + 1);
+            if ((info & Maze::CELL_EAST) && cell + cellsAcrossHeight < area && (cellInfo[cell + cellsAcrossHeight] & Maze::CELL_WEST))
+                function(cell + cellsAcrossHeight);
+            if ((info & Maze::CELL_SOUTH) && cell % cellsAcrossHeight != 0 && (cellInfo[cell - 1] & Maze::CELL_NORTH))
+                function(cell - 1);
+            if ((info & Maze::CELL_WEST) && cell >= cellsAcrossHeight && (cellInfo[cell - cellsAcrossHeight] & Maze::CELL_EAST))
+                function(cell - cellsAcrossHeight);
+        };
+
+    cost[route.first] = 0;
+    if (costs == STEPS || maze.m_CellWeights.size() != area)
+    {
+        if (costs == WEIGHTS)
+            return unreachable;
+
+        std::vector<uint32_t> queue;
+        queue.reserve(area);
+        queue.push_back(route.first);
+        for (size_t next = 0; next < queue.size() && cost[route.second] == unreachable; next++)
+        {
+            const uint32_t cell = queue[next];
+            forEachNeighbour(cell, [&](uint32_t neighbour)
+                {
+                    if (cost[neighbour] != unreachable)
+                        return;
+                    cost[neighbour] = cost[cell] + 1;
+                    queue.push_back(neighbour);
+                });
+        }
+        return cost[route.second];
+    }
+
+    maze.m_CellWeights.Visit([&](const auto& weights)
+        {
+            using Entry = std::pair<uint64_t, uint32_t>;
+            std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+            queue.push({ 0, route.first });
+            while (!queue.empty())
+            {
+                const Entry entry = queue.top();
+                queue.pop();
+                if (entry.first != cost[entry.second])
+                    continue;
+                if (entry.second == route.second)
+                    break;
+
+                forEachNeighbour(entry.second, [&](uint32_t neighbour)
+                    {
+                        const uint64_t next = entry.first + weights[neighbour];
+                        if (next < cost[neighbour])
+                        {
+                            cost[neighbour] = next;
+                            queue.push({ next, neighbour });
+                        }
+                    });
+            }
+        });
+    return cost[route.second];
+}
+
+uint64_t MazeValidator::GetPathCost(const Maze& maze, const PackedPath& path, Costs costs)
+{
+    if (path.size() == 0)
+        return 0;
+    if (costs == STEPS)
+        return path.size() - 1;
+
+    uint64_t cost = 0;
+    maze.m_CellWeights.Visit([&](const auto& weights)
+        {
+            bool start = true;
+            for (uint32_t cell : path)
+            {
+                if (!start && cell < weights.size())
+                    cost += weights[cell];
+                start = false;
+            }
+        });
+    return cost;
+}
+
+MazePathValidation MazeValidator::CheckPath(const Maze& maze, std::pair<uint32_t, uint32_t> route, const PackedPath& path, Costs costs)
+{
+    MazePathValidation validation;
+    validation.referenceCost = GetReferenceCost(maze, route, costs);
+
+    if (path.size() == 0)
+    {
+        validation.error = "empty path";
+        return validation;
+    }
+
+    PackedPath::Iterator cell = path.begin();
+    if (*cell != route.first)
+    {
+        validation.error = "path starts at " + std::to_string(*cell) + " instead of " + std::to_string(route.first);
+        return validation;
+    }
+
+    uint32_t previous = *cell;
+    for (++cell; cell != path.end(); ++cell)
+    {
+        // Both walls have to be open, a path through a half open wall is as wrong as one through a closed wall
+        if (!IsPassage(maze.m_VisitedCellInfo, maze.m_CellsAcrossHeight, previous, *cell) ||
+            !IsPassage(maze.m_VisitedCellInfo, maze.m_CellsAcrossHeight, *cell, previous))
+        {
+            validation.error = "no passage from " + std::to_string(previous) + " to " + std::to_string(*cell);
+            return validation;
+        }
+        previous = *cell;
+    }
+
+    if (previous != route.second)
+    {
+        validation.error = "path ends at " + std::to_string(previous) + " instead of " + std::to_string(route.second);
+        return validation;
+    }
+
+    validation.connected = true;
+    validation.cost = GetPathCost(maze, path, costs);
+    validation.optimal = validation.cost == validation.referenceCost;
+    if (!validation.optimal)
+        validation.error = "cost " + std::to_string(validation.cost) + " instead of " + std::to_string(validation.referenceCost);
+    return validation;
+}
+
+template<typename Topology>
+MazeValidation MazeValidator::CheckTopologyWalls(const std::vector<uint16_t>& cellInfo, const MazeTopologySize& size)
+{
+    MazeValidation validation;
+    const uint32_t cellCount = size.GetCellCount();
+    if (cellInfo.size() != cellCount)
+    {
+        validation.error = "cell info has " + std::to_string(cellInfo.size()) + " cells instead of " + std::to_string(cellCount);
+        validation.mismatchedWalls = 1;
+        return validation;
+    }
+
+    auto fail = [&](uint64_t& counter, const char* problem, uint32_t cell)
+        {
+            if (validation.error.empty())
+                validation.error = std::string(problem) + " at cell " + std::to_string(cell);
+            counter++;
+        };
+
+    // Visited sits right above the passage bits, see TopologyMaze
+    const uint16_t visited = 1 << Topology::DIRECTIONS;
+    DisjointSet sets(cellCount);
+    validation.components = cellCount;
+
+    for (uint32_t cell = 0; cell < cellCount; cell++)
+    {
+        const uint16_t info = cellInfo[cell];
+        if ((info & visited) == 0)
+            fail(validation.unvisitedCells, "unvisited cell", cell);
+
+        ForEachDirection<Topology>([&](auto direction)
+            {
+                if ((info & Topology::PASSAGES[direction]) == 0)
+                    return;
+
+                uint32_t neighbour = 0;
+                if (!Topology::template Neighbour<decltype(direction)::value>(size, cell, neighbour))
+                {
+                    fail(validation.outerPassages, "passage out of the maze", cell);
+                    return;
+                }
+                if ((cellInfo[neighbour] & Topology::PASSAGES[Topology::OPPOSITE[direction]]) == 0)
+                {
+                    fail(validation.mismatchedWalls, "passage without one back", cell);
+                    return;
+                }
+
+                // Both sides are open, the pair is counted from its lower cell
+                if (neighbour < cell)
+                    return;
+                validation.passages++;
+                const uint32_t a = sets.Find(cell);
+                const uint32_t b = sets.Find(neighbour);
+                if (a == b)
+                {
+                    fail(validation.loops, "loop closed", cell);
+                    return;
+                }
+                sets.UnionSets(a, b);
+                validation.components--;
+            });
+    }
+
+    if (validation.error.empty() && validation.components != 1)
+        validation.error = std::to_string(validation.components) + " separate regions";
+    return validation;
+}
+
+template<typename Topology>
+uint64_t MazeValidator::GetTopologyReferenceSteps(const std::vector<uint16_t>& cellInfo, const MazeTopologySize& size, std::pair<uint32_t, uint32_t> route)
+{
+    const uint64_t unreachable = std::numeric_limits<uint64_t>::max();
+    const uint32_t cellCount = size.GetCellCount();
+    if (std::max(route.first, route.second) >= cellCount || cellInfo.size() != cellCount)
+        return unreachable;
+
+    std::vector<uint64_t> steps(cellCount, unreachable);
+    std::vector<uint32_t> queue;
+    queue.reserve(cellCount);
+    queue.push_back(route.first);
+    steps[route.first] = 0;
+    for (size_t next = 0; next < queue.size() && steps[route.second] == unreachable; next++)
+    {
+        const uint32_t cell = queue[next];
+        ForEachDirection<Topology>([&](auto direction)
+            {
+                uint32_t neighbour = 0;
+                if ((cellInfo[cell] & Topology::PASSAGES[direction]) != 0 && Topology::template Neighbour<decltype(direction)::value>(size, cell, neighbour) &&
+                    (cellInfo[neighbour] & Topology::PASSAGES[Topology::OPPOSITE[direction]]) != 0 && steps[neighbour] == unreachable)
+                {
+                    steps[neighbour] = steps[cell] + 1;
+                    queue.push_back(neighbour);
+                }
+            });
+    }
+    return steps[route.second];
+}
+
+template<typename Topology>
+MazePathValidation MazeValidator::CheckTopologyPath(const std::vector<uint16_t>& cellInfo, const MazeTopologySize& size, std::pair<uint32_t, uint32_t> route,
+    const std::vector<uint32_t>& path)
+{
+    MazePathValidation validation;
+    validation.referenceCost = GetTopologyReferenceSteps<Topology>(cellInfo, size, route);
+
+    if (path.empty())
+    {
+        validation.error = "empty path";
+        return validation;
+    }
+    if (path.front() != route.first || path.back() != route.second)
+    {
+        validation.error = "path runs from " + std::to_string(path.front()) + " to " + std::to_string(path.back()) + " instead of " +
+            std::to_string(route.first) + " to " + std::to_string(route.second);
+        return validation;
+    }
+    for (size_t i = 1; i < path.size(); i++)
+    {
+        if (path[i] >= cellInfo.size() || !IsTopologyPassage<Topology>(cellInfo, size, path[i - 1], path[i]))
+        {
+            validation.error = "no passage from " + std::to_string(path[i - 1]) + " to " + std::to_string(path[i]);
+            return validation;
+        }
+    }
+
+    validation.connected = true;
+    validation.cost = path.size() - 1;
+    validation.optimal = validation.cost == validation.referenceCost;
+    if (!validation.optimal)
+        validation.error = "path takes " + std::to_string(validation.cost) + " steps, reference " + std::to_string(validation.referenceCost);
+    return validation;
+}
+
+template MazeValidation MazeValidator::CheckTopologyWalls<TorusTopology>(const std::vector<uint16_t>&, const MazeTopologySize&);
+template uint64_t MazeValidator::GetTopologyReferenceSteps<TorusTopology>(const std::vector<uint16_t>&, const MazeTopologySize&, std::pair<uint32_t, uint32_t>);
+template MazePathValidation MazeValidator::CheckTopologyPath<TorusTopology>(const std::vector<uint16_t>&, const MazeTopologySize&, std::pair<uint32_t, uint32_t>,
+    const std::vector<uint32_t>&);
+template MazeValidation MazeValidator::CheckTopologyWalls<HexTopology>(const std::vector<uint16_t>&, const MazeTopologySize&);
+template uint64_t MazeValidator::GetTopologyReferenceSteps<HexTopology>(const std::vector<uint16_t>&, const MazeTopologySize&, std::pair<uint32_t, uint32_t>);
+template MazePathValidation MazeValidator::CheckTopologyPath<HexTopology>(const std::vector<uint16_t>&, const MazeTopologySize&, std::pair<uint32_t, uint32_t>,
+    const std::vector<uint32_t>&);
+template MazeValidation MazeValidator::CheckTopologyWalls<TriangleTopology>(const std::vector<uint16_t>&, const MazeTopologySize&);
+template uint64_t MazeValidator::GetTopologyReferenceSteps<TriangleTopology>(const std::vector<uint16_t>&, const MazeTopologySize&, std::pair<uint32_t, uint32_t>);
+template MazePathValidation MazeValidator::CheckTopologyPath<TriangleTopology>(const std::vector<uint16_t>&, const MazeTopologySize&, std::pair<uint32_t, uint32_t>,
+    const std::vector<uint32_t>&);
+template MazeValidation MazeValidator::CheckTopologyWalls<LayeredTopology>(const std::vector<uint16_t>&, const MazeTopologySize&);
+template uint64_t MazeValidator::GetTopologyReferenceSteps<LayeredTopology>(const std::vector<uint16_t>&, const MazeTopologySize&, std::pair<uint32_t, uint32_t>);
+template MazePathValidation MazeValidator::CheckTopologyPath<LayeredTopology>(const std::vector<uint16_t>&, const MazeTopologySize&, std::pair<uint32_t, uint32_t>,
+    const std::vector<uint32_t>&);
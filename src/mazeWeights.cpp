@@ -0,0 +1,436 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+
+#include "mazeWeights.h"
+#include "narrowVector.h"
+
+namespace
+{
+    // Runs function(columnBegin, columnEnd, column) with a scratch column of cellsAcrossHeight floats per thread
+    template<typename Function>
+    void ForEachColumn(uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight, Function function)
+    {
+        uint64_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+        // Not worth starting threads for small mazes
+        uint64_t mazeArea = static_cast<uint64_t>(cellsAcrossWidth) * cellsAcrossHeight;
+        threadCount = std::min<uint64_t>({ threadCount, mazeArea / (1 << 16) + 1, cellsAcrossWidth });
+
+        uint32_t perThread = static_cast<uint32_t>((cellsAcrossWidth + threadCount - 1) / threadCount);
+        auto run = [&](uint32_t columnBegin, uint32_t columnEnd)
+            {
+                std::vector<float> column(cellsAcrossHeight);
+                function(columnBegin, columnEnd, column.data());
+            };
+
+        std::vector<std::thread> threads;
+        for (uint32_t begin = perThread; begin < cellsAcrossWidth; begin += perThread)
+            threads.emplace_back(run, begin, std::min(begin + perThread, cellsAcrossWidth));
+        run(0, std::min(perThread, cellsAcrossWidth));
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+
+    // Stateless so every cell can be computed on its own, in any order
+    inline uint32_t Hash(uint32_t a, uint32_t b, uint32_t c)
+    {
+        uint32_t h = a * 0x9E3779B1u ^ b * 0x85EBCA77u ^ c * 0xC2B2AE3Du;
+        h ^= h >> 16;
+        h *= 0x7FEB352Du;
+        h ^= h >> 15;
+        h *= 0x846CA68Bu;
+        h ^= h >> 16;
+        return h;
+    }
+
+    // [0, 1) from the top 24 bits, exact in a float
+    inline float ToUnit(uint32_t h)
+    {
+        return static_cast<float>(h >> 8) * (1.0f / 16777216.0f);
+    }
+
+    inline float Fade(float t)
+    {
+        return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+    }
+
+    // Converts a column of values in [0, 1] to weights
+    template<typename Weight>
+    void StoreColumn(Weight* weights, const float* column, uint32_t count, uint32_t maxWeight, bool invert)
+    {
+        const float scale = static_cast<float>(maxWeight);
+        const float top = static_cast<float>(maxWeight - 1);
+        const float flip = invert ? 1.0f : 0.0f;
+        for (uint32_t y = 0; y < count; y++)
+        {
+            float t = std::fabs(flip - std::min(std::max(column[y], 0.0f), 1.0f));
+            weights[y] = static_cast<Weight>(std::min(t * scale, top));
+        }
+    }
+
+    void Uniform(float* column, uint32_t cellBegin, uint32_t count, uint32_t seed)
+    {
+        for (uint32_t y = 0; y < count; y++)
+            column[y] = ToUnit(Hash(seed, cellBegin + y, 0));
+    }
+
+    // Unit vectors every 22.5 degrees
+    const float GRADIENTS[16][2] =
+    {
+        { 1.0f, 0.0f }, { 0.9238795f, 0.3826834f }, { 0.7071068f, 0.7071068f }, { 0.3826834f, 0.9238795f },
+        { 0.0f, 1.0f }, { -0.3826834f, 0.9238795f }, { -0.7071068f, 0.7071068f }, { -0.9238795f, 0.3826834f },
+        { -1.0f, 0.0f }, { -0.9238795f, -0.3826834f }, { -0.7071068f, -0.7071068f }, { -0.3826834f, -0.9238795f },
+        { 0.0f, -1.0f }, { 0.3826834f, -0.9238795f }, { 0.7071068f, -0.7071068f }, { 0.9238795f, -0.3826834f }
+    };
+
+    // Gradient noise with a random unit gradient on every lattice point. Down a column x is fixed so each lattice row
+    // reduces to a + b * fy, which leaves a lookup, a fade and a lerp per cell and octave.
+    void Terrain(float* column, uint32_t x, uint32_t count, const MazeWeightSettings& settings, std::vector<float>& rowA, std::vector<float>& rowB)
+    {
+        std::fill(column, column + count, 0.0f);
+
+        float spacing = std::max(settings.featureSize, 1.0f);
+        float amplitude = 1.0f, amplitudeSum = 0.0f;
+        for (uint32_t octave = 0; octave < std::max(settings.octaves, 1u); octave++)
+        {
+            const float frequency = 1.0f / spacing;
+            float px = (x + 0.5f) * frequency;
+            uint32_t ix = static_cast<uint32_t>(px);
+            float fx = px - ix;
+            float sx = Fade(fx);
+
+            uint32_t latticeRows = static_cast<uint32_t>(count * frequency) + 2;
+            rowA.resize(latticeRows);
+            rowB.resize(latticeRows);
+            uint32_t octaveSeed = Hash(settings.seed, octave, 0x7E44A1Bu);
+            for (uint32_t j = 0; j < latticeRows; j++)
+            {
+                uint32_t gradient0 = Hash(octaveSeed, ix, j) & 15;
+                uint32_t gradient1 = Hash(octaveSeed, ix + 1, j) & 15;
+                float a0 = GRADIENTS[gradient0][0] * fx, a1 = GRADIENTS[gradient1][0] * (fx - 1.0f);
+                float b0 = GRADIENTS[gradient0][1], b1 = GRADIENTS[gradient1][1];
+                rowA[j] = a0 + (a1 - a0) * sx;
+                rowB[j] = b0 + (b1 - b0) * sx;
+            }
+
+            // One run of cells per lattice row, the inner loop has no lookups left and vectorizes
+            uint32_t y = 0;
+            for (uint32_t j = 0; y < count; j++)
+            {
+                uint32_t yEnd = std::min(static_cast<uint32_t>(std::ceil((j + 1) * spacing - 0.5f)), count);
+                const float a0 = rowA[j], b0 = rowB[j], a1 = rowA[j + 1], b1 = rowB[j + 1];
+                for (; y < yEnd; y++)
+                {
+                    float fy = (y + 0.5f) * frequency - j;
+                    float bottom = a0 + b0 * fy;
+                    float top = a1 + b1 * (fy - 1.0f);
+                    column[y] += amplitude * (bottom + (top - bottom) * Fade(fy));
+                }
+            }
+
+            amplitudeSum += amplitude;
+            amplitude *= 0.5f;
+            spacing = std::max(spacing * 0.5f, 1.0f);
+        }
+
+        // Noise is within +-0.71 but mostly inside +-0.3, stretched so the field uses most of the weights
+        const float scale = 1.6f / amplitudeSum;
+        for (uint32_t y = 0; y < count; y++)
+            column[y] = 0.5f + column[y] * scale;
+    }
+
+    struct SwampPatch
+    {
+        float x, y, radius;
+    };
+}
+
+const char* MazeWeights::GetGeneratorName(uint8_t generator)
+{
+    switch (generator)
+    {
+    case MazeWeightSettings::UNIFORM: return "Uniform";
+    case MazeWeightSettings::TERRAIN: return "Terrain";
+    case MazeWeightSettings::RADIAL: return "Radial";
+    case MazeWeightSettings::LINEAR: return "Linear";
+    case MazeWeightSettings::SWAMP: return "Swamp";
+    }
+    return "Unknown";
+}
+
+void MazeWeights::Generate(NarrowVector& weights, uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight, const MazeWeightSettings& settings)
+{
+    const uint32_t maxWeight = std::max(settings.maxWeight, 1u);
+    weights.Assign(static_cast<size_t>(cellsAcrossWidth) * cellsAcrossHeight, maxWeight - 1);
+    if (weights.empty())
+        return;
+
+    const float width = static_cast<float>(cellsAcrossWidth);
+    const float height = static_cast<float>(cellsAcrossHeight);
+
+    // Patches are few, they are placed up front and every column only visits the ones crossing it
+    std::vector<SwampPatch> patches;
+    if (settings.generator == MazeWeightSettings::SWAMP)
+    {
+        std::mt19937 generator(settings.seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        for (uint32_t i = 0; i < settings.patchCount; i++)
+        {
+            SwampPatch patch;
+            patch.x = unit(generator) * width;
+            patch.y = unit(generator) * height;
+            patch.radius = std::max(settings.patchRadius * (0.5f + unit(generator)), 1.0f);
+            patches.push_back(patch);
+        }
+    }
+
+    // Linear gradient spans the projections of the four corners
+    const float radians = settings.angle * 0.017453293f;
+    const float directionX = std::cos(radians), directionY = std::sin(radians);
+    const float projectionMin = std::min(0.0f, width * directionX) + std::min(0.0f, height * directionY);
+    const float projectionMax = std::max(0.0f, width * directionX) + std::max(0.0f, height * directionY);
+    const float projectionScale = 1.0f / std::max(projectionMax - projectionMin, 1.0f);
+
+    // Radial gradient reaches 1 at the farthest corner
+    const float centerX = settings.centerX * width, centerY = settings.centerY * height;
+    const float farX = std::max(centerX, width - centerX), farY = std::max(centerY, height - centerY);
+    const float radialScale = 1.0f / std::max(std::sqrt(farX * farX + farY * farY), 1.0f);
+
+    ForEachColumn(cellsAcrossWidth, cellsAcrossHeight, [&](uint32_t columnBegin, uint32_t columnEnd, float* column)
+        {
+            std::vector<float> rowA, rowB;
+            for (uint32_t x = columnBegin; x < columnEnd; x++)
+            {
+                const uint32_t cellBegin = x * cellsAcrossHeight;
+                const float cx = x + 0.5f;
+
+                switch (settings.generator)
+                {
+                case MazeWeightSettings::TERRAIN:
+                    Terrain(column, x, cellsAcrossHeight, settings, rowA, rowB);
+                    break;
+                case MazeWeightSettings::RADIAL:
+                {
+                    const float dx2 = (cx - centerX) * (cx - centerX);
+                    for (uint32_t y = 0; y < cellsAcrossHeight; y++)
+                    {
+                        float dy = y + 0.5f - centerY;
+                        column[y] = std::sqrt(dx2 + dy * dy) * radialScale;
+                    }
+                    break;
+                }
+                case MazeWeightSettings::LINEAR:
+                {
+                    const float base = cx * directionX - projectionMin;
+                    for (uint32_t y = 0; y < cellsAcrossHeight; y++)
+                        column[y] = (base + (y + 0.5f) * directionY) * projectionScale;
+                    break;
+                }
+                case MazeWeightSettings::SWAMP:
+                {
+                    // Ground gets a little noise so there is still a cheapest way around
+                    for (uint32_t y = 0; y < cellsAcrossHeight; y++)
+                        column[y] = ToUnit(Hash(settings.seed, cellBegin + y, 1)) * 0.1f;
+
+                    for (const SwampPatch& patch : patches)
+                    {
+                        float dx = cx - patch.x;
+                        if (std::fabs(dx) >= patch.radius)
+                            continue;
+                        float halfChord = std::sqrt(patch.radius * patch.radius - dx * dx);
+                        uint32_t yBegin = static_cast<uint32_t>(std::max(patch.y - halfChord, 0.0f));
+                        uint32_t yEnd = static_cast<uint32_t>(std::min(patch.y + halfChord + 1.0f, height));
+                        // Solid in the middle, softening over the outer half
+                        const float inverseRadius = 2.0f / patch.radius;
+                        for (uint32_t y = yBegin; y < yEnd; y++)
+                        {
+                            float dy = y + 0.5f - patch.y;
+                            float depth = (patch.radius - std::sqrt(dx * dx + dy * dy)) * inverseRadius;
+                            column[y] = std::max(column[y], depth);
+                        }
+                    }
+                    break;
+                }
+                default:
+                    Uniform(column, cellBegin, cellsAcrossHeight, settings.seed);
+                    break;
+                }
+
+                weights.Visit([&](auto& narrow) { StoreColumn(narrow.data() + cellBegin, column, cellsAcrossHeight, maxWeight, settings.invert); });
+            }
+        });
+}
+
+bool MazeWeights::Load(const std::string& filePath, NarrowVector& weights, uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight, uint32_t maxWeight)
+{
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Failed to open " << filePath << std::endl;
+        return false;
+    }
+
+    const uint64_t mazeArea = static_cast<uint64_t>(cellsAcrossWidth) * cellsAcrossHeight;
+    std::string extension = filePath.size() >= 4 ? filePath.substr(filePath.size() - 4) : "";
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (extension != ".pgm" && extension != ".ppm")
+    {
+        file.seekg(0, std::ios::end);
+        if (static_cast<uint64_t>(file.tellg()) != mazeArea * sizeof(uint32_t))
+        {
+            std::cout << filePath << " does not have one uint32_t weight for each of the " << mazeArea << " cells" << std::endl;
+            return false;
+        }
+        file.seekg(0);
+        std::vector<uint32_t> values(mazeArea);
+        file.read(reinterpret_cast<char*>(values.data()), mazeArea * sizeof(uint32_t));
+        if (!file)
+        {
+            std::cout << "Failed to read " << filePath << std::endl;
+            return false;
+        }
+        weights.Assign(values.data(), values.size());
+        return true;
+    }
+
+    // Binary netpbm, P5 greyscale or P6 RGB with 8 or 16 bits per sample
+    std::string magic;
+    uint32_t values[3]{};
+    file >> magic;
+    for (uint32_t i = 0; i < 3 && file; i++)
+    {
+        file >> std::ws;
+        while (file.peek() == '#')
+        {
+            std::string comment;
+            std::getline(file, comment);
+            file >> std::ws;
+        }
+        file >> values[i];
+    }
+    file.get();
+
+    const uint32_t imageWidth = values[0], imageHeight = values[1], maxValue = values[2];
+    if (!file || (magic != "P5" && magic != "P6") || imageWidth == 0 || imageHeight == 0 || maxValue == 0 || maxValue > 65535)
+    {
+        std::cout << filePath << " is not a binary PGM or PPM image" << std::endl;
+        return false;
+    }
+
+    const uint32_t channels = magic == "P6" ? 3 : 1;
+    const uint32_t sampleSize = maxValue > 255 ? 2 : 1;
+    const size_t rowSize = static_cast<size_t>(imageWidth) * channels * sampleSize;
+    std::vector<uint8_t> pixels(rowSize * imageHeight);
+    file.read(reinterpret_cast<char*>(pixels.data()), pixels.size());
+    if (!file)
+    {
+        std::cout << "Failed to read the pixels of " << filePath << std::endl;
+        return false;
+    }
+
+    // Nearest pixel, image row 0 is cell row 0 like exported images
+    maxWeight = std::max(maxWeight, 1u);
+    const float scale = static_cast<float>(maxWeight - 1) / (maxValue * channels);
+    weights.Assign(mazeArea, maxWeight - 1);
+    weights.Visit([&](auto& narrow)
+        {
+            using Weight = typename std::decay_t<decltype(narrow)>::value_type;
+            ForEachColumn(cellsAcrossWidth, cellsAcrossHeight, [&](uint32_t columnBegin, uint32_t columnEnd, float*)
+                {
+                    for (uint32_t x = columnBegin; x < columnEnd; x++)
+                    {
+                        const size_t pixelColumn = static_cast<uint64_t>(x) * imageWidth / cellsAcrossWidth;
+                        Weight* column = &narrow[static_cast<size_t>(x) * cellsAcrossHeight];
+                        for (uint32_t y = 0; y < cellsAcrossHeight; y++)
+                        {
+                            const size_t pixelRow = static_cast<uint64_t>(y) * imageHeight / cellsAcrossHeight;
+                            const uint8_t* sample = &pixels[pixelRow * rowSize + pixelColumn * channels * sampleSize];
+                            uint32_t sum = 0;
+                            for (uint32_t channel = 0; channel < channels; channel++, sample += sampleSize)
+                                sum += sampleSize == 2 ? (sample[0] << 8 | sample[1]) : sample[0];
+                            column[y] = static_cast<Weight>(sum * scale + 0.5f);
+                        }
+                    }
+                });
+        });
+    return true;
+}
+
+bool MazeWeights::Write(const std::string& filePath, const NarrowVector& weights, uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight)
+{
+    const size_t mazeArea = static_cast<size_t>(cellsAcrossWidth) * cellsAcrossHeight;
+    if (weights.size() != mazeArea)
+    {
+        std::cout << "Weights do not match the size of the maze" << std::endl;
+        return false;
+    }
+
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Failed to open " << filePath << " for writing" << std::endl;
+        return false;
+    }
+
+    std::string extension = filePath.size() >= 4 ? filePath.substr(filePath.size() - 4) : "";
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (extension == ".pgm")
+    {
+        // 16 bit samples are big endian and only used when a weight needs them, larger weights are clamped
+        uint32_t largest = weights.Visit([](const auto& narrow) { return static_cast<uint32_t>(*std::max_element(narrow.begin(), narrow.end())); });
+        uint32_t maxValue = std::max(1u, std::min(largest, 65535u));
+        const uint32_t sampleSize = maxValue > 255 ? 2 : 1;
+        file << "P5\n" << cellsAcrossWidth << ' ' << cellsAcrossHeight << '\n' << maxValue << '\n';
+
+        std::vector<uint8_t> row(static_cast<size_t>(cellsAcrossWidth) * sampleSize);
+        for (uint32_t y = 0; y < cellsAcrossHeight; y++)
+        {
+            for (uint32_t x = 0; x < cellsAcrossWidth; x++)
+            {
+                uint32_t value = std::min(weights.Get(static_cast<size_t>(x) * cellsAcrossHeight + y), maxValue);
+                if (sampleSize == 2)
+                {
+                    row[2 * x] = static_cast<uint8_t>(value >> 8);
+                    row[2 * x + 1] = static_cast<uint8_t>(value);
+                }
+                else
+                {
+                    row[x] = static_cast<uint8_t>(value);
+                }
+            }
+            file.write(reinterpret_cast<const char*>(row.data()), row.size());
+        }
+    }
+    else
+    {
+        WriteRaw(file, weights);
+    }
+
+    file.flush();
+    if (!file.good())
+    {
+        std::cout << "Failed to write " << filePath << std::endl;
+        return false;
+    }
+    std::cout << "Weights written to " << filePath << std::endl;
+    return true;
+}
+
+void MazeWeights::WriteRaw(std::ostream& stream, const NarrowVector& weights)
+{
+    // Narrower weights are widened a block at a time
+    std::vector<uint32_t> block;
+    weights.Visit([&](const auto& narrow)
+        {
+            for (size_t begin = 0; begin < narrow.size(); begin += 1 << 16)
+            {
+                block.assign(narrow.begin() + begin, narrow.begin() + std::min<size_t>(begin + (1 << 16), narrow.size()));
+                stream.write(reinterpret_cast<const char*>(block.data()), block.size() * sizeof(uint32_t));
+            }
+        });
+}
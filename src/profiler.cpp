@@ -0,0 +1,234 @@
+#include <fstream>
+#include <iostream>
+
+#include "profiler.h"
+
+Profiler::Profiler()
+{
+    m_Epoch = std::chrono::steady_clock::now();
+    m_FrameStart = m_Epoch;
+
+    for (uint32_t i = 0; i < COUNTER_COUNT; i++)
+        m_PendingCounters[i] = 0;
+
+    m_Frames.resize(HISTORY_SIZE);
+    for (uint32_t i = 0; i < PHASE_COUNT; i++)
+        m_PhaseHistory[i].resize(HISTORY_SIZE, 0.0f);
+    for (uint32_t i = 0; i < COUNTER_COUNT; i++)
+        m_CounterHistory[i].resize(HISTORY_SIZE, 0.0f);
+
+    m_TraceEvents.resize(TRACE_EVENTS_SIZE);
+}
+
+void Profiler::BeginFrame()
+{
+    m_FrameStart = std::chrono::steady_clock::now();
+    m_CurrentFrame = FrameRecord();
+    m_CurrentFrame.frame = m_FrameNumber;
+}
+
+void Profiler::EndFrame()
+{
+    std::chrono::steady_clock::time_point frameEnd = std::chrono::steady_clock::now();
+    m_FrameNumber++;
+
+    // Counts of paused frames are thrown away, otherwise the first frame after resuming would get all of them
+    for (uint32_t i = 0; i < COUNTER_COUNT; i++)
+        m_CurrentFrame.counters[i] = m_PendingCounters[i].exchange(0, std::memory_order_relaxed);
+    if (m_Paused)
+        return;
+
+    m_CurrentFrame.frameMs = std::chrono::duration<double, std::milli>(frameEnd - m_FrameStart).count();
+
+    m_Frames[m_HistoryHead] = m_CurrentFrame;
+    for (uint32_t i = 0; i < PHASE_COUNT; i++)
+        m_PhaseHistory[i][m_HistoryHead] = static_cast<float>(m_CurrentFrame.phaseMs[i]);
+    for (uint32_t i = 0; i < COUNTER_COUNT; i++)
+        m_CounterHistory[i][m_HistoryHead] = static_cast<float>(m_CurrentFrame.counters[i]);
+
+    m_HistoryHead = (m_HistoryHead + 1) % HISTORY_SIZE;
+    if (m_HistoryCount < HISTORY_SIZE)
+        m_HistoryCount++;
+}
+
+void Profiler::AddPhaseTime(Phase phase, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    if (m_Paused)
+        return;
+
+    TraceEvent& event = m_TraceEvents[m_TraceHead];
+    event.frame = m_FrameNumber;
+    event.phase = phase;
+    event.startUs = ToMicroseconds(start);
+    event.durationUs = ToMicroseconds(end) - event.startUs;
+
+    m_TraceHead = (m_TraceHead + 1) % TRACE_EVENTS_SIZE;
+    if (m_TraceCount < TRACE_EVENTS_SIZE)
+        m_TraceCount++;
+
+    m_CurrentFrame.phaseMs[phase] += event.durationUs / 1000.0;
+}
+
+void Profiler::AddCounter(Counter counter, uint64_t value)
+{
+    m_PendingCounters[counter].fetch_add(value, std::memory_order_relaxed);
+}
+
+bool Profiler::ExportCSV(const std::string& filePath) const
+{
+    std::ofstream file(filePath);
+    if (!file.is_open())
+    {
+        std::cout << "Failed to open " << filePath << " for writing" << std::endl;
+        return false;
+    }
+
+    file << "frame,frame_ms";
+    for (uint32_t i = 0; i < PHASE_COUNT; i++)
+        file << ',' << GetPhaseName(static_cast<Phase>(i)) << "_ms";
+    for (uint32_t i = 0; i < COUNTER_COUNT; i++)
+        file << ',' << GetCounterName(static_cast<Counter>(i));
+    file << '\n';
+
+    for (uint32_t i = 0; i < GetFrameCount(); i++)
+    {
+        const FrameRecord& record = GetFrame(i);
+        file << record.frame << ',' << record.frameMs;
+        for (uint32_t j = 0; j < PHASE_COUNT; j++)
+            file << ',' << record.phaseMs[j];
+        for (uint32_t j = 0; j < COUNTER_COUNT; j++)
+            file << ',' << record.counters[j];
+        file << '\n';
+    }
+
+    std::cout << "Profile exported to " << filePath << std::endl;
+    return true;
+}
+
+bool Profiler::ExportChromeTrace(const std::string& filePath) const
+{
+    std::ofstream file(filePath);
+    if (!file.is_open())
+    {
+        std::cout << "Failed to open " << filePath << " for writing" << std::endl;
+        return false;
+    }
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"Render\"}}";
+
+    // Complete events for each phase, oldest first
+    uint32_t firstEvent = (m_TraceHead + TRACE_EVENTS_SIZE - m_TraceCount) % TRACE_EVENTS_SIZE;
+    uint64_t oldestFrame = 0;
+    for (uint32_t i = 0; i < m_TraceCount; i++)
+    {
+        const TraceEvent& event = m_TraceEvents[(firstEvent + i) % TRACE_EVENTS_SIZE];
+        if (i == 0)
+            oldestFrame = event.frame;
+
+        file << ",\n{\"name\":\"" << GetPhaseName(event.phase) << "\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+            << ",\"ts\":" << event.startUs << ",\"dur\":" << event.durationUs
+            << ",\"args\":{\"frame\":" << event.frame << "}}";
+    }
+
+    // Counter events at the end of every frame that still has trace events
+    uint32_t traceIndex = 0;
+    for (uint32_t i = 0; i < GetFrameCount(); i++)
+    {
+        const FrameRecord& record = GetFrame(i);
+        if (m_TraceCount == 0 || record.frame < oldestFrame)
+            continue;
+
+        // Timestamp of the last phase recorded in this frame
+        double timestamp = -1.0;
+        for (; traceIndex < m_TraceCount; traceIndex++)
+        {
+            const TraceEvent& event = m_TraceEvents[(firstEvent + traceIndex) % TRACE_EVENTS_SIZE];
+            if (event.frame > record.frame)
+                break;
+            if (event.frame == record.frame)
+                timestamp = event.startUs + event.durationUs;
+        }
+        if (timestamp < 0.0)
+            continue;
+
+        for (uint32_t j = 0; j < COUNTER_COUNT; j++)
+        {
+            file << ",\n{\"name\":\"" << GetCounterName(static_cast<Counter>(j)) << "\",\"ph\":\"C\",\"pid\":1"
+                << ",\"ts\":" << timestamp << ",\"args\":{\"value\":" << record.counters[j] << "}}";
+        }
+    }
+
+    file << "\n]}\n";
+
+    std::cout << "Trace exported to " << filePath << std::endl;
+    return true;
+}
+
+const Profiler::FrameRecord& Profiler::GetFrame(uint32_t i) const
+{
+    return m_Frames[(GetHistoryOffset() + i) % HISTORY_SIZE];
+}
+
+uint32_t Profiler::GetFrameCount() const
+{
+    return m_HistoryCount;
+}
+
+uint32_t Profiler::GetHistoryOffset() const
+{
+    return (m_HistoryHead + HISTORY_SIZE - m_HistoryCount) % HISTORY_SIZE;
+}
+
+const float* Profiler::GetPhaseHistory(Phase phase) const
+{
+    return m_PhaseHistory[phase].data();
+}
+
+const float* Profiler::GetCounterHistory(Counter counter) const
+{
+    return m_CounterHistory[counter].data();
+}
+
+const char* Profiler::GetPhaseName(Phase phase)
+{
+    switch (phase)
+    {
+    case GET_BUTTON_STATES:
+        return "GetButtonStates";
+    case DRAW_MAZE:
+        return "DrawMaze";
+    case GET_PATH_IF_FOUND:
+        return "GetPathIfFound";
+    case BUFFER_UPLOAD:
+        return "BufferUpload";
+    case DRAW_CALLS:
+        return "DrawCalls";
+    case IMGUI_RENDER:
+        return "ImGuiRender";
+    default:
+        return "Unknown";
+    }
+}
+
+const char* Profiler::GetCounterName(Counter counter)
+{
+    switch (counter)
+    {
+    case BUILDER_STEPS:
+        return "BuilderSteps";
+    case SOLVER_STEPS:
+        return "SolverSteps";
+    case BYTES_UPLOADED:
+        return "BytesUploaded";
+    case CELLS_TOUCHED:
+        return "CellsTouched";
+    default:
+        return "Unknown";
+    }
+}
+
+double Profiler::ToMicroseconds(std::chrono::steady_clock::time_point time) const
+{
+    return std::chrono::duration<double, std::micro>(time - m_Epoch).count();
+}
\ No newline at end of file
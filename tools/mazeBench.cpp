@@ -0,0 +1,544 @@
+// Reproducible timings of every builder and solver over a ladder of square maze sizes
+//   MazeBench run <output.json> [min=64] [max=8192] [passes=6] [runs=1] [time=25] [warmup=1] [seed=1] [counters=1] [builders=kruskal,wilson,...] [solvers=bfs,astar,...]
+//   MazeBench compare <baseline.json> <current.json> [threshold=10] [floor=0.5]
+// Sizes are cells across and double from min to max. Every maze is built with a fixed seed, gets uniform weights
+// with the same seed and is solved from the bottom left to the top right corner by every solver.
+// A case is reported with cells per second, ns per step, steps, the peak frontier of solvers, the peak resident
+// memory while it ran and the number and bytes of its heap allocations. Every case first runs once without being
+// measured, warmup=0 leaves that out, then runs at least runs times and until time milliseconds were measured.
+// The whole ladder is gone through passes times and the fastest run of a case over all passes is kept, so a case
+// is not slower only because the machine was busy or clocked down for the few seconds it ran in. On Linux run
+// starts itself again with address space randomization turned off, where the heap and the stack land moves some
+// cases by a fifth between two runs of the same binary.
+// On Linux cases also get cycles, instructions, L1D and LLC misses and branch misses per cell from perf_event_open,
+// cells being the maze area for builders and the expanded cells for solvers. Counters which can not be opened are
+// left out of the output, counters=0 leaves all of them out.
+// structureBytes is what the maze, graph, builder and solver of a case had reserved when it finished. At the end the
+// structures of the case which reserved the most are printed, along with the case with the highest peak resident memory.
+// compare matches the cases of two outputs by name and exits with 1 when the ns per step, the allocations or the
+// peak memory of any case grew by more than threshold percent. The ns per step of cases whose fastest run took less
+// than floor milliseconds in the baseline are only noise and not compared, neither are peak memory changes below 2 MB.
+// Cases in only one of the files are listed.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/personality.h>
+#include <unistd.h>
+#endif
+
+#include "maze.h"
+#include "mazeBuilder.h"
+#include "mazeCounters.h"
+#include "mazeGraph.h"
+#include "mazeMemory.h"
+#include "mazeRegistry.h"
+#include "mazeWeights.h"
+
+namespace
+{
+    std::atomic<uint64_t> g_Allocations{ 0 };
+    std::atomic<uint64_t> g_AllocatedBytes{ 0 };
+
+    void* CountedAllocate(size_t size)
+    {
+        g_Allocations.fetch_add(1, std::memory_order_relaxed);
+        g_AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        if (void* memory = std::malloc(size ? size : 1))
+            return memory;
+        throw std::bad_alloc();
+    }
+}
+
+// Every heap allocation of the process goes through these, the counters are read around each case
+void* operator new(size_t size) { return CountedAllocate(size); }
+void* operator new[](size_t size) { return CountedAllocate(size); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+
+namespace
+{
+    // Fields compared by MazeBench compare, all of them are better when lower
+    constexpr const char* COMPARED_FIELDS[] = { "nsPerStep", "allocations", "peakRssKb" };
+    // Compared ones and the time of the fastest run for the noise floor
+    constexpr const char* READ_FIELDS[] = { "nsPerStep", "allocations", "peakRssKb", "ms" };
+    // Peak resident memory that grew by less is pages the allocator kept from an earlier case, not the case itself
+    constexpr double PEAK_RSS_FLOOR_KB = 2048.0;
+
+    struct BenchCase
+    {
+        std::string name;
+        std::string builder;
+        std::string solver;
+        uint64_t cells = 0;
+        uint64_t steps = 0;
+        // Of the fastest run, out of runs measured ones over all passes
+        double milliseconds = 0.0;
+        uint32_t runs = 0;
+        uint64_t peakFrontier = 0;
+        uint64_t pathCells = 0;
+        // Lowest of all runs, the others include pages kept from earlier cases
+        uint64_t peakRssKb = 0;
+        uint64_t allocations = 0;
+        uint64_t allocatedBytes = 0;
+        // cells of the counters are the processed cells
+        MazeCounterSample counters;
+        MazeMemoryReport memory;
+    };
+
+    // Peak resident memory is reset where the platform allows it, otherwise it is the peak of the whole process so far
+    void ResetPeakMemory()
+    {
+#ifndef _WIN32
+        std::ofstream clearRefs("/proc/self/clear_refs");
+        clearRefs << "5";
+#endif
+    }
+
+    uint64_t GetPeakMemoryKb()
+    {
+        return MazeMemoryReport::GetPeakResidentBytes() / 1024;
+    }
+
+    // Counters of one case, started right before the timed part
+    class CaseMeter
+    {
+    public:
+        CaseMeter(const MazeCounters& counters)
+            : m_Counters(counters)
+        {
+            ResetPeakMemory();
+            m_Allocations = g_Allocations;
+            m_AllocatedBytes = g_AllocatedBytes;
+            m_Start = std::chrono::steady_clock::now();
+            m_CountersStart = m_Counters.Read();
+        }
+
+        // cells is the number of cells the case processed
+        void Finish(BenchCase& result, uint64_t cells) const
+        {
+            result.counters = MazeCounters::Difference(m_CountersStart, m_Counters.Read());
+            result.counters.cells = cells;
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - m_Start;
+            result.milliseconds = elapsed.count();
+            result.allocations = g_Allocations - m_Allocations;
+            result.allocatedBytes = g_AllocatedBytes - m_AllocatedBytes;
+            result.peakRssKb = GetPeakMemoryKb();
+        }
+
+    private:
+        const MazeCounters& m_Counters;
+        MazeCounterSample m_CountersStart;
+        uint64_t m_Allocations = 0;
+        uint64_t m_AllocatedBytes = 0;
+        std::chrono::steady_clock::time_point m_Start;
+    };
+
+    // Fastest of the runs of a case. measure runs it once and returns the result, the first run only warms up the
+    // caches, the allocator and the pages of the maze when warmUp is set
+    template<typename Measure>
+    BenchCase RepeatCase(Measure measure, uint32_t runs, double minMilliseconds, bool warmUp)
+    {
+        if (warmUp)
+            measure();
+
+        BenchCase fastest = measure();
+        double total = fastest.milliseconds;
+        uint64_t peakRssKb = fastest.peakRssKb;
+        uint32_t count = 1;
+        for (; count < runs || total < minMilliseconds; count++)
+        {
+            BenchCase result = measure();
+            total += result.milliseconds;
+            peakRssKb = std::min(peakRssKb, result.peakRssKb);
+            if (result.milliseconds < fastest.milliseconds)
+                fastest = std::move(result);
+        }
+        fastest.runs = count;
+        fastest.peakRssKb = peakRssKb;
+        return fastest;
+    }
+
+    // The first pass adds the cases, later ones replace a case when their fastest run was faster
+    void KeepFastest(std::vector<BenchCase>& cases, size_t index, BenchCase result)
+    {
+        if (index == cases.size())
+        {
+            cases.push_back(std::move(result));
+            return;
+        }
+        const uint32_t runs = cases[index].runs + result.runs;
+        const uint64_t peakRssKb = std::min(cases[index].peakRssKb, result.peakRssKb);
+        if (result.milliseconds < cases[index].milliseconds)
+            cases[index] = std::move(result);
+        cases[index].runs = runs;
+        cases[index].peakRssKb = peakRssKb;
+    }
+
+    // Names separated by commas, looked up in the registry with find
+    template<typename Entry, typename Find>
+    bool ParseList(Find find, const std::string& list, std::vector<const Entry*>& selected)
+    {
+        std::stringstream stream(list);
+        std::string name;
+        while (std::getline(stream, name, ','))
+        {
+            const Entry* found = find(name);
+            if (!found)
+            {
+                std::cout << "Unknown algorithm " << name << std::endl;
+                return false;
+            }
+            selected.push_back(found);
+        }
+        return true;
+    }
+
+    void WriteCase(std::ostream& stream, const BenchCase& result)
+    {
+        const double seconds = result.milliseconds / 1000.0;
+        // One case per line so compare can read it back without a JSON library
+        stream << "    {\"name\": \"" << result.name << "\", \"builder\": \"" << result.builder << "\", \"solver\": \"" << result.solver
+            << "\", \"cells\": " << result.cells << ", \"steps\": " << result.steps << ", \"ms\": " << result.milliseconds << ", \"runs\": " << result.runs
+            << ", \"cellsPerSecond\": " << (seconds > 0.0 ? result.cells / seconds : 0.0)
+            << ", \"nsPerStep\": " << (result.steps ? result.milliseconds * 1e6 / result.steps : 0.0)
+            << ", \"peakFrontier\": " << result.peakFrontier << ", \"pathCells\": " << result.pathCells
+            << ", \"peakRssKb\": " << result.peakRssKb << ", \"allocations\": " << result.allocations
+            << ", \"allocatedBytes\": " << result.allocatedBytes << ", \"structureBytes\": " << result.memory.GetReservedBytes();
+
+        // Field names are the event names in camel case with PerCell appended
+        constexpr const char* COUNTER_FIELDS[MazeCounterSample::EVENT_COUNT] =
+            { "cyclesPerCell", "instructionsPerCell", "l1dMissesPerCell", "llcMissesPerCell", "branchMissesPerCell" };
+        for (uint32_t i = 0; i < MazeCounterSample::EVENT_COUNT; i++)
+        {
+            const MazeCounterSample::Events event = static_cast<MazeCounterSample::Events>(i);
+            if (result.counters.IsAvailable(event))
+                stream << ", \"" << COUNTER_FIELDS[i] << "\": " << result.counters.GetPerCell(event);
+        }
+        if (result.counters.IsAvailable(MazeCounterSample::CYCLES) && result.counters.IsAvailable(MazeCounterSample::INSTRUCTIONS))
+            stream << ", \"ipc\": " << result.counters.GetIpc();
+        stream << "}";
+    }
+
+    int Run(const std::string& outputPath, int argc, char** argv)
+    {
+        uint32_t minSize = 64, maxSize = 8192, seed = 1;
+        int runs = 1, passes = 6;
+        double minMilliseconds = 25.0;
+        bool warmUp = true;
+        bool countHardwareEvents = true;
+        std::vector<const MazeBuilderEntry*> builders;
+        std::vector<const MazeSolverEntry*> solvers;
+        for (int i = 0; i < argc; i++)
+        {
+            std::string option = argv[i];
+            size_t separator = option.find('=');
+            std::string name = option.substr(0, separator);
+            std::string value = separator == std::string::npos ? "" : option.substr(separator + 1);
+            if (name == "min")
+                minSize = static_cast<uint32_t>(std::atoi(value.c_str()));
+            else if (name == "max")
+                maxSize = static_cast<uint32_t>(std::atoi(value.c_str()));
+            else if (name == "passes")
+                passes = std::atoi(value.c_str());
+            else if (name == "runs")
+                runs = std::atoi(value.c_str());
+            else if (name == "time")
+                minMilliseconds = std::atof(value.c_str());
+            else if (name == "warmup")
+                warmUp = value != "0";
+            else if (name == "seed")
+                seed = static_cast<uint32_t>(std::atoi(value.c_str()));
+            else if (name == "counters")
+                countHardwareEvents = value != "0";
+            else if (name == "builders")
+            {
+                if (!ParseList<MazeBuilderEntry>([](const std::string& name) { return MazeRegistry::FindBuilder(name); }, value, builders))
+                    return 2;
+            }
+            else if (name == "solvers")
+            {
+                if (!ParseList<MazeSolverEntry>([](const std::string& name) { return MazeRegistry::FindSolver(name); }, value, solvers))
+                    return 2;
+            }
+            else
+            {
+                std::cout << "Unknown option " << option << std::endl;
+                return 2;
+            }
+        }
+        // Everything registered by default, plugins included
+        if (builders.empty())
+        {
+            for (const MazeBuilderEntry& entry : MazeRegistry::GetBuilders())
+                builders.push_back(&entry);
+        }
+        if (solvers.empty())
+        {
+            for (const MazeSolverEntry& entry : MazeRegistry::GetSolvers())
+                solvers.push_back(&entry);
+        }
+        if (minSize < 2 || maxSize < minSize || runs < 1 || passes < 1)
+        {
+            std::cout << "Sizes have to be at least 2 with min not above max, runs and passes at least 1" << std::endl;
+            return 2;
+        }
+
+        // Left closed when turned off, reads then come back empty
+        MazeCounters counters;
+        if (countHardwareEvents && !counters.Open())
+            std::cout << "Hardware counters unavailable: " << counters.GetError() << std::endl;
+
+        MazeWeightSettings weightSettings;
+        weightSettings.seed = seed;
+
+        std::vector<BenchCase> cases;
+        for (int pass = 0; pass < passes; pass++)
+        {
+            size_t index = 0;
+            for (uint64_t size = minSize; size <= maxSize; size *= 2)
+            {
+                const std::string sizeName = std::to_string(size);
+                for (const MazeBuilderEntry* builder : builders)
+                {
+                    // Cells are 2 * 2 + 1 pixels across
+                    Maze maze(static_cast<uint32_t>(size * 5), static_cast<uint32_t>(size * 5), 2, 1, false);
+                    auto measureBuilder = [&]()
+                        {
+                            std::fill(maze.m_VisitedCellInfo.begin(), maze.m_VisitedCellInfo.end(), 0);
+                            maze.m_VisitedCellCount = 0;
+
+                            BenchCase result;
+                            result.name = builder->name + "/" + sizeName;
+                            result.builder = builder->name;
+                            result.cells = maze.m_MazeArea;
+                            CaseMeter meter(counters);
+                            MazeBuilder mazeBuilder(&maze, builder->algorithm, seed);
+                            result.steps = builder->run(mazeBuilder);
+                            meter.Finish(result, maze.m_MazeArea);
+                            maze.ReportMemory(result.memory);
+                            mazeBuilder.ReportMemory(result.memory);
+                            return result;
+                        };
+                    // Every run builds the same maze, the solvers get the one of the last run
+                    KeepFastest(cases, index, RepeatCase(measureBuilder, static_cast<uint32_t>(runs), minMilliseconds, warmUp));
+                    std::cout << cases[index].name << ": " << cases[index].milliseconds << " ms, " << cases[index].runs << " runs" << std::endl;
+                    index++;
+
+                    maze.SetCellWeights(weightSettings);
+                    MazeGraph graph;
+                    if (!graph.Build(maze))
+                        return 2;
+
+                    for (const MazeSolverEntry* solver : solvers)
+                    {
+                        std::pair<uint32_t, uint32_t> route(0, maze.m_MazeArea - 1);
+                        auto measureSolver = [&]()
+                            {
+                                for (uint16_t& cell : maze.m_VisitedCellInfo)
+                                    cell &= ~Maze::CELL_SEARCHED;
+
+                                BenchCase result;
+                                result.name = builder->name + "/" + solver->name + "/" + sizeName;
+                                result.builder = builder->name;
+                                result.solver = solver->name;
+                                result.cells = maze.m_MazeArea;
+                                CaseMeter meter(counters);
+                                // Stepped one at a time to follow the peak frontier
+                                MazeSolver mazeSolver(&maze, graph, solver->algorithm, route, seed);
+                                result.peakFrontier = mazeSolver.GetFrontierSize();
+                                while (!mazeSolver.m_Completed && mazeSolver.GetFrontierSize() > 0)
+                                {
+                                    mazeSolver.Step();
+                                    result.steps += !mazeSolver.m_Completed;
+                                    result.peakFrontier = std::max<uint64_t>(result.peakFrontier, mazeSolver.GetFrontierSize());
+                                }
+                                result.pathCells = mazeSolver.m_Path.size();
+                                // Every step but the last expands one cell
+                                meter.Finish(result, result.steps);
+                                maze.ReportMemory(result.memory);
+                                graph.ReportMemory(result.memory);
+                                mazeSolver.ReportMemory(result.memory);
+                                return result;
+                            };
+                        KeepFastest(cases, index, RepeatCase(measureSolver, static_cast<uint32_t>(runs), minMilliseconds, warmUp));
+                        std::cout << cases[index].name << ": " << cases[index].milliseconds << " ms, " << cases[index].runs << " runs" << std::endl;
+                        index++;
+                    }
+                }
+            }
+        }
+
+        std::ofstream file(outputPath);
+        if (!file.is_open())
+        {
+            std::cout << "Failed to open " << outputPath << " for writing" << std::endl;
+            return 2;
+        }
+        file << "{\n  \"seed\": " << seed << ",\n  \"passes\": " << passes << ",\n  \"runs\": " << runs << ",\n  \"time\": " << minMilliseconds << ",\n  \"warmup\": " << warmUp
+            << ",\n  \"cases\": [\n";
+        for (size_t i = 0; i < cases.size(); i++)
+        {
+            WriteCase(file, cases[i]);
+            file << (i + 1 < cases.size() ? ",\n" : "\n");
+        }
+        file << "  ]\n}\n";
+        std::cout << cases.size() << " cases written to " << outputPath << std::endl;
+
+        auto largest = std::max_element(cases.begin(), cases.end(),
+            [](const BenchCase& a, const BenchCase& b) { return a.memory.GetReservedBytes() < b.memory.GetReservedBytes(); });
+        if (largest != cases.end())
+        {
+            std::cout << "\nPeak memory, structures of " << largest->name << ":\n";
+            largest->memory.Print(std::cout);
+        }
+
+        auto highest = std::max_element(cases.begin(), cases.end(), [](const BenchCase& a, const BenchCase& b) { return a.peakRssKb < b.peakRssKb; });
+        if (highest != cases.end())
+            std::cout << "Highest peak resident memory: " << highest->peakRssKb / 1024.0 << " MB in " << highest->name << std::endl;
+        return file.good() ? 0 : 2;
+    }
+
+    // Returns only when the process already runs without randomization or it can not be turned off
+    void DisableAddressRandomization(char** argv)
+    {
+#ifdef __linux__
+        const int persona = personality(0xffffffff);
+        if (persona == -1 || (persona & ADDR_NO_RANDOMIZE) != 0 || personality(persona | ADDR_NO_RANDOMIZE) == -1)
+            return;
+        execv("/proc/self/exe", argv);
+        std::cout << "Could not restart without address space randomization, timings vary more between runs" << std::endl;
+#else
+        (void)argv;
+#endif
+    }
+
+    // Reads the cases of a file written by Run, a case is one line
+    bool ReadCases(const std::string& filePath, std::map<std::string, std::map<std::string, double>>& cases)
+    {
+        std::ifstream file(filePath);
+        if (!file.is_open())
+        {
+            std::cout << "Failed to open " << filePath << std::endl;
+            return false;
+        }
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            size_t name = line.find("\"name\": \"");
+            if (name == std::string::npos)
+                continue;
+            name += 9;
+            std::map<std::string, double>& fields = cases[line.substr(name, line.find('"', name) - name)];
+            for (const char* field : READ_FIELDS)
+            {
+                size_t value = line.find("\"" + std::string(field) + "\": ");
+                if (value != std::string::npos)
+                    fields[field] = std::atof(line.c_str() + value + std::strlen(field) + 4);
+            }
+        }
+        return true;
+    }
+
+    int Compare(const std::string& baselinePath, const std::string& currentPath, double threshold, double floor)
+    {
+        std::map<std::string, std::map<std::string, double>> baseline, current;
+        if (!ReadCases(baselinePath, baseline) || !ReadCases(currentPath, current))
+            return 2;
+
+        uint32_t regressions = 0, compared = 0, belowFloor = 0, unmatched = 0;
+        for (const auto& [name, fields] : baseline)
+        {
+            if (current.find(name) == current.end())
+            {
+                std::cout << name << ": not in " << currentPath << std::endl;
+                unmatched++;
+            }
+        }
+
+        for (const auto& [name, fields] : current)
+        {
+            auto match = baseline.find(name);
+            if (match == baseline.end())
+            {
+                std::cout << name << ": not in " << baselinePath << std::endl;
+                unmatched++;
+                continue;
+            }
+            compared++;
+
+            // Timer resolution and scheduling are a large part of a run this short
+            auto milliseconds = match->second.find("ms");
+            const bool timeIsNoise = milliseconds != match->second.end() && milliseconds->second < floor;
+            belowFloor += timeIsNoise;
+
+            for (const char* field : COMPARED_FIELDS)
+            {
+                auto before = match->second.find(field);
+                auto after = fields.find(field);
+                if (before == match->second.end() || after == fields.end() || (timeIsNoise && std::strcmp(field, "nsPerStep") == 0))
+                    continue;
+                if (std::strcmp(field, "peakRssKb") == 0 && std::abs(after->second - before->second) < PEAK_RSS_FLOOR_KB)
+                    continue;
+
+                // A case that went from nothing to something is always a regression
+                double change = before->second > 0.0 ? (after->second / before->second - 1.0) * 100.0 : (after->second > 0.0 ? 100.0 : 0.0);
+                if (change > threshold)
+                {
+                    std::cout << "REGRESSION " << name << " " << field << ": " << before->second << " -> " << after->second
+                        << " (+" << change << "%)" << std::endl;
+                    regressions++;
+                }
+                else if (change < -threshold)
+                {
+                    std::cout << "improved " << name << " " << field << ": " << before->second << " -> " << after->second
+                        << " (" << change << "%)" << std::endl;
+                }
+            }
+        }
+
+        std::cout << compared << " cases compared, " << belowFloor << " of them faster than " << floor << " ms and not timed, " << unmatched
+            << " in only one file, " << regressions << " regressions above " << threshold << "%" << std::endl;
+        return regressions ? 1 : 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc >= 3 && std::strcmp(argv[1], "run") == 0)
+    {
+        DisableAddressRandomization(argv);
+        return Run(argv[2], argc - 3, argv + 3);
+    }
+    if (argc >= 4 && argc <= 6 && std::strcmp(argv[1], "compare") == 0)
+    {
+        double threshold = 10.0, floor = 0.5;
+        for (int i = 4; i < argc; i++)
+        {
+            if (std::strncmp(argv[i], "threshold=", 10) == 0)
+                threshold = std::atof(argv[i] + 10);
+            else if (std::strncmp(argv[i], "floor=", 6) == 0)
+                floor = std::atof(argv[i] + 6);
+        }
+        return Compare(argv[2], argv[3], threshold, floor);
+    }
+
+    std::cout << "Usage: MazeBench run <output.json> [min=64] [max=8192] [passes=6] [runs=1] [time=25] [warmup=1] [seed=1] [counters=1] [builders=backtrack,kruskal,prims,wilson,eller] [solvers=dfs,bfs,dijkstra,astar]" << std::endl;
+    std::cout << "       MazeBench compare <baseline.json> <current.json> [threshold=10] [floor=0.5]" << std::endl;
+    return 2;
+}
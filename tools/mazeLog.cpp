@@ -0,0 +1,162 @@
+// Reads step logs written with Record Steps
+//   MazeLog stats <log>              aggregate statistics of one run
+//   MazeLog compare <log> <log>      compares two runs step by step, exits with 1 when they differ
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+
+#include "mazeRecorder.h"
+#include "mazeRegistry.h"
+
+namespace
+{
+    const char* GetAlgorithmName(const MazeLogHeader& header)
+    {
+        if (header.kind == MAZE_LOG_BUILDER)
+        {
+            const MazeBuilderEntry* entry = MazeRegistry::FindBuilder(header.algorithm);
+            return entry ? entry->label.c_str() : "Unknown";
+        }
+        const MazeSolverEntry* entry = MazeRegistry::FindSolver(header.algorithm);
+        return entry ? entry->label.c_str() : "Unknown";
+    }
+
+    void PrintHeader(const MazeLogHeader& header)
+    {
+        std::cout << (header.kind == MAZE_LOG_BUILDER ? "Builder " : "Solver ") << GetAlgorithmName(header)
+            << ", " << header.cellsAcrossWidth << 'x' << header.cellsAcrossHeight << " cells, seed " << header.seed;
+        if (header.kind == MAZE_LOG_SOLVER)
+            std::cout << ", route " << header.routeStart << " -> " << header.routeEnd;
+        std::cout << std::endl;
+    }
+
+    void PrintEvent(const char* name, const MazeLogEvent& event)
+    {
+        std::cout << "  " << name << " cell " << event.cell << " flags 0x" << std::hex << event.flags << std::dec
+            << " frontier " << event.frontier << std::endl;
+    }
+
+    int Stats(const std::string& filePath)
+    {
+        MazeLogReader reader;
+        if (!reader.Open(filePath))
+            return 2;
+
+        const MazeLogHeader& header = reader.GetHeader();
+        PrintHeader(header);
+
+        uint64_t steps = 0, frontierSum = 0;
+        uint32_t maxFrontier = 0;
+        uint64_t flagCounts[6]{};
+        std::unordered_set<uint32_t> cells;
+
+        MazeLogEvent event;
+        while (reader.Next(event))
+        {
+            steps++;
+            frontierSum += event.frontier;
+            maxFrontier = std::max(maxFrontier, event.frontier);
+            cells.insert(event.cell);
+            for (uint32_t bit = 0; bit < 6; bit++)
+                flagCounts[bit] += (event.flags >> bit) & 1;
+        }
+
+        static const char* flagNames[6] = { "north", "east", "south", "west", "visited", "searched" };
+        uint64_t mazeArea = static_cast<uint64_t>(header.cellsAcrossWidth) * header.cellsAcrossHeight;
+
+        std::cout << "Steps            " << steps << std::endl;
+        std::cout << "Distinct cells   " << cells.size() << " (" << (mazeArea ? 100.0 * cells.size() / mazeArea : 0.0) << "% of the maze)" << std::endl;
+        std::cout << "Revisits         " << steps - cells.size() << std::endl;
+        std::cout << "Frontier         max " << maxFrontier << ", mean " << (steps ? static_cast<double>(frontierSum) / steps : 0.0) << std::endl;
+        std::cout << "Flags after a step" << std::endl;
+        for (uint32_t bit = 0; bit < 6; bit++)
+            std::cout << "  " << flagNames[bit] << ' ' << flagCounts[bit] << std::endl;
+        return 0;
+    }
+
+    int Compare(const std::string& filePathA, const std::string& filePathB)
+    {
+        MazeLogReader readerA, readerB;
+        if (!readerA.Open(filePathA) || !readerB.Open(filePathB))
+            return 2;
+
+        const MazeLogHeader& headerA = readerA.GetHeader();
+        const MazeLogHeader& headerB = readerB.GetHeader();
+        std::cout << "A: ";
+        PrintHeader(headerA);
+        std::cout << "B: ";
+        PrintHeader(headerB);
+
+        if (headerA.kind != headerB.kind || headerA.cellsAcrossWidth != headerB.cellsAcrossWidth || headerA.cellsAcrossHeight != headerB.cellsAcrossHeight)
+        {
+            std::cout << "Runs are on different mazes or of different kinds" << std::endl;
+            return 1;
+        }
+        // Still compared, the steps up to where the algorithms changed can match
+        if (headerA.version != headerB.version)
+            std::cout << "Logs of version " << headerA.version << " and " << headerB.version << ", the same seed may replay differently, see MazeRecorder::VERSION" << std::endl;
+
+        // Only the first few differences are printed, the rest are counted
+        const uint64_t maxPrinted = 10;
+        uint64_t step = 0, differences = 0, cellDifferences = 0, flagDifferences = 0, frontierDifferences = 0;
+        MazeLogEvent eventA, eventB;
+        bool hasA = readerA.Next(eventA);
+        bool hasB = readerB.Next(eventB);
+
+        while (hasA && hasB)
+        {
+            bool cellDiffers = eventA.cell != eventB.cell;
+            bool flagsDiffer = eventA.flags != eventB.flags;
+            bool frontierDiffers = eventA.frontier != eventB.frontier;
+            if (cellDiffers || flagsDiffer || frontierDiffers)
+            {
+                if (differences < maxPrinted)
+                {
+                    std::cout << "Step " << step << " differs" << std::endl;
+                    PrintEvent("A", eventA);
+                    PrintEvent("B", eventB);
+                }
+                differences++;
+                cellDifferences += cellDiffers;
+                flagDifferences += flagsDiffer;
+                frontierDifferences += frontierDiffers;
+            }
+
+            step++;
+            hasA = readerA.Next(eventA);
+            hasB = readerB.Next(eventB);
+        }
+
+        uint64_t stepsA = step, stepsB = step;
+        for (; hasA; hasA = readerA.Next(eventA))
+            stepsA++;
+        for (; hasB; hasB = readerB.Next(eventB))
+            stepsB++;
+
+        if (differences == 0 && stepsA == stepsB)
+        {
+            std::cout << "Identical, " << step << " steps" << std::endl;
+            return 0;
+        }
+
+        std::cout << differences << " of " << step << " common steps differ (cell " << cellDifferences << ", flags " << flagDifferences
+            << ", frontier " << frontierDifferences << ")" << std::endl;
+        std::cout << "Steps A " << stepsA << ", B " << stepsB << std::endl;
+        return 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 3 && std::strcmp(argv[1], "stats") == 0)
+        return Stats(argv[2]);
+    if (argc == 4 && std::strcmp(argv[1], "compare") == 0)
+        return Compare(argv[2], argv[3]);
+
+    std::cout << "Usage: MazeLog stats <log>" << std::endl;
+    std::cout << "       MazeLog compare <log> <log>" << std::endl;
+    return 2;
+}
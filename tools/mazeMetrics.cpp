@@ -0,0 +1,173 @@
+// Shape statistics of mazes as JSON, see MazeMetrics
+//   MazeMetrics measure <maze> <output.json> [dfs|bfs|dijkstra|astar]
+//       one saved maze, with a solver the solution from the bottom left to the top right corner is measured too
+//   MazeMetrics sample <output.json> <count> <cells across> [backtrack|kruskal|prims|wilson|eller ...] [seed=value]
+//       count square mazes of every builder, RECURSIVE_BACKTRACK, KRUSKAL, PRIMS and WILSON by default.
+//       Registered plugins are accepted by their name too.
+//       Every maze is solved with BFS and the samples are spread over the hardware threads.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "maze.h"
+#include "mazeBuilder.h"
+#include "mazeFile.h"
+#include "mazeGraph.h"
+#include "mazeMetrics.h"
+#include "mazeRegistry.h"
+
+namespace
+{
+    // Corner to corner like the default route, returns null if the solver ran out of cells
+    const PackedPath* Solve(Maze& maze, const MazeSolverEntry& entry, std::unique_ptr<MazeSolver>& solver, MazeGraph& graph, std::pair<uint32_t, uint32_t>& route)
+    {
+        if (!graph.Build(maze))
+            return nullptr;
+
+        route = { 0, maze.m_MazeArea - 1 };
+        solver = std::make_unique<MazeSolver>(&maze, graph, entry.algorithm, route, 1);
+        entry.run(*solver);
+        return solver->m_Completed ? &solver->m_Path : nullptr;
+    }
+
+    int Measure(const std::string& mazePath, const std::string& outputPath, int argc, char** argv)
+    {
+        const MazeSolverEntry* solverEntry = argc > 0 ? MazeRegistry::FindSolver(argv[0]) : nullptr;
+        if (argc > 0 && !solverEntry)
+        {
+            std::cout << "Unknown algorithm " << argv[0] << std::endl;
+            return 2;
+        }
+
+        std::unique_ptr<Maze> maze(MazeFile::Load(mazePath));
+        if (!maze)
+            return 2;
+
+        std::unique_ptr<MazeSolver> solver;
+        MazeGraph graph;
+        std::pair<uint32_t, uint32_t> route;
+        const PackedPath* solution = nullptr;
+        if (solverEntry)
+        {
+            solution = Solve(*maze, *solverEntry, solver, graph, route);
+            if (!solution)
+                std::cout << "No path between the corners, the solution is left out" << std::endl;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        MazeMetrics metrics = MazeMetrics::Compute(*maze, solution);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Metrics of " << maze->m_MazeArea << " cells in " << elapsed.count() << " ms" << std::endl;
+
+        return metrics.WriteJson(outputPath) ? 0 : 2;
+    }
+
+    // Samples i, i + threads, i + 2 * threads ... of one builder on a maze of its own
+    void SampleThread(const MazeBuilderEntry& entry, uint32_t cellsAcross, uint32_t seed, uint32_t first, uint32_t count, uint32_t stride, MazeMetrics& metrics)
+    {
+        // Cells are 2 * 2 + 1 pixels across
+        Maze maze(cellsAcross * 5, cellsAcross * 5, 2, 1, false);
+        for (uint32_t sample = first; sample < count; sample += stride)
+        {
+            std::fill(maze.m_VisitedCellInfo.begin(), maze.m_VisitedCellInfo.end(), 0);
+            maze.m_VisitedCellCount = 0;
+            {
+                MazeBuilder builder(&maze, entry.algorithm, seed + sample);
+                entry.run(builder);
+            }
+
+            std::unique_ptr<MazeSolver> solver;
+            MazeGraph graph;
+            std::pair<uint32_t, uint32_t> route;
+            metrics.Add(MazeMetrics::Compute(maze, Solve(maze, *MazeRegistry::FindSolver(MazeSolver::BFS), solver, graph, route)));
+        }
+    }
+
+    int Sample(const std::string& outputPath, uint32_t count, uint32_t cellsAcross, int argc, char** argv)
+    {
+        uint32_t seed = 1;
+        std::vector<const MazeBuilderEntry*> builders;
+        for (int i = 0; i < argc; i++)
+        {
+            if (std::strncmp(argv[i], "seed=", 5) == 0)
+            {
+                seed = static_cast<uint32_t>(std::atoi(argv[i] + 5));
+                continue;
+            }
+            const MazeBuilderEntry* entry = MazeRegistry::FindBuilder(argv[i]);
+            if (!entry)
+            {
+                std::cout << "Unknown algorithm " << argv[i] << std::endl;
+                return 2;
+            }
+            builders.push_back(entry);
+        }
+        if (builders.empty())
+        {
+            for (uint8_t algorithm = MazeBuilder::RECURSIVE_BACKTRACK; algorithm <= MazeBuilder::WILSON; algorithm++)
+                builders.push_back(MazeRegistry::FindBuilder(algorithm));
+        }
+
+        const uint32_t threadCount = std::max(1u, std::min(std::thread::hardware_concurrency(), count));
+        std::vector<MazeMetrics> results;
+        for (const MazeBuilderEntry* builder : builders)
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            // Summed in thread order so the output only depends on the seed
+            std::vector<MazeMetrics> partials(threadCount);
+            std::vector<std::thread> threads;
+            for (uint32_t i = 0; i < threadCount; i++)
+                threads.emplace_back(SampleThread, std::cref(*builder), cellsAcross, seed, i, count, threadCount, std::ref(partials[i]));
+            for (std::thread& thread : threads)
+                thread.join();
+
+            MazeMetrics metrics;
+            for (const MazeMetrics& partial : partials)
+                metrics.Add(partial);
+            results.push_back(metrics);
+
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            std::cout << builder->name << ": " << count << " mazes in " << elapsed.count() << " s, dead ends "
+                << metrics.GetDeadEndRatio() << ", river " << metrics.GetRiver() << ", tortuosity " << metrics.GetTortuosity() << std::endl;
+        }
+
+        std::ofstream file(outputPath);
+        if (!file.is_open())
+        {
+            std::cout << "Failed to open " << outputPath << " for writing" << std::endl;
+            return 2;
+        }
+        file << "{\n";
+        for (size_t i = 0; i < builders.size(); i++)
+        {
+            file << "  \"" << builders[i]->name << "\": ";
+            results[i].WriteJson(file, "  ");
+            file << (i + 1 < builders.size() ? ",\n" : "\n");
+        }
+        file << "}\n";
+        std::cout << "Metrics written to " << outputPath << std::endl;
+        return file.good() ? 0 : 2;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc >= 4 && argc <= 5 && std::strcmp(argv[1], "measure") == 0)
+        return Measure(argv[2], argv[3], argc - 4, argv + 4);
+    if (argc >= 5 && std::strcmp(argv[1], "sample") == 0 && std::atoi(argv[3]) > 0 && std::atoi(argv[4]) > 1)
+        return Sample(argv[2], static_cast<uint32_t>(std::atoi(argv[3])), static_cast<uint32_t>(std::atoi(argv[4])), argc - 5, argv + 5);
+
+    std::cout << "Usage: MazeMetrics measure <maze> <output.json> [dfs|bfs|dijkstra|astar]" << std::endl;
+    std::cout << "       MazeMetrics sample <output.json> <count> <cells across> [backtrack|kruskal|prims|wilson|eller ...] [seed=value]" << std::endl;
+    return 2;
+}
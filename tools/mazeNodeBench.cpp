@@ -0,0 +1,223 @@
+// Compares the per cell record Dijkstra and A* use against keeping distance, parent, closed flag, weight and
+// heuristic in separate arrays, which costs a cache miss per array for every neighbour on large mazes
+//   MazeNodeBench [cells across] [uniform|terrain|radial|linear|swamp] [seed] [runs]
+// The maze is square and built with Eller's algorithm, the route goes from one corner to the opposite one.
+// Every layout is run a few times and the fastest run is reported.
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "maze.h"
+#include "mazeBuilder.h"
+#include "mazeGraph.h"
+#include "mazeSolver.h"
+#include "mazeWeights.h"
+
+namespace
+{
+    struct RunResult
+    {
+        uint64_t steps = 0;
+        double milliseconds = 0.0;
+        size_t bytesPerCell = 0;
+        PackedPath path;
+    };
+
+    // The layout the solver used before the records, one array per field and the parent as a cell id
+    template<bool WithHeuristic, typename Weight>
+    RunResult RunSplit(Maze& maze, const MazeGraph& graph, const std::vector<Weight>& weights, std::pair<uint32_t, uint32_t> route)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        const uint32_t mazeArea = maze.m_MazeArea;
+        const uint32_t cellsAcrossHeight = maze.m_CellsAcrossHeight;
+        std::vector<uint32_t> distances(mazeArea, std::numeric_limits<uint32_t>::max());
+        std::vector<uint32_t> parents(mazeArea, route.first);
+        std::vector<uint8_t> closed(mazeArea, 0);
+        std::vector<uint32_t> heuristic;
+        if constexpr (WithHeuristic)
+        {
+            heuristic.resize(mazeArea);
+            uint32_t xEnd = route.second / cellsAcrossHeight;
+            uint32_t yEnd = route.second % cellsAcrossHeight;
+            for (uint32_t xCurrent = 0, i = 0; xCurrent < maze.m_CellsAcrossWidth; xCurrent++)
+            {
+                uint64_t xDifference = xCurrent > xEnd ? (xCurrent - xEnd) : (xEnd - xCurrent);
+                for (uint32_t yCurrent = 0; yCurrent < cellsAcrossHeight; yCurrent++, i++)
+                {
+                    uint64_t yDifference = yCurrent > yEnd ? (yCurrent - yEnd) : (yEnd - yCurrent);
+                    heuristic[i] = static_cast<uint32_t>(std::sqrt(static_cast<double>(xDifference * xDifference + yDifference * yDifference)));
+                }
+            }
+        }
+
+        std::priority_queue<WeightDetails, std::vector<WeightDetails>, CompareWeights> queue;
+        distances[route.first] = 0;
+        queue.push({ route.first, 0 });
+
+        RunResult result;
+        while (!queue.empty() && queue.top().id != route.second)
+        {
+            uint32_t currentCell = queue.top().id;
+            queue.pop();
+            result.steps++;
+
+            if (closed[currentCell])
+                continue;
+            closed[currentCell] = 1;
+
+            for (const uint32_t* neighbour = graph.GetNeighboursBegin(currentCell); neighbour != graph.GetNeighboursEnd(currentCell); neighbour++)
+            {
+                uint32_t nextCell = *neighbour;
+                if (closed[nextCell])
+                    continue;
+
+                uint32_t nextDistance = distances[currentCell] + weights[nextCell];
+                if (distances[nextCell] > nextDistance)
+                {
+                    distances[nextCell] = nextDistance;
+                    parents[nextCell] = currentCell;
+                    // A* orders by the cost plus the heuristic like MazeSolver
+                    if constexpr (WithHeuristic)
+                        queue.push({ nextCell, nextDistance + heuristic[nextCell] });
+                    else
+                        queue.push({ nextCell, nextDistance });
+                    maze.m_VisitedCellInfo[nextCell] |= Maze::CELL_SEARCHED;
+                }
+            }
+        }
+
+        result.path.Reset(route.second, cellsAcrossHeight);
+        for (uint32_t cell = route.second; cell != route.first; cell = parents[cell])
+            result.path.Append(parents[cell]);
+        result.path.Reverse();
+
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        result.milliseconds = elapsed.count();
+        result.bytesPerCell = sizeof(uint32_t) * 2 + sizeof(uint8_t) + sizeof(Weight) + (WithHeuristic ? sizeof(uint32_t) : 0);
+        return result;
+    }
+
+    RunResult RunPacked(Maze& maze, const MazeGraph& graph, uint8_t algorithm, std::pair<uint32_t, uint32_t> route)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        RunResult result;
+        MazeSolver solver(&maze, graph, algorithm, route);
+        // Same completion check as the simulation thread
+        while (!solver.m_PQueue.empty() && solver.m_PQueue.top().id != route.second)
+        {
+            if (algorithm == MazeSolver::ASTAR)
+                solver.AstarSearch();
+            else
+                solver.DijkstraSearch();
+            result.steps++;
+        }
+        solver.OnCompletion();
+        result.path = solver.m_Path;
+
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        result.milliseconds = elapsed.count();
+        // Compact records leave the weight in the maze, which is read for every relaxation too
+        result.bytesPerCell = solver.m_CompactNodes.empty() ? sizeof(MazeSolverNode) : sizeof(MazeSolverCompactNode) + maze.m_CellWeights.GetWidth();
+        return result;
+    }
+
+    void ClearSearched(Maze& maze)
+    {
+        for (uint16_t& cell : maze.m_VisitedCellInfo)
+            cell &= ~Maze::CELL_SEARCHED;
+    }
+
+    void Report(const char* layout, const char* algorithm, const RunResult& result)
+    {
+        std::cout << algorithm << " " << layout << ": " << result.steps << " steps in " << result.milliseconds << " ms, "
+            << result.milliseconds * 1e6 / std::max<uint64_t>(result.steps, 1) << " ns per step, "
+            << result.bytesPerCell << " bytes per cell" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // 2048 across is a little over 4 million cells, well past the caches
+    uint32_t cellsAcross = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 2048;
+    MazeWeightSettings settings;
+    settings.generator = MazeWeightSettings::TERRAIN;
+    if (argc > 2)
+    {
+        bool found = false;
+        for (uint8_t i = MazeWeightSettings::UNIFORM; i <= MazeWeightSettings::SWAMP; i++)
+        {
+            std::string candidate = MazeWeights::GetGeneratorName(i);
+            std::string name = argv[2];
+            if (candidate.size() == name.size() && std::equal(name.begin(), name.end(), candidate.begin(),
+                [](char a, char b) { return std::tolower(a) == std::tolower(b); }))
+            {
+                settings.generator = i;
+                found = true;
+            }
+        }
+        if (!found)
+            cellsAcross = 0;
+    }
+    settings.seed = argc > 3 ? static_cast<uint32_t>(std::atoi(argv[3])) : 1;
+    int runs = argc > 4 ? std::atoi(argv[4]) : 3;
+
+    if (cellsAcross < 2 || runs < 1)
+    {
+        std::cout << "Usage: MazeNodeBench [cells across] [uniform|terrain|radial|linear|swamp] [seed] [runs]" << std::endl;
+        return 2;
+    }
+
+    // Cells are 2 * 2 + 1 pixels across
+    Maze maze(cellsAcross * 5, cellsAcross * 5, 2, 1, false);
+    MazeBuilder builder(&maze, MazeBuilder::ELLER, settings.seed);
+    while (!maze.MazeCompleted())
+        builder.Eller();
+    maze.SetCellWeights(settings);
+
+    MazeGraph graph;
+    if (!graph.Build(maze))
+        return 2;
+
+    const std::pair<uint32_t, uint32_t> route(0, maze.m_MazeArea - 1);
+    bool matching = true;
+    for (uint8_t algorithm : { MazeSolver::DIJKSTRA, MazeSolver::ASTAR })
+    {
+        const char* name = algorithm == MazeSolver::ASTAR ? "A*" : "Dijkstra";
+
+        RunResult split, packed;
+        // Alternated so both layouts see the same state of the machine
+        for (int run = 0; run < runs; run++)
+        {
+            RunResult result = maze.m_CellWeights.Visit([&](const auto& weights)
+                {
+                    return algorithm == MazeSolver::ASTAR ? RunSplit<true>(maze, graph, weights, route) : RunSplit<false>(maze, graph, weights, route);
+                });
+            ClearSearched(maze);
+            if (run == 0 || result.milliseconds < split.milliseconds)
+                split = std::move(result);
+
+            result = RunPacked(maze, graph, algorithm, route);
+            ClearSearched(maze);
+            if (run == 0 || result.milliseconds < packed.milliseconds)
+                packed = std::move(result);
+        }
+        Report("split arrays", name, split);
+        Report("node records", name, packed);
+
+        std::cout << name << " node records are " << split.milliseconds / packed.milliseconds << "x the speed of split arrays" << std::endl;
+        if (packed.path != split.path || packed.steps != split.steps)
+        {
+            std::cout << name << " layouts found different paths" << std::endl;
+            matching = false;
+        }
+    }
+
+    return matching ? 0 : 1;
+}
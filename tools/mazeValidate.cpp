@@ -0,0 +1,406 @@
+// Correctness checks of the builders and solvers, see MazeValidator
+//   MazeValidate check <maze> [dfs|bfs|dijkstra|astar ...]
+//       walls of a saved maze, with solvers also their paths from the bottom left to the top right corner.
+//       The graph and the solvers read the file through its mapping, registered plugins get the decoded maze
+//   MazeValidate random <rounds> [max=cells across] [seed=value] [braid=percent]
+//       Every round picks a size up to max (256 by default) and a seed. Every registered builder builds it twice,
+//       with its batch run loop and step by step, the two have to match and be perfect. Eller is compared with
+//       MazeStreamBuilder. Every TopologyMaze builder builds a torus, hexagon, triangle and layered maze of about the
+//       same size, which has to be perfect, and its BFS path has to match the reference.
+//       braid opens that share of the walls left afterwards so there are loops and solvers can go wrong.
+//       Every registered solver then runs between two random cells, batch and step by step again, and its path is
+//       checked against the reference solver of MazeValidator. BFS has to take the fewest steps and Dijkstra the
+//       lowest cost. The others only have to on perfect mazes, where there is a single path, with loops they are
+//       only reported. A* is measured by cost, it is only exact when no weight is 0.
+//       At the end the structures of the maze, graph and solver which reserved the most memory are printed.
+// The example plugins of plugins/ are linked in, so they are checked like the algorithms of MazeBuilder and MazeSolver.
+// Exits with 1 when anything failed.
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "maze.h"
+#include "mazeBuilder.h"
+#include "mazeFile.h"
+#include "mazeGraph.h"
+#include "mazeMemory.h"
+#include "mazeRegistry.h"
+#include "mazeStreamBuilder.h"
+#include "mazeTopology.h"
+#include "mazeValidator.h"
+#include "mazeWeights.h"
+
+namespace
+{
+    // Printing stops after this many, the count goes on
+    const uint64_t MAX_PRINTED_FAILURES = 20;
+
+    struct Totals
+    {
+        uint64_t checks = 0;
+        uint64_t failures = 0;
+        // Paths of inexact solvers which were longer than the reference
+        uint64_t detours = 0;
+    };
+
+    std::map<std::string, Totals> totals;
+    uint64_t failureCount = 0;
+    // Largest solver run so far and where it was
+    MazeMemoryReport peakMemory;
+    std::string peakMemoryWhere;
+
+    void Check(const std::string& name, bool passed, const std::string& what)
+    {
+        Totals& total = totals[name];
+        total.checks++;
+        if (passed)
+            return;
+
+        total.failures++;
+        if (failureCount++ < MAX_PRINTED_FAILURES)
+            std::cout << "FAIL " << name << ": " << what << std::endl;
+    }
+
+    // Only the number of cells matters, 5 pixels a cell like MazeBench
+    std::unique_ptr<Maze> CreateMaze(uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight)
+    {
+        return std::make_unique<Maze>(cellsAcrossWidth * 5, cellsAcrossHeight * 5, 2, 1, false);
+    }
+
+    std::unique_ptr<Maze> Build(const MazeBuilderEntry& entry, uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight, uint32_t seed, bool stepwise)
+    {
+        std::unique_ptr<Maze> maze = CreateMaze(cellsAcrossWidth, cellsAcrossHeight);
+        MazeBuilder builder(maze.get(), entry.algorithm, seed);
+        if (stepwise)
+        {
+            while (!maze->MazeCompleted())
+                builder.Step();
+        }
+        else
+        {
+            entry.run(builder);
+        }
+        builder.m_Completed = true;
+        builder.OnCompletion();
+        return maze;
+    }
+
+    std::string Describe(const std::string& name, uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight, uint32_t seed)
+    {
+        return name + " " + std::to_string(cellsAcrossWidth) + "x" + std::to_string(cellsAcrossHeight) + " seed " + std::to_string(seed);
+    }
+
+    // Opens about percent of the closed inner walls
+    void Braid(Maze& maze, uint32_t percent, std::mt19937& generator)
+    {
+        const uint32_t cellsAcrossHeight = maze.m_CellsAcrossHeight;
+        std::vector<uint16_t>& cellInfo = maze.m_VisitedCellInfo;
+        for (uint32_t cell = 0; cell < maze.m_MazeArea; cell++)
+        {
+            if (cell % cellsAcrossHeight + 1 < cellsAcrossHeight && (cellInfo[cell] & Maze::CELL_NORTH) == 0 && generator() % 100 < percent)
+            {
+                cellInfo[cell] |= Maze::CELL_NORTH;
+                cellInfo[cell + 1] |= Maze::CELL_SOUTH;
+            }
+            if (cell + cellsAcrossHeight < maze.m_MazeArea && (cellInfo[cell] & Maze::CELL_EAST) == 0 && generator() % 100 < percent)
+            {
+                cellInfo[cell] |= Maze::CELL_EAST;
+                cellInfo[cell + cellsAcrossHeight] |= Maze::CELL_WEST;
+            }
+        }
+    }
+
+    // A* orders by cost plus heuristic, its paths are as cheap as Dijkstra's unless 0 weights make the heuristic overestimate
+    MazeValidator::Costs GetCosts(uint8_t algorithm)
+    {
+        return algorithm == MazeSolver::DIJKSTRA || algorithm == MazeSolver::ASTAR ? MazeValidator::WEIGHTS : MazeValidator::STEPS;
+    }
+
+    // Solvers which promise the cheapest path on any maze
+    bool IsExact(uint8_t algorithm)
+    {
+        return algorithm == MazeSolver::BFS || algorithm == MazeSolver::DIJKSTRA;
+    }
+
+    bool SamePath(const PackedPath& a, const PackedPath& b)
+    {
+        if (a.size() != b.size())
+            return false;
+        for (PackedPath::Iterator i = a.begin(), j = b.begin(); i != a.end(); ++i, ++j)
+        {
+            if (*i != *j)
+                return false;
+        }
+        return true;
+    }
+
+    void CheckBuilders(uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight, uint32_t seed)
+    {
+        for (const MazeBuilderEntry& entry : MazeRegistry::GetBuilders())
+        {
+            const std::string where = Describe(entry.name, cellsAcrossWidth, cellsAcrossHeight, seed);
+            std::unique_ptr<Maze> batch = Build(entry, cellsAcrossWidth, cellsAcrossHeight, seed, false);
+            std::unique_ptr<Maze> stepped = Build(entry, cellsAcrossWidth, cellsAcrossHeight, seed, true);
+
+            MazeValidation validation = MazeValidator::CheckMaze(*batch);
+            Check(entry.name, validation.IsPerfect(), where + ": " + validation.error);
+            Check(entry.name, batch->m_VisitedCellInfo == stepped->m_VisitedCellInfo, where + ": batch and step by step builds differ");
+
+            if (entry.algorithm != MazeBuilder::ELLER)
+                continue;
+
+            // Streamed columns use the maze file wall bits, 1 north and 2 east
+            bool same = true;
+            MazeStreamBuilder stream;
+            stream.Reset(cellsAcrossWidth, cellsAcrossHeight, seed);
+            stream.Run([&](uint32_t column, const std::vector<uint8_t>& wallBits)
+                {
+                    for (uint32_t y = 0; y < cellsAcrossHeight; y++)
+                    {
+                        const uint16_t info = batch->m_VisitedCellInfo[column * cellsAcrossHeight + y];
+                        same &= ((info & Maze::CELL_NORTH) != 0) == ((wallBits[y] & 0x01) != 0);
+                        same &= ((info & Maze::CELL_EAST) != 0) == ((wallBits[y] & 0x02) != 0);
+                    }
+                    return same;
+                });
+            Check("stream", same, where + ": MazeStreamBuilder and MazeBuilder differ");
+        }
+    }
+
+    // Every builder of TopologyMaze on one topology, each maze has to be perfect and BFS has to find the path with
+    // the fewest steps between two random cells
+    template<typename Topology>
+    void CheckTopologyKernels(const char* topologyName, const MazeTopologySize& size, uint32_t seed, std::mt19937& generator)
+    {
+        using Kernel = void (TopologyMaze<Topology>::*)(uint32_t);
+        const std::pair<const char*, Kernel> kernels[] = {
+            { "backtrack", &TopologyMaze<Topology>::BuildBacktrack },
+            { "kruskal", &TopologyMaze<Topology>::BuildKruskal },
+            { "prims", &TopologyMaze<Topology>::BuildPrims },
+            { "wilson", &TopologyMaze<Topology>::BuildWilson }
+        };
+
+        TopologyMaze<Topology> topology(size);
+        for (const auto& kernel : kernels)
+        {
+            const std::string name = std::string(topologyName) + " " + kernel.first;
+            const std::string where = Describe(name, topology.m_Size.width, topology.m_Size.height, seed) + "x" + std::to_string(topology.m_Size.layers);
+            (topology.*kernel.second)(seed);
+            const MazeValidation validation = MazeValidator::CheckTopologyWalls<Topology>(topology.m_CellInfo, topology.m_Size);
+            Check(name, validation.IsPerfect(), where + ": " + validation.error);
+
+            const std::pair<uint32_t, uint32_t> route(generator() % topology.m_CellCount, generator() % topology.m_CellCount);
+            std::vector<uint32_t> path;
+            topology.Solve(route.first, route.second, path);
+            const MazePathValidation pathValidation = MazeValidator::CheckTopologyPath<Topology>(topology.m_CellInfo, topology.m_Size, route, path);
+            Check(std::string(topologyName) + " bfs", pathValidation.connected && pathValidation.optimal, where + ": " + pathValidation.error);
+        }
+    }
+
+    void CheckTopologies(uint32_t cellsAcrossWidth, uint32_t cellsAcrossHeight, uint32_t seed, std::mt19937& generator)
+    {
+        // TopologyMaze raises the torus to 3 cells across itself
+        CheckTopologyKernels<TorusTopology>("torus", { cellsAcrossWidth, cellsAcrossHeight, 1 }, seed, generator);
+        CheckTopologyKernels<HexTopology>("hex", { cellsAcrossWidth, cellsAcrossHeight, 1 }, seed, generator);
+        CheckTopologyKernels<TriangleTopology>("triangle", { cellsAcrossWidth, cellsAcrossHeight, 1 }, seed, generator);
+        // Layers multiply the cells, so they get a quarter of the area each
+        const MazeTopologySize layered = { std::max(cellsAcrossWidth / 2, 2u), std::max(cellsAcrossHeight / 2, 2u), 2 + static_cast<uint32_t>(generator() % 3) };
+        CheckTopologyKernels<LayeredTopology>("layered", layered, seed, generator);
+    }
+
+    void CheckSolvers(Maze& maze, bool perfect, uint32_t seed, std::mt19937& generator)
+    {
+        MazeGraph graph;
+        graph.Build(maze);
+
+        MazeWeightSettings weights;
+        weights.seed = seed;
+        maze.SetCellWeights(weights);
+
+        const uint32_t area = maze.m_MazeArea;
+        std::pair<uint32_t, uint32_t> route(generator() % area, generator() % area);
+        if (route.first == route.second)
+            route.second = (route.second + 1) % area;
+
+        for (const MazeSolverEntry& entry : MazeRegistry::GetSolvers())
+        {
+            const std::string where = Describe(entry.name, maze.m_CellsAcrossWidth, maze.m_CellsAcrossHeight, seed) + " route " +
+                std::to_string(route.first) + "-" + std::to_string(route.second);
+
+            // Searched cells go to overlays so the maze stays the same for every solver
+            std::vector<uint16_t> batchOverlay = maze.m_VisitedCellInfo, steppedOverlay = maze.m_VisitedCellInfo;
+            std::pair<uint32_t, uint32_t> batchRoute = route, steppedRoute = route;
+            MazeSolver batch(&maze, graph, entry.algorithm, batchRoute, seed, &batchOverlay);
+            MazeSolver stepped(&maze, graph, entry.algorithm, steppedRoute, seed, &steppedOverlay);
+            entry.run(batch);
+            while (!stepped.m_Completed && stepped.GetFrontierSize() > 0)
+                stepped.Step();
+
+            Check(entry.name, batch.m_Completed == stepped.m_Completed && SamePath(batch.m_Path, stepped.m_Path),
+                where + ": batch and step by step paths differ");
+
+            MazeMemoryReport memory;
+            maze.ReportMemory(memory);
+            graph.ReportMemory(memory);
+            batch.ReportMemory(memory);
+            if (memory.GetReservedBytes() > peakMemory.GetReservedBytes())
+            {
+                peakMemory = memory;
+                peakMemoryWhere = where;
+            }
+
+            const MazeValidator::Costs costs = GetCosts(entry.algorithm);
+            if (!batch.m_Completed)
+            {
+                const uint64_t reference = MazeValidator::GetReferenceCost(maze, route, costs);
+                Check(entry.name, reference == UINT64_MAX, where + ": gave up, the reference reaches the goal");
+                continue;
+            }
+
+            MazePathValidation validation = MazeValidator::CheckPath(maze, route, batch.m_Path, costs);
+            if (!validation.connected || perfect || IsExact(entry.algorithm))
+            {
+                Check(entry.name, validation.connected && validation.optimal, where + ": " + validation.error);
+                continue;
+            }
+
+            // Loops let inexact solvers take a detour, that is how they work and not a failure
+            Check(entry.name, true, "");
+            totals[entry.name].detours += !validation.optimal;
+        }
+    }
+
+    int Random(uint32_t rounds, int argc, char** argv)
+    {
+        uint32_t maxCells = 256;
+        uint32_t seed = 1;
+        uint32_t braid = 0;
+        for (int i = 0; i < argc; i++)
+        {
+            const std::string argument = argv[i];
+            if (argument.rfind("max=", 0) == 0)
+                maxCells = std::max(std::atoi(argument.c_str() + 4), 2);
+            else if (argument.rfind("seed=", 0) == 0)
+                seed = static_cast<uint32_t>(std::strtoul(argument.c_str() + 5, nullptr, 10));
+            else if (argument.rfind("braid=", 0) == 0)
+                braid = std::min(std::atoi(argument.c_str() + 6), 100);
+            else
+            {
+                std::cout << "Unknown option " << argument << std::endl;
+                return 2;
+            }
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        std::mt19937 generator(seed);
+        for (uint32_t round = 0; round < rounds; round++)
+        {
+            const uint32_t cellsAcrossWidth = 2 + generator() % (maxCells - 1);
+            const uint32_t cellsAcrossHeight = 2 + generator() % (maxCells - 1);
+            const uint32_t mazeSeed = generator();
+
+            CheckBuilders(cellsAcrossWidth, cellsAcrossHeight, mazeSeed);
+            CheckTopologies(cellsAcrossWidth, cellsAcrossHeight, mazeSeed, generator);
+
+            // Solvers get a maze of the next builder in turn
+            const std::vector<MazeBuilderEntry>& builders = MazeRegistry::GetBuilders();
+            std::unique_ptr<Maze> maze = Build(builders[round % builders.size()], cellsAcrossWidth, cellsAcrossHeight, mazeSeed, false);
+            if (braid > 0)
+                Braid(*maze, braid, generator);
+            CheckSolvers(*maze, braid == 0, mazeSeed, generator);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        for (const auto& total : totals)
+        {
+            std::cout << total.first << ": " << total.second.checks << " checks, " << total.second.failures << " failed";
+            if (total.second.detours > 0)
+                std::cout << ", " << total.second.detours << " paths longer than the reference";
+            std::cout << std::endl;
+        }
+        std::cout << "\nPeak memory, structures of " << peakMemoryWhere << ":\n";
+        peakMemory.Print(std::cout);
+        std::cout << rounds << " rounds in " << elapsed.count() << " s, " << failureCount << " failures" << std::endl;
+        return failureCount == 0 ? 0 : 1;
+    }
+
+    int CheckFile(const std::string& mazePath, int argc, char** argv)
+    {
+        std::vector<const MazeSolverEntry*> solvers;
+        for (int i = 0; i < argc; i++)
+        {
+            const MazeSolverEntry* entry = MazeRegistry::FindSolver(argv[i]);
+            if (!entry)
+            {
+                std::cout << "Unknown algorithm " << argv[i] << std::endl;
+                return 2;
+            }
+            solvers.push_back(entry);
+        }
+
+        // Solvers run on the mapping, the decoded maze is only the reference they are checked against
+        MappedMazeFile file;
+        if (!file.Open(mazePath))
+            return 2;
+        std::unique_ptr<Maze> maze(file.CreateMaze(10, 2));
+        if (!maze)
+            return 2;
+
+        const MazeValidation validation = MazeValidator::CheckMaze(*maze);
+        std::cout << maze->m_CellsAcrossWidth << "x" << maze->m_CellsAcrossHeight << ": " << validation.passages << " passages, "
+            << validation.loops << " loops, " << validation.components << " regions, " << validation.mismatchedWalls << " mismatched walls, "
+            << validation.outerPassages << " passages out of the maze, " << validation.unvisitedCells << " unvisited cells" << std::endl;
+        std::cout << (validation.IsPerfect() ? "Perfect maze" : "Not a perfect maze: " + validation.error) << std::endl;
+
+        MazeGraph graph, mappedGraph;
+        graph.Build(*maze);
+        mappedGraph.Build(file);
+        Check("mapped graph", mappedGraph.m_Offsets == graph.m_Offsets && mappedGraph.m_Targets == graph.m_Targets,
+            "differs from the graph of the decoded maze");
+
+        const std::pair<uint32_t, uint32_t> route(0, maze->m_MazeArea - 1);
+        for (const MazeSolverEntry* entry : solvers)
+        {
+            // Registered plugins work on a Maze
+            const bool mapped = entry->createPlugin == nullptr;
+            std::vector<uint16_t> overlay = mapped ? std::vector<uint16_t>(maze->m_MazeArea, 0) : maze->m_VisitedCellInfo;
+            std::pair<uint32_t, uint32_t> solverRoute = route;
+            std::unique_ptr<MazeSolver> solver(mapped ? new MazeSolver(file, mappedGraph, entry->algorithm, solverRoute, 1, overlay) :
+                new MazeSolver(maze.get(), graph, entry->algorithm, solverRoute, 1, &overlay));
+            entry->run(*solver);
+
+            if (!solver->m_Completed)
+            {
+                const bool reachable = MazeValidator::GetReferenceCost(*maze, route, GetCosts(entry->algorithm)) != UINT64_MAX;
+                Check(entry->name, !reachable, "gave up, the reference reaches the goal");
+                std::cout << entry->name << ": no path" << std::endl;
+                continue;
+            }
+
+            const MazePathValidation path = MazeValidator::CheckPath(*maze, route, solver->m_Path, GetCosts(entry->algorithm));
+            std::cout << entry->name << ": cost " << path.cost << ", reference " << path.referenceCost << (path.error.empty() ? "" : ", " + path.error) << std::endl;
+            Check(entry->name, path.connected && (path.optimal || (!IsExact(entry->algorithm) && !validation.IsPerfect())), path.error);
+        }
+
+        return validation.IsConsistent() && failureCount == 0 ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc >= 3 && std::strcmp(argv[1], "check") == 0)
+        return CheckFile(argv[2], argc - 3, argv + 3);
+    if (argc >= 3 && std::strcmp(argv[1], "random") == 0 && std::atoi(argv[2]) > 0)
+        return Random(static_cast<uint32_t>(std::atoi(argv[2])), argc - 3, argv + 3);
+
+    std::cout << "Usage: MazeValidate check <maze> [dfs|bfs|dijkstra|astar ...]" << std::endl;
+    std::cout << "       MazeValidate random <rounds> [max=cells across] [seed=value] [braid=percent]" << std::endl;
+    return 2;
+}
@@ -0,0 +1,143 @@
+// Weight fields for saved mazes, for benchmarking weighted solvers on something other than noise
+//   MazeWeights generate <maze> <generator> [option=value ...]    replaces the weights stored in a maze file
+//   MazeWeights import <maze> <weight map> [max=value]          stores a .pgm/.ppm image or raw weights in a maze file
+//   MazeWeights export <maze> <weight map>                      writes the weights of a maze file as .pgm or raw
+// Generators are uniform, terrain, radial, linear and swamp. Options are seed, max, size, octaves,
+// centerx, centery, angle, patches, radius and invert=1, see MazeWeightSettings.
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "maze.h"
+#include "mazeFile.h"
+#include "mazeWeights.h"
+
+namespace
+{
+    bool ParseGenerator(const std::string& name, uint8_t& generator)
+    {
+        for (uint8_t i = MazeWeightSettings::UNIFORM; i <= MazeWeightSettings::SWAMP; i++)
+        {
+            std::string candidate = MazeWeights::GetGeneratorName(i);
+            if (candidate.size() == name.size() && std::equal(name.begin(), name.end(), candidate.begin(),
+                [](char a, char b) { return std::tolower(a) == std::tolower(b); }))
+            {
+                generator = i;
+                return true;
+            }
+        }
+        std::cout << "Unknown generator " << name << std::endl;
+        return false;
+    }
+
+    bool ParseOption(const std::string& option, MazeWeightSettings& settings)
+    {
+        size_t separator = option.find('=');
+        if (separator == std::string::npos)
+        {
+            std::cout << "Options are name=value, got " << option << std::endl;
+            return false;
+        }
+
+        std::string name = option.substr(0, separator);
+        double value = std::atof(option.c_str() + separator + 1);
+        if (name == "seed")
+            settings.seed = static_cast<uint32_t>(value);
+        else if (name == "max")
+            settings.maxWeight = static_cast<uint32_t>(value);
+        else if (name == "size")
+            settings.featureSize = static_cast<float>(value);
+        else if (name == "octaves")
+            settings.octaves = static_cast<uint32_t>(value);
+        else if (name == "centerx")
+            settings.centerX = static_cast<float>(value);
+        else if (name == "centery")
+            settings.centerY = static_cast<float>(value);
+        else if (name == "angle")
+            settings.angle = static_cast<float>(value);
+        else if (name == "patches")
+            settings.patchCount = static_cast<uint32_t>(value);
+        else if (name == "radius")
+            settings.patchRadius = static_cast<float>(value);
+        else if (name == "invert")
+            settings.invert = value != 0.0;
+        else
+        {
+            std::cout << "Unknown option " << name << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    int Generate(const std::string& mazePath, int argc, char** argv)
+    {
+        MazeWeightSettings settings;
+        if (!ParseGenerator(argv[0], settings.generator))
+            return 2;
+        for (int i = 1; i < argc; i++)
+        {
+            if (!ParseOption(argv[i], settings))
+                return 2;
+        }
+
+        std::unique_ptr<Maze> maze(MazeFile::Load(mazePath));
+        if (!maze)
+            return 2;
+
+        auto start = std::chrono::steady_clock::now();
+        maze->SetCellWeights(settings);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << MazeWeights::GetGeneratorName(settings.generator) << " weights for " << maze->m_MazeArea
+            << " cells in " << elapsed.count() << " ms" << std::endl;
+
+        return MazeFile::Save(mazePath, *maze, true) ? 0 : 2;
+    }
+
+    int Import(const std::string& mazePath, const std::string& weightPath, int argc, char** argv)
+    {
+        MazeWeightSettings settings;
+        for (int i = 0; i < argc; i++)
+        {
+            if (!ParseOption(argv[i], settings))
+                return 2;
+        }
+
+        std::unique_ptr<Maze> maze(MazeFile::Load(mazePath));
+        if (!maze)
+            return 2;
+        if (!MazeWeights::Load(weightPath, maze->m_CellWeights, maze->m_CellsAcrossWidth, maze->m_CellsAcrossHeight, settings.maxWeight))
+            return 2;
+
+        return MazeFile::Save(mazePath, *maze, true) ? 0 : 2;
+    }
+
+    int Export(const std::string& mazePath, const std::string& weightPath)
+    {
+        std::unique_ptr<Maze> maze(MazeFile::Load(mazePath));
+        if (!maze)
+            return 2;
+
+        return MazeWeights::Write(weightPath, maze->m_CellWeights, maze->m_CellsAcrossWidth, maze->m_CellsAcrossHeight) ? 0 : 2;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc >= 4 && std::strcmp(argv[1], "generate") == 0)
+        return Generate(argv[2], argc - 3, argv + 3);
+    if (argc >= 4 && std::strcmp(argv[1], "import") == 0)
+        return Import(argv[2], argv[3], argc - 4, argv + 4);
+    if (argc == 4 && std::strcmp(argv[1], "export") == 0)
+        return Export(argv[2], argv[3]);
+
+    std::cout << "Usage: MazeWeights generate <maze> <uniform|terrain|radial|linear|swamp> [option=value ...]" << std::endl;
+    std::cout << "       MazeWeights import <maze> <weight map> [max=value]" << std::endl;
+    std::cout << "       MazeWeights export <maze> <weight map>" << std::endl;
+    return 2;
+}